@@ -34,7 +34,6 @@
 #include "core/os/copymem.h"
 #include "core/os/memory.h"
 #include "core/os/rw_lock.h"
-#include "core/pool_allocator.h"
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
@@ -42,38 +41,52 @@ struct MemoryPool {
 
 	//avoid accessing these directly, must be public for template access
 
-	static PoolAllocator *memory_pool;
-	static uint8_t *pool_memory;
-	static size_t *pool_size;
-
 	struct Alloc {
 
 		SafeRefCount refcount;
 		uint32_t lock;
 		void *mem;
-		PoolAllocator::ID pool_id;
 		size_t size;
 
-		Alloc *free_list;
-
 		Alloc() :
 				lock(0),
 				mem(NULL),
-				pool_id(POOL_ALLOCATOR_INVALID_ID),
-				size(0),
-				free_list(NULL) {
+				size(0) {
 		}
 	};
 
-	static Alloc *allocs;
-	static Alloc *free_list;
-	static uint32_t alloc_count;
+	//all counters are atomic, no lock is taken when allocs come and go
 	static uint32_t allocs_used;
-	static Mutex *alloc_mutex;
-	static size_t total_memory;
-	static size_t max_memory;
+	static uint64_t total_memory;
+	static uint64_t max_memory;
+
+	_FORCE_INLINE_ static Alloc *alloc_new() {
+
+		Alloc *alloc = memnew(Alloc);
+		alloc->refcount.init();
+		atomic_increment(&allocs_used);
+		return alloc;
+	}
+
+	_FORCE_INLINE_ static void alloc_free(Alloc *p_alloc) {
+
+		if (p_alloc->mem) {
+			memfree(p_alloc->mem);
+		}
+		memdelete(p_alloc);
+		atomic_decrement(&allocs_used);
+	}
+
+	_FORCE_INLINE_ static void track_resize(size_t p_from, size_t p_to) {
+#ifdef DEBUG_ENABLED
+		if (p_to > p_from) {
+			atomic_exchange_if_greater(&max_memory, atomic_add(&total_memory, uint64_t(p_to - p_from)));
+		} else if (p_to < p_from) {
+			atomic_sub(&total_memory, uint64_t(p_from - p_to));
+		}
+#endif
+	}
 
-	static void setup(uint32_t p_max_allocs = (1 << 16));
 	static void cleanup();
 };
 
@@ -99,41 +112,12 @@ class PoolVector {
 
 		//must allocate something
 
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_EXPLAINC("All memory pool allocations are in use, can't COW.");
-			ERR_FAIL();
-		}
-
 		MemoryPool::Alloc *old_alloc = alloc;
 
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
-
-		//copy the alloc data
+		alloc = MemoryPool::alloc_new();
 		alloc->size = old_alloc->size;
-		alloc->refcount.init();
-		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		alloc->lock = 0;
-
-#ifdef DEBUG_ENABLED
-		MemoryPool::total_memory += alloc->size;
-		if (MemoryPool::total_memory > MemoryPool::max_memory) {
-			MemoryPool::max_memory = MemoryPool::total_memory;
-		}
-#endif
-
-		MemoryPool::alloc_mutex->unlock();
-
-		if (MemoryPool::memory_pool) {
-
-		} else {
-			alloc->mem = memalloc(alloc->size);
-		}
+		alloc->mem = memalloc(alloc->size);
+		MemoryPool::track_resize(0, alloc->size);
 
 		{
 			Write w;
@@ -152,11 +136,7 @@ class PoolVector {
 		if (old_alloc->refcount.unref()) {
 			//this should never happen but..
 
-#ifdef DEBUG_ENABLED
-			MemoryPool::alloc_mutex->lock();
-			MemoryPool::total_memory -= old_alloc->size;
-			MemoryPool::alloc_mutex->unlock();
-#endif
+			MemoryPool::track_resize(old_alloc->size, 0);
 
 			{
 				Write w;
@@ -169,22 +149,7 @@ class PoolVector {
 				}
 			}
 
-			if (MemoryPool::memory_pool) {
-				//resize memory pool
-				//if none, create
-				//if some resize
-			} else {
-
-				memfree(old_alloc->mem);
-				old_alloc->mem = NULL;
-				old_alloc->size = 0;
-
-				MemoryPool::alloc_mutex->lock();
-				old_alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = old_alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
-			}
+			MemoryPool::alloc_free(old_alloc);
 		}
 	}
 
@@ -231,28 +196,8 @@ class PoolVector {
 			}
 		}
 
-#ifdef DEBUG_ENABLED
-		MemoryPool::alloc_mutex->lock();
-		MemoryPool::total_memory -= alloc->size;
-		MemoryPool::alloc_mutex->unlock();
-#endif
-
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
-		} else {
-
-			memfree(alloc->mem);
-			alloc->mem = NULL;
-			alloc->size = 0;
-
-			MemoryPool::alloc_mutex->lock();
-			alloc->free_list = MemoryPool::free_list;
-			MemoryPool::free_list = alloc;
-			MemoryPool::allocs_used--;
-			MemoryPool::alloc_mutex->unlock();
-		}
+		MemoryPool::track_resize(alloc->size, 0);
+		MemoryPool::alloc_free(alloc);
 
 		alloc = NULL;
 	}
@@ -268,12 +213,7 @@ public:
 		_FORCE_INLINE_ void _ref(MemoryPool::Alloc *p_alloc) {
 			alloc = p_alloc;
 			if (alloc) {
-				if (atomic_increment(&alloc->lock) == 1) {
-					if (MemoryPool::memory_pool) {
-						//lock it and get mem
-					}
-				}
-
+				atomic_increment(&alloc->lock);
 				mem = (T *)alloc->mem;
 			}
 		}
@@ -281,12 +221,7 @@ public:
 		_FORCE_INLINE_ void _unref() {
 
 			if (alloc) {
-				if (atomic_decrement(&alloc->lock) == 0) {
-					if (MemoryPool::memory_pool) {
-						//put mem back
-					}
-				}
-
+				atomic_decrement(&alloc->lock);
 				mem = NULL;
 				alloc = NULL;
 			}
@@ -517,27 +452,11 @@ Error PoolVector<T>::resize(int p_size) {
 			return OK; //nothing to do here
 
 		//must allocate something
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_EXPLAINC("All memory pool allocations are in use.");
-			ERR_FAIL_V(ERR_OUT_OF_MEMORY);
-		}
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = MemoryPool::alloc_new();
 
-		//cleanup the alloc
-		alloc->size = 0;
-		alloc->refcount.init();
-		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		MemoryPool::alloc_mutex->unlock();
-
-	} else {
+	} else if (alloc->refcount.get() == 1) {
 
+		// a shared alloc can be locked by other owners, possibly on other threads, it gets copied below instead
 		ERR_FAIL_COND_V(alloc->lock > 0, ERR_LOCKED); //can't resize if locked!
 	}
 
@@ -553,31 +472,16 @@ Error PoolVector<T>::resize(int p_size) {
 
 	_copy_on_write(); // make it unique
 
-#ifdef DEBUG_ENABLED
-	MemoryPool::alloc_mutex->lock();
-	MemoryPool::total_memory -= alloc->size;
-	MemoryPool::total_memory += new_size;
-	if (MemoryPool::total_memory > MemoryPool::max_memory) {
-		MemoryPool::max_memory = MemoryPool::total_memory;
-	}
-	MemoryPool::alloc_mutex->unlock();
-#endif
+	MemoryPool::track_resize(alloc->size, new_size);
 
 	int cur_elements = alloc->size / sizeof(T);
 
 	if (p_size > cur_elements) {
 
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
+		if (alloc->size == 0) {
+			alloc->mem = memalloc(new_size);
 		} else {
-
-			if (alloc->size == 0) {
-				alloc->mem = memalloc(new_size);
-			} else {
-				alloc->mem = memrealloc(alloc->mem, new_size);
-			}
+			alloc->mem = memrealloc(alloc->mem, new_size);
 		}
 
 		alloc->size = new_size;
@@ -599,28 +503,8 @@ Error PoolVector<T>::resize(int p_size) {
 			}
 		}
 
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
-		} else {
-
-			if (new_size == 0) {
-				memfree(alloc->mem);
-				alloc->mem = NULL;
-				alloc->size = 0;
-
-				MemoryPool::alloc_mutex->lock();
-				alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
-
-			} else {
-				alloc->mem = memrealloc(alloc->mem, new_size);
-				alloc->size = new_size;
-			}
-		}
+		alloc->mem = memrealloc(alloc->mem, new_size);
+		alloc->size = new_size;
 	}
 
 	return OK;
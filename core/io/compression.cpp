@@ -32,6 +32,7 @@
 
 #include "core/io/zip_io.h"
 #include "core/os/copymem.h"
+#include "core/os/spin_lock.h"
 #include "core/project_settings.h"
 
 #include "thirdparty/misc/fastlz.h"
@@ -39,7 +40,69 @@
 #include <zlib.h>
 #include <zstd.h>
 
-int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode) {
+// Creating a zstd context costs more than compressing a small block, so every
+// thread keeps its own pair around.
+struct ZstdThreadContexts {
+
+	ZSTD_CCtx *cctx;
+	ZSTD_DCtx *dctx;
+
+	ZSTD_CCtx *get_cctx() {
+		if (!cctx)
+			cctx = ZSTD_createCCtx();
+		return cctx;
+	}
+
+	ZSTD_DCtx *get_dctx() {
+		if (!dctx)
+			dctx = ZSTD_createDCtx();
+		return dctx;
+	}
+
+	ZstdThreadContexts() {
+		cctx = NULL;
+		dctx = NULL;
+	}
+
+	~ZstdThreadContexts() {
+		if (cctx)
+			ZSTD_freeCCtx(cctx);
+		if (dctx)
+			ZSTD_freeDCtx(dctx);
+	}
+};
+
+static thread_local ZstdThreadContexts zstd_contexts;
+
+struct ZstdDictionary {
+
+	uint32_t id;
+	Vector<uint8_t> data;
+	ZSTD_DDict *ddict;
+	ZSTD_CDict *cdict; // only for the one compressed with
+};
+
+// Dictionaries are added at startup and only go away at exit, so lookups just
+// need the lock to read the list.
+static Vector<ZstdDictionary *> zstd_dictionaries;
+static ZstdDictionary *zstd_compress_dictionary = NULL;
+static SpinLock zstd_dictionaries_lock;
+
+static ZstdDictionary *_find_zstd_dictionary(uint32_t p_id) {
+
+	ZstdDictionary *found = NULL;
+	zstd_dictionaries_lock.lock();
+	for (int i = 0; i < zstd_dictionaries.size(); i++) {
+		if (zstd_dictionaries[i]->id == p_id) {
+			found = zstd_dictionaries[i];
+			break;
+		}
+	}
+	zstd_dictionaries_lock.unlock();
+	return found;
+}
+
+int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode, bool p_use_dictionary) {
 
 	switch (p_mode) {
 		case MODE_FASTLZ: {
@@ -80,16 +143,25 @@ int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,
 
 		} break;
 		case MODE_ZSTD: {
-			ZSTD_CCtx *cctx = ZSTD_createCCtx();
+			ZSTD_CCtx *cctx = zstd_contexts.get_cctx();
+			int max_dst_size = get_max_compressed_buffer_size(p_src_size, MODE_ZSTD);
+
+			ZstdDictionary *dictionary = NULL;
+			if (p_use_dictionary) {
+				zstd_dictionaries_lock.lock();
+				dictionary = zstd_compress_dictionary;
+				zstd_dictionaries_lock.unlock();
+			}
+			if (dictionary) {
+				return ZSTD_compress_usingCDict(cctx, p_dst, max_dst_size, p_src, p_src_size, dictionary->cdict);
+			}
+
 			ZSTD_CCtx_setParameter(cctx, ZSTD_p_compressionLevel, zstd_level);
 			if (zstd_long_distance_matching) {
 				ZSTD_CCtx_setParameter(cctx, ZSTD_p_enableLongDistanceMatching, 1);
 				ZSTD_CCtx_setParameter(cctx, ZSTD_p_windowLog, zstd_window_log_size);
 			}
-			int max_dst_size = get_max_compressed_buffer_size(p_src_size, MODE_ZSTD);
-			int ret = ZSTD_compressCCtx(cctx, p_dst, max_dst_size, p_src, p_src_size, zstd_level);
-			ZSTD_freeCCtx(cctx);
-			return ret;
+			return ZSTD_compressCCtx(cctx, p_dst, max_dst_size, p_src, p_src_size, zstd_level);
 		} break;
 	}
 
@@ -174,17 +246,87 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 			return total;
 		} break;
 		case MODE_ZSTD: {
-			ZSTD_DCtx *dctx = ZSTD_createDCtx();
+			ZSTD_DCtx *dctx = zstd_contexts.get_dctx();
 			if (zstd_long_distance_matching) ZSTD_DCtx_setMaxWindowSize(dctx, (size_t)1 << zstd_window_log_size);
-			int ret = ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
-			ZSTD_freeDCtx(dctx);
-			return ret;
+
+			uint32_t dictionary_id = ZSTD_getDictID_fromFrame(p_src, p_src_size);
+			if (dictionary_id) {
+				ZstdDictionary *dictionary = _find_zstd_dictionary(dictionary_id);
+				ERR_EXPLAIN("Data was compressed with a zstd dictionary that was not added: " + itos(dictionary_id));
+				ERR_FAIL_COND_V(!dictionary, -1);
+				return ZSTD_decompress_usingDDict(dctx, p_dst, p_dst_max_size, p_src, p_src_size, dictionary->ddict);
+			}
+
+			return ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
 		} break;
 	}
 
 	ERR_FAIL_V(-1);
 }
 
+Error Compression::add_zstd_dictionary(const Vector<uint8_t> &p_dictionary) {
+
+	ERR_FAIL_COND_V(p_dictionary.empty(), ERR_INVALID_PARAMETER);
+
+	uint32_t id = ZSTD_getDictID_fromDict(p_dictionary.ptr(), p_dictionary.size());
+	ERR_EXPLAIN("Not a zstd dictionary (train one with `zstd --train`).");
+	ERR_FAIL_COND_V(id == 0, ERR_INVALID_DATA);
+
+	if (_find_zstd_dictionary(id))
+		return OK;
+
+	ZstdDictionary *dictionary = memnew(ZstdDictionary);
+	dictionary->id = id;
+	dictionary->data = p_dictionary;
+	dictionary->ddict = ZSTD_createDDict(p_dictionary.ptr(), p_dictionary.size());
+	dictionary->cdict = NULL;
+
+	zstd_dictionaries_lock.lock();
+	zstd_dictionaries.push_back(dictionary);
+	zstd_dictionaries_lock.unlock();
+
+	return OK;
+}
+
+Error Compression::set_zstd_dictionary(const Vector<uint8_t> &p_dictionary) {
+
+	if (p_dictionary.empty()) {
+		zstd_dictionaries_lock.lock();
+		zstd_compress_dictionary = NULL;
+		zstd_dictionaries_lock.unlock();
+		return OK;
+	}
+
+	Error err = add_zstd_dictionary(p_dictionary);
+	if (err != OK)
+		return err;
+
+	ZstdDictionary *dictionary = _find_zstd_dictionary(ZSTD_getDictID_fromDict(p_dictionary.ptr(), p_dictionary.size()));
+	if (!dictionary->cdict) {
+		dictionary->cdict = ZSTD_createCDict(dictionary->data.ptr(), dictionary->data.size(), zstd_level);
+	}
+
+	zstd_dictionaries_lock.lock();
+	zstd_compress_dictionary = dictionary;
+	zstd_dictionaries_lock.unlock();
+
+	return OK;
+}
+
+void Compression::clear_zstd_dictionaries() {
+
+	zstd_dictionaries_lock.lock();
+	for (int i = 0; i < zstd_dictionaries.size(); i++) {
+		ZSTD_freeDDict(zstd_dictionaries[i]->ddict);
+		if (zstd_dictionaries[i]->cdict)
+			ZSTD_freeCDict(zstd_dictionaries[i]->cdict);
+		memdelete(zstd_dictionaries[i]);
+	}
+	zstd_dictionaries.clear();
+	zstd_compress_dictionary = NULL;
+	zstd_dictionaries_lock.unlock();
+}
+
 int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
 int Compression::zstd_level = 3;
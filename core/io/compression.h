@@ -32,6 +32,7 @@
 #define COMPRESSION_H
 
 #include "core/typedefs.h"
+#include "core/vector.h"
 
 class Compression {
 
@@ -49,10 +50,18 @@ public:
 		MODE_GZIP
 	};
 
-	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD, bool p_use_dictionary = false); ///< p_use_dictionary only for data read back by the same project
 	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
 	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
 
+	/* Zstd dictionaries must be in the format produced by `zstd --train`. Every frame
+	 * records the ID of the dictionary it was compressed with, and decompression picks
+	 * it among the added ones, so data compressed with and without them can be mixed.
+	 */
+	static Error add_zstd_dictionary(const Vector<uint8_t> &p_dictionary); ///< make a dictionary available for decompression
+	static Error set_zstd_dictionary(const Vector<uint8_t> &p_dictionary); ///< add it and compress with it from now on when asked to, empty to stop
+	static void clear_zstd_dictionaries();
+
 	Compression();
 };
 
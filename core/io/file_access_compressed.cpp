@@ -30,9 +30,10 @@
 
 #include "file_access_compressed.h"
 
+#include "core/os/copymem.h"
 #include "core/print_string.h"
 
-void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, int p_block_size) {
+void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, int p_block_size, bool p_use_dictionary) {
 
 	magic = p_magic.ascii().get_data();
 	if (magic.length() > 4)
@@ -44,6 +45,7 @@ void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_
 
 	cmode = p_mode;
 	block_size = p_block_size;
+	use_dictionary = p_use_dictionary;
 }
 
 #define WRITE_FIT(m_bytes)                                  \
@@ -58,6 +60,159 @@ void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_
 		}                                                   \
 	}
 
+void FileAccessCompressed::_compress_block_task(void *p_userdata, uint32_t p_index) {
+
+	BlockJob *job = (BlockJob *)p_userdata;
+	const FileAccessCompressed *fac = job->file;
+
+	uint32_t from = (job->first + p_index) * fac->block_size;
+	int size = MIN(fac->block_size, fac->write_max - from);
+
+	job->sizes[p_index] = Compression::compress(job->dst + p_index * job->stride, job->src + from, size, fac->cmode, fac->use_dictionary);
+}
+
+void FileAccessCompressed::_decompress_block_task(void *p_userdata, uint32_t p_index) {
+
+	BlockJob *job = (BlockJob *)p_userdata;
+	const FileAccessCompressed *fac = job->file;
+
+	const ReadBlock &rb = fac->read_blocks[job->first + p_index];
+	const uint8_t *src = job->src + (rb.offset - fac->read_blocks[job->first].offset);
+
+	if (Compression::decompress(job->dst + p_index * fac->block_size, fac->block_size, src, rb.csize, fac->cmode) < 0) {
+		job->failed = true;
+	}
+}
+
+void FileAccessCompressed::_run_block_jobs(WorkerThreadPool::GroupFunc p_func, BlockJob *p_job, int p_count) {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool && p_count > 1) {
+		WorkerThreadPool::TaskID task = pool->add_native_group_task(p_func, p_job, p_count);
+		pool->wait_for_task_completion(task);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			p_func(p_job, i);
+		}
+	}
+}
+
+int FileAccessCompressed::_get_block_size(int p_block) const {
+
+	return p_block == read_block_count - 1 ? read_total % block_size : block_size;
+}
+
+const uint8_t *FileAccessCompressed::_read_compressed(int p_first, int p_count, Vector<uint8_t> &r_buffer) const {
+
+	// blocks are stored back to back, so a batch is a single read
+	const ReadBlock &last = read_blocks[p_first + p_count - 1];
+	int from = read_blocks[p_first].offset;
+	int size = last.offset + last.csize - from;
+
+	if (r_buffer.size() < size)
+		r_buffer.resize(size);
+
+	f->seek(from);
+	f->get_buffer(r_buffer.ptrw(), size);
+	return r_buffer.ptr();
+}
+
+void FileAccessCompressed::_wait_read_ahead() const {
+
+	if (ahead_task == WorkerThreadPool::INVALID_TASK_ID)
+		return;
+
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(ahead_task);
+	ahead_task = WorkerThreadPool::INVALID_TASK_ID;
+}
+
+void FileAccessCompressed::_fill_window(int p_block) const {
+
+	_wait_read_ahead();
+
+	// reading on right after the window doubles it, anything else starts over from a single block
+	bool sequential = window_count && p_block == window_first + window_count;
+	window_span = sequential ? MIN(window_span * 2, window_blocks) : 1;
+
+	bool failed;
+	if (ahead_count && ahead_first == p_block) {
+		// decoded in the background already, swap the buffers
+		{
+			Vector<uint8_t> decoded = ahead_window;
+			ahead_window = window;
+			window = decoded;
+		}
+		window_first = ahead_first;
+		window_count = ahead_count;
+		failed = ahead_job.failed;
+	} else {
+		int count = MIN(window_span, read_block_count - p_block);
+		if (window.size() < count * int(block_size))
+			window.resize(count * block_size);
+
+		BlockJob job;
+		job.file = this;
+		job.first = p_block;
+		job.src = _read_compressed(p_block, count, comp_buffer);
+		job.dst = window.ptrw();
+		job.stride = 0;
+		job.sizes = NULL;
+		job.failed = false;
+		_run_block_jobs(&_decompress_block_task, &job, count);
+
+		window_first = p_block;
+		window_count = count;
+		failed = job.failed;
+	}
+	ahead_count = 0;
+
+	if (failed) {
+		ERR_PRINTS("Failed to decompress blocks of: " + f->get_path());
+	}
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	int next = window_first + window_count;
+	if (pool && sequential && next < read_block_count) {
+		ahead_first = next;
+		ahead_count = MIN(window_span, read_block_count - next);
+		if (ahead_window.size() < ahead_count * int(block_size))
+			ahead_window.resize(ahead_count * block_size);
+
+		ahead_job.file = this;
+		ahead_job.first = next;
+		ahead_job.src = _read_compressed(next, ahead_count, ahead_comp_buffer);
+		ahead_job.dst = ahead_window.ptrw();
+		ahead_job.stride = 0;
+		ahead_job.sizes = NULL;
+		ahead_job.failed = false;
+		ahead_task = pool->add_native_group_task(&_decompress_block_task, &ahead_job, ahead_count);
+	}
+}
+
+void FileAccessCompressed::_set_block(int p_block) const {
+
+	if (p_block < window_first || p_block >= window_first + window_count) {
+		_fill_window(p_block);
+	}
+
+	read_block = p_block;
+	read_block_size = _get_block_size(p_block);
+	read_ptr = window.ptrw() + (p_block - window_first) * block_size;
+}
+
+bool FileAccessCompressed::_next_block() const {
+
+	// the last block is empty when the size is a multiple of the block size
+	if (read_block + 1 >= read_block_count || _get_block_size(read_block + 1) == 0) {
+		at_end = true;
+		return false;
+	}
+
+	_set_block(read_block + 1);
+	read_pos = 0;
+	return true;
+}
+
 Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 
 	f = p_base;
@@ -66,29 +221,27 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	read_total = f->get_32();
 	int bc = (read_total / block_size) + 1;
 	int acc_ofs = f->get_position() + bc * 4;
-	int max_bs = 0;
 	for (int i = 0; i < bc; i++) {
 
 		ReadBlock rb;
 		rb.offset = acc_ofs;
 		rb.csize = f->get_32();
 		acc_ofs += rb.csize;
-		max_bs = MAX(max_bs, rb.csize);
 		read_blocks.push_back(rb);
 	}
 
-	comp_buffer.resize(max_bs);
-	buffer.resize(block_size);
-	read_ptr = buffer.ptrw();
-	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
-	at_end = false;
-	read_eof = false;
 	read_block_count = bc;
-	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
-
-	Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
-	read_block = 0;
+	window_blocks = MIN(MAX(1, BATCH_SIZE / int(block_size)), bc);
+	window_span = 1;
+	window_first = 0;
+	window_count = 0;
+	ahead_count = 0;
+	ahead_task = WorkerThreadPool::INVALID_TASK_ID;
+
+	at_end = read_total == 0;
+	read_eof = false;
 	read_pos = 0;
+	_set_block(0);
 
 	return OK;
 }
@@ -155,18 +308,32 @@ void FileAccessCompressed::close() {
 			f->store_32(0); //compressed sizes, will update later
 		}
 
+		// compress a batch of blocks at a time in parallel, then store them in order
 		Vector<int> block_sizes;
-		for (int i = 0; i < bc; i++) {
+		block_sizes.resize(bc);
+		int stride = Compression::get_max_compressed_buffer_size(block_size, cmode);
+		int batch = MIN(MAX(1, BATCH_SIZE / int(block_size)), bc);
+
+		Vector<uint8_t> cblocks;
+		cblocks.resize(batch * stride);
+
+		for (int first = 0; first < bc; first += batch) {
 
-			int bl = i == (bc - 1) ? write_max % block_size : block_size;
-			uint8_t *bp = &write_ptr[i * block_size];
+			int count = MIN(batch, bc - first);
 
-			Vector<uint8_t> cblock;
-			cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
+			BlockJob job;
+			job.file = this;
+			job.first = first;
+			job.src = write_ptr;
+			job.dst = cblocks.ptrw();
+			job.stride = stride;
+			job.sizes = block_sizes.ptrw() + first;
+			job.failed = false;
+			_run_block_jobs(&_compress_block_task, &job, count);
 
-			f->store_buffer(cblock.ptr(), s);
-			block_sizes.push_back(s);
+			for (int i = 0; i < count; i++) {
+				f->store_buffer(cblocks.ptr() + i * stride, block_sizes[first + i]);
+			}
 		}
 
 		f->seek(16); //ok write block sizes
@@ -179,8 +346,11 @@ void FileAccessCompressed::close() {
 
 	} else {
 
+		_wait_read_ahead();
 		comp_buffer.clear();
-		buffer.clear();
+		ahead_comp_buffer.clear();
+		window.clear();
+		ahead_window.clear();
 		read_blocks.clear();
 	}
 
@@ -205,20 +375,16 @@ void FileAccessCompressed::seek(size_t p_position) {
 	} else {
 
 		ERR_FAIL_COND(p_position > read_total);
+		read_eof = false;
 		if (p_position == read_total) {
+			// keep get_position() right, the window is left alone until the next seek back
 			at_end = true;
+			read_block = read_total > 0 ? (read_total - 1) / block_size : 0;
+			read_pos = read_total - read_block * block_size;
 		} else {
 
-			int block_idx = p_position / block_size;
-			if (block_idx != read_block) {
-
-				read_block = block_idx;
-				f->seek(read_blocks[read_block].offset);
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			}
-
+			at_end = false;
+			_set_block(p_position / block_size);
 			read_pos = p_position % block_size;
 		}
 	}
@@ -281,19 +447,7 @@ uint8_t FileAccessCompressed::get_8() const {
 
 	read_pos++;
 	if (read_pos >= read_block_size) {
-		read_block++;
-
-		if (read_block < read_block_count) {
-			//read another block of compressed data
-			f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-			Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			read_pos = 0;
-
-		} else {
-			read_block--;
-			at_end = true;
-		}
+		_next_block();
 	}
 
 	return ret;
@@ -304,35 +458,26 @@ int FileAccessCompressed::get_buffer(uint8_t *p_dst, int p_length) const {
 	ERR_FAIL_COND_V(!f, 0);
 
 	if (at_end) {
-		read_eof = true;
+		read_eof = p_length > 0;
 		return 0;
 	}
 
-	for (int i = 0; i < p_length; i++) {
-
-		p_dst[i] = read_ptr[read_pos];
-		read_pos++;
-		if (read_pos >= read_block_size) {
-			read_block++;
-
-			if (read_block < read_block_count) {
-				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-				read_pos = 0;
-
-			} else {
-				read_block--;
-				at_end = true;
-				if (i < p_length - 1)
-					read_eof = true;
-				return i;
-			}
+	int done = 0;
+	while (done < p_length) {
+
+		int chunk = MIN(p_length - done, read_block_size - read_pos);
+		copymem(p_dst + done, read_ptr + read_pos, chunk);
+		done += chunk;
+		read_pos += chunk;
+
+		if (read_pos >= read_block_size && !_next_block()) {
+			if (done < p_length)
+				read_eof = true;
+			break;
 		}
 	}
 
-	return p_length;
+	return done;
 }
 
 Error FileAccessCompressed::get_error() const {
@@ -356,6 +501,16 @@ void FileAccessCompressed::store_8(uint8_t p_dest) {
 	write_ptr[write_pos++] = p_dest;
 }
 
+void FileAccessCompressed::store_buffer(const uint8_t *p_src, int p_length) {
+
+	ERR_FAIL_COND(!f);
+	ERR_FAIL_COND(!writing);
+
+	WRITE_FIT(p_length);
+	copymem(write_ptr + write_pos, p_src, p_length);
+	write_pos += p_length;
+}
+
 bool FileAccessCompressed::file_exists(const String &p_name) {
 
 	FileAccess *fa = FileAccess::open(p_name, FileAccess::READ);
@@ -375,6 +530,7 @@ uint64_t FileAccessCompressed::_get_modified_time(const String &p_file) {
 
 FileAccessCompressed::FileAccessCompressed() :
 		cmode(Compression::MODE_ZSTD),
+		use_dictionary(false),
 		writing(false),
 		write_ptr(0),
 		write_buffer_size(0),
@@ -388,6 +544,13 @@ FileAccessCompressed::FileAccessCompressed() :
 		read_block_size(0),
 		read_pos(0),
 		read_total(0),
+		window_blocks(0),
+		window_span(1),
+		window_first(0),
+		window_count(0),
+		ahead_first(0),
+		ahead_count(0),
+		ahead_task(WorkerThreadPool::INVALID_TASK_ID),
 		magic("GCMP"),
 		f(NULL) {
 }
@@ -33,10 +33,12 @@
 
 #include "core/io/compression.h"
 #include "core/os/file_access.h"
+#include "core/os/worker_thread_pool.h"
 
 class FileAccessCompressed : public FileAccess {
 
 	Compression::Mode cmode;
+	bool use_dictionary; // compress with the project zstd dictionary, reading doesn't need to know
 	bool writing;
 	uint32_t write_pos;
 	uint8_t *write_ptr;
@@ -51,8 +53,26 @@ class FileAccessCompressed : public FileAccess {
 		int offset;
 	};
 
+	// Blocks are compressed and decompressed in batches spread over the worker pool.
+	// Reading decodes a window of blocks at once, and while it is consumed the next
+	// window is already being decoded in the background. The window starts at one
+	// block and only grows, up to a batch, while the file is read sequentially.
+	enum {
+		BATCH_SIZE = 256 * 1024
+	};
+
+	struct BlockJob {
+		const FileAccessCompressed *file;
+		int first;
+		const uint8_t *src;
+		uint8_t *dst;
+		int stride; // room for each compressed block in dst, when compressing
+		int *sizes; // compressed size of each block, when compressing
+		bool failed;
+	};
+
 	mutable Vector<uint8_t> comp_buffer;
-	uint8_t *read_ptr;
+	mutable uint8_t *read_ptr;
 	mutable int read_block;
 	int read_block_count;
 	mutable int read_block_size;
@@ -60,12 +80,36 @@ class FileAccessCompressed : public FileAccess {
 	Vector<ReadBlock> read_blocks;
 	uint32_t read_total;
 
+	int window_blocks; // largest window
+	mutable int window_span; // blocks in the next window
+	mutable Vector<uint8_t> window;
+	mutable int window_first;
+	mutable int window_count;
+
+	mutable Vector<uint8_t> ahead_comp_buffer;
+	mutable Vector<uint8_t> ahead_window;
+	mutable int ahead_first;
+	mutable int ahead_count;
+	mutable BlockJob ahead_job;
+	mutable WorkerThreadPool::TaskID ahead_task;
+
+	static void _compress_block_task(void *p_userdata, uint32_t p_index);
+	static void _decompress_block_task(void *p_userdata, uint32_t p_index);
+	static void _run_block_jobs(WorkerThreadPool::GroupFunc p_func, BlockJob *p_job, int p_count);
+
+	int _get_block_size(int p_block) const;
+	const uint8_t *_read_compressed(int p_first, int p_count, Vector<uint8_t> &r_buffer) const;
+	void _wait_read_ahead() const;
+	void _fill_window(int p_block) const;
+	void _set_block(int p_block) const;
+	bool _next_block() const;
+
 	String magic;
 	mutable Vector<uint8_t> buffer;
 	FileAccess *f;
 
 public:
-	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, int p_block_size = 4096);
+	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, int p_block_size = 4096, bool p_use_dictionary = false);
 
 	Error open_after_magic(FileAccess *p_base);
 
@@ -87,6 +131,7 @@ public:
 
 	virtual void flush();
 	virtual void store_8(uint8_t p_dest); ///< store a byte
+	virtual void store_buffer(const uint8_t *p_src, int p_length); ///< store an array of bytes
 
 	virtual bool file_exists(const String &p_name); ///< return true if a file exists
 
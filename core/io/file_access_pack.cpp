@@ -30,12 +30,14 @@
 
 #include "file_access_pack.h"
 
+#include "core/io/compression.h"
+#include "core/io/marshalls.h"
+#include "core/os/copymem.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/version.h"
 
 #include <stdio.h>
 
-#define PACK_VERSION 1
-
 Error PackedData::add_pack(const String &p_path) {
 
 	for (int i = 0; i < sources.size(); i++) {
@@ -49,7 +51,7 @@ Error PackedData::add_pack(const String &p_path) {
 	return ERR_FILE_UNRECOGNIZED;
 };
 
-void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src) {
+void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, const uint8_t *p_data, bool p_compressed) {
 
 	PathMD5 pmd5(path.md5_buffer());
 	//printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
@@ -63,6 +65,8 @@ void PackedData::add_path(const String &pkg_path, const String &path, uint64_t o
 	for (int i = 0; i < 16; i++)
 		pf.md5[i] = p_md5[i];
 	pf.src = p_src;
+	pf.data = p_data;
+	pf.compressed = p_compressed;
 
 	files[pmd5] = pf;
 
@@ -172,7 +176,7 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 	f->get_32(); // ver_rev
 
 	ERR_EXPLAIN("Pack version unsupported: " + itos(version));
-	ERR_FAIL_COND_V(version != PACK_VERSION, false);
+	ERR_FAIL_COND_V(version != PACK_FORMAT_VERSION_UNCOMPRESSED && version != PACK_FORMAT_VERSION, false);
 	ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor));
 	ERR_FAIL_COND_V(ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), false);
 
@@ -183,6 +187,12 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 
 	int file_count = f->get_32();
 
+	// Serve the packed files straight from a read-only mapping when the platform
+	// supports it, so opening one needs no handle of its own and reads don't copy
+	// through stdio buffers.
+	const uint8_t *mapped = f->get_mapped_buffer();
+	uint64_t pack_len = f->get_len();
+
 	for (int i = 0; i < file_count; i++) {
 
 		uint32_t sl = f->get_32();
@@ -198,9 +208,18 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		uint64_t size = f->get_64();
 		uint8_t md5[16];
 		f->get_buffer(md5, 16);
-		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this);
+		uint32_t flags = version >= PACK_FORMAT_VERSION ? f->get_32() : 0;
+		const uint8_t *data = (mapped && ofs + size <= pack_len) ? mapped + ofs : NULL;
+		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, data, flags & PACK_FILE_COMPRESSED);
 	};
 
+	if (mapped) {
+		// the mapping lives as long as the pack stays open
+		mapped_packs.push_back(f);
+	} else {
+		memdelete(f);
+	}
+
 	return true;
 };
 
@@ -209,6 +228,56 @@ FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFi
 	return memnew(FileAccessPack(p_path, *p_file));
 };
 
+Vector<uint8_t> PackedSourcePCK::compress_file(const uint8_t *p_data, uint64_t p_size) {
+
+	// uint64 size, uint32 block size, uint32 block count, then the uint64 end of
+	// every block relative to the start of the entry, then the blocks
+	Vector<uint8_t> stored;
+	uint64_t block_count = (p_size + PACK_COMPRESSED_BLOCK_SIZE - 1) / PACK_COMPRESSED_BLOCK_SIZE;
+	if (block_count == 0)
+		return stored;
+
+	uint64_t table_end = 16 + block_count * 8;
+	int max_block = Compression::get_max_compressed_buffer_size(PACK_COMPRESSED_BLOCK_SIZE, Compression::MODE_ZSTD);
+	uint64_t ofs = table_end;
+
+	for (uint64_t i = 0; i < block_count; i++) {
+
+		uint64_t from = i * PACK_COMPRESSED_BLOCK_SIZE;
+		int src_size = MIN(PACK_COMPRESSED_BLOCK_SIZE, p_size - from);
+
+		stored.resize(ofs + max_block);
+		uint8_t *w = stored.ptrw();
+		int csize = Compression::compress(w + ofs, p_data + from, src_size, Compression::MODE_ZSTD);
+		ERR_FAIL_COND_V(csize < 0, Vector<uint8_t>());
+		if (csize >= src_size) {
+			// incompressible, keep it raw (the reader tells by the stored size)
+			copymem(w + ofs, p_data + from, src_size);
+			csize = src_size;
+		}
+		ofs += csize;
+		encode_uint64(ofs, w + 16 + i * 8);
+	}
+
+	if (ofs >= p_size)
+		return Vector<uint8_t>();
+
+	stored.resize(ofs);
+	uint8_t *w = stored.ptrw();
+	encode_uint64(p_size, w);
+	encode_uint32(PACK_COMPRESSED_BLOCK_SIZE, w + 8);
+	encode_uint32(block_count, w + 12);
+
+	return stored;
+}
+
+PackedSourcePCK::~PackedSourcePCK() {
+
+	for (int i = 0; i < mapped_packs.size(); i++) {
+		memdelete(mapped_packs[i]);
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 
 Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
@@ -219,28 +288,35 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 
 void FileAccessPack::close() {
 
-	f->close();
+	if (f) {
+		f->close();
+	} else {
+		data = NULL;
+	}
 }
 
 bool FileAccessPack::is_open() const {
 
-	return f->is_open();
+	if (f)
+		return f->is_open();
+	return data != NULL;
 }
 
 void FileAccessPack::seek(size_t p_position) {
 
-	if (p_position > pf.size) {
+	if (p_position > len) {
 		eof = true;
 	} else {
 		eof = false;
 	}
 
-	f->seek(pf.offset + p_position);
+	if (f && !pf.compressed)
+		f->seek(pf.offset + p_position);
 	pos = p_position;
 }
 void FileAccessPack::seek_end(int64_t p_position) {
 
-	seek(pf.size + p_position);
+	seek(len + p_position);
 }
 size_t FileAccessPack::get_position() const {
 
@@ -248,7 +324,7 @@ size_t FileAccessPack::get_position() const {
 }
 size_t FileAccessPack::get_len() const {
 
-	return pf.size;
+	return len;
 }
 
 bool FileAccessPack::eof_reached() const {
@@ -258,11 +334,22 @@ bool FileAccessPack::eof_reached() const {
 
 uint8_t FileAccessPack::get_8() const {
 
-	if (pos >= pf.size) {
+	if (pos >= len) {
 		eof = true;
 		return 0;
 	}
 
+	if (pf.compressed) {
+		uint8_t b = 0;
+		_read_compressed(&b, pos, 1);
+		pos++;
+		return b;
+	}
+
+	if (data)
+		return data[pos++];
+
+	ERR_FAIL_COND_V(!f, 0);
 	pos++;
 	return f->get_8();
 }
@@ -273,23 +360,176 @@ int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 		return 0;
 
 	int64_t to_read = p_length;
-	if (to_read + pos > pf.size) {
+	if (to_read + pos > len) {
 		eof = true;
-		to_read = int64_t(pf.size) - int64_t(pos);
+		to_read = int64_t(len) - int64_t(pos);
 	}
 
+	size_t from = pos;
 	pos += p_length;
 
 	if (to_read <= 0)
 		return 0;
+
+	if (pf.compressed)
+		return _read_compressed(p_dst, from, to_read);
+
+	if (data) {
+		copymem(p_dst, data + from, to_read);
+		return to_read;
+	}
+
+	ERR_FAIL_COND_V(!f, 0);
 	f->get_buffer(p_dst, to_read);
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_mapped_buffer() {
+
+	return pf.compressed ? NULL : data;
+}
+
+bool FileAccessPack::_open_compressed() {
+
+	const uint8_t *header = _read_stored(0, 16);
+	ERR_FAIL_COND_V(!header, false);
+
+	len = decode_uint64(header);
+	block_size = decode_uint32(header + 8);
+	uint32_t block_count = decode_uint32(header + 12);
+	// the size comes from the pack, only the one the packer writes is trusted for the block buffers
+	ERR_FAIL_COND_V(block_size != PACK_COMPRESSED_BLOCK_SIZE || block_count != (len + block_size - 1) / block_size, false);
+
+	const uint8_t *table = _read_stored(16, uint64_t(block_count) * 8);
+	ERR_FAIL_COND_V(!table, false);
+
+	block_ofs.resize(block_count + 1);
+	block_ofs.write[0] = 16 + uint64_t(block_count) * 8;
+	for (uint32_t i = 0; i < block_count; i++) {
+		uint64_t end = decode_uint64(table + i * 8);
+		ERR_FAIL_COND_V(end < block_ofs[i] || end > pf.size, false);
+		block_ofs.write[i + 1] = end;
+	}
+
+	return true;
+}
+
+const uint8_t *FileAccessPack::_read_stored(uint64_t p_from, uint64_t p_size) const {
+
+	ERR_FAIL_COND_V(p_from + p_size > pf.size, NULL);
+
+	if (data)
+		return data + p_from;
+
+	ERR_FAIL_COND_V(!f, NULL);
+	if ((uint64_t)stored_buffer.size() < p_size)
+		stored_buffer.resize(p_size);
+
+	f->seek(pf.offset + p_from);
+	if ((uint64_t)f->get_buffer(stored_buffer.ptrw(), p_size) != p_size)
+		return NULL;
+
+	return stored_buffer.ptr();
+}
+
+bool FileAccessPack::_decode_block(int p_block, const uint8_t *p_src, uint8_t *p_dst) const {
+
+	int size = MIN(uint64_t(block_size), len - uint64_t(p_block) * block_size);
+	int stored_size = block_ofs[p_block + 1] - block_ofs[p_block];
+
+	if (stored_size == size) {
+		copymem(p_dst, p_src, size);
+		return true;
+	}
+
+	return Compression::decompress(p_dst, size, p_src, stored_size, Compression::MODE_ZSTD) == size;
+}
+
+void FileAccessPack::_decode_block_task(void *p_userdata, uint32_t p_index) {
+
+	BlockDecodeJob *job = (BlockDecodeJob *)p_userdata;
+	int block = job->first + p_index;
+
+	const uint8_t *src = job->src + (job->file->block_ofs[block] - job->file->block_ofs[job->first]);
+	if (!job->file->_decode_block(block, src, job->dst + uint64_t(p_index) * job->file->block_size)) {
+		job->failed = true;
+	}
+}
+
+bool FileAccessPack::_decode_blocks(int p_first, int p_count, uint8_t *p_dst) const {
+
+	const uint8_t *src = _read_stored(block_ofs[p_first], block_ofs[p_first + p_count] - block_ofs[p_first]);
+	ERR_FAIL_COND_V(!src, false);
+
+	BlockDecodeJob job;
+	job.file = this;
+	job.first = p_first;
+	job.src = src;
+	job.dst = p_dst;
+	job.failed = false;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool && p_count >= PARALLEL_DECODE_MIN_BLOCKS) {
+		WorkerThreadPool::TaskID task = pool->add_native_group_task(&_decode_block_task, &job, p_count);
+		pool->wait_for_task_completion(task);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			_decode_block_task(&job, i);
+		}
+	}
+
+	return !job.failed;
+}
+
+int FileAccessPack::_read_compressed(uint8_t *p_dst, uint64_t p_from, int p_length) const {
+
+	int block_count = block_ofs.size() - 1;
+	uint64_t end = p_from + p_length;
+	uint64_t ofs = p_from;
+	int block = p_from / block_size;
+
+	while (ofs < end) {
+
+		uint64_t block_start = uint64_t(block) * block_size;
+		uint64_t block_end = MIN(block_start + block_size, len);
+
+		if (ofs == block_start && block_end <= end) {
+			// blocks the read covers whole are decoded straight into the destination
+			int run_end = block + 1;
+			while (run_end < block_count && MIN(uint64_t(run_end + 1) * block_size, len) <= end) {
+				run_end++;
+			}
+
+			ERR_FAIL_COND_V(!_decode_blocks(block, run_end - block, p_dst + (ofs - p_from)), ofs - p_from);
+			ofs = MIN(uint64_t(run_end) * block_size, len);
+			block = run_end;
+			continue;
+		}
+
+		if (cached_block != block) {
+			block_cache.resize(block_size);
+			const uint8_t *src = _read_stored(block_ofs[block], block_ofs[block + 1] - block_ofs[block]);
+			if (!src || !_decode_block(block, src, block_cache.ptrw())) {
+				cached_block = -1;
+				ERR_FAIL_V(ofs - p_from);
+			}
+			cached_block = block;
+		}
+
+		uint64_t to_copy = MIN(end, block_end) - ofs;
+		copymem(p_dst + (ofs - p_from), block_cache.ptr() + (ofs - block_start), to_copy);
+		ofs += to_copy;
+		block++;
+	}
+
+	return p_length;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
-	f->set_endian_swap(p_swap);
+	if (f)
+		f->set_endian_swap(p_swap);
 }
 
 Error FileAccessPack::get_error() const {
@@ -321,14 +561,28 @@ bool FileAccessPack::file_exists(const String &p_name) {
 
 FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) :
 		pf(p_file),
-		f(FileAccess::open(pf.pack, FileAccess::READ)) {
-	if (!f) {
-		ERR_EXPLAIN("Can't open pack-referenced file: " + String(pf.pack));
-		ERR_FAIL_COND(!f);
+		pos(0),
+		eof(false),
+		len(pf.size),
+		data(pf.data),
+		f(NULL),
+		block_size(0),
+		cached_block(-1) {
+
+	if (!data) {
+		f = FileAccess::open(pf.pack, FileAccess::READ);
+		if (!f) {
+			ERR_EXPLAIN("Can't open pack-referenced file: " + String(pf.pack));
+			ERR_FAIL_COND(!f);
+		}
+		f->seek(pf.offset);
+	}
+
+	if (pf.compressed && !_open_compressed()) {
+		len = 0;
+		ERR_EXPLAIN("Corrupt compressed file in pack: " + p_path);
+		ERR_FAIL();
 	}
-	f->seek(pf.offset);
-	pos = 0;
-	eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
@@ -37,6 +37,16 @@
 #include "core/os/file_access.h"
 #include "core/print_string.h"
 
+// Version 2 adds a flags word to every file in the index. Files flagged
+// PACK_FILE_COMPRESSED are stored as a table of blocks followed by the blocks,
+// each compressed on its own so a seek only has to decode the block it lands in.
+// Packs without compressed files are still written as version 1.
+#define PACK_FORMAT_VERSION 2
+#define PACK_FORMAT_VERSION_UNCOMPRESSED 1
+
+#define PACK_FILE_COMPRESSED 1
+#define PACK_COMPRESSED_BLOCK_SIZE 65536
+
 class PackSource;
 
 class PackedData {
@@ -52,6 +62,8 @@ public:
 		uint64_t size;
 		uint8_t md5[16];
 		PackSource *src;
+		const uint8_t *data; // contents in the memory mapped pack, NULL if the pack is not mapped
+		bool compressed; // size and data refer to the stored blocks, not the file
 	};
 
 private:
@@ -102,7 +114,7 @@ private:
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src); // for PackSource
+	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, const uint8_t *p_data = NULL, bool p_compressed = false); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
@@ -127,9 +139,15 @@ public:
 
 class PackedSourcePCK : public PackSource {
 
+	Vector<FileAccess *> mapped_packs;
+
 public:
 	virtual bool try_open_pack(const String &p_path);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	static Vector<uint8_t> compress_file(const uint8_t *p_data, uint64_t p_size); // stored form of a PACK_FILE_COMPRESSED entry, empty if compressing doesn't pay off
+
+	~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -138,8 +156,36 @@ class FileAccessPack : public FileAccess {
 
 	mutable size_t pos;
 	mutable bool eof;
+	uint64_t len;
 
+	const uint8_t *data;
 	FileAccess *f;
+
+	uint32_t block_size;
+	Vector<uint64_t> block_ofs; // where each block starts in the stored entry, plus where the last one ends
+	mutable Vector<uint8_t> block_cache;
+	mutable int cached_block;
+	mutable Vector<uint8_t> stored_buffer;
+
+	enum {
+		PARALLEL_DECODE_MIN_BLOCKS = 4
+	};
+
+	struct BlockDecodeJob {
+		const FileAccessPack *file;
+		int first;
+		const uint8_t *src;
+		uint8_t *dst;
+		bool failed;
+	};
+
+	bool _open_compressed();
+	const uint8_t *_read_stored(uint64_t p_from, uint64_t p_size) const;
+	bool _decode_block(int p_block, const uint8_t *p_src, uint8_t *p_dst) const;
+	bool _decode_blocks(int p_first, int p_count, uint8_t *p_dst) const;
+	static void _decode_block_task(void *p_userdata, uint32_t p_index);
+	int _read_compressed(uint8_t *p_dst, uint64_t p_from, int p_length) const;
+
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 
@@ -157,6 +203,7 @@ public:
 	virtual uint8_t get_8() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *get_mapped_buffer();
 
 	virtual void set_endian_swap(bool p_swap);
 
@@ -30,6 +30,7 @@
 
 #include "pck_packer.h"
 
+#include "core/io/file_access_pack.h"
 #include "core/os/file_access.h"
 #include "core/version.h"
 
@@ -55,12 +56,12 @@ static void _pad(FileAccess *p_file, int p_bytes) {
 
 void PCKPacker::_bind_methods() {
 
-	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment"), &PCKPacker::pck_start);
+	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment", "compress"), &PCKPacker::pck_start, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path"), &PCKPacker::add_file);
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush);
 };
 
-Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
+Error PCKPacker::pck_start(const String &p_file, int p_alignment, bool p_compress) {
 
 	file = FileAccess::open(p_file, FileAccess::WRITE);
 	if (file == NULL) {
@@ -69,9 +70,10 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 	};
 
 	alignment = p_alignment;
+	compress = p_compress;
 
 	file->store_32(0x43504447); // MAGIC
-	file->store_32(1); // # version
+	file->store_32(compress ? PACK_FORMAT_VERSION : PACK_FORMAT_VERSION_UNCOMPRESSED); // # version
 	file->store_32(VERSION_MAJOR); // # major
 	file->store_32(VERSION_MINOR); // # minor
 	file->store_32(0); // # revision
@@ -130,6 +132,10 @@ Error PCKPacker::flush(bool p_verbose) {
 		file->store_32(0);
 		file->store_32(0);
 		file->store_32(0);
+
+		if (compress) {
+			file->store_32(0); // flags, set once the file is stored
+		}
 	};
 
 	uint64_t ofs = file->get_position();
@@ -145,6 +151,26 @@ Error PCKPacker::flush(bool p_verbose) {
 
 		FileAccess *src = FileAccess::open(files[i].src_path, FileAccess::READ);
 		uint64_t to_write = files[i].size;
+		uint64_t stored_size = to_write;
+		uint32_t flags = 0;
+
+		if (compress && to_write > 0) {
+
+			Vector<uint8_t> contents;
+			contents.resize(to_write);
+			src->get_buffer(contents.ptrw(), to_write);
+
+			Vector<uint8_t> stored = PackedSourcePCK::compress_file(contents.ptr(), to_write);
+			if (stored.size()) {
+				file->store_buffer(stored.ptr(), stored.size());
+				stored_size = stored.size();
+				flags |= PACK_FILE_COMPRESSED;
+			} else {
+				file->store_buffer(contents.ptr(), to_write);
+			}
+			to_write = 0;
+		}
+
 		while (to_write > 0) {
 
 			int read = src->get_buffer(buf, MIN(to_write, buf_max));
@@ -155,9 +181,14 @@ Error PCKPacker::flush(bool p_verbose) {
 		uint64_t pos = file->get_position();
 		file->seek(files[i].offset_offset); // go back to store the file's offset
 		file->store_64(ofs);
+		if (compress) {
+			file->store_64(stored_size);
+			file->seek(file->get_position() + 16); // md5
+			file->store_32(flags);
+		}
 		file->seek(pos);
 
-		ofs = _align(ofs + files[i].size, alignment);
+		ofs = _align(ofs + stored_size, alignment);
 		_pad(file, ofs - pos);
 
 		src->close();
@@ -183,6 +214,7 @@ Error PCKPacker::flush(bool p_verbose) {
 PCKPacker::PCKPacker() {
 
 	file = NULL;
+	compress = false;
 };
 
 PCKPacker::~PCKPacker() {
@@ -86,9 +86,11 @@ enum {
 	OBJECT_EXTERNAL_RESOURCE_INDEX = 3,
 	//version 2: added 64 bits support for float and int
 	//version 3: changed nodepath encoding
-	FORMAT_VERSION = 3,
+	//version 4: pool array payloads aligned
+	FORMAT_VERSION = 4,
 	FORMAT_VERSION_CAN_RENAME_DEPS = 1,
 	FORMAT_VERSION_NO_NODEPATH_PROPERTY = 3,
+	FORMAT_VERSION_ALIGNED_ARRAYS = 4,
 
 };
 
@@ -101,6 +103,34 @@ void ResourceInteractiveLoaderBinary::_advance_padding(uint32_t p_len) {
 	}
 }
 
+// pool arrays are read in bulk, in the byte order of the file
+void ResourceInteractiveLoaderBinary::_fix_endianness(void *p_data, uint32_t p_count) {
+
+#ifdef BIG_ENDIAN_ENABLED
+	bool swap = !f->get_endian_swap();
+#else
+	bool swap = f->get_endian_swap();
+#endif
+	if (!swap)
+		return;
+
+	uint32_t *ptr = (uint32_t *)p_data;
+	for (uint32_t i = 0; i < p_count; i++) {
+		ptr[i] = BSWAP32(ptr[i]);
+	}
+}
+
+void ResourceInteractiveLoaderBinary::_advance_alignment() {
+
+	if (ver_format < FORMAT_VERSION_ALIGNED_ARRAYS)
+		return;
+
+	uint64_t pos = f->get_position();
+	uint32_t extra = (ResourceFormatSaverBinaryInstance::ARRAY_ALIGNMENT - pos % ResourceFormatSaverBinaryInstance::ARRAY_ALIGNMENT) % ResourceFormatSaverBinaryInstance::ARRAY_ALIGNMENT;
+	if (extra)
+		f->seek(pos + extra);
+}
+
 StringName ResourceInteractiveLoaderBinary::_get_string() {
 
 	uint32_t id = f->get_32();
@@ -306,10 +336,12 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 				} break;
 				case OBJECT_INTERNAL_RESOURCE: {
 					uint32_t index = f->get_32();
-					String path = res_path + "::" + itos(index);
-					RES res = ResourceLoader::load(path);
+					RES res = _get_internal_resource(index);
+					if (error != OK) {
+						return error;
+					}
 					if (res.is_null()) {
-						WARN_PRINT(String("Couldn't load resource: " + path).utf8().get_data());
+						WARN_PRINT(String("Couldn't load resource: " + res_path + "::" + itos(index)).utf8().get_data());
 					}
 					r_v = res;
 
@@ -404,6 +436,7 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 		case VARIANT_RAW_ARRAY: {
 
 			uint32_t len = f->get_32();
+			_advance_alignment();
 
 			PoolVector<uint8_t> array;
 			array.resize(len);
@@ -417,42 +450,26 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 		case VARIANT_INT_ARRAY: {
 
 			uint32_t len = f->get_32();
+			_advance_alignment();
 
 			PoolVector<int> array;
 			array.resize(len);
 			PoolVector<int>::Write w = array.write();
 			f->get_buffer((uint8_t *)w.ptr(), len * 4);
-#ifdef BIG_ENDIAN_ENABLED
-			{
-				uint32_t *ptr = (uint32_t *)w.ptr();
-				for (int i = 0; i < len; i++) {
-
-					ptr[i] = BSWAP32(ptr[i]);
-				}
-			}
-
-#endif
+			_fix_endianness(w.ptr(), len);
 			w = PoolVector<int>::Write();
 			r_v = array;
 		} break;
 		case VARIANT_REAL_ARRAY: {
 
 			uint32_t len = f->get_32();
+			_advance_alignment();
 
 			PoolVector<real_t> array;
 			array.resize(len);
 			PoolVector<real_t>::Write w = array.write();
 			f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t));
-#ifdef BIG_ENDIAN_ENABLED
-			{
-				uint32_t *ptr = (uint32_t *)w.ptr();
-				for (int i = 0; i < len; i++) {
-
-					ptr[i] = BSWAP32(ptr[i]);
-				}
-			}
-
-#endif
+			_fix_endianness(w.ptr(), len);
 
 			w = PoolVector<real_t>::Write();
 			r_v = array;
@@ -472,23 +489,14 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 		case VARIANT_VECTOR2_ARRAY: {
 
 			uint32_t len = f->get_32();
+			_advance_alignment();
 
 			PoolVector<Vector2> array;
 			array.resize(len);
 			PoolVector<Vector2>::Write w = array.write();
 			if (sizeof(Vector2) == 8) {
 				f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 2);
-#ifdef BIG_ENDIAN_ENABLED
-				{
-					uint32_t *ptr = (uint32_t *)w.ptr();
-					for (int i = 0; i < len * 2; i++) {
-
-						ptr[i] = BSWAP32(ptr[i]);
-					}
-				}
-
-#endif
-
+				_fix_endianness(w.ptr(), len * 2);
 			} else {
 				ERR_EXPLAIN("Vector2 size is NOT 8!");
 				ERR_FAIL_V(ERR_UNAVAILABLE);
@@ -500,23 +508,14 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 		case VARIANT_VECTOR3_ARRAY: {
 
 			uint32_t len = f->get_32();
+			_advance_alignment();
 
 			PoolVector<Vector3> array;
 			array.resize(len);
 			PoolVector<Vector3>::Write w = array.write();
 			if (sizeof(Vector3) == 12) {
 				f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 3);
-#ifdef BIG_ENDIAN_ENABLED
-				{
-					uint32_t *ptr = (uint32_t *)w.ptr();
-					for (int i = 0; i < len * 3; i++) {
-
-						ptr[i] = BSWAP32(ptr[i]);
-					}
-				}
-
-#endif
-
+				_fix_endianness(w.ptr(), len * 3);
 			} else {
 				ERR_EXPLAIN("Vector3 size is NOT 12!");
 				ERR_FAIL_V(ERR_UNAVAILABLE);
@@ -528,23 +527,14 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 		case VARIANT_COLOR_ARRAY: {
 
 			uint32_t len = f->get_32();
+			_advance_alignment();
 
 			PoolVector<Color> array;
 			array.resize(len);
 			PoolVector<Color>::Write w = array.write();
 			if (sizeof(Color) == 16) {
 				f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 4);
-#ifdef BIG_ENDIAN_ENABLED
-				{
-					uint32_t *ptr = (uint32_t *)w.ptr();
-					for (int i = 0; i < len * 4; i++) {
-
-						ptr[i] = BSWAP32(ptr[i]);
-					}
-				}
-
-#endif
-
+				_fix_endianness(w.ptr(), len * 4);
 			} else {
 				ERR_EXPLAIN("Color size is NOT 16!");
 				ERR_FAIL_V(ERR_UNAVAILABLE);
@@ -628,6 +618,24 @@ void ResourceInteractiveLoaderBinary::set_local_path(const String &p_local_path)
 	res_path = p_local_path;
 }
 
+void ResourceInteractiveLoaderBinary::_request_external_resources() {
+
+	//dependencies don't depend on each other through this file, so all of them can load at once.
+	//internal subresources stay in order, they are parsed from this same file and refer to the ones before them
+	for (int i = 0; i < external_resources.size(); i++) {
+
+		String path = external_resources[i].path;
+		if (remaps.has(path)) {
+			path = remaps[path];
+		}
+
+		if (ResourceCache::has(path))
+			continue;
+
+		external_resources.write[i].requested = ResourceLoader::load_threaded_request(path, external_resources[i].type, true) == OK;
+	}
+}
+
 Ref<Resource> ResourceInteractiveLoaderBinary::get_resource() {
 
 	return resource;
@@ -639,6 +647,10 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 	int s = stage;
 
+	if (s == 0 && ResourceLoader::is_using_sub_threads()) {
+		_request_external_resources();
+	}
+
 	if (s < external_resources.size()) {
 
 		String path = external_resources[s].path;
@@ -646,7 +658,14 @@ Error ResourceInteractiveLoaderBinary::poll() {
 		if (remaps.has(path)) {
 			path = remaps[path];
 		}
-		RES res = ResourceLoader::load(path, external_resources[s].type);
+
+		RES res;
+		if (external_resources[s].requested) {
+			external_resources.write[s].requested = false;
+			res = ResourceLoader::load_threaded_get(path);
+		} else {
+			res = ResourceLoader::load(path, external_resources[s].type);
+		}
 		if (res.is_null()) {
 
 			if (!ResourceLoader::get_abort_on_missing_resources()) {
@@ -677,6 +696,13 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 	bool main = s == (internal_resources.size() - 1);
 
+	if (!main && lazy_subresources) {
+		// built when something refers to it, see _get_internal_resource()
+		stage++;
+		error = OK;
+		return error;
+	}
+
 	//maybe it is loaded already
 	String path;
 	int subindex = 0;
@@ -692,6 +718,7 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 		if (ResourceCache::has(path)) {
 			//already loaded, don't do anything
+			internal_resources.write[s].resource = RES(ResourceCache::get(path));
 			stage++;
 			error = OK;
 			return error;
@@ -702,7 +729,27 @@ Error ResourceInteractiveLoaderBinary::poll() {
 			path = res_path;
 	}
 
-	uint64_t offset = internal_resources[s].offset;
+	RES res;
+	error = _parse_resource(s, path, subindex, res);
+	if (error)
+		return error;
+
+	stage++;
+
+	if (main) {
+
+		f->close();
+		resource = res;
+		resource->set_as_translation_remapped(translation_remapped);
+		error = ERR_FILE_EOF;
+	}
+
+	return OK;
+}
+
+Error ResourceInteractiveLoaderBinary::_parse_resource(int p_index, const String &p_path, int p_subindex, RES &r_res) {
+
+	uint64_t offset = internal_resources[p_index].offset;
 
 	f->seek(offset);
 
@@ -710,14 +757,12 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 	Object *obj = ClassDB::instance(t);
 	if (!obj) {
-		error = ERR_FILE_CORRUPT;
 		ERR_EXPLAIN(local_path + ":Resource of unrecognized type in file: " + t);
 	}
 	ERR_FAIL_COND_V(!obj, ERR_FILE_CORRUPT);
 
 	Resource *r = Object::cast_to<Resource>(obj);
 	if (!r) {
-		error = ERR_FILE_CORRUPT;
 		memdelete(obj); //bye
 		ERR_EXPLAIN(local_path + ":Resource type in resource field not a resource, type is: " + obj->get_class());
 		ERR_FAIL_COND_V(!r, ERR_FILE_CORRUPT);
@@ -725,8 +770,12 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 	RES res = RES(r);
 
-	r->set_path(path);
-	r->set_subindex(subindex);
+	r->set_path(p_path);
+	r->set_subindex(p_subindex);
+
+	// registered before its properties, so references back to it resolve
+	internal_resources.write[p_index].resource = res;
+	resource_cache.push_back(res);
 
 	int pc = f->get_32();
 
@@ -737,38 +786,63 @@ Error ResourceInteractiveLoaderBinary::poll() {
 		StringName name = _get_string();
 
 		if (name == StringName()) {
-			error = ERR_FILE_CORRUPT;
 			ERR_FAIL_V(ERR_FILE_CORRUPT);
 		}
 
 		Variant value;
 
-		error = parse_variant(value);
-		if (error)
-			return error;
+		Error err = parse_variant(value);
+		if (err)
+			return err;
 
 		res->set(name, value);
 	}
 #ifdef TOOLS_ENABLED
 	res->set_edited(false);
 #endif
-	stage++;
 
-	resource_cache.push_back(res);
+	r_res = res;
+	return OK;
+}
 
-	if (main) {
+RES ResourceInteractiveLoaderBinary::_get_internal_resource(int p_subindex) {
 
-		f->close();
-		resource = res;
-		resource->set_as_translation_remapped(translation_remapped);
-		error = ERR_FILE_EOF;
+	String path = res_path + "::" + itos(p_subindex);
 
-	} else {
-		error = OK;
+	const int *index = internal_index.getptr(p_subindex);
+	if (!index) {
+		// not a local:// path, only old files can get here
+		return ResourceLoader::load(path);
 	}
 
-	return OK;
+	const IntResource &ir = internal_resources[*index];
+	if (ir.resource.is_valid()) {
+		return ir.resource;
+	}
+
+	if (ResourceCache::has(path)) {
+		RES res = RES(ResourceCache::get(path));
+		internal_resources.write[*index].resource = res;
+		return res;
+	}
+
+	if (!lazy_subresources) {
+		return ResourceLoader::load(path);
+	}
+
+	// first reference to it, build it now and come back
+	uint64_t pos = f->get_position();
+	RES res;
+	Error err = _parse_resource(*index, path, p_subindex, res);
+	f->seek(pos);
+	if (err) {
+		error = err;
+		return RES();
+	}
+
+	return res;
 }
+
 int ResourceInteractiveLoaderBinary::get_stage() const {
 
 	return stage;
@@ -846,6 +920,9 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 		fac->open_after_magic(f);
 		f = fac;
 
+		//jumping back and forth would decompress the same blocks over and over
+		lazy_subresources = false;
+
 	} else if (header[0] != 'R' || header[1] != 'S' || header[2] != 'R' || header[3] != 'C') {
 		//not normal
 
@@ -906,6 +983,7 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 		er.type = get_unicode_string();
 
 		er.path = get_unicode_string();
+		er.requested = false;
 
 		external_resources.push_back(er);
 	}
@@ -921,6 +999,13 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 		internal_resources.push_back(ir);
 	}
 
+	// the main resource is last, nothing refers to it by index
+	for (int i = 0; i < internal_resources.size() - 1; i++) {
+		if (internal_resources[i].path.begins_with("local://")) {
+			internal_index[internal_resources[i].path.replace_first("local://", "").to_int()] = i;
+		}
+	}
+
 	print_bl("int resources: " + itos(int_resources_size));
 
 	if (f->eof_reached()) {
@@ -973,12 +1058,24 @@ String ResourceInteractiveLoaderBinary::recognize(FileAccess *p_f) {
 ResourceInteractiveLoaderBinary::ResourceInteractiveLoaderBinary() :
 		translation_remapped(false),
 		f(NULL),
+		lazy_subresources(false),
 		error(OK),
 		stage(0) {
 }
 
 ResourceInteractiveLoaderBinary::~ResourceInteractiveLoaderBinary() {
 
+	//every request must be collected, even if loading stopped early
+	for (int i = 0; i < external_resources.size(); i++) {
+		if (external_resources[i].requested) {
+			String path = external_resources[i].path;
+			if (remaps.has(path)) {
+				path = remaps[path];
+			}
+			ResourceLoader::load_threaded_get(path);
+		}
+	}
+
 	if (f)
 		memdelete(f);
 }
@@ -1000,6 +1097,7 @@ Ref<ResourceInteractiveLoader> ResourceFormatLoaderBinary::load_interactive(cons
 	String path = p_original_path != "" ? p_original_path : p_path;
 	ria->local_path = ProjectSettings::get_singleton()->localize_path(path);
 	ria->res_path = ria->local_path;
+	ria->lazy_subresources = GLOBAL_GET("application/run/lazy_subresources");
 	//ria->set_local_path( Globals::get_singleton()->localize_path(p_path) );
 	ria->open(f);
 
@@ -1072,7 +1170,7 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 		f = fac;
 
 		FileAccessCompressed *facw = memnew(FileAccessCompressed);
-		facw->configure("RSCC");
+		facw->configure("RSCC", Compression::MODE_ZSTD, 4096, true);
 		Error err = facw->_open(p_path + ".depren", FileAccess::WRITE);
 		if (err) {
 			memdelete(fac);
@@ -1197,8 +1295,9 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 		String type = get_ustring(f);
 		String path = get_ustring(f);
 
+		// same test as when loading, user:// and absolute paths are left alone
 		bool relative = false;
-		if (!path.begins_with("res://")) {
+		if (path.find("://") == -1 && path.is_rel_path()) {
 			path = local_path.plus_file(path).simplify_path();
 			relative = true;
 		}
@@ -1219,6 +1318,14 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 
 	int64_t size_diff = (int64_t)fw->get_position() - (int64_t)f->get_position();
 
+	//the rest of the file moves by size_diff, keep the arrays in it aligned
+	int align_pad = 0;
+	if (ver_format >= FORMAT_VERSION_ALIGNED_ARRAYS) {
+		int alignment = ResourceFormatSaverBinaryInstance::ARRAY_ALIGNMENT;
+		align_pad = (alignment - size_diff % alignment) % alignment;
+		size_diff += align_pad;
+	}
+
 	//internal resources
 	uint32_t int_resources_size = f->get_32();
 	fw->store_32(int_resources_size);
@@ -1231,6 +1338,10 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 		fw->store_64(offset + size_diff);
 	}
 
+	for (int i = 0; i < align_pad; i++) {
+		fw->store_8(0);
+	}
+
 	//rest of file
 	uint8_t b = f->get_8();
 	while (!f->eof_reached()) {
@@ -1285,6 +1396,24 @@ void ResourceFormatSaverBinaryInstance::_pad_buffer(FileAccess *f, int p_bytes)
 	}
 }
 
+void ResourceFormatSaverBinaryInstance::_pad_alignment(FileAccess *f) {
+
+	int extra = (ARRAY_ALIGNMENT - f->get_position() % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT;
+	for (int i = 0; i < extra; i++)
+		f->store_8(0);
+}
+
+// Pool arrays can be stored straight from memory unless the file is written
+// with the other endianness.
+static bool _can_store_raw(FileAccess *f) {
+
+#ifdef BIG_ENDIAN_ENABLED
+	return false;
+#else
+	return !f->get_endian_swap();
+#endif
+}
+
 void ResourceFormatSaverBinaryInstance::_write_variant(const Variant &p_property, const PropertyInfo &p_hint) {
 
 	write_variant(f, p_property, resource_set, external_resources, string_map, p_hint);
@@ -1550,6 +1679,7 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			PoolVector<uint8_t> arr = p_property;
 			int len = arr.size();
 			f->store_32(len);
+			_pad_alignment(f);
 			PoolVector<uint8_t>::Read r = arr.read();
 			f->store_buffer(r.ptr(), len);
 			_pad_buffer(f, len);
@@ -1561,9 +1691,14 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			PoolVector<int> arr = p_property;
 			int len = arr.size();
 			f->store_32(len);
+			_pad_alignment(f);
 			PoolVector<int>::Read r = arr.read();
-			for (int i = 0; i < len; i++)
-				f->store_32(r[i]);
+			if (_can_store_raw(f)) {
+				f->store_buffer((const uint8_t *)r.ptr(), len * 4);
+			} else {
+				for (int i = 0; i < len; i++)
+					f->store_32(r[i]);
+			}
 
 		} break;
 		case Variant::POOL_REAL_ARRAY: {
@@ -1572,9 +1707,14 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			PoolVector<real_t> arr = p_property;
 			int len = arr.size();
 			f->store_32(len);
+			_pad_alignment(f);
 			PoolVector<real_t>::Read r = arr.read();
-			for (int i = 0; i < len; i++) {
-				f->store_real(r[i]);
+			if (_can_store_raw(f)) {
+				f->store_buffer((const uint8_t *)r.ptr(), len * sizeof(real_t));
+			} else {
+				for (int i = 0; i < len; i++) {
+					f->store_real(r[i]);
+				}
 			}
 
 		} break;
@@ -1596,11 +1736,16 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			PoolVector<Vector3> arr = p_property;
 			int len = arr.size();
 			f->store_32(len);
+			_pad_alignment(f);
 			PoolVector<Vector3>::Read r = arr.read();
-			for (int i = 0; i < len; i++) {
-				f->store_real(r[i].x);
-				f->store_real(r[i].y);
-				f->store_real(r[i].z);
+			if (_can_store_raw(f) && sizeof(Vector3) == sizeof(real_t) * 3) {
+				f->store_buffer((const uint8_t *)r.ptr(), len * sizeof(real_t) * 3);
+			} else {
+				for (int i = 0; i < len; i++) {
+					f->store_real(r[i].x);
+					f->store_real(r[i].y);
+					f->store_real(r[i].z);
+				}
 			}
 
 		} break;
@@ -1610,10 +1755,15 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			PoolVector<Vector2> arr = p_property;
 			int len = arr.size();
 			f->store_32(len);
+			_pad_alignment(f);
 			PoolVector<Vector2>::Read r = arr.read();
-			for (int i = 0; i < len; i++) {
-				f->store_real(r[i].x);
-				f->store_real(r[i].y);
+			if (_can_store_raw(f) && sizeof(Vector2) == sizeof(real_t) * 2) {
+				f->store_buffer((const uint8_t *)r.ptr(), len * sizeof(real_t) * 2);
+			} else {
+				for (int i = 0; i < len; i++) {
+					f->store_real(r[i].x);
+					f->store_real(r[i].y);
+				}
 			}
 
 		} break;
@@ -1623,12 +1773,17 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			PoolVector<Color> arr = p_property;
 			int len = arr.size();
 			f->store_32(len);
+			_pad_alignment(f);
 			PoolVector<Color>::Read r = arr.read();
-			for (int i = 0; i < len; i++) {
-				f->store_real(r[i].r);
-				f->store_real(r[i].g);
-				f->store_real(r[i].b);
-				f->store_real(r[i].a);
+			if (_can_store_raw(f) && sizeof(Color) == sizeof(real_t) * 4) {
+				f->store_buffer((const uint8_t *)r.ptr(), len * sizeof(real_t) * 4);
+			} else {
+				for (int i = 0; i < len; i++) {
+					f->store_real(r[i].r);
+					f->store_real(r[i].g);
+					f->store_real(r[i].b);
+					f->store_real(r[i].a);
+				}
 			}
 
 		} break;
@@ -1740,7 +1895,8 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 	Error err;
 	if (p_flags & ResourceSaver::FLAG_COMPRESS) {
 		FileAccessCompressed *fac = memnew(FileAccessCompressed);
-		fac->configure("RSCC");
+		// only resources use the shared dictionary, they are loaded by the project that has it
+		fac->configure("RSCC", Compression::MODE_ZSTD, 4096, true);
 		f = fac;
 		err = fac->_open(p_path, FileAccess::WRITE);
 		if (err)
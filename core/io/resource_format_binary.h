@@ -59,6 +59,7 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
 	struct ExtResource {
 		String path;
 		String type;
+		bool requested; // loading on the worker pool, collected with load_threaded_get()
 	};
 
 	Vector<ExtResource> external_resources;
@@ -66,12 +67,17 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
 	struct IntResource {
 		String path;
 		uint64_t offset;
+		RES resource; // once built, or found in the cache
 	};
 
 	Vector<IntResource> internal_resources;
+	HashMap<int, int> internal_index; // subindex of local:// paths to internal_resources
+	bool lazy_subresources;
 
 	String get_unicode_string();
 	void _advance_padding(uint32_t p_len);
+	void _advance_alignment();
+	void _fix_endianness(void *p_data, uint32_t p_count);
 
 	Map<String, String> remaps;
 	Error error;
@@ -81,6 +87,9 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
 	friend class ResourceFormatLoaderBinary;
 
 	Error parse_variant(Variant &r_v);
+	void _request_external_resources();
+	Error _parse_resource(int p_index, const String &p_path, int p_subindex, RES &r_res);
+	RES _get_internal_resource(int p_subindex);
 
 public:
 	virtual void set_local_path(const String &p_local_path);
@@ -142,12 +151,17 @@ class ResourceFormatSaverBinaryInstance {
 	};
 
 	static void _pad_buffer(FileAccess *f, int p_bytes);
+	static void _pad_alignment(FileAccess *f);
 	void _write_variant(const Variant &p_property, const PropertyInfo &p_hint = PropertyInfo());
 	void _find_resources(const Variant &p_variant, bool p_main = false);
 	static void save_unicode_string(FileAccess *f, const String &p_string, bool p_bit_on_len = false);
 	int get_string_index(const String &p_string);
 
 public:
+	enum {
+		ARRAY_ALIGNMENT = 16 // pool array payloads start at multiples of this, since format version 4
+	};
+
 	Error save(const String &p_path, const RES &p_resource, uint32_t p_flags = 0);
 	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint = PropertyInfo());
 };
@@ -280,45 +280,129 @@ RES ResourceLoader::_load(const String &p_path, const String &p_original_path, c
 	return RES();
 }
 
+String ResourceLoader::_validate_local_path(const String &p_path) {
+
+	if (p_path.is_rel_path())
+		return "res://" + p_path;
+	else
+		return ProjectSettings::get_singleton()->localize_path(p_path);
+}
+
 RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
 
 	if (r_error)
 		*r_error = ERR_CANT_OPEN;
 
-	String local_path;
-	if (p_path.is_rel_path())
-		local_path = "res://" + p_path;
-	else
-		local_path = ProjectSettings::get_singleton()->localize_path(p_path);
+	String local_path = _validate_local_path(p_path);
+
+	if (p_no_cache) {
+		return _load_local(p_path, local_path, p_type_hint, true, r_error);
+	}
 
-	if (!p_no_cache) {
-		//lock first if possible
-		if (ResourceCache::lock) {
-			ResourceCache::lock->read_lock();
+	//lock first if possible
+	if (ResourceCache::lock) {
+		ResourceCache::lock->read_lock();
+	}
+
+	//get ptr
+	Resource **rptr = ResourceCache::resources.getptr(local_path);
+
+	if (rptr) {
+		RES res(*rptr);
+		//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
+		if (res.is_valid()) {
+			//referencing is fine
+			if (r_error)
+				*r_error = OK;
+			if (ResourceCache::lock) {
+				ResourceCache::lock->read_unlock();
+			}
+			print_verbose("Loading resource: " + local_path + " (cached)");
+			return res;
 		}
+	}
+	if (ResourceCache::lock) {
+		ResourceCache::lock->read_unlock();
+	}
+
+	//a path is loaded by one thread at a time, the others wait for it and share the result
+	ThreadLoadTask *load_task = NULL;
+	if (thread_load_mutex) {
+
+		thread_load_mutex->lock();
+
+		load_task = thread_load_tasks.getptr(local_path);
+		if (load_task) {
+
+			if (!_thread_load_would_deadlock(load_task)) {
 
-		//get ptr
-		Resource **rptr = ResourceCache::resources.getptr(local_path);
+				load_task->waiters++;
+				_wait_for_thread_load(load_task);
+				load_task->waiters--;
+
+				RES res = load_task->resource;
+				Error err = load_task->error;
+				_release_thread_load(load_task);
+				thread_load_mutex->unlock();
 
-		if (rptr) {
-			RES res(*rptr);
-			//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
-			if (res.is_valid()) {
-				//referencing is fine
 				if (r_error)
-					*r_error = OK;
-				if (ResourceCache::lock) {
-					ResourceCache::lock->read_unlock();
-				}
-				print_verbose("Loading resource: " + local_path + " (cached)");
+					*r_error = err;
 				return res;
 			}
+
+			//this thread is loading it already (threaded load, or a cyclic dependency), or the thread loading it
+			//waits for this one, load as usual
+			load_task = NULL;
+
+		} else {
+
+			//it may have finished loading after the cache was checked
+			Resource *cached = ResourceCache::get(local_path);
+			if (cached) {
+				RES res(cached);
+				if (res.is_valid()) {
+					thread_load_mutex->unlock();
+					if (r_error)
+						*r_error = OK;
+					return res;
+				}
+			}
+
+			ThreadLoadTask new_task;
+			new_task.local_path = local_path;
+			new_task.type_hint = p_type_hint;
+			new_task.awaited = true; //no pool task behind it
+			new_task.running = true;
+			new_task.loader_thread = Thread::get_caller_id();
+			new_task.waiters = 1;
+
+			thread_load_tasks[local_path] = new_task;
+			load_task = thread_load_tasks.getptr(local_path);
 		}
-		if (ResourceCache::lock) {
-			ResourceCache::lock->read_unlock();
-		}
+
+		thread_load_mutex->unlock();
 	}
 
+	Error err = ERR_CANT_OPEN;
+	RES res = _load_local(p_path, local_path, p_type_hint, false, &err);
+	if (r_error)
+		*r_error = err;
+
+	if (load_task) {
+		thread_load_mutex->lock();
+		_finish_thread_load(load_task, res, err);
+		load_task->waiters--;
+		_release_thread_load(load_task);
+		thread_load_mutex->unlock();
+	}
+
+	return res;
+}
+
+RES ResourceLoader::_load_local(const String &p_path, const String &p_local_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
+
+	const String &local_path = p_local_path;
+
 	bool xl_remapped = false;
 	String path = _path_remap(local_path, &xl_remapped);
 
@@ -383,6 +467,261 @@ bool ResourceLoader::exists(const String &p_path, const String &p_type_hint) {
 	return false;
 }
 
+// Set while a worker runs a load requested with p_use_sub_threads, so loaders can request their dependencies in parallel.
+static thread_local bool thread_load_use_sub_threads = false;
+
+bool ResourceLoader::is_using_sub_threads() {
+
+	return thread_load_use_sub_threads;
+}
+
+void ResourceLoader::_thread_load_function(void *p_userdata) {
+
+	ThreadLoadTask *load_task = (ThreadLoadTask *)p_userdata;
+
+	thread_load_mutex->lock();
+	load_task->running = true;
+	load_task->loader_thread = Thread::get_caller_id();
+	String local_path = load_task->local_path;
+	String type_hint = load_task->type_hint;
+	bool use_sub_threads = load_task->use_sub_threads;
+	thread_load_mutex->unlock();
+
+	//tasks run nested while a worker waits, so keep the outer value
+	bool prev_use_sub_threads = thread_load_use_sub_threads;
+	thread_load_use_sub_threads = use_sub_threads;
+
+	Error err = OK;
+	RES res = load(local_path, type_hint, false, &err);
+
+	thread_load_use_sub_threads = prev_use_sub_threads;
+
+	thread_load_mutex->lock();
+	_finish_thread_load(load_task, res, err);
+	thread_load_mutex->unlock();
+}
+
+void ResourceLoader::_finish_thread_load(ThreadLoadTask *p_load_task, const RES &p_resource, Error p_error) {
+
+	//called with thread_load_mutex locked
+
+	p_load_task->resource = p_resource;
+	p_load_task->error = p_resource.is_valid() ? OK : (p_error != OK ? p_error : ERR_CANT_OPEN);
+	p_load_task->status = p_resource.is_valid() ? THREAD_LOAD_LOADED : THREAD_LOAD_FAILED;
+	p_load_task->running = false;
+
+	for (; p_load_task->sleepers > 0; p_load_task->sleepers--) {
+		p_load_task->done_semaphore->post();
+	}
+}
+
+bool ResourceLoader::_thread_load_would_deadlock(const ThreadLoadTask *p_load_task) {
+
+	//called with thread_load_mutex locked
+
+	//follow the loads the loading thread waits for, if one of them is run by this thread nobody ever finishes
+	Thread::ID caller = Thread::get_caller_id();
+	Set<Thread::ID> visited;
+	Vector<const ThreadLoadTask *> pending;
+	pending.push_back(p_load_task);
+
+	while (pending.size()) {
+
+		const ThreadLoadTask *load_task = pending[pending.size() - 1];
+		pending.resize(pending.size() - 1);
+
+		if (!load_task->running)
+			continue; //queued or done, the pool runs it whatever this thread does
+
+		if (load_task->loader_thread == caller)
+			return true;
+
+		if (visited.has(load_task->loader_thread))
+			continue;
+		visited.insert(load_task->loader_thread);
+
+		//tasks nested on that thread finish only after all of its waits
+		const Vector<ThreadLoadTask *> *waits = thread_load_waits.getptr(load_task->loader_thread);
+		if (waits) {
+			for (int i = 0; i < waits->size(); i++) {
+				pending.push_back((*waits)[i]);
+			}
+		}
+	}
+
+	return false;
+}
+
+void ResourceLoader::_wait_for_thread_load(ThreadLoadTask *p_load_task) {
+
+	//called and returns with thread_load_mutex locked
+
+	//published in the same locked section as the deadlock check, so two threads can't both miss the cycle
+	Thread::ID caller = Thread::get_caller_id();
+	thread_load_waits[caller].push_back(p_load_task);
+
+	if (!p_load_task->awaited) {
+		//the first one to wait also frees the pool task, and helps running pending tasks meanwhile
+		p_load_task->awaited = true;
+		if (p_load_task->task_id != WorkerThreadPool::INVALID_TASK_ID) {
+			thread_load_mutex->unlock();
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(p_load_task->task_id);
+			thread_load_mutex->lock();
+		}
+	}
+
+	while (p_load_task->status == THREAD_LOAD_IN_PROGRESS) {
+
+		//the task may still be queued behind us, so help before going to sleep
+		thread_load_mutex->unlock();
+		bool helped = WorkerThreadPool::get_singleton()->process_pending_task();
+		thread_load_mutex->lock();
+
+		if (helped || p_load_task->status != THREAD_LOAD_IN_PROGRESS)
+			continue;
+
+		if (!p_load_task->done_semaphore)
+			p_load_task->done_semaphore = Semaphore::create();
+
+		p_load_task->sleepers++;
+		thread_load_mutex->unlock();
+		p_load_task->done_semaphore->wait();
+		thread_load_mutex->lock();
+	}
+
+	//waits nest when tasks run while waiting, so this one is always the last
+	Vector<ThreadLoadTask *> &waits = thread_load_waits[caller];
+	waits.resize(waits.size() - 1);
+	if (waits.empty()) {
+		thread_load_waits.erase(caller);
+	}
+}
+
+void ResourceLoader::_release_thread_load(ThreadLoadTask *p_load_task) {
+
+	//called with thread_load_mutex locked
+
+	if (p_load_task->requests > 0 || p_load_task->waiters > 0)
+		return;
+
+	if (p_load_task->done_semaphore)
+		memdelete(p_load_task->done_semaphore);
+
+	thread_load_tasks.erase(p_load_task->local_path);
+}
+
+Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads) {
+
+	ERR_FAIL_COND_V(!thread_load_mutex, ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V(!WorkerThreadPool::get_singleton(), ERR_UNCONFIGURED);
+
+	String local_path = _validate_local_path(p_path);
+
+	thread_load_mutex->lock();
+
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	if (load_task) {
+		//already requested, share the task
+		load_task->requests++;
+		thread_load_mutex->unlock();
+		return OK;
+	}
+
+	ThreadLoadTask new_task;
+	new_task.local_path = local_path;
+	new_task.type_hint = p_type_hint;
+	new_task.use_sub_threads = p_use_sub_threads;
+	new_task.requests = 1;
+
+	//cached resources are handed out right away, without going through the pool
+	Resource *cached = ResourceCache::get(local_path);
+	if (cached) {
+		new_task.resource = RES(cached);
+		if (new_task.resource.is_valid()) {
+			new_task.status = THREAD_LOAD_LOADED;
+		}
+	}
+
+	thread_load_tasks[local_path] = new_task;
+	load_task = thread_load_tasks.getptr(local_path);
+
+	if (load_task->status == THREAD_LOAD_IN_PROGRESS) {
+		//elements of a HashMap never move, so the task can keep a pointer to its entry
+		load_task->task_id = WorkerThreadPool::get_singleton()->add_native_task(&ResourceLoader::_thread_load_function, load_task);
+	}
+
+	thread_load_mutex->unlock();
+
+	return OK;
+}
+
+ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path) {
+
+	ERR_FAIL_COND_V(!thread_load_mutex, THREAD_LOAD_INVALID_RESOURCE);
+
+	String local_path = _validate_local_path(p_path);
+
+	thread_load_mutex->lock();
+
+	ThreadLoadStatus status = THREAD_LOAD_INVALID_RESOURCE;
+	const ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	if (load_task && load_task->requests > 0)
+		status = load_task->status;
+
+	thread_load_mutex->unlock();
+
+	return status;
+}
+
+RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
+
+	if (r_error)
+		*r_error = ERR_INVALID_PARAMETER;
+
+	ERR_FAIL_COND_V(!thread_load_mutex, RES());
+
+	String local_path = _validate_local_path(p_path);
+
+	thread_load_mutex->lock();
+
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	if (!load_task || load_task->requests == 0) {
+		thread_load_mutex->unlock();
+		ERR_EXPLAIN("Attempted to get a resource that was not requested with load_threaded_request(): " + local_path);
+		ERR_FAIL_V(RES());
+	}
+
+	if (load_task->running && load_task->loader_thread == Thread::get_caller_id()) {
+		thread_load_mutex->unlock();
+		ERR_EXPLAIN("Resource requested while loading itself (cyclic dependency?): " + local_path);
+		ERR_FAIL_V(RES());
+	}
+
+	if (_thread_load_would_deadlock(load_task)) {
+
+		//its loader waits for something this thread is loading (a cyclic dependency across threads), load it here instead
+		String type_hint = load_task->type_hint;
+		load_task->requests--;
+		_release_thread_load(load_task);
+		thread_load_mutex->unlock();
+
+		return _load_local(p_path, local_path, type_hint, false, r_error);
+	}
+
+	_wait_for_thread_load(load_task);
+
+	RES res = load_task->resource;
+	if (r_error)
+		*r_error = load_task->error;
+
+	load_task->requests--;
+	_release_thread_load(load_task);
+
+	thread_load_mutex->unlock();
+
+	return res;
+}
+
 Ref<ResourceInteractiveLoader> ResourceLoader::load_interactive(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
 
 	if (r_error)
@@ -847,3 +1186,57 @@ HashMap<String, Vector<String> > ResourceLoader::translation_remaps;
 HashMap<String, String> ResourceLoader::path_remaps;
 
 ResourceLoaderImport ResourceLoader::import = NULL;
+
+Mutex *ResourceLoader::thread_load_mutex = NULL;
+HashMap<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
+HashMap<Thread::ID, Vector<ResourceLoader::ThreadLoadTask *> > ResourceLoader::thread_load_waits;
+
+void ResourceLoader::initialize() {
+
+	thread_load_mutex = Mutex::create();
+}
+
+void ResourceLoader::clear_thread_load_tasks() {
+
+	//requests nobody collected still own pool tasks, wait for them so nothing runs past this point
+	thread_load_mutex->lock();
+
+	//first let everything in flight finish, loads still collect the dependencies they requested
+	while (true) {
+
+		ThreadLoadTask *pending = NULL;
+		for (const String *K = thread_load_tasks.next(NULL); K; K = thread_load_tasks.next(K)) {
+			ThreadLoadTask *load_task = thread_load_tasks.getptr(*K);
+			if (load_task->status == THREAD_LOAD_IN_PROGRESS || (!load_task->awaited && load_task->task_id != WorkerThreadPool::INVALID_TASK_ID)) {
+				pending = load_task;
+				break;
+			}
+		}
+
+		if (!pending)
+			break;
+
+		pending->waiters++;
+		_wait_for_thread_load(pending);
+		pending->waiters--;
+		_release_thread_load(pending);
+	}
+
+	//what is left was requested but never collected
+	while (thread_load_tasks.size()) {
+
+		ThreadLoadTask *load_task = thread_load_tasks.getptr(*thread_load_tasks.next(NULL));
+		load_task->requests = 0;
+		_release_thread_load(load_task);
+	}
+
+	thread_load_mutex->unlock();
+}
+
+void ResourceLoader::finalize() {
+
+	clear_thread_load_tasks();
+
+	memdelete(thread_load_mutex);
+	thread_load_mutex = NULL;
+}
@@ -31,6 +31,9 @@
 #ifndef RESOURCE_LOADER_H
 #define RESOURCE_LOADER_H
 
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/resource.h"
 
 /**
@@ -92,6 +95,60 @@ class ResourceLoader {
 		MAX_LOADERS = 64
 	};
 
+public:
+	enum ThreadLoadStatus {
+		THREAD_LOAD_INVALID_RESOURCE,
+		THREAD_LOAD_IN_PROGRESS,
+		THREAD_LOAD_FAILED,
+		THREAD_LOAD_LOADED
+	};
+
+private:
+	struct ThreadLoadTask {
+
+		WorkerThreadPool::TaskID task_id;
+		bool awaited; // the pool task is waited for exactly once, later waiters use the semaphore
+		bool running; // loader_thread is set while the load runs
+		Thread::ID loader_thread;
+		String local_path;
+		String type_hint;
+		bool use_sub_threads;
+		ThreadLoadStatus status;
+		Error error;
+		RES resource;
+		int requests; // pending load_threaded_get() calls, each request is matched by one
+		int waiters; // plain load() calls waiting for this task, they keep it alive without a request
+		int sleepers; // threads blocked on done_semaphore
+		Semaphore *done_semaphore;
+
+		ThreadLoadTask() {
+			task_id = WorkerThreadPool::INVALID_TASK_ID;
+			awaited = false;
+			running = false;
+			loader_thread = 0;
+			use_sub_threads = false;
+			status = THREAD_LOAD_IN_PROGRESS;
+			error = OK;
+			requests = 0;
+			waiters = 0;
+			sleepers = 0;
+			done_semaphore = NULL;
+		}
+	};
+
+	static Mutex *thread_load_mutex;
+	static HashMap<String, ThreadLoadTask> thread_load_tasks;
+	static HashMap<Thread::ID, Vector<ThreadLoadTask *> > thread_load_waits; // loads each thread is blocked on, innermost last
+
+	static RES _load_local(const String &p_path, const String &p_local_path, const String &p_type_hint, bool p_no_cache, Error *r_error);
+
+	static void _thread_load_function(void *p_userdata);
+	static void _finish_thread_load(ThreadLoadTask *p_load_task, const RES &p_resource, Error p_error);
+	static bool _thread_load_would_deadlock(const ThreadLoadTask *p_load_task);
+	static void _wait_for_thread_load(ThreadLoadTask *p_load_task);
+	static void _release_thread_load(ThreadLoadTask *p_load_task);
+	static String _validate_local_path(const String &p_path);
+
 	static Ref<ResourceFormatLoader> loader[MAX_LOADERS];
 	static int loader_count;
 	static bool timestamp_on_load;
@@ -122,6 +179,11 @@ public:
 	static RES load(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
 	static bool exists(const String &p_path, const String &p_type_hint = "");
 
+	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false);
+	static ThreadLoadStatus load_threaded_get_status(const String &p_path);
+	static RES load_threaded_get(const String &p_path, Error *r_error = NULL);
+	static bool is_using_sub_threads();
+
 	static void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions);
 	static void add_resource_format_loader(Ref<ResourceFormatLoader> p_format_loader, bool p_at_front = false);
 	static void remove_resource_format_loader(Ref<ResourceFormatLoader> p_format_loader);
@@ -170,6 +232,11 @@ public:
 	static void remove_custom_resource_format_loader(String script_path);
 	static void add_custom_loaders();
 	static void remove_custom_loaders();
+
+	static void clear_thread_load_tasks();
+
+	static void initialize();
+	static void finalize();
 };
 
 #endif
@@ -0,0 +1,384 @@
+/*************************************************************************/
+/*  aabb_tree.h                                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include "core/math/aabb.h"
+#include "core/os/memory.h"
+
+/*
+	Balanced binary tree of AABBs, used by the BVH spatial index and the BVH physics broadphase.
+
+	Nodes live in a single array and are addressed by index, with freed nodes kept in a free
+	list. Leaves are inserted where they grow the tree the least, and ancestors are rotated to
+	keep it balanced. Users allocate a leaf, fill its AABB and ID, then insert it.
+
+	Nodes can be marked dirty, which propagates up to the root, so users can skip the branches
+	that have not changed since the flags were last cleared.
+*/
+
+template <class I>
+class AABBTree {
+public:
+	struct Node {
+
+		AABB aabb;
+		int parent;
+		int children[2];
+		int height; // 0 for leaves
+		I id; // only valid for leaves
+		bool dirty;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == -1; }
+	};
+
+	Node *nodes;
+	int node_capacity;
+	int free_list;
+	int root;
+
+	static _FORCE_INLINE_ real_t aabb_cost(const AABB &p_aabb) {
+
+		// half the surface area, good enough to compare insertion costs
+		const Vector3 &s = p_aabb.size;
+		return s.x * s.y + s.y * s.z + s.z * s.x;
+	}
+
+	// leaves store the AABB grown by a fraction of its size, with a minimum in world units,
+	// so small movements don't need a reinsertion
+	static _FORCE_INLINE_ AABB fatten(const AABB &p_aabb) {
+
+		return p_aabb.grow(MAX(p_aabb.get_longest_axis_size() * 0.1, 0.05));
+	}
+
+	int allocate_node();
+	void free_node(int p_node);
+
+	void insert_leaf(int p_leaf);
+	void remove_leaf(int p_leaf);
+	int balance(int p_node);
+	void refit(int p_node);
+	void mark_dirty(int p_leaf);
+	void clear_dirty(int p_node);
+
+	AABBTree();
+	~AABBTree();
+};
+
+template <class I>
+int AABBTree<I>::allocate_node() {
+
+	if (free_list == -1) {
+
+		int new_capacity = node_capacity ? node_capacity * 2 : 64;
+		nodes = (Node *)memrealloc(nodes, sizeof(Node) * new_capacity);
+		for (int i = node_capacity; i < new_capacity; i++) {
+			nodes[i].parent = i + 1;
+			nodes[i].height = -1;
+		}
+		nodes[new_capacity - 1].parent = -1;
+		free_list = node_capacity;
+		node_capacity = new_capacity;
+	}
+
+	int n = free_list;
+	free_list = nodes[n].parent;
+
+	Node &node = nodes[n];
+	node.aabb = AABB();
+	node.parent = -1;
+	node.children[0] = -1;
+	node.children[1] = -1;
+	node.height = 0;
+	node.id = I();
+	node.dirty = false;
+
+	return n;
+}
+
+template <class I>
+void AABBTree<I>::free_node(int p_node) {
+
+	nodes[p_node].parent = free_list;
+	nodes[p_node].height = -1;
+	free_list = p_node;
+}
+
+template <class I>
+void AABBTree<I>::insert_leaf(int p_leaf) {
+
+	if (root == -1) {
+		root = p_leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	// walk down picking the child that grows the least
+	AABB leaf_aabb = nodes[p_leaf].aabb;
+	int index = root;
+	while (!nodes[index].is_leaf()) {
+
+		const Node &node = nodes[index];
+
+		real_t area = aabb_cost(node.aabb);
+		real_t combined_area = aabb_cost(node.aabb.merge(leaf_aabb));
+
+		// cost of creating a new parent for this node and the new leaf
+		real_t cost = 2.0 * combined_area;
+		// minimum cost of pushing the leaf further down the tree
+		real_t inheritance_cost = 2.0 * (combined_area - area);
+
+		real_t child_cost[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = nodes[node.children[i]];
+			real_t merged = aabb_cost(child.aabb.merge(leaf_aabb));
+			if (child.is_leaf()) {
+				child_cost[i] = merged + inheritance_cost;
+			} else {
+				child_cost[i] = merged - aabb_cost(child.aabb) + inheritance_cost;
+			}
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+			break;
+
+		index = child_cost[0] < child_cost[1] ? node.children[0] : node.children[1];
+	}
+
+	int sibling = index;
+	int old_parent = nodes[sibling].parent;
+	int new_parent = allocate_node();
+
+	nodes[new_parent].parent = old_parent;
+	nodes[new_parent].children[0] = sibling;
+	nodes[new_parent].children[1] = p_leaf;
+	nodes[sibling].parent = new_parent;
+	nodes[p_leaf].parent = new_parent;
+
+	if (old_parent != -1) {
+		if (nodes[old_parent].children[0] == sibling) {
+			nodes[old_parent].children[0] = new_parent;
+		} else {
+			nodes[old_parent].children[1] = new_parent;
+		}
+	} else {
+		root = new_parent;
+	}
+
+	// refit and rebalance the ancestors
+	index = new_parent;
+	while (index != -1) {
+		index = balance(index);
+		refit(index);
+		index = nodes[index].parent;
+	}
+}
+
+template <class I>
+void AABBTree<I>::remove_leaf(int p_leaf) {
+
+	if (p_leaf == root) {
+		root = -1;
+		return;
+	}
+
+	int parent = nodes[p_leaf].parent;
+	int grand_parent = nodes[parent].parent;
+	int sibling = nodes[parent].children[0] == p_leaf ? nodes[parent].children[1] : nodes[parent].children[0];
+
+	if (grand_parent != -1) {
+
+		if (nodes[grand_parent].children[0] == parent) {
+			nodes[grand_parent].children[0] = sibling;
+		} else {
+			nodes[grand_parent].children[1] = sibling;
+		}
+		nodes[sibling].parent = grand_parent;
+		free_node(parent);
+
+		int index = grand_parent;
+		while (index != -1) {
+			index = balance(index);
+			refit(index);
+			index = nodes[index].parent;
+		}
+	} else {
+
+		root = sibling;
+		nodes[sibling].parent = -1;
+		free_node(parent);
+	}
+
+	nodes[p_leaf].parent = -1;
+}
+
+template <class I>
+void AABBTree<I>::refit(int p_node) {
+
+	Node &node = nodes[p_node];
+	const Node &a = nodes[node.children[0]];
+	const Node &b = nodes[node.children[1]];
+
+	node.aabb = a.aabb.merge(b.aabb);
+	node.height = 1 + MAX(a.height, b.height);
+	node.dirty = a.dirty || b.dirty;
+}
+
+// rotates the taller grandchild up if the subtree at p_node is unbalanced, returns the new subtree root
+template <class I>
+int AABBTree<I>::balance(int p_node) {
+
+	Node &A = nodes[p_node];
+	if (A.is_leaf() || A.height < 2)
+		return p_node;
+
+	int iB = A.children[0];
+	int iC = A.children[1];
+	Node &B = nodes[iB];
+	Node &C = nodes[iC];
+
+	int balance = C.height - B.height;
+
+	if (balance > 1) {
+		// rotate C up
+
+		int iF = C.children[0];
+		int iG = C.children[1];
+
+		C.children[0] = p_node;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		if (C.parent != -1) {
+			if (nodes[C.parent].children[0] == p_node) {
+				nodes[C.parent].children[0] = iC;
+			} else {
+				nodes[C.parent].children[1] = iC;
+			}
+		} else {
+			root = iC;
+		}
+
+		if (nodes[iF].height > nodes[iG].height) {
+			C.children[1] = iF;
+			A.children[1] = iG;
+			nodes[iG].parent = p_node;
+		} else {
+			C.children[1] = iG;
+			A.children[1] = iF;
+			nodes[iF].parent = p_node;
+		}
+
+		refit(p_node);
+		refit(iC);
+		return iC;
+	}
+
+	if (balance < -1) {
+		// rotate B up
+
+		int iD = B.children[0];
+		int iE = B.children[1];
+
+		B.children[0] = p_node;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if (B.parent != -1) {
+			if (nodes[B.parent].children[0] == p_node) {
+				nodes[B.parent].children[0] = iB;
+			} else {
+				nodes[B.parent].children[1] = iB;
+			}
+		} else {
+			root = iB;
+		}
+
+		if (nodes[iD].height > nodes[iE].height) {
+			B.children[1] = iD;
+			A.children[0] = iE;
+			nodes[iE].parent = p_node;
+		} else {
+			B.children[1] = iE;
+			A.children[0] = iD;
+			nodes[iD].parent = p_node;
+		}
+
+		refit(p_node);
+		refit(iB);
+		return iB;
+	}
+
+	return p_node;
+}
+
+template <class I>
+void AABBTree<I>::mark_dirty(int p_leaf) {
+
+	int index = p_leaf;
+	while (index != -1 && !nodes[index].dirty) {
+		nodes[index].dirty = true;
+		index = nodes[index].parent;
+	}
+}
+
+template <class I>
+void AABBTree<I>::clear_dirty(int p_node) {
+
+	Node &node = nodes[p_node];
+	if (!node.dirty)
+		return;
+
+	node.dirty = false;
+	if (!node.is_leaf()) {
+		clear_dirty(node.children[0]);
+		clear_dirty(node.children[1]);
+	}
+}
+
+template <class I>
+AABBTree<I>::AABBTree() {
+
+	nodes = NULL;
+	node_capacity = 0;
+	free_list = -1;
+	root = -1;
+}
+
+template <class I>
+AABBTree<I>::~AABBTree() {
+
+	if (nodes) {
+		memfree(nodes);
+	}
+}
+
+#endif // AABB_TREE_H
@@ -0,0 +1,673 @@
+/*************************************************************************/
+/*  bvh.h                                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "core/math/aabb.h"
+#include "core/math/aabb_tree.h"
+#include "core/math/plane.h"
+#include "core/os/memory.h"
+#include "core/vector.h"
+
+/*
+	Dynamic AABB tree, usable in place of Octree<T, true>.
+
+	Leaves store "fat" AABBs (the real AABB grown by a margin), so an element moving
+	inside its fat AABB does not touch the tree at all. Pairable and non-pairable
+	elements live in separate trees, as only pairable elements need to be checked
+	against both. Pairs are updated as elements move, and exist only while their
+	AABBs intersect, so the callbacks match the octree ones.
+
+	Every element is stored once, so unlike the octree, culling doesn't modify the
+	tree and can run from several threads at once.
+*/
+
+typedef uint32_t BVHElementID;
+
+template <class T>
+class BVH {
+public:
+	typedef void *(*PairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int);
+	typedef void (*UnpairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int, void *);
+
+private:
+	enum {
+		TREE_REGULAR,
+		TREE_PAIRABLE,
+		TREE_MAX,
+		CULL_STACK_SIZE = 128, // trees are balanced, height never gets near this
+	};
+
+	typedef AABBTree<BVHElementID> Tree;
+	typedef typename Tree::Node Node;
+
+	struct Pair {
+
+		BVHElementID A;
+		BVHElementID B;
+		int index_A; // position in the pair list of each element
+		int index_B;
+		void *ud;
+	};
+
+	struct Element {
+
+		T *userdata;
+		int subindex;
+		bool pairable;
+		uint32_t pairable_type;
+		uint32_t pairable_mask;
+		AABB aabb;
+		int leaf;
+		uint64_t pass;
+		Vector<Pair *> pairs;
+
+		Element() {
+			userdata = NULL;
+			subindex = 0;
+			pairable = false;
+			pairable_type = 0;
+			pairable_mask = 0;
+			leaf = -1;
+			pass = 0;
+		}
+	};
+
+	Tree trees[TREE_MAX];
+
+	Vector<Element> elements; // IDs are index + 1
+	Vector<BVHElementID> free_ids;
+	Vector<BVHElementID> candidates;
+
+	uint64_t pass;
+	int pair_count;
+
+	PairCallback pair_callback;
+	UnpairCallback unpair_callback;
+	void *pair_callback_userdata;
+	void *unpair_callback_userdata;
+
+	// -1 outside, 1 fully inside, 0 intersecting, only checking the planes still set in r_mask
+	static _FORCE_INLINE_ int _classify_convex(const AABB &p_aabb, const Plane *p_planes, int p_plane_count, uint32_t &r_mask) {
+
+		Vector3 half = p_aabb.size * 0.5;
+		Vector3 center = p_aabb.position + half;
+
+		for (int i = 0; i < p_plane_count; i++) {
+
+			uint32_t bit = i < 32 ? (1 << i) : 0;
+			if (bit && !(r_mask & bit))
+				continue;
+
+			const Plane &p = p_planes[i];
+			real_t distance = p.normal.dot(center) - p.d;
+			real_t extent = Math::abs(p.normal.x) * half.x + Math::abs(p.normal.y) * half.y + Math::abs(p.normal.z) * half.z;
+
+			if (distance - extent > 0)
+				return -1;
+			if (distance + extent <= 0)
+				r_mask &= ~bit; // inside this one, children don't need to check it again
+		}
+
+		return r_mask == 0 && p_plane_count <= 32 ? 1 : 0;
+	}
+
+	_FORCE_INLINE_ bool _can_pair(const Element &p_A, const Element &p_B) const {
+
+		if (!p_A.pairable && !p_B.pairable)
+			return false;
+		if (p_A.userdata == p_B.userdata && p_A.userdata)
+			return false;
+		return (p_A.pairable_type & p_B.pairable_mask) || (p_B.pairable_type & p_A.pairable_mask);
+	}
+
+	_FORCE_INLINE_ int _get_tree(const Element &p_element) const { return p_element.pairable ? TREE_PAIRABLE : TREE_REGULAR; }
+
+	void _insert(BVHElementID p_id);
+	void _remove(BVHElementID p_id);
+	void _pair(BVHElementID p_A, BVHElementID p_B);
+	void _unpair(Pair *p_pair);
+	void _unpair_all(BVHElementID p_id);
+	void _check_pairs(BVHElementID p_id);
+	void _gather_candidates(int p_tree, const AABB &p_aabb);
+
+	template <class Tester>
+	void _cull(int p_tree, const Tester &p_tester, T **p_result_array, int &r_result_count, int p_result_max, int *p_subindex_array, uint32_t p_mask) const;
+	void _cull_convex(int p_tree, const Plane *p_planes, int p_plane_count, T **p_result_array, int &r_result_count, int p_result_max, uint32_t p_mask) const;
+
+	struct AABBTester {
+		AABB aabb;
+		_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return aabb.intersects_inclusive(p_aabb); }
+	};
+
+	struct SegmentTester {
+		Vector3 from, to;
+		_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+	};
+
+	struct PointTester {
+		Vector3 point;
+		_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+	};
+
+public:
+	BVHElementID create(T *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+	void move(BVHElementID p_id, const AABB &p_aabb);
+	void set_pairable(BVHElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1);
+	void erase(BVHElementID p_id);
+
+	bool is_pairable(BVHElementID p_id) const;
+	T *get(BVHElementID p_id) const;
+	int get_subindex(BVHElementID p_id) const;
+
+	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata);
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+
+	int get_pair_count() const { return pair_count; }
+
+	BVH();
+	~BVH();
+};
+
+/* PRIVATE FUNCTIONS */
+
+template <class T>
+void BVH<T>::_insert(BVHElementID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	Tree &tree = trees[_get_tree(e)];
+
+	e.leaf = tree.allocate_node();
+	tree.nodes[e.leaf].aabb = Tree::fatten(e.aabb);
+	tree.nodes[e.leaf].id = p_id;
+	tree.insert_leaf(e.leaf);
+}
+
+template <class T>
+void BVH<T>::_remove(BVHElementID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	Tree &tree = trees[_get_tree(e)];
+
+	tree.remove_leaf(e.leaf);
+	tree.free_node(e.leaf);
+	e.leaf = -1;
+}
+
+template <class T>
+void BVH<T>::_pair(BVHElementID p_A, BVHElementID p_B) {
+
+	Element *elems = elements.ptrw();
+	Element &A = elems[p_A - 1];
+	Element &B = elems[p_B - 1];
+
+	Pair *pair = memnew(Pair);
+	pair->A = p_A;
+	pair->B = p_B;
+	pair->index_A = A.pairs.size();
+	pair->index_B = B.pairs.size();
+	pair->ud = NULL;
+
+	A.pairs.push_back(pair);
+	B.pairs.push_back(pair);
+
+	if (pair_callback) {
+		pair->ud = pair_callback(pair_callback_userdata, p_A, A.userdata, A.subindex, p_B, B.userdata, B.subindex);
+	}
+	pair_count++;
+}
+
+template <class T>
+void BVH<T>::_unpair(Pair *p_pair) {
+
+	Element *elems = elements.ptrw();
+	Element &A = elems[p_pair->A - 1];
+	Element &B = elems[p_pair->B - 1];
+
+	if (unpair_callback) {
+		unpair_callback(unpair_callback_userdata, p_pair->A, A.userdata, A.subindex, p_pair->B, B.userdata, B.subindex, p_pair->ud);
+	}
+	pair_count--;
+
+	// remove from both lists, moving the last pair into the hole
+	for (int i = 0; i < 2; i++) {
+
+		BVHElementID id = i == 0 ? p_pair->A : p_pair->B;
+		int index = i == 0 ? p_pair->index_A : p_pair->index_B;
+		Vector<Pair *> &pairs = elems[id - 1].pairs;
+
+		int last = pairs.size() - 1;
+		if (index != last) {
+			Pair *moved = pairs[last];
+			pairs.write[index] = moved;
+			if (moved->A == id) {
+				moved->index_A = index;
+			} else {
+				moved->index_B = index;
+			}
+		}
+		pairs.resize(last);
+	}
+
+	memdelete(p_pair);
+}
+
+template <class T>
+void BVH<T>::_unpair_all(BVHElementID p_id) {
+
+	const Vector<Pair *> &pairs = elements[p_id - 1].pairs;
+	while (pairs.size()) {
+		_unpair(pairs[pairs.size() - 1]);
+	}
+}
+
+template <class T>
+void BVH<T>::_gather_candidates(int p_tree, const AABB &p_aabb) {
+
+	const Tree &tree = trees[p_tree];
+	if (tree.root == -1)
+		return;
+
+	int stack[CULL_STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = tree.root;
+
+	while (stack_size) {
+
+		const Node &node = tree.nodes[stack[--stack_size]];
+		if (!node.aabb.intersects_inclusive(p_aabb))
+			continue;
+
+		if (node.is_leaf()) {
+			candidates.push_back(node.id);
+		} else {
+			ERR_CONTINUE(stack_size + 2 > CULL_STACK_SIZE);
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+}
+
+template <class T>
+void BVH<T>::_check_pairs(BVHElementID p_id) {
+
+	pass++;
+
+	{
+		Element *elems = elements.ptrw();
+		Element &e = elems[p_id - 1];
+
+		// drop pairs that stopped intersecting, mark the others so they are not paired again
+		for (int i = e.pairs.size() - 1; i >= 0; i--) {
+
+			Pair *pair = e.pairs[i];
+			Element &other = elems[(pair->A == p_id ? pair->B : pair->A) - 1];
+
+			if (e.aabb.intersects_inclusive(other.aabb)) {
+				other.pass = pass;
+			} else {
+				_unpair(pair);
+			}
+		}
+	}
+
+	const Element &e = elements[p_id - 1];
+
+	candidates.resize(0);
+	// everything can pair with pairable elements, but only these can pair with the rest
+	_gather_candidates(TREE_PAIRABLE, e.aabb);
+	if (e.pairable) {
+		_gather_candidates(TREE_REGULAR, e.aabb);
+	}
+
+	for (int i = 0; i < candidates.size(); i++) {
+
+		BVHElementID id = candidates[i];
+		if (id == p_id)
+			continue;
+
+		Element &other = elements.write[id - 1];
+		if (other.pass == pass)
+			continue;
+
+		if (!_can_pair(e, other) || !e.aabb.intersects_inclusive(other.aabb))
+			continue;
+
+		other.pass = pass;
+		_pair(p_id, id);
+	}
+}
+
+template <class T>
+template <class Tester>
+void BVH<T>::_cull(int p_tree, const Tester &p_tester, T **p_result_array, int &r_result_count, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	const Tree &tree = trees[p_tree];
+	if (tree.root == -1)
+		return;
+
+	const Element *elems = elements.ptr();
+
+	int stack[CULL_STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = tree.root;
+
+	while (stack_size && r_result_count < p_result_max) {
+
+		const Node &node = tree.nodes[stack[--stack_size]];
+		if (!p_tester.test(node.aabb))
+			continue;
+
+		if (node.is_leaf()) {
+
+			const Element &e = elems[node.id - 1];
+			if (!(e.pairable_type & p_mask) || !p_tester.test(e.aabb))
+				continue;
+
+			p_result_array[r_result_count] = e.userdata;
+			if (p_subindex_array)
+				p_subindex_array[r_result_count] = e.subindex;
+			r_result_count++;
+		} else {
+			ERR_CONTINUE(stack_size + 2 > CULL_STACK_SIZE);
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+}
+
+template <class T>
+void BVH<T>::_cull_convex(int p_tree, const Plane *p_planes, int p_plane_count, T **p_result_array, int &r_result_count, int p_result_max, uint32_t p_mask) const {
+
+	const Tree &tree = trees[p_tree];
+	if (tree.root == -1)
+		return;
+
+	const Element *elems = elements.ptr();
+
+	struct Entry {
+		int node;
+		uint32_t plane_mask; // planes the node may still cross, zero once it is fully inside
+	};
+
+	// planes past the first 32 have no bit, they are checked on every node
+	bool all_in_mask = p_plane_count <= 32;
+
+	Entry stack[CULL_STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size].node = tree.root;
+	stack[stack_size].plane_mask = all_in_mask ? (uint32_t)((1ULL << p_plane_count) - 1) : 0xFFFFFFFF;
+	stack_size++;
+
+	while (stack_size && r_result_count < p_result_max) {
+
+		Entry entry = stack[--stack_size];
+		const Node &node = tree.nodes[entry.node];
+
+		if (entry.plane_mask || !all_in_mask) {
+			if (_classify_convex(node.aabb, p_planes, p_plane_count, entry.plane_mask) < 0)
+				continue;
+		}
+
+		if (node.is_leaf()) {
+
+			const Element &e = elems[node.id - 1];
+			if (!(e.pairable_type & p_mask))
+				continue;
+
+			// the leaf holds the fat AABB, so unless it is fully inside check the real one
+			if ((entry.plane_mask || !all_in_mask) && !e.aabb.intersects_convex_shape(p_planes, p_plane_count))
+				continue;
+
+			p_result_array[r_result_count++] = e.userdata;
+		} else {
+			ERR_CONTINUE(stack_size + 2 > CULL_STACK_SIZE);
+			for (int i = 0; i < 2; i++) {
+				stack[stack_size].node = node.children[i];
+				stack[stack_size].plane_mask = entry.plane_mask;
+				stack_size++;
+			}
+		}
+	}
+}
+
+/* PUBLIC FUNCTIONS */
+
+template <class T>
+BVHElementID BVH<T>::create(T *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	BVHElementID id;
+	if (free_ids.size()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.resize(free_ids.size() - 1);
+	} else {
+		elements.push_back(Element());
+		id = elements.size();
+	}
+
+	Element &e = elements.write[id - 1];
+	e.userdata = p_userdata;
+	e.subindex = p_subindex;
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+	e.aabb = p_aabb;
+	e.pass = 0;
+
+	_insert(id);
+	_check_pairs(id);
+
+	return id;
+}
+
+template <class T>
+void BVH<T>::move(BVHElementID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (BVHElementID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(e.leaf == -1);
+
+	e.aabb = p_aabb;
+
+	Tree &tree = trees[_get_tree(e)];
+	const AABB &fat = tree.nodes[e.leaf].aabb;
+
+	// reinsert when leaving the fat AABB, or when it's far too large after shrinking
+	if (!fat.encloses(p_aabb) || Tree::aabb_cost(fat) > 4.0 * Tree::aabb_cost(Tree::fatten(p_aabb))) {
+		_remove(p_id);
+		_insert(p_id);
+	}
+
+	_check_pairs(p_id);
+}
+
+template <class T>
+void BVH<T>::set_pairable(BVHElementID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (BVHElementID)elements.size());
+	ERR_FAIL_COND(elements[p_id - 1].leaf == -1);
+
+	const Element &e = elements[p_id - 1];
+	if (p_pairable == e.pairable && e.pairable_type == p_pairable_type && e.pairable_mask == p_pairable_mask)
+		return; // no changes, return
+
+	_unpair_all(p_id);
+
+	bool change_tree = p_pairable != e.pairable;
+	if (change_tree) {
+		_remove(p_id);
+	}
+
+	Element &w = elements.write[p_id - 1];
+	w.pairable = p_pairable;
+	w.pairable_type = p_pairable_type;
+	w.pairable_mask = p_pairable_mask;
+
+	if (change_tree) {
+		_insert(p_id);
+	}
+
+	_check_pairs(p_id);
+}
+
+template <class T>
+void BVH<T>::erase(BVHElementID p_id) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (BVHElementID)elements.size());
+	ERR_FAIL_COND(elements[p_id - 1].leaf == -1);
+
+	_unpair_all(p_id);
+	_remove(p_id);
+
+	elements.write[p_id - 1] = Element();
+	free_ids.push_back(p_id);
+}
+
+template <class T>
+bool BVH<T>::is_pairable(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (BVHElementID)elements.size(), false);
+	return elements[p_id - 1].pairable;
+}
+
+template <class T>
+T *BVH<T>::get(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (BVHElementID)elements.size(), NULL);
+	return elements[p_id - 1].userdata;
+}
+
+template <class T>
+int BVH<T>::get_subindex(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (BVHElementID)elements.size(), -1);
+	return elements[p_id - 1].subindex;
+}
+
+template <class T>
+int BVH<T>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) const {
+
+	if (p_convex.empty())
+		return 0;
+
+	int result_count = 0;
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull_convex(i, p_convex.ptr(), p_convex.size(), p_result_array, result_count, p_result_max, p_mask);
+	}
+	return result_count;
+}
+
+template <class T>
+int BVH<T>::cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	AABBTester tester;
+	tester.aabb = p_aabb;
+
+	int result_count = 0;
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull(i, tester, p_result_array, result_count, p_result_max, p_subindex_array, p_mask);
+	}
+	return result_count;
+}
+
+template <class T>
+int BVH<T>::cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	SegmentTester tester;
+	tester.from = p_from;
+	tester.to = p_to;
+
+	int result_count = 0;
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull(i, tester, p_result_array, result_count, p_result_max, p_subindex_array, p_mask);
+	}
+	return result_count;
+}
+
+template <class T>
+int BVH<T>::cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	PointTester tester;
+	tester.point = p_point;
+
+	int result_count = 0;
+	for (int i = 0; i < TREE_MAX; i++) {
+		_cull(i, tester, p_result_array, result_count, p_result_max, p_subindex_array, p_mask);
+	}
+	return result_count;
+}
+
+template <class T>
+void BVH<T>::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	pair_callback = p_callback;
+	pair_callback_userdata = p_userdata;
+}
+
+template <class T>
+void BVH<T>::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	unpair_callback = p_callback;
+	unpair_callback_userdata = p_userdata;
+}
+
+template <class T>
+BVH<T>::BVH() {
+
+	pass = 1;
+	pair_count = 0;
+
+	pair_callback = NULL;
+	unpair_callback = NULL;
+	pair_callback_userdata = NULL;
+	unpair_callback_userdata = NULL;
+}
+
+template <class T>
+BVH<T>::~BVH() {
+
+	// pairs are shared, free each one from its first element only
+	for (int i = 0; i < elements.size(); i++) {
+		const Vector<Pair *> &pairs = elements[i].pairs;
+		for (int j = 0; j < pairs.size(); j++) {
+			if (pairs[j]->A == BVHElementID(i + 1)) {
+				memdelete(pairs[j]);
+			}
+		}
+	}
+}
+
+#endif // BVH_H
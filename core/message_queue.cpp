@@ -34,45 +34,141 @@
 #include "core/script_language.h"
 
 MessageQueue *MessageQueue::singleton = NULL;
+uint32_t MessageQueue::last_generation = 0;
 
 MessageQueue *MessageQueue::get_singleton() {
 
 	return singleton;
 }
 
-Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+// Remembers the buffer of each thread, and marks it for release when the thread exits.
+struct MessageQueueThreadData {
+
+	uint32_t generation;
+	MessageQueue::ThreadBuffer *buffer;
+
+	MessageQueueThreadData() {
+		generation = 0;
+		buffer = NULL;
+	}
+
+	~MessageQueueThreadData() {
+
+		MessageQueue *mq = MessageQueue::singleton;
+		if (buffer && mq && mq->generation == generation) {
+			buffer->lock.lock();
+			buffer->orphan = true;
+			buffer->lock.unlock();
+		}
+	}
+};
+
+static thread_local MessageQueueThreadData message_queue_thread_data;
+
+MessageQueue::ThreadBuffer *MessageQueue::_get_thread_buffer() {
+
+	MessageQueueThreadData &data = message_queue_thread_data;
+	if (likely(data.buffer && data.generation == generation)) {
+		return data.buffer;
+	}
+
+	ThreadBuffer *tb = memnew(ThreadBuffer);
+	tb->pushing.data = NULL;
+	tb->pushing.end = 0;
+	tb->pushing.size = 0;
+	tb->flushing = tb->pushing;
+	tb->orphan = false;
+
+	buffers_lock->lock();
+	buffers.push_back(tb);
+	buffers_lock->unlock();
+
+	data.generation = generation;
+	data.buffer = tb;
+	return tb;
+}
+
+uint8_t *MessageQueue::_lock_room(uint32_t p_room, ThreadBuffer *&r_buffer) {
+
+	r_buffer = _get_thread_buffer();
+	r_buffer->lock.lock();
+
+	Buffer &b = r_buffer->pushing;
 
-	_THREAD_SAFE_METHOD_
+	if (b.end + p_room > b.size) {
 
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+		uint32_t size = b.size ? b.size : THREAD_QUEUE_SIZE_KB * 1024;
+		while (b.end + p_room > size) {
+			size *= 2;
+		}
+
+		// messages only point to data stored elsewhere, so they can be moved
+		uint8_t *data = (uint8_t *)memrealloc(b.data, size);
+		if (!data) {
+			r_buffer->lock.unlock();
+			ERR_EXPLAIN("Message queue out of memory.");
+			ERR_FAIL_V(NULL);
+		}
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id))
-			type = ObjectDB::get_instance(p_id)->get_class();
-		print_line("Failed method: " + type + ":" + p_method + " target ID: " + itos(p_id));
-		statistics();
-		ERR_EXPLAIN("Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
-		ERR_FAIL_V(ERR_OUT_OF_MEMORY);
+		b.data = data;
+		b.size = size;
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	uint8_t *room = &b.data[b.end];
+	b.end += p_room;
+	return room;
+}
+
+uint32_t MessageQueue::_get_message_size(const Message *p_message) {
+
+	uint32_t size = sizeof(Message);
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION)
+		size += sizeof(Variant) * p_message->args;
+	return size;
+}
+
+void MessageQueue::_clear_buffer(Buffer &p_buffer) {
+
+	uint32_t read_pos = 0;
+
+	while (read_pos < p_buffer.end) {
+
+		Message *message = (Message *)&p_buffer.data[read_pos];
+		read_pos += _get_message_size(message);
+
+		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+			Variant *args = (Variant *)(message + 1);
+			for (int i = 0; i < message->args; i++)
+				args[i].~Variant();
+		}
+		message->~Message();
+	}
+
+	p_buffer.end = 0;
+}
+
+Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+
+	ThreadBuffer *tb;
+	uint8_t *room = _lock_room(sizeof(Message) + sizeof(Variant) * p_argcount, tb);
+	ERR_FAIL_COND_V(!room, ERR_OUT_OF_MEMORY);
+
+	Message *msg = memnew_placement(room, Message);
 	msg->args = p_argcount;
 	msg->instance_ID = p_id;
 	msg->target = p_method;
 	msg->type = TYPE_CALL;
 	if (p_show_error)
 		msg->type |= FLAG_SHOW_ERROR;
+	msg->order = atomic_increment(&order);
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
-
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
-		*v = *p_args[i];
+		memnew_placement(&args[i], Variant(*p_args[i]));
 	}
 
+	tb->lock.unlock();
+
 	return OK;
 }
 
@@ -93,61 +189,41 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
 
-	_THREAD_SAFE_METHOD_
-
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id))
-			type = ObjectDB::get_instance(p_id)->get_class();
-		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
-		ERR_EXPLAIN("Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
-		ERR_FAIL_V(ERR_OUT_OF_MEMORY);
-	}
+	ThreadBuffer *tb;
+	uint8_t *room = _lock_room(sizeof(Message) + sizeof(Variant), tb);
+	ERR_FAIL_COND_V(!room, ERR_OUT_OF_MEMORY);
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(room, Message);
 	msg->args = 1;
 	msg->instance_ID = p_id;
 	msg->target = p_prop;
 	msg->type = TYPE_SET;
+	msg->order = atomic_increment(&order);
 
-	buffer_end += sizeof(Message);
+	memnew_placement(msg + 1, Variant(p_value));
 
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
-	*v = p_value;
+	tb->lock.unlock();
 
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
 
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id))
-			type = ObjectDB::get_instance(p_id)->get_class();
-		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
-		ERR_EXPLAIN("Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
-		ERR_FAIL_V(ERR_OUT_OF_MEMORY);
-	}
+	ThreadBuffer *tb;
+	uint8_t *room = _lock_room(sizeof(Message), tb);
+	ERR_FAIL_COND_V(!room, ERR_OUT_OF_MEMORY);
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(room, Message);
 
 	msg->type = TYPE_NOTIFICATION;
 	msg->instance_ID = p_id;
 	//msg->target;
 	msg->notification = p_notification;
+	msg->order = atomic_increment(&order);
 
-	buffer_end += sizeof(Message);
+	tb->lock.unlock();
 
 	return OK;
 }
@@ -172,56 +248,69 @@ void MessageQueue::statistics() {
 	Map<int, int> notify_count;
 	Map<StringName, int> call_count;
 	int null_count = 0;
+	uint32_t total = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	buffers_lock->lock();
 
-		Object *target = ObjectDB::get_instance(message->instance_ID);
+	for (int i = 0; i < buffers.size(); i++) {
 
-		if (target != NULL) {
+		ThreadBuffer *tb = buffers[i];
+		tb->lock.lock();
 
-			switch (message->type & FLAG_MASK) {
+		uint32_t read_pos = 0;
+		while (read_pos < tb->pushing.end) {
+			Message *message = (Message *)&tb->pushing.data[read_pos];
 
-				case TYPE_CALL: {
+			Object *target = ObjectDB::get_instance(message->instance_ID);
 
-					if (!call_count.has(message->target))
-						call_count[message->target] = 0;
+			if (target != NULL) {
 
-					call_count[message->target]++;
+				switch (message->type & FLAG_MASK) {
 
-				} break;
-				case TYPE_NOTIFICATION: {
+					case TYPE_CALL: {
 
-					if (!notify_count.has(message->notification))
-						notify_count[message->notification] = 0;
+						if (!call_count.has(message->target))
+							call_count[message->target] = 0;
 
-					notify_count[message->notification]++;
+						call_count[message->target]++;
 
-				} break;
-				case TYPE_SET: {
+					} break;
+					case TYPE_NOTIFICATION: {
 
-					if (!set_count.has(message->target))
-						set_count[message->target] = 0;
+						if (!notify_count.has(message->notification))
+							notify_count[message->notification] = 0;
 
-					set_count[message->target]++;
+						notify_count[message->notification]++;
 
-				} break;
-			}
+					} break;
+					case TYPE_SET: {
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+						if (!set_count.has(message->target))
+							set_count[message->target] = 0;
 
-			null_count++;
+						set_count[message->target]++;
+
+					} break;
+				}
+
+			} else {
+				//object was deleted
+				print_line("Object was deleted while awaiting a callback");
+
+				null_count++;
+			}
+
+			read_pos += _get_message_size(message);
 		}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+		total += tb->pushing.end;
+		tb->lock.unlock();
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	print_line("THREAD BUFFERS: " + itos(buffers.size()));
+	buffers_lock->unlock();
+
+	print_line("TOTAL BYTES: " + itos(total));
 	print_line("NULL count: " + itos(null_count));
 
 	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
@@ -260,31 +349,38 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 	}
 }
 
-void MessageQueue::flush() {
+void MessageQueue::_flush_buffers(const Vector<ThreadBuffer *> &p_buffers) {
 
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
+	int count = p_buffers.size();
+	uint32_t *read_pos = (uint32_t *)alloca(sizeof(uint32_t) * count);
+	for (int i = 0; i < count; i++) {
+		read_pos[i] = 0;
 	}
 
-	uint32_t read_pos = 0;
+	while (true) {
 
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
+		// take the oldest message of all threads
+		int from = -1;
+		uint32_t from_order = 0;
 
-	while (read_pos < buffer_end) {
+		for (int i = 0; i < count; i++) {
 
-		//lock on each iteration, so a call can re-add itself to the message queue
-
-		Message *message = (Message *)&buffer[read_pos];
-
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			advance += sizeof(Variant) * message->args;
+			const Buffer &b = p_buffers[i]->flushing;
+			if (read_pos[i] < b.end) {
+				uint32_t message_order = ((Message *)&b.data[read_pos[i]])->order;
+				if (from < 0 || int32_t(message_order - from_order) < 0) {
+					from = i;
+					from_order = message_order;
+				}
+			}
+		}
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+		if (from < 0) {
+			break;
+		}
 
-		_THREAD_SAFE_UNLOCK_
+		Message *message = (Message *)&p_buffers[from]->flushing.data[read_pos[from]];
+		read_pos[from] += _get_message_size(message);
 
 		Object *target = ObjectDB::get_instance(message->instance_ID);
 
@@ -299,10 +395,6 @@ void MessageQueue::flush() {
 
 					_call_function(target, message->target, args, message->args, message->type & FLAG_SHOW_ERROR);
 
-					for (int i = 0; i < message->args; i++) {
-						args[i].~Variant();
-					}
-
 				} break;
 				case TYPE_NOTIFICATION: {
 
@@ -316,18 +408,87 @@ void MessageQueue::flush() {
 					// messages don't expect a return value
 					target->set(message->target, *arg);
 
-					arg->~Variant();
 				} break;
 			}
 		}
 
+		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+			Variant *args = (Variant *)(message + 1);
+			for (int i = 0; i < message->args; i++) {
+				args[i].~Variant();
+			}
+		}
+
 		message->~Message();
+	}
+
+	for (int i = 0; i < count; i++) {
+		p_buffers[i]->flushing.end = 0;
+	}
+}
+
+void MessageQueue::flush() {
+
+	buffers_lock->lock();
 
-		_THREAD_SAFE_LOCK_
+	if (flushing) {
+		// called from a message or another thread, the running flush will get to everything
+		buffers_lock->unlock();
+		return;
 	}
 
-	buffer_end = 0; // reset buffer
-	_THREAD_SAFE_UNLOCK_
+	flushing = true;
+
+	while (true) {
+
+		// Swapping all buffers while holding every lock cuts the pushes at a single point,
+		// so nothing pushed later can be flushed before something pushed earlier.
+		uint32_t total = 0;
+
+		for (int i = 0; i < buffers.size(); i++) {
+			buffers[i]->lock.lock();
+		}
+
+		for (int i = buffers.size() - 1; i >= 0; i--) {
+
+			ThreadBuffer *tb = buffers[i];
+			SWAP(tb->pushing, tb->flushing);
+			total += tb->flushing.end;
+
+			if (tb->orphan && tb->flushing.end == 0) {
+				// its thread is gone and it's empty, it won't be used again
+				tb->lock.unlock();
+				if (tb->flushing.data)
+					memfree(tb->flushing.data);
+				if (tb->pushing.data)
+					memfree(tb->pushing.data);
+				memdelete(tb);
+				buffers.remove(i);
+			} else {
+				tb->lock.unlock();
+			}
+		}
+
+		if (total == 0) {
+			break;
+		}
+
+		if (total > buffer_max_used) {
+			buffer_max_used = total;
+		}
+
+		Vector<ThreadBuffer *> flush_buffers = buffers;
+
+		buffers_lock->unlock();
+
+		// messages pushed meanwhile go to the other buffer of each thread, and are handled in the next round
+		_flush_buffers(flush_buffers);
+
+		buffers_lock->lock();
+	}
+
+	flushing = false;
+	buffers_lock->unlock();
 }
 
 MessageQueue::MessageQueue() {
@@ -335,34 +496,40 @@ MessageQueue::MessageQueue() {
 	ERR_FAIL_COND(singleton != NULL);
 	singleton = this;
 
-	buffer_end = 0;
+	buffers_lock = Mutex::create();
+	generation = ++last_generation;
+	order = 0;
 	buffer_max_used = 0;
-	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
+	flushing = false;
+
+	uint32_t initial_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "0,2048,1,or_greater"));
-	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+	initial_size = initial_size * 1024 / 2;
+
+	// the thread creating the queue is the one pushing most, give it the configured size upfront
+	ThreadBuffer *tb = _get_thread_buffer();
+	if (initial_size) {
+		tb->pushing.data = (uint8_t *)memalloc(initial_size);
+		tb->pushing.size = initial_size;
+		tb->flushing.data = (uint8_t *)memalloc(initial_size);
+		tb->flushing.size = initial_size;
+	}
 }
 
 MessageQueue::~MessageQueue() {
 
-	uint32_t read_pos = 0;
-
-	while (read_pos < buffer_end) {
-
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++)
-				args[i].~Variant();
-		}
-		message->~Message();
+	for (int i = 0; i < buffers.size(); i++) {
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+		ThreadBuffer *tb = buffers[i];
+		_clear_buffer(tb->pushing);
+		_clear_buffer(tb->flushing);
+		if (tb->pushing.data)
+			memfree(tb->pushing.data);
+		if (tb->flushing.data)
+			memfree(tb->flushing.data);
+		memdelete(tb);
 	}
 
 	singleton = NULL;
-	memdelete_arr(buffer);
+	memdelete(buffers_lock);
 }
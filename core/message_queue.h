@@ -32,15 +32,15 @@
 #define MESSAGE_QUEUE_H
 
 #include "core/object.h"
+#include "core/os/spin_lock.h"
 #include "core/os/thread_safe.h"
 
 class MessageQueue {
 
-	_THREAD_SAFE_CLASS_
-
 	enum {
 
-		DEFAULT_QUEUE_SIZE_KB = 1024
+		DEFAULT_QUEUE_SIZE_KB = 1024,
+		THREAD_QUEUE_SIZE_KB = 16
 	};
 
 	enum {
@@ -61,16 +61,44 @@ class MessageQueue {
 			int16_t notification;
 			int16_t args;
 		};
+		uint32_t order; // messages from all threads are flushed in this order
+	};
+
+	struct Buffer {
+
+		uint8_t *data;
+		uint32_t end;
+		uint32_t size;
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end;
+	// Every thread pushes into its own buffer, so threads never wait on each other.
+	// The lock is only shared with flush(), which swaps the buffer out.
+	struct ThreadBuffer {
+
+		SpinLock lock;
+		Buffer pushing;
+		Buffer flushing;
+		bool orphan; // the thread has exited, free once empty
+	};
+
+	Mutex *buffers_lock;
+	Vector<ThreadBuffer *> buffers;
+	uint32_t generation;
+	uint32_t order;
 	uint32_t buffer_max_used;
-	uint32_t buffer_size;
+	bool flushing;
 
+	ThreadBuffer *_get_thread_buffer();
+	uint8_t *_lock_room(uint32_t p_room, ThreadBuffer *&r_buffer);
+	static uint32_t _get_message_size(const Message *p_message);
+	static void _clear_buffer(Buffer &p_buffer);
+	void _flush_buffers(const Vector<ThreadBuffer *> &p_buffers);
 	void _call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
+	static uint32_t last_generation;
+
+	friend struct MessageQueueThreadData;
 
 public:
 	static MessageQueue *get_singleton();
@@ -44,6 +44,9 @@
  *
  * The entries are stored inplace, so huge keys or values might fill cache lines
  * a lot faster.
+ *
+ * A map created with a capacity of zero allocates nothing until the first insert,
+ * which makes it cheap to embed in objects that usually stay empty.
  */
 template <class TKey, class TValue,
 		class Hasher = HashMapHasherDefault,
@@ -61,8 +64,9 @@ private:
 
 	static const uint32_t EMPTY_HASH = 0;
 	static const uint32_t DELETED_HASH_BIT = 1 << 31;
+	static const uint32_t MIN_CAPACITY = 4;
 
-	_FORCE_INLINE_ uint32_t _hash(const TKey &p_key) {
+	_FORCE_INLINE_ static uint32_t _hash(const TKey &p_key) {
 		uint32_t hash = Hasher::hash(p_key);
 
 		if (hash == EMPTY_HASH) {
@@ -74,11 +78,16 @@ private:
 		return hash;
 	}
 
-	_FORCE_INLINE_ uint32_t _get_probe_length(uint32_t p_pos, uint32_t p_hash) {
+	_FORCE_INLINE_ uint32_t _get_probe_length(uint32_t p_pos, uint32_t p_hash) const {
 		p_hash = p_hash & ~DELETED_HASH_BIT; // we don't care if it was deleted or not
 
 		uint32_t original_pos = p_hash % capacity;
 
+		if (p_pos < original_pos) {
+			// the probe wrapped around the end of the table
+			return capacity - original_pos + p_pos;
+		}
+
 		return p_pos - original_pos;
 	}
 
@@ -90,7 +99,11 @@ private:
 		num_elements++;
 	}
 
-	bool _lookup_pos(const TKey &p_key, uint32_t &r_pos) {
+	bool _lookup_pos(const TKey &p_key, uint32_t &r_pos) const {
+		if (num_elements == 0) {
+			return false;
+		}
+
 		uint32_t hash = _hash(p_key);
 		uint32_t pos = hash % capacity;
 		uint32_t distance = 0;
@@ -151,6 +164,48 @@ private:
 			distance++;
 		}
 	}
+	// keys and values are only constructed while their slot is in use
+	void _allocate(uint32_t p_capacity) {
+
+		capacity = p_capacity;
+		num_elements = 0;
+
+		if (capacity == 0) {
+			keys = NULL;
+			values = NULL;
+			hashes = NULL;
+			return;
+		}
+
+		keys = (TKey *)memalloc(sizeof(TKey) * capacity);
+		values = (TValue *)memalloc(sizeof(TValue) * capacity);
+		hashes = (uint32_t *)memalloc(sizeof(uint32_t) * capacity);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			hashes[i] = EMPTY_HASH;
+		}
+	}
+
+	static void _destroy(TKey *p_keys, TValue *p_values, uint32_t *p_hashes, uint32_t p_capacity) {
+
+		if (!p_hashes) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < p_capacity; i++) {
+			if (p_hashes[i] == EMPTY_HASH || (p_hashes[i] & DELETED_HASH_BIT)) {
+				continue;
+			}
+
+			p_keys[i].~TKey();
+			p_values[i].~TValue();
+		}
+
+		memfree(p_keys);
+		memfree(p_values);
+		memfree(p_hashes);
+	}
+
 	void _resize_and_rehash() {
 
 		TKey *old_keys = keys;
@@ -159,16 +214,7 @@ private:
 
 		uint32_t old_capacity = capacity;
 
-		capacity = old_capacity * 2;
-		num_elements = 0;
-
-		keys = memnew_arr(TKey, capacity);
-		values = memnew_arr(TValue, capacity);
-		hashes = memnew_arr(uint32_t, capacity);
-
-		for (uint32_t i = 0; i < capacity; i++) {
-			hashes[i] = 0;
-		}
+		_allocate(old_capacity ? old_capacity * 2 : MIN_CAPACITY);
 
 		for (uint32_t i = 0; i < old_capacity; i++) {
 			if (old_hashes[i] == EMPTY_HASH) {
@@ -181,9 +227,7 @@ private:
 			_insert_with_hash(old_hashes[i], old_keys[i], old_values[i]);
 		}
 
-		memdelete_arr(old_keys);
-		memdelete_arr(old_values);
-		memdelete_arr(old_hashes);
+		_destroy(old_keys, old_values, old_hashes, old_capacity);
 	}
 
 public:
@@ -192,7 +236,7 @@ public:
 
 	void insert(const TKey &p_key, const TValue &p_value) {
 
-		if ((float)num_elements / (float)capacity > 0.9) {
+		if (capacity == 0 || (float)num_elements / (float)capacity > 0.9) {
 			_resize_and_rehash();
 		}
 
@@ -232,7 +276,22 @@ public:
 		return false;
 	}
 
-	_FORCE_INLINE_ bool has(const TKey &p_key) {
+	/**
+	 * returns a pointer to the value stored for the key, or NULL.
+	 *
+	 * the pointer is only valid until the next insert or remove.
+	 */
+	_FORCE_INLINE_ TValue *lookup_ptr(const TKey &p_key) {
+		uint32_t pos = 0;
+		return _lookup_pos(p_key, pos) ? &values[pos] : NULL;
+	}
+
+	_FORCE_INLINE_ const TValue *lookup_ptr(const TKey &p_key) const {
+		uint32_t pos = 0;
+		return _lookup_pos(p_key, pos) ? &values[pos] : NULL;
+	}
+
+	_FORCE_INLINE_ bool has(const TKey &p_key) const {
 		uint32_t _pos = 0;
 		return _lookup_pos(p_key, _pos);
 	}
@@ -251,6 +310,12 @@ public:
 		num_elements--;
 	}
 
+	void clear() {
+
+		_destroy(keys, values, hashes, capacity);
+		_allocate(0);
+	}
+
 	struct Iterator {
 		bool valid;
 
@@ -304,23 +369,12 @@ public:
 
 	OAHashMap(uint32_t p_initial_capacity = 64) {
 
-		capacity = p_initial_capacity;
-		num_elements = 0;
-
-		keys = memnew_arr(TKey, p_initial_capacity);
-		values = memnew_arr(TValue, p_initial_capacity);
-		hashes = memnew_arr(uint32_t, p_initial_capacity);
-
-		for (uint32_t i = 0; i < p_initial_capacity; i++) {
-			hashes[i] = 0;
-		}
+		_allocate(p_initial_capacity);
 	}
 
 	~OAHashMap() {
 
-		memdelete_arr(keys);
-		memdelete_arr(values);
-		memdelete_arr(hashes);
+		_destroy(keys, values, hashes, capacity);
 	}
 };
 
@@ -41,19 +41,6 @@
 
 #ifdef DEBUG_ENABLED
 
-struct _ObjectDebugLock {
-
-	Object *obj;
-
-	_ObjectDebugLock(Object *p_obj) {
-		obj = p_obj;
-		obj->_lock_index.ref();
-	}
-	~_ObjectDebugLock() {
-		obj->_lock_index.unref();
-	}
-};
-
 #define OBJ_DEBUG_LOCK _ObjectDebugLock _debug_lock(this);
 
 #else
@@ -1115,14 +1102,15 @@ void Object::add_user_signal(const MethodInfo &p_signal) {
 	ERR_FAIL_COND(signal_map.has(p_signal.name));
 	Signal s;
 	s.user = p_signal;
-	signal_map[p_signal.name] = s;
+	signal_map.insert(p_signal.name, s);
 }
 
 bool Object::_has_user_signal(const StringName &p_name) const {
 
-	if (!signal_map.has(p_name))
+	const Signal *s = signal_map.lookup_ptr(p_name);
+	if (!s)
 		return false;
-	return signal_map[p_name].user.name.length() > 0;
+	return s->user.name.length() > 0;
 }
 
 struct _ObjectSignalDisconnectData {
@@ -1165,7 +1153,7 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 	if (_block_signals)
 		return ERR_CANT_ACQUIRE_RESOURCE; //no emit, signals blocked
 
-	Signal *s = signal_map.getptr(p_name);
+	Signal *s = signal_map.lookup_ptr(p_name);
 	if (!s) {
 #ifdef DEBUG_ENABLED
 		bool signal_is_valid = ClassDB::has_signal(get_class_name(), p_name);
@@ -1190,13 +1178,21 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 	OBJ_DEBUG_LOCK
 
-	Vector<const Variant *> bind_mem;
+	// connections made while emitting are not in the copy, so this is enough for all of them
+	const Variant **bind_mem = NULL;
+	if (s->max_binds) {
+		bind_mem = (const Variant **)alloca(sizeof(Variant *) * (p_argcount + s->max_binds));
+		for (int j = 0; j < p_argcount; j++) {
+			bind_mem[j] = p_args[j];
+		}
+	}
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slot_map.getv(i);
+		const Connection &c = slot.conn;
 
 		Object *target;
 #ifdef DEBUG_ENABLED
@@ -1211,24 +1207,27 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
-
-			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
-			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+				bind_mem[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_mem;
+			argc = p_argcount + c.binds.size();
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
 			MessageQueue::get_singleton()->push_call(target->get_instance_id(), c.method, args, argc, true);
 		} else {
 			Variant::CallError ce;
-			target->call(c.method, args, argc, ce);
+			if (slot.method && !target->script_instance) {
+				// nothing can override the native method, skip the lookups done by call()
+#ifdef DEBUG_ENABLED
+				_ObjectDebugLock target_lock(target);
+#endif
+				slot.method->call(target, args, argc, ce);
+			} else {
+				target->call(c.method, args, argc, ce);
+			}
 
 			if (ce.error != Variant::CallError::CALL_OK) {
 #ifdef DEBUG_ENABLED
@@ -1374,24 +1373,20 @@ void Object::get_signal_list(List<MethodInfo> *p_signals) const {
 
 	ClassDB::get_signal_list(get_class_name(), p_signals);
 	//find maybe usersignals?
-	const StringName *S = NULL;
+	for (OAHashMap<StringName, Signal>::Iterator it = signal_map.iter(); it.valid; it = signal_map.next_iter(it)) {
 
-	while ((S = signal_map.next(S))) {
-
-		if (signal_map[*S].user.name != "") {
+		if (it.value->user.name != "") {
 			//user signal
-			p_signals->push_back(signal_map[*S].user);
+			p_signals->push_back(it.value->user);
 		}
 	}
 }
 
 void Object::get_all_signal_connections(List<Connection> *p_connections) const {
 
-	const StringName *S = NULL;
-
-	while ((S = signal_map.next(S))) {
+	for (OAHashMap<StringName, Signal>::Iterator it = signal_map.iter(); it.valid; it = signal_map.next_iter(it)) {
 
-		const Signal *s = &signal_map[*S];
+		const Signal *s = it.value;
 
 		for (int i = 0; i < s->slot_map.size(); i++) {
 
@@ -1402,7 +1397,7 @@ void Object::get_all_signal_connections(List<Connection> *p_connections) const {
 
 void Object::get_signal_connection_list(const StringName &p_signal, List<Connection> *p_connections) const {
 
-	const Signal *s = signal_map.getptr(p_signal);
+	const Signal *s = signal_map.lookup_ptr(p_signal);
 	if (!s)
 		return; //nothing
 
@@ -1412,11 +1407,9 @@ void Object::get_signal_connection_list(const StringName &p_signal, List<Connect
 
 bool Object::has_persistent_signal_connections() const {
 
-	const StringName *S = NULL;
-
-	while ((S = signal_map.next(S))) {
+	for (OAHashMap<StringName, Signal>::Iterator it = signal_map.iter(); it.valid; it = signal_map.next_iter(it)) {
 
-		const Signal *s = &signal_map[*S];
+		const Signal *s = it.value;
 
 		for (int i = 0; i < s->slot_map.size(); i++) {
 
@@ -1439,7 +1432,7 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 
 	ERR_FAIL_NULL_V(p_to_object, ERR_INVALID_PARAMETER);
 
-	Signal *s = signal_map.getptr(p_signal);
+	Signal *s = signal_map.lookup_ptr(p_signal);
 	if (!s) {
 		bool signal_is_valid = ClassDB::has_signal(get_class_name(), p_signal);
 		//check in script
@@ -1462,8 +1455,8 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 			ERR_EXPLAIN("In Object of type '" + String(get_class()) + "': Attempt to connect nonexistent signal '" + p_signal + "' to method '" + p_to_object->get_class() + "." + p_to_method + "'");
 			ERR_FAIL_COND_V(!signal_is_valid, ERR_INVALID_PARAMETER);
 		}
-		signal_map[p_signal] = Signal();
-		s = &signal_map[p_signal];
+		signal_map.insert(p_signal, Signal());
+		s = signal_map.lookup_ptr(p_signal);
 	}
 
 	Signal::Target target(p_to_object->get_instance_id(), p_to_method);
@@ -1491,8 +1484,11 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 	if (p_flags & CONNECT_REFERENCE_COUNTED) {
 		slot.reference_count = 1;
 	}
+	// scripts override call() to reach their static functions first, so they are always called through it
+	slot.method = Object::cast_to<Script>(p_to_object) ? NULL : ClassDB::get_method(p_to_object->get_class_name(), p_to_method);
 
 	s->slot_map[target] = slot;
+	s->max_binds = MAX(s->max_binds, p_binds.size());
 
 	return OK;
 }
@@ -1500,7 +1496,7 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 bool Object::is_connected(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method) const {
 
 	ERR_FAIL_NULL_V(p_to_object, false);
-	const Signal *s = signal_map.getptr(p_signal);
+	const Signal *s = signal_map.lookup_ptr(p_signal);
 	if (!s) {
 		bool signal_is_valid = ClassDB::has_signal(get_class_name(), p_signal);
 		if (signal_is_valid)
@@ -1527,7 +1523,7 @@ void Object::disconnect(const StringName &p_signal, Object *p_to_object, const S
 void Object::_disconnect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method, bool p_force) {
 
 	ERR_FAIL_NULL(p_to_object);
-	Signal *s = signal_map.getptr(p_signal);
+	Signal *s = signal_map.lookup_ptr(p_signal);
 	if (!s) {
 		ERR_EXPLAIN("Nonexistent signal: " + p_signal);
 		ERR_FAIL_COND(!s);
@@ -1558,7 +1554,7 @@ void Object::_disconnect(const StringName &p_signal, Object *p_to_object, const
 
 	if (s->slot_map.empty() && ClassDB::has_signal(get_class_name(), p_signal)) {
 		//not user signal, delete
-		signal_map.erase(p_signal);
+		signal_map.remove(p_signal);
 	}
 }
 
@@ -1924,7 +1920,8 @@ void *Object::get_script_instance_binding(int p_script_language_index) {
 	return _script_instance_bindings[p_script_language_index];
 }
 
-Object::Object() {
+Object::Object() :
+		signal_map(0) {
 
 	_class_ptr = NULL;
 	_block_signals = false;
@@ -1953,11 +1950,9 @@ Object::~Object() {
 		memdelete(script_instance);
 	script_instance = NULL;
 
-	const StringName *S = NULL;
+	for (OAHashMap<StringName, Signal>::Iterator it = signal_map.iter(); it.valid; it = signal_map.next_iter(it)) {
 
-	while ((S = signal_map.next(NULL))) {
-
-		Signal *s = &signal_map[*S];
+		const Signal *s = it.value;
 
 		if (s->lock) {
 			ERR_EXPLAIN("Attempt to delete an object in the middle of a signal emission from it");
@@ -1972,10 +1967,10 @@ Object::~Object() {
 
 			slot_list[i].value.conn.target->connections.erase(slot_list[i].value.cE);
 		}
-
-		signal_map.erase(*S);
 	}
 
+	signal_map.clear();
+
 	//signals from nodes that connect to this node
 	while (connections.size()) {
 
@@ -2004,54 +1999,199 @@ void postinitialize_handler(Object *p_object) {
 	p_object->_postinitialize();
 }
 
-HashMap<ObjectID, Object *> ObjectDB::instances;
-ObjectID ObjectDB::instance_counter = 1;
-HashMap<Object *, ObjectID, ObjectDB::ObjectPtrHash> ObjectDB::instance_checks;
+ObjectDB::ObjectSlot *ObjectDB::slot_chunks[ObjectDB::SLOT_MAX_CHUNKS];
+uint32_t ObjectDB::slot_count = 0;
+uint32_t ObjectDB::free_slot = 0xFFFFFFFF;
+uint32_t ObjectDB::object_count = 0;
+Mutex *ObjectDB::slot_lock = NULL;
+ObjectDB::CheckShard ObjectDB::check_shards[ObjectDB::CHECK_SHARDS];
+
+// Slots freed by a thread are reused by it first, so the shared free list is only
+// locked once every few dozen objects created or freed. Slots still cached when a
+// thread ends go back to the shared list.
+struct ObjectDBSlotCache {
+
+	enum {
+		SIZE = 64
+	};
+
+	uint32_t slots[SIZE];
+	uint32_t count;
+
+	ObjectDBSlotCache() {
+		count = 0;
+	}
+
+	~ObjectDBSlotCache() {
+		// nothing to give back once the ObjectDB is gone
+		if (count && ObjectDB::slot_lock) {
+			ObjectDB::_free_slots(slots, count);
+		}
+	}
+};
+
+static thread_local ObjectDBSlotCache object_db_slot_cache;
+
+uint32_t ObjectDB::_alloc_slots(uint32_t *r_slots, uint32_t p_count) {
+
+	slot_lock->lock();
+
+	uint32_t count = 0;
+	while (count < p_count && free_slot != 0xFFFFFFFF) {
+
+		r_slots[count++] = free_slot;
+		free_slot = _get_slot(free_slot).next_free;
+	}
+
+	while (count < p_count && slot_count <= SLOT_MASK) {
+
+		uint32_t chunk = slot_count >> SLOT_CHUNK_BITS;
+		if (!slot_chunks[chunk]) {
+
+			ObjectSlot *slots = (ObjectSlot *)memalloc(sizeof(ObjectSlot) * SLOT_CHUNK_SIZE);
+			memset(slots, 0, sizeof(ObjectSlot) * SLOT_CHUNK_SIZE);
+			// lookups read the chunk table without locking
+			atomic_memory_barrier();
+			slot_chunks[chunk] = slots;
+		}
+		r_slots[count++] = slot_count++;
+	}
+
+	slot_lock->unlock();
+
+	return count;
+}
+
+void ObjectDB::_free_slots(const uint32_t *p_slots, uint32_t p_count) {
+
+	slot_lock->lock();
+
+	for (uint32_t i = 0; i < p_count; i++) {
+
+		_get_slot(p_slots[i]).next_free = free_slot;
+		free_slot = p_slots[i];
+	}
+
+	slot_lock->unlock();
+}
+
 ObjectID ObjectDB::add_instance(Object *p_object) {
 
 	ERR_FAIL_COND_V(p_object->get_instance_id() != 0, 0);
 
-	rw_lock->write_lock();
-	ObjectID instance_id = ++instance_counter;
-	instances[instance_id] = p_object;
-	instance_checks[p_object] = instance_id;
+	ObjectDBSlotCache &cache = object_db_slot_cache;
+	if (cache.count == 0) {
+
+		cache.count = _alloc_slots(cache.slots, ObjectDBSlotCache::SIZE / 2);
+		ERR_EXPLAIN("Too many objects");
+		ERR_FAIL_COND_V(cache.count == 0, 0);
+	}
+
+	uint32_t slot_idx = cache.slots[--cache.count];
+	ObjectSlot &slot = _get_slot(slot_idx);
+
+	uint64_t validator = slot.last_validator + 1;
+	if (validator >= (uint64_t(1) << (63 - SLOT_BITS))) {
+		validator = 1; // keep IDs positive as script integers
+	}
+
+	slot.object = p_object;
+	// the object must be visible before the slot resolves to it
+	atomic_memory_barrier();
+	slot.validator = validator;
 
-	rw_lock->write_unlock();
+	ObjectID instance_id = (validator << SLOT_BITS) | slot_idx;
+
+	CheckShard &shard = _get_check_shard(p_object);
+	shard.lock->lock();
+	shard.instances[p_object] = instance_id;
+	shard.lock->unlock();
+
+	atomic_increment(&object_count);
 
 	return instance_id;
 }
 
 void ObjectDB::remove_instance(Object *p_object) {
 
-	rw_lock->write_lock();
+	CheckShard &shard = _get_check_shard(p_object);
+	shard.lock->lock();
+	shard.instances.erase(p_object);
+	shard.lock->unlock();
+
+	ObjectID instance_id = p_object->get_instance_id();
+	if (instance_id == 0) {
+		return; // never got a slot
+	}
+
+	uint32_t slot_idx = instance_id & SLOT_MASK;
+	ObjectSlot &slot = _get_slot(slot_idx);
+	ERR_FAIL_COND(slot.object != p_object);
+
+	slot.last_validator = slot.validator;
+	slot.validator = 0;
+	atomic_memory_barrier();
+	slot.object = NULL;
 
-	instances.erase(p_object->get_instance_id());
-	instance_checks.erase(p_object);
+	atomic_decrement(&object_count);
 
-	rw_lock->write_unlock();
+	ObjectDBSlotCache &cache = object_db_slot_cache;
+	if (cache.count == ObjectDBSlotCache::SIZE) {
+
+		// give back the older half
+		_free_slots(cache.slots, ObjectDBSlotCache::SIZE / 2);
+		memmove(cache.slots, &cache.slots[ObjectDBSlotCache::SIZE / 2], sizeof(uint32_t) * (ObjectDBSlotCache::SIZE / 2));
+		cache.count = ObjectDBSlotCache::SIZE / 2;
+	}
+	cache.slots[cache.count++] = slot_idx;
 }
+
 Object *ObjectDB::get_instance(ObjectID p_instance_ID) {
 
-	rw_lock->read_lock();
-	Object **obj = instances.getptr(p_instance_ID);
-	rw_lock->read_unlock();
+	uint64_t validator = p_instance_ID >> SLOT_BITS;
+	uint32_t slot_idx = p_instance_ID & SLOT_MASK;
+
+	if (validator == 0) {
+		return NULL;
+	}
 
-	if (!obj)
+	ObjectSlot *chunk = slot_chunks[slot_idx >> SLOT_CHUNK_BITS];
+	if (!chunk) {
 		return NULL;
-	return *obj;
+	}
+
+	ObjectSlot &slot = chunk[slot_idx & SLOT_CHUNK_MASK];
+	Object *obj = slot.object;
+	// the object read must not be older than the validator check
+	atomic_memory_barrier();
+	if (slot.validator != validator) {
+		return NULL;
+	}
+
+	return obj;
+}
+
+bool ObjectDB::instance_validate(Object *p_ptr) {
+
+	CheckShard &shard = _get_check_shard(p_ptr);
+	shard.lock->lock();
+	bool valid = shard.instances.has(p_ptr);
+	shard.lock->unlock();
+
+	return valid;
 }
 
 void ObjectDB::debug_objects(DebugFunc p_func) {
 
-	rw_lock->read_lock();
+	uint32_t count = slot_count;
 
-	const ObjectID *K = NULL;
-	while ((K = instances.next(K))) {
+	for (uint32_t i = 0; i < count; i++) {
 
-		p_func(instances[*K]);
+		ObjectSlot *chunk = slot_chunks[i >> SLOT_CHUNK_BITS];
+		if (chunk && chunk[i & SLOT_CHUNK_MASK].validator) {
+			p_func(chunk[i & SLOT_CHUNK_MASK].object);
+		}
 	}
-
-	rw_lock->read_unlock();
 }
 
 void Object::get_argument_options(const StringName &p_function, int p_idx, List<String> *r_options) const {
@@ -2059,41 +2199,59 @@ void Object::get_argument_options(const StringName &p_function, int p_idx, List<
 
 int ObjectDB::get_object_count() {
 
-	rw_lock->read_lock();
-	int count = instances.size();
-	rw_lock->read_unlock();
-
-	return count;
+	return object_count;
 }
 
-RWLock *ObjectDB::rw_lock = NULL;
-
 void ObjectDB::setup() {
 
-	rw_lock = RWLock::create();
+	slot_lock = Mutex::create();
+	for (int i = 0; i < CHECK_SHARDS; i++) {
+		check_shards[i].lock = Mutex::create();
+	}
 }
 
 void ObjectDB::cleanup() {
 
-	rw_lock->write_lock();
-	if (instances.size()) {
+	slot_lock->lock();
+	if (object_count) {
 
 		WARN_PRINT("ObjectDB Instances still exist!");
 		if (OS::get_singleton()->is_stdout_verbose()) {
-			const ObjectID *K = NULL;
-			while ((K = instances.next(K))) {
+			for (uint32_t i = 0; i < slot_count; i++) {
+
+				ObjectSlot &slot = _get_slot(i);
+				if (!slot.validator) {
+					continue;
+				}
 
+				ObjectID id = (slot.validator << SLOT_BITS) | i;
 				String node_name;
-				if (instances[*K]->is_class("Node"))
-					node_name = " - Node name: " + String(instances[*K]->call("get_name"));
-				if (instances[*K]->is_class("Resource"))
-					node_name = " - Resource name: " + String(instances[*K]->call("get_name")) + " Path: " + String(instances[*K]->call("get_path"));
-				print_line("Leaked instance: " + String(instances[*K]->get_class()) + ":" + itos(*K) + node_name);
+				if (slot.object->is_class("Node"))
+					node_name = " - Node name: " + String(slot.object->call("get_name"));
+				if (slot.object->is_class("Resource"))
+					node_name = " - Resource name: " + String(slot.object->call("get_name")) + " Path: " + String(slot.object->call("get_path"));
+				print_line("Leaked instance: " + String(slot.object->get_class()) + ":" + itos(id) + node_name);
 			}
 		}
 	}
-	instances.clear();
-	instance_checks.clear();
-	rw_lock->write_unlock();
-	memdelete(rw_lock);
+
+	for (int i = 0; i < SLOT_MAX_CHUNKS; i++) {
+		if (slot_chunks[i]) {
+			memfree(slot_chunks[i]);
+			slot_chunks[i] = NULL;
+		}
+	}
+	slot_count = 0;
+	free_slot = 0xFFFFFFFF;
+	object_count = 0;
+	slot_lock->unlock();
+	memdelete(slot_lock);
+	slot_lock = NULL;
+	// the slots cached by this thread belonged to the old table
+	object_db_slot_cache.count = 0;
+
+	for (int i = 0; i < CHECK_SHARDS; i++) {
+		check_shards[i].instances.clear();
+		memdelete(check_shards[i].lock);
+	}
 }
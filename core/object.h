@@ -34,6 +34,8 @@
 #include "core/hash_map.h"
 #include "core/list.h"
 #include "core/map.h"
+#include "core/oa_hash_map.h"
+#include "core/os/mutex.h"
 #include "core/os/rw_lock.h"
 #include "core/set.h"
 #include "core/variant.h"
@@ -382,6 +384,7 @@ public:                                                        \
 private:
 
 class ScriptInstance;
+class MethodBind;
 typedef uint64_t ObjectID;
 
 class Object {
@@ -445,16 +448,24 @@ private:
 			int reference_count;
 			Connection conn;
 			List<Connection>::Element *cE;
-			Slot() { reference_count = 0; }
+			MethodBind *method; // native method of the target, called directly while no script is attached
+			Slot() {
+				reference_count = 0;
+				method = NULL;
+			}
 		};
 
 		MethodInfo user;
 		VMap<Target, Slot> slot_map;
+		int max_binds; // most binds of any connection, never shrinks
 		int lock;
-		Signal() { lock = 0; }
+		Signal() {
+			max_binds = 0;
+			lock = 0;
+		}
 	};
 
-	HashMap<StringName, Signal> signal_map;
+	OAHashMap<StringName, Signal> signal_map;
 	List<Connection> connections;
 #ifdef DEBUG_ENABLED
 	SafeRefCount _lock_index;
@@ -738,8 +749,48 @@ public:
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
+#ifdef DEBUG_ENABLED
+
+// Held while a method of the object runs, freeing it meanwhile is reported as an error.
+struct _ObjectDebugLock {
+
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+
+#endif
+
 class ObjectDB {
 
+	// An ObjectID is the index of the object's slot in its low bits and the validator
+	// of the slot above them. Validators grow every time a slot is reused, so a stale
+	// ID never resolves to a newer object, and resolving one is an array access.
+	enum {
+		SLOT_BITS = 24,
+		SLOT_MASK = (1 << SLOT_BITS) - 1,
+		SLOT_CHUNK_BITS = 12, // slots are allocated in chunks that never move
+		SLOT_CHUNK_SIZE = 1 << SLOT_CHUNK_BITS,
+		SLOT_CHUNK_MASK = SLOT_CHUNK_SIZE - 1,
+		SLOT_MAX_CHUNKS = 1 << (SLOT_BITS - SLOT_CHUNK_BITS),
+		CHECK_SHARD_BITS = 6, // pointer checks are split so creating objects on different threads rarely contends
+		CHECK_SHARDS = 1 << CHECK_SHARD_BITS,
+	};
+
+	struct ObjectSlot {
+
+		uint64_t validator; // 0 while free
+		uint64_t last_validator;
+		Object *object;
+		uint32_t next_free;
+	};
+
 	struct ObjectPtrHash {
 
 		static _FORCE_INLINE_ uint32_t hash(const Object *p_obj) {
@@ -753,17 +804,31 @@ class ObjectDB {
 		}
 	};
 
-	static HashMap<ObjectID, Object *> instances;
-	static HashMap<Object *, ObjectID, ObjectPtrHash> instance_checks;
+	struct CheckShard {
+
+		Mutex *lock;
+		HashMap<Object *, ObjectID, ObjectPtrHash> instances;
+	};
+
+	static ObjectSlot *slot_chunks[SLOT_MAX_CHUNKS];
+	static uint32_t slot_count;
+	static uint32_t free_slot; // head of the shared free list
+	static uint32_t object_count;
+	static Mutex *slot_lock; // guards the shared free list and slot allocation
+	static CheckShard check_shards[CHECK_SHARDS];
 
-	static ObjectID instance_counter;
 	friend class Object;
+	friend struct ObjectDBSlotCache;
 	friend void unregister_core_types();
 
-	static RWLock *rw_lock;
 	static void cleanup();
 	static ObjectID add_instance(Object *p_object);
 	static void remove_instance(Object *p_object);
+	static uint32_t _alloc_slots(uint32_t *r_slots, uint32_t p_count);
+	static void _free_slots(const uint32_t *p_slots, uint32_t p_count);
+	static _FORCE_INLINE_ ObjectSlot &_get_slot(uint32_t p_slot) { return slot_chunks[p_slot >> SLOT_CHUNK_BITS][p_slot & SLOT_CHUNK_MASK]; }
+	// the top bits of the hash pick the shard, the maps use the low ones
+	static _FORCE_INLINE_ CheckShard &_get_check_shard(const Object *p_obj) { return check_shards[ObjectPtrHash::hash(p_obj) >> (32 - CHECK_SHARD_BITS)]; }
 	friend void register_core_types();
 	static void setup();
 
@@ -774,10 +839,7 @@ public:
 	static void debug_objects(DebugFunc p_func);
 	static int get_object_count();
 
-	_FORCE_INLINE_ static bool instance_validate(Object *p_ptr) {
-
-		return instance_checks.has(p_ptr);
-	}
+	static bool instance_validate(Object *p_ptr);
 };
 
 //needed by macros
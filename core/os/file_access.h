@@ -110,6 +110,7 @@ public:
 	virtual real_t get_real() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const; ///< get an array of bytes
+	virtual const uint8_t *get_mapped_buffer() { return NULL; } ///< whole file contents as read-only memory if the backend can provide it (valid until the file is closed), NULL otherwise
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(const String &p_delim = ",") const;
@@ -32,6 +32,7 @@
 
 #include "core/error_macros.h"
 #include "core/os/copymem.h"
+#include "core/os/spin_lock.h"
 #include "core/safe_refcount.h"
 
 #include <stdio.h>
@@ -70,9 +71,303 @@ void operator delete(void *p_mem, void *p_pointer, size_t check, const char *p_d
 #ifdef DEBUG_ENABLED
 uint64_t Memory::mem_usage = 0;
 uint64_t Memory::max_usage = 0;
+uint64_t Memory::alloc_count = 0;
 #endif
 
-uint64_t Memory::alloc_count = 0;
+#ifdef SMALL_ALLOCATOR_ENABLED
+
+/*
+ * Small allocations are served from size classes. Each class carves 64 KiB spans into
+ * blocks of its size; freed blocks go to a per-thread list first and move to the shared
+ * list of the class in batches, so most allocations touch no shared state at all.
+ * Spans come from larger regions and are never given back to the system.
+ *
+ * A block carries no header: the class of any pointer is found from its span address
+ * through a two level table, which also tells blocks apart from malloc'ed memory.
+ */
+
+#define SMALL_ALLOC_MAX_SIZE 512
+#define SMALL_ALLOC_CLASSES 16
+#define SMALL_ALLOC_SPAN_BITS 16
+#define SMALL_ALLOC_SPAN_SIZE (1 << SMALL_ALLOC_SPAN_BITS)
+#define SMALL_ALLOC_REGION_SIZE (SMALL_ALLOC_SPAN_SIZE * 16)
+#define SMALL_ALLOC_BATCH_BYTES 4096
+
+static const uint32_t small_alloc_sizes[SMALL_ALLOC_CLASSES] = { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+// class for each size, in 16 byte steps
+static const uint8_t small_alloc_class_of_size[SMALL_ALLOC_MAX_SIZE / 16 + 1] = { 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15 };
+
+struct SmallAllocClass {
+
+	SpinLock lock;
+	void *free_list;
+#ifdef DEBUG_ENABLED
+	uint64_t used;
+	uint64_t allocs;
+	uint64_t spans;
+#endif
+};
+
+static SmallAllocClass small_alloc_classes[SMALL_ALLOC_CLASSES];
+
+static SpinLock small_alloc_span_lock;
+static uint8_t *small_alloc_region = NULL;
+static uint32_t small_alloc_region_spans = 0;
+static uint8_t *small_alloc_span_map[1 << 16]; // class + 1 of each span, indexed by the span address
+
+struct SmallAllocThreadCache {
+
+	struct Bin {
+
+		void *head;
+		uint32_t count;
+	};
+
+	Bin bins[SMALL_ALLOC_CLASSES];
+	bool active; // false once the thread is exiting, blocks then go straight to the shared lists
+
+	SmallAllocThreadCache();
+	~SmallAllocThreadCache();
+};
+
+static thread_local SmallAllocThreadCache small_alloc_cache;
+
+static _FORCE_INLINE_ uint32_t _small_alloc_batch(int p_class) {
+
+	uint32_t batch = SMALL_ALLOC_BATCH_BYTES / small_alloc_sizes[p_class];
+	return batch < 4 ? 4 : batch;
+}
+
+static void _small_alloc_give_back(int p_class, void *p_head, void *p_tail) {
+
+	SmallAllocClass &c = small_alloc_classes[p_class];
+
+	c.lock.lock();
+	*(void **)p_tail = c.free_list;
+	c.free_list = p_head;
+	c.lock.unlock();
+}
+
+static uint8_t *_small_alloc_new_span(int p_class) {
+
+	small_alloc_span_lock.lock();
+
+	if (small_alloc_region_spans == 0) {
+
+		uint8_t *mem = (uint8_t *)malloc(SMALL_ALLOC_REGION_SIZE + SMALL_ALLOC_SPAN_SIZE);
+		uint64_t aligned = ((uint64_t)(uintptr_t)mem + SMALL_ALLOC_SPAN_SIZE - 1) & ~(uint64_t)(SMALL_ALLOC_SPAN_SIZE - 1);
+
+		// the span table covers 48 bit addresses, anything beyond is left to malloc
+		if (!mem || ((aligned + SMALL_ALLOC_REGION_SIZE - 1) >> (SMALL_ALLOC_SPAN_BITS + 32))) {
+			free(mem);
+			small_alloc_span_lock.unlock();
+			return NULL;
+		}
+
+		small_alloc_region = (uint8_t *)(uintptr_t)aligned;
+		small_alloc_region_spans = SMALL_ALLOC_REGION_SIZE / SMALL_ALLOC_SPAN_SIZE;
+	}
+
+	uint64_t key = (uint64_t)(uintptr_t)small_alloc_region >> SMALL_ALLOC_SPAN_BITS;
+	uint8_t *&page = small_alloc_span_map[key >> 16];
+	if (!page) {
+
+		uint8_t *new_page = (uint8_t *)calloc(1 << 16, 1);
+		if (!new_page) {
+			small_alloc_span_lock.unlock();
+			return NULL;
+		}
+		// frees look the table up without locking
+		atomic_memory_barrier();
+		page = new_page;
+	}
+	page[key & 0xFFFF] = p_class + 1;
+
+	uint8_t *span = small_alloc_region;
+	small_alloc_region += SMALL_ALLOC_SPAN_SIZE;
+	small_alloc_region_spans--;
+
+	small_alloc_span_lock.unlock();
+
+#ifdef DEBUG_ENABLED
+	atomic_increment(&small_alloc_classes[p_class].spans);
+#endif
+	return span;
+}
+
+static void _small_alloc_refill(int p_class, SmallAllocThreadCache::Bin &r_bin, uint32_t p_count) {
+
+	SmallAllocClass &c = small_alloc_classes[p_class];
+
+	c.lock.lock();
+	while (r_bin.count < p_count && c.free_list) {
+
+		void *block = c.free_list;
+		c.free_list = *(void **)block;
+		*(void **)block = r_bin.head;
+		r_bin.head = block;
+		r_bin.count++;
+	}
+	c.lock.unlock();
+
+	if (r_bin.count) {
+		return;
+	}
+
+	uint8_t *span = _small_alloc_new_span(p_class);
+	if (!span) {
+		return;
+	}
+
+	// the first blocks refill the caller, the rest of the span goes to the shared list
+	uint32_t size = small_alloc_sizes[p_class];
+	uint32_t blocks = SMALL_ALLOC_SPAN_SIZE / size;
+	uint32_t taken = MIN(p_count, blocks);
+
+	for (uint32_t i = 0; i < blocks; i++) {
+		*(void **)(span + i * size) = (i + 1 < blocks && i + 1 != taken) ? span + (i + 1) * size : NULL;
+	}
+
+	r_bin.head = span;
+	r_bin.count = taken;
+	if (taken < blocks) {
+		_small_alloc_give_back(p_class, span + taken * size, span + (blocks - 1) * size);
+	}
+}
+
+SmallAllocThreadCache::SmallAllocThreadCache() {
+
+	for (int i = 0; i < SMALL_ALLOC_CLASSES; i++) {
+		bins[i].head = NULL;
+		bins[i].count = 0;
+	}
+	active = true;
+}
+
+SmallAllocThreadCache::~SmallAllocThreadCache() {
+
+	active = false;
+
+	for (int i = 0; i < SMALL_ALLOC_CLASSES; i++) {
+
+		if (!bins[i].head) {
+			continue;
+		}
+
+		void *tail = bins[i].head;
+		while (*(void **)tail) {
+			tail = *(void **)tail;
+		}
+		_small_alloc_give_back(i, bins[i].head, tail);
+		bins[i].head = NULL;
+		bins[i].count = 0;
+	}
+}
+
+int Memory::_get_small_class(const void *p_ptr) {
+
+	uint64_t key = (uint64_t)(uintptr_t)p_ptr >> SMALL_ALLOC_SPAN_BITS;
+	if (key >> 32) {
+		return -1;
+	}
+
+	const uint8_t *page = small_alloc_span_map[key >> 16];
+	return page ? int(page[key & 0xFFFF]) - 1 : -1;
+}
+
+void *Memory::_alloc_small(int p_class) {
+
+	SmallAllocThreadCache &cache = small_alloc_cache;
+	void *mem;
+
+	if (likely(cache.active)) {
+
+		SmallAllocThreadCache::Bin &bin = cache.bins[p_class];
+		if (!bin.head) {
+			_small_alloc_refill(p_class, bin, _small_alloc_batch(p_class));
+			if (!bin.head) {
+				return NULL;
+			}
+		}
+
+		mem = bin.head;
+		bin.head = *(void **)mem;
+		bin.count--;
+	} else {
+
+		SmallAllocThreadCache::Bin bin = { NULL, 0 };
+		_small_alloc_refill(p_class, bin, 1);
+		mem = bin.head;
+		if (!mem) {
+			return NULL;
+		}
+	}
+
+#ifdef DEBUG_ENABLED
+	atomic_increment(&small_alloc_classes[p_class].used);
+	atomic_increment(&small_alloc_classes[p_class].allocs);
+#endif
+	return mem;
+}
+
+void Memory::_free_small(void *p_ptr, int p_class) {
+
+#ifdef DEBUG_ENABLED
+	atomic_decrement(&small_alloc_classes[p_class].used);
+#endif
+
+	SmallAllocThreadCache &cache = small_alloc_cache;
+
+	if (unlikely(!cache.active)) {
+		_small_alloc_give_back(p_class, p_ptr, p_ptr);
+		return;
+	}
+
+	SmallAllocThreadCache::Bin &bin = cache.bins[p_class];
+	*(void **)p_ptr = bin.head;
+	bin.head = p_ptr;
+	bin.count++;
+
+	uint32_t batch = _small_alloc_batch(p_class);
+	if (bin.count > batch * 2) {
+
+		// keep one batch, hand the rest over to the other threads
+		void *tail = bin.head;
+		for (uint32_t i = 1; i < batch; i++) {
+			tail = *(void **)tail;
+		}
+		void *head = *(void **)tail;
+		*(void **)tail = NULL;
+		bin.count = batch;
+
+		void *last = head;
+		while (*(void **)last) {
+			last = *(void **)last;
+		}
+		_small_alloc_give_back(p_class, head, last);
+	}
+}
+
+#ifdef DEBUG_ENABLED
+int Memory::get_small_alloc_class_count() {
+
+	return SMALL_ALLOC_CLASSES;
+}
+
+Memory::SmallAllocStats Memory::get_small_alloc_stats(int p_class) {
+
+	SmallAllocStats stats;
+	ERR_FAIL_INDEX_V(p_class, SMALL_ALLOC_CLASSES, stats);
+
+	stats.size = small_alloc_sizes[p_class];
+	stats.used = small_alloc_classes[p_class].used;
+	stats.allocs = small_alloc_classes[p_class].allocs;
+	stats.spans = small_alloc_classes[p_class].spans;
+	return stats;
+}
+#endif
+
+#endif // SMALL_ALLOCATOR_ENABLED
 
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
@@ -82,11 +377,22 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
-	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+	size_t total = p_bytes + (prepad ? PAD_ALIGN : 0);
+
+#ifdef SMALL_ALLOCATOR_ENABLED
+	void *mem = total <= SMALL_ALLOC_MAX_SIZE ? _alloc_small(small_alloc_class_of_size[(total + 15) >> 4]) : NULL;
+	if (!mem) {
+		mem = malloc(total);
+	}
+#else
+	void *mem = malloc(total);
+#endif
 
 	ERR_FAIL_COND_V(!mem, NULL);
 
+#ifdef DEBUG_ENABLED
 	atomic_increment(&alloc_count);
+#endif
 
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
@@ -118,6 +424,52 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef SMALL_ALLOCATOR_ENABLED
+	int small_class = _get_small_class(prepad ? mem - PAD_ALIGN : mem);
+	if (small_class >= 0) {
+
+		if (p_bytes == 0) {
+			free_static(p_memory, p_pad_align);
+			return NULL;
+		}
+
+		size_t total = p_bytes + (prepad ? PAD_ALIGN : 0);
+		if (total <= SMALL_ALLOC_MAX_SIZE && small_alloc_class_of_size[(total + 15) >> 4] == small_class) {
+
+			// still the same class, the block can stay
+			if (prepad) {
+				uint64_t *s = (uint64_t *)(mem - PAD_ALIGN);
+#ifdef DEBUG_ENABLED
+				if (p_bytes > *s) {
+					atomic_add(&mem_usage, p_bytes - *s);
+					atomic_exchange_if_greater(&max_usage, mem_usage);
+				} else {
+					atomic_sub(&mem_usage, *s - p_bytes);
+				}
+#endif
+				*s = p_bytes;
+			}
+			return p_memory;
+		}
+
+		// blocks can't grow, move to a new one
+		uint8_t *new_mem = (uint8_t *)alloc_static(p_bytes, p_pad_align);
+		ERR_FAIL_COND_V(!new_mem, NULL);
+
+		if (prepad) {
+			// like realloc, keep what callers store in the pad after the size
+			size_t old_bytes = *(uint64_t *)(mem - PAD_ALIGN);
+			size_t skip = PAD_ALIGN - sizeof(uint64_t);
+			memcpy(new_mem - skip, mem - skip, skip + MIN(old_bytes, p_bytes));
+		} else {
+			memcpy(new_mem, mem, MIN((size_t)small_alloc_sizes[small_class], p_bytes));
+		}
+
+		free_static(p_memory, p_pad_align);
+		return new_mem;
+	}
+#endif
+
 	if (prepad) {
 		mem -= PAD_ALIGN;
 		uint64_t *s = (uint64_t *)mem;
@@ -168,7 +520,9 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef DEBUG_ENABLED
 	atomic_decrement(&alloc_count);
+#endif
 
 	if (prepad) {
 		mem -= PAD_ALIGN;
@@ -177,12 +531,17 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 		uint64_t *s = (uint64_t *)mem;
 		atomic_sub(&mem_usage, *s);
 #endif
+	}
 
-		free(mem);
-	} else {
-
-		free(mem);
+#ifdef SMALL_ALLOCATOR_ENABLED
+	int small_class = _get_small_class(mem);
+	if (small_class >= 0) {
+		_free_small(mem, small_class);
+		return;
 	}
+#endif
+
+	free(mem);
 }
 
 uint64_t Memory::get_mem_available() {
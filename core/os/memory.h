@@ -49,9 +49,14 @@ class Memory {
 #ifdef DEBUG_ENABLED
 	static uint64_t mem_usage;
 	static uint64_t max_usage;
+	static uint64_t alloc_count;
 #endif
 
-	static uint64_t alloc_count;
+#ifdef SMALL_ALLOCATOR_ENABLED
+	static void *_alloc_small(int p_class);
+	static void _free_small(void *p_ptr, int p_class);
+	static int _get_small_class(const void *p_ptr);
+#endif
 
 public:
 	static void *alloc_static(size_t p_bytes, bool p_pad_align = false);
@@ -61,6 +66,19 @@ public:
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+
+#if defined(SMALL_ALLOCATOR_ENABLED) && defined(DEBUG_ENABLED)
+	struct SmallAllocStats {
+
+		size_t size; // bytes per block
+		uint64_t used; // blocks currently handed out, including those cached by threads
+		uint64_t allocs; // blocks requested since startup
+		uint64_t spans; // spans carved for this size
+	};
+
+	static int get_small_alloc_class_count();
+	static SmallAllocStats get_small_alloc_stats(int p_class);
+#endif
 };
 
 class DefaultAllocator {
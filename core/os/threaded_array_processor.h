@@ -35,6 +35,7 @@
 #include "core/os/os.h"
 #include "core/os/thread.h"
 #include "core/os/thread_safe.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/safe_refcount.h"
 
 template <class C, class U>
@@ -64,6 +65,12 @@ void process_array_thread(void *ud) {
 	}
 }
 
+template <class T>
+void process_array_task(void *ud, uint32_t p_index) {
+
+	((T *)ud)->process(p_index);
+}
+
 template <class C, class M, class U>
 void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
 
@@ -73,6 +80,16 @@ void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_us
 	data.userdata = p_userdata;
 	data.index = 0;
 	data.elements = p_elements;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool) {
+		//persistent workers, the calling thread helps while waiting
+		WorkerThreadPool::TaskID task = pool->add_native_group_task(&process_array_task<ThreadArrayProcessData<C, U> >, &data, p_elements);
+		pool->wait_for_task_completion(task);
+		return;
+	}
+
+	//pool not available yet (early startup), spawn temporary threads
 	data.process(data.index); //process first, let threads increment for next
 
 	Vector<Thread *> threads;
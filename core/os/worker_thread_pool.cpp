@@ -0,0 +1,583 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/method_bind_ext.gen.inc"
+#include "core/os/os.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = NULL;
+
+void WorkerThreadPool::TaskDeque::push_back(Task *p_task) {
+
+	if (count == (uint32_t)buffer.size()) {
+		//full, grow and unroll the ring so head is at zero again
+		Vector<Task *> new_buffer;
+		new_buffer.resize(MAX(16, buffer.size() * 2));
+		for (uint32_t i = 0; i < count; i++) {
+			new_buffer.write[i] = buffer[(head + i) % buffer.size()];
+		}
+		buffer = new_buffer;
+		head = 0;
+	}
+
+	buffer.write[(head + count) % buffer.size()] = p_task;
+	count++;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop_back() {
+
+	if (count == 0)
+		return NULL;
+
+	count--;
+	return buffer[(head + count) % buffer.size()];
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop_front() {
+
+	if (count == 0)
+		return NULL;
+
+	Task *task = buffer[head];
+	head = (head + 1) % buffer.size();
+	count--;
+	return task;
+}
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+
+	ThreadData *thread_data = (ThreadData *)p_user;
+	WorkerThreadPool *pool = thread_data->pool;
+	thread_data->id = Thread::get_caller_id();
+
+	Thread::set_name("WorkerThreadPool " + itos(thread_data->index));
+
+	while (true) {
+
+		pool->work_semaphore->wait();
+		if (pool->exit_threads)
+			break;
+
+		Task *task = pool->_pop_task(thread_data->index);
+		while (task) {
+			pool->_process_task(task);
+			task = pool->_pop_task(thread_data->index);
+		}
+	}
+}
+
+int WorkerThreadPool::_get_thread_index() const {
+
+	Thread::ID caller = Thread::get_caller_id();
+	for (int i = 0; i < thread_count; i++) {
+		if (threads[i].id == caller)
+			return i;
+	}
+	return -1;
+}
+
+void WorkerThreadPool::_enqueue_task(Task *p_task) {
+
+	int thread_index = _get_thread_index();
+	uint32_t first_queue;
+	if (thread_index >= 0) {
+		//keep it local, other workers will steal it if idle
+		first_queue = thread_index;
+	} else {
+		first_queue = atomic_increment(&next_queue);
+	}
+
+	for (uint32_t i = 0; i < p_task->runners; i++) {
+		TaskDeque &queue = queues[(first_queue + i) % queue_count];
+		queue.mutex->lock();
+		queue.push_back(p_task);
+		queue.mutex->unlock();
+	}
+
+	if (thread_count) {
+		for (uint32_t i = 0; i < MIN(p_task->runners, (uint32_t)thread_count); i++) {
+			work_semaphore->post();
+		}
+	}
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_pop_task(int p_thread_index) {
+
+	Task *task = NULL;
+
+	if (p_thread_index >= 0) {
+		TaskDeque &own = queues[p_thread_index];
+		own.mutex->lock();
+		task = own.pop_back();
+		own.mutex->unlock();
+		if (task)
+			return task;
+	}
+
+	//steal from the others, oldest first
+	int from = p_thread_index >= 0 ? p_thread_index + 1 : 0;
+	for (int i = 0; i < queue_count; i++) {
+		int victim = (from + i) % queue_count;
+		if (victim == p_thread_index)
+			continue;
+
+		TaskDeque &queue = queues[victim];
+		queue.mutex->lock();
+		task = queue.pop_front();
+		queue.mutex->unlock();
+		if (task)
+			return task;
+	}
+
+	return NULL;
+}
+
+void WorkerThreadPool::_process_group_elements(Task *p_task) {
+
+	Object *instance = NULL;
+	if (!p_task->native_group_func) {
+		instance = ObjectDB::get_instance(p_task->instance_id);
+	}
+
+	while (true) {
+		uint32_t index = atomic_increment(&p_task->index) - 1;
+		if (index >= p_task->elements)
+			break;
+
+		if (p_task->native_group_func) {
+			p_task->native_group_func(p_task->native_userdata, index);
+		} else if (instance) {
+			Variant index_arg = index;
+			const Variant *args[2] = { &index_arg, &p_task->userdata };
+			Variant::CallError ce;
+			instance->call(p_task->method, args, 2, ce);
+			if (ce.error != Variant::CallError::CALL_OK) {
+				ERR_PRINTS("Error calling group task method: " + Variant::get_call_error_text(instance, p_task->method, args, 2, ce));
+				//don't spam one error per element
+				instance = NULL;
+			}
+		}
+
+		if (atomic_decrement(&p_task->unfinished) == 0) {
+			//only reachable by the waiter, a runner still counts itself
+			_task_completed(p_task);
+			break;
+		}
+	}
+}
+
+void WorkerThreadPool::_process_task(Task *p_task) {
+
+	//the task is complete only once every runner is done, so no queue entry outlives it
+	if (p_task->is_group) {
+		_process_group_elements(p_task);
+	} else if (p_task->native_func) {
+		p_task->native_func(p_task->native_userdata);
+	} else {
+		Object *instance = ObjectDB::get_instance(p_task->instance_id);
+		if (instance) {
+			const Variant *args[1] = { &p_task->userdata };
+			Variant::CallError ce;
+			instance->call(p_task->method, args, 1, ce);
+			if (ce.error != Variant::CallError::CALL_OK) {
+				ERR_PRINTS("Error calling task method: " + Variant::get_call_error_text(instance, p_task->method, args, 1, ce));
+			}
+		}
+	}
+
+	if (atomic_decrement(&p_task->unfinished) == 0) {
+		_task_completed(p_task);
+	}
+}
+
+void WorkerThreadPool::_task_completed(Task *p_task) {
+
+	Vector<Task *> ready;
+
+	task_mutex->lock();
+	p_task->completed = true;
+	for (int i = 0; i < p_task->dependents.size(); i++) {
+		Task *dependent = p_task->dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0) {
+			ready.push_back(dependent);
+		}
+	}
+	p_task->dependents.clear();
+	if (p_task->done_semaphore) {
+		p_task->done_semaphore->post();
+	}
+	task_mutex->unlock();
+
+	//p_task may be freed by the waiter from now on
+	for (int i = 0; i < ready.size(); i++) {
+		_enqueue_task(ready[i]);
+	}
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::_add_task(Task *p_task, const Vector<TaskID> &p_dependencies) {
+
+	p_task->unfinished = p_task->runners + (p_task->is_group ? p_task->elements : 0);
+
+	task_mutex->lock();
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		if (!tasks.has(p_dependencies[i])) {
+			task_mutex->unlock();
+			memdelete(p_task);
+			ERR_EXPLAIN("Invalid dependency task ID (already waited for?): " + itos(p_dependencies[i]));
+			ERR_FAIL_V(INVALID_TASK_ID);
+		}
+	}
+
+	last_task_id++;
+	TaskID id = last_task_id;
+	p_task->self = id;
+	tasks[id] = p_task;
+
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		Task *dependency = tasks[p_dependencies[i]];
+		if (!dependency->completed) {
+			dependency->dependents.push_back(p_task);
+			p_task->pending_dependencies++;
+		}
+	}
+	bool ready = p_task->pending_dependencies == 0;
+	task_mutex->unlock();
+
+	if (ready) {
+		_enqueue_task(p_task);
+	}
+
+	return id;
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(TaskFunc p_func, void *p_userdata, const Vector<TaskID> &p_dependencies) {
+
+	ERR_FAIL_COND_V(!queues, INVALID_TASK_ID);
+	ERR_FAIL_COND_V(!p_func, INVALID_TASK_ID);
+
+	Task *task = memnew(Task);
+	task->native_func = p_func;
+	task->native_userdata = p_userdata;
+	return _add_task(task, p_dependencies);
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_group_task(GroupFunc p_func, void *p_userdata, uint32_t p_elements, int p_tasks_needed, const Vector<TaskID> &p_dependencies) {
+
+	ERR_FAIL_COND_V(!queues, INVALID_TASK_ID);
+	ERR_FAIL_COND_V(!p_func, INVALID_TASK_ID);
+
+	Task *task = memnew(Task);
+	task->native_group_func = p_func;
+	task->native_userdata = p_userdata;
+	task->is_group = true;
+	task->elements = p_elements;
+
+	if (p_tasks_needed < 0) {
+		p_tasks_needed = queue_count;
+	}
+	task->runners = CLAMP((uint32_t)p_tasks_needed, 1U, MAX(p_elements, 1U));
+
+	return _add_task(task, p_dependencies);
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_task(Object *p_instance, const StringName &p_method, const Variant &p_userdata, const Vector<TaskID> &p_dependencies) {
+
+	ERR_FAIL_COND_V(!queues, INVALID_TASK_ID);
+	ERR_FAIL_NULL_V(p_instance, INVALID_TASK_ID);
+
+	Task *task = memnew(Task);
+	task->instance_id = p_instance->get_instance_id();
+	task->method = p_method;
+	task->userdata = p_userdata;
+	return _add_task(task, p_dependencies);
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_group_task(Object *p_instance, const StringName &p_method, uint32_t p_elements, int p_tasks_needed, const Variant &p_userdata, const Vector<TaskID> &p_dependencies) {
+
+	ERR_FAIL_COND_V(!queues, INVALID_TASK_ID);
+	ERR_FAIL_NULL_V(p_instance, INVALID_TASK_ID);
+
+	Task *task = memnew(Task);
+	task->instance_id = p_instance->get_instance_id();
+	task->method = p_method;
+	task->userdata = p_userdata;
+	task->is_group = true;
+	task->elements = p_elements;
+
+	if (p_tasks_needed < 0) {
+		p_tasks_needed = queue_count;
+	}
+	task->runners = CLAMP((uint32_t)p_tasks_needed, 1U, MAX(p_elements, 1U));
+
+	return _add_task(task, p_dependencies);
+}
+
+bool WorkerThreadPool::is_task_completed(TaskID p_task) const {
+
+	task_mutex->lock();
+	const Task *const *task = tasks.getptr(p_task);
+	if (!task) {
+		task_mutex->unlock();
+		ERR_EXPLAIN("Invalid task ID: " + itos(p_task));
+		ERR_FAIL_V(false);
+	}
+	bool completed = (*task)->completed;
+	task_mutex->unlock();
+
+	return completed;
+}
+
+Error WorkerThreadPool::wait_for_task_completion(TaskID p_task) {
+
+	task_mutex->lock();
+	Task **taskptr = tasks.getptr(p_task);
+	if (!taskptr) {
+		task_mutex->unlock();
+		ERR_EXPLAIN("Invalid task ID: " + itos(p_task));
+		ERR_FAIL_V(ERR_INVALID_PARAMETER);
+	}
+	Task *task = *taskptr;
+	if (task->waiting) {
+		task_mutex->unlock();
+		ERR_EXPLAIN("Another thread is already waiting for task ID: " + itos(p_task));
+		ERR_FAIL_V(ERR_BUSY);
+	}
+	task->waiting = true;
+	task_mutex->unlock();
+
+	int thread_index = _get_thread_index();
+
+	while (true) {
+
+		task_mutex->lock();
+		bool completed = task->completed;
+		bool runnable = task->pending_dependencies == 0;
+		task_mutex->unlock();
+
+		if (completed)
+			break;
+
+		if (task->is_group && runnable) {
+			//help with our own elements first
+			_process_group_elements(task);
+		}
+
+		//then with anything else that is pending
+		Task *other = _pop_task(thread_index);
+		if (other) {
+			_process_task(other);
+			continue;
+		}
+
+		task_mutex->lock();
+		if (task->completed) {
+			task_mutex->unlock();
+			break;
+		}
+		//nothing left to help with, sleep until the remaining runners finish
+		task->done_semaphore = Semaphore::create();
+		task_mutex->unlock();
+
+		task->done_semaphore->wait();
+		break;
+	}
+
+	task_mutex->lock();
+	tasks.erase(p_task);
+	task_mutex->unlock();
+
+	if (task->done_semaphore) {
+		memdelete(task->done_semaphore);
+	}
+	memdelete(task);
+
+	return OK;
+}
+
+bool WorkerThreadPool::process_pending_task() {
+
+	Task *task = _pop_task(_get_thread_index());
+	if (!task)
+		return false;
+
+	_process_task(task);
+	return true;
+}
+
+int WorkerThreadPool::get_thread_count() const {
+
+	return thread_count;
+}
+
+bool WorkerThreadPool::is_worker_thread() const {
+
+	return _get_thread_index() >= 0;
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::_add_task_bind(Object *p_instance, const StringName &p_method, const Variant &p_userdata, const PoolIntArray &p_dependencies) {
+
+	Vector<TaskID> dependencies;
+	PoolIntArray::Read r = p_dependencies.read();
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		dependencies.push_back(r[i]);
+	}
+
+	return add_task(p_instance, p_method, p_userdata, dependencies);
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::_add_group_task_bind(Object *p_instance, const StringName &p_method, int p_elements, int p_tasks_needed, const Variant &p_userdata, const PoolIntArray &p_dependencies) {
+
+	ERR_FAIL_COND_V(p_elements < 0, INVALID_TASK_ID);
+
+	Vector<TaskID> dependencies;
+	PoolIntArray::Read r = p_dependencies.read();
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		dependencies.push_back(r[i]);
+	}
+
+	return add_group_task(p_instance, p_method, p_elements, p_tasks_needed, p_userdata, dependencies);
+}
+
+void WorkerThreadPool::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("add_task", "instance", "method", "userdata", "dependencies"), &WorkerThreadPool::_add_task_bind, DEFVAL(Variant()), DEFVAL(PoolIntArray()));
+	ClassDB::bind_method(D_METHOD("add_group_task", "instance", "method", "elements", "tasks_needed", "userdata", "dependencies"), &WorkerThreadPool::_add_group_task_bind, DEFVAL(-1), DEFVAL(Variant()), DEFVAL(PoolIntArray()));
+	ClassDB::bind_method(D_METHOD("is_task_completed", "task_id"), &WorkerThreadPool::is_task_completed);
+	ClassDB::bind_method(D_METHOD("wait_for_task_completion", "task_id"), &WorkerThreadPool::wait_for_task_completion);
+	ClassDB::bind_method(D_METHOD("get_thread_count"), &WorkerThreadPool::get_thread_count);
+	ClassDB::bind_method(D_METHOD("is_worker_thread"), &WorkerThreadPool::is_worker_thread);
+
+	BIND_CONSTANT(INVALID_TASK_ID);
+}
+
+WorkerThreadPool *WorkerThreadPool::get_singleton() {
+
+	return singleton;
+}
+
+void WorkerThreadPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(queues);
+
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_processor_count();
+	}
+#ifdef NO_THREADS
+	//everything runs on the thread waiting for it
+	p_thread_count = 0;
+#endif
+
+	thread_count = p_thread_count;
+	queue_count = MAX(thread_count, 1);
+
+	queues = memnew_arr(TaskDeque, queue_count);
+	for (int i = 0; i < queue_count; i++) {
+		queues[i].mutex = Mutex::create(false);
+	}
+
+	exit_threads = false;
+	if (thread_count) {
+		threads = memnew_arr(ThreadData, thread_count);
+		for (int i = 0; i < thread_count; i++) {
+			threads[i].pool = this;
+			threads[i].index = i;
+			threads[i].thread = Thread::create(_thread_function, &threads[i]);
+		}
+	}
+}
+
+void WorkerThreadPool::finish() {
+
+	if (!queues)
+		return;
+
+	exit_threads = true;
+	for (int i = 0; i < thread_count; i++) {
+		work_semaphore->post();
+	}
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+	}
+	if (threads) {
+		memdelete_arr(threads);
+		threads = NULL;
+	}
+	thread_count = 0;
+
+	for (int i = 0; i < queue_count; i++) {
+		memdelete(queues[i].mutex);
+	}
+	memdelete_arr(queues);
+	queues = NULL;
+	queue_count = 0;
+
+	if (tasks.size()) {
+		WARN_PRINTS("WorkerThreadPool: " + itos(tasks.size()) + " task(s) were never waited for.");
+		const TaskID *k = NULL;
+		while ((k = tasks.next(k))) {
+			Task *task = tasks[*k];
+			if (task->done_semaphore) {
+				memdelete(task->done_semaphore);
+			}
+			memdelete(task);
+		}
+		tasks.clear();
+	}
+}
+
+WorkerThreadPool::WorkerThreadPool() {
+
+	singleton = this;
+
+	threads = NULL;
+	thread_count = 0;
+	queues = NULL;
+	queue_count = 0;
+
+	task_mutex = Mutex::create();
+	last_task_id = 0;
+
+	work_semaphore = Semaphore::create();
+	next_queue = 0;
+	exit_threads = false;
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+	finish();
+
+	memdelete(task_mutex);
+	memdelete(work_semaphore);
+
+	singleton = NULL;
+}
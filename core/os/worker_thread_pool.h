@@ -0,0 +1,198 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/hash_map.h"
+#include "core/object.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+/**
+ * Persistent, engine-wide pool of worker threads.
+ *
+ * Every worker owns a deque of pending tasks. Tasks added from a worker go to its
+ * own deque and are popped LIFO, idle workers steal FIFO from the other deques.
+ * Tasks may depend on other tasks, and group tasks split an index range among
+ * several workers (see thread_process_array()).
+ *
+ * Every task added must be waited for exactly once with wait_for_task_completion(),
+ * which also frees it. While waiting, the calling thread helps running pending tasks.
+ */
+
+class WorkerThreadPool : public Object {
+
+	GDCLASS(WorkerThreadPool, Object);
+
+public:
+	typedef int64_t TaskID;
+	enum {
+		INVALID_TASK_ID = -1
+	};
+
+	typedef void (*TaskFunc)(void *p_userdata);
+	typedef void (*GroupFunc)(void *p_userdata, uint32_t p_index);
+
+private:
+	struct Task {
+
+		TaskID self;
+
+		TaskFunc native_func;
+		GroupFunc native_group_func;
+		void *native_userdata;
+
+		ObjectID instance_id;
+		StringName method;
+		Variant userdata;
+
+		bool is_group;
+		uint32_t elements;
+		volatile uint32_t index; // next element of a group to process
+		uint32_t runners; // how many queue entries point to this task
+		volatile uint32_t unfinished; // runners not done yet, plus group elements not processed yet (the waiter helps with those)
+
+		uint32_t pending_dependencies;
+		Vector<Task *> dependents;
+
+		bool completed;
+		bool waiting;
+		Semaphore *done_semaphore;
+
+		Task() {
+			self = INVALID_TASK_ID;
+			native_func = NULL;
+			native_group_func = NULL;
+			native_userdata = NULL;
+			instance_id = 0;
+			is_group = false;
+			elements = 0;
+			index = 0;
+			runners = 1;
+			unfinished = 0;
+			pending_dependencies = 0;
+			completed = false;
+			waiting = false;
+			done_semaphore = NULL;
+		}
+	};
+
+	// Growable ring buffer. The owner pushes and pops at the back, thieves take from the front.
+	struct TaskDeque {
+
+		Mutex *mutex;
+		Vector<Task *> buffer;
+		uint32_t head;
+		uint32_t count;
+
+		void push_back(Task *p_task);
+		Task *pop_back();
+		Task *pop_front();
+
+		TaskDeque() {
+			mutex = NULL;
+			head = 0;
+			count = 0;
+		}
+	};
+
+	struct ThreadData {
+
+		WorkerThreadPool *pool;
+		uint32_t index;
+		Thread::ID id;
+		Thread *thread;
+
+		ThreadData() {
+			pool = NULL;
+			index = 0;
+			id = 0;
+			thread = NULL;
+		}
+	};
+
+	static WorkerThreadPool *singleton;
+
+	ThreadData *threads;
+	int thread_count;
+	TaskDeque *queues; // one per thread, or a single one when running without threads
+	int queue_count;
+
+	Mutex *task_mutex;
+	HashMap<TaskID, Task *> tasks;
+	TaskID last_task_id;
+
+	Semaphore *work_semaphore;
+	volatile uint32_t next_queue;
+	volatile bool exit_threads;
+
+	static void _thread_function(void *p_user);
+
+	int _get_thread_index() const;
+	void _enqueue_task(Task *p_task);
+	Task *_pop_task(int p_thread_index);
+	void _process_task(Task *p_task);
+	void _process_group_elements(Task *p_task);
+	void _task_completed(Task *p_task);
+	TaskID _add_task(Task *p_task, const Vector<TaskID> &p_dependencies);
+
+	TaskID _add_task_bind(Object *p_instance, const StringName &p_method, const Variant &p_userdata, const PoolIntArray &p_dependencies);
+	TaskID _add_group_task_bind(Object *p_instance, const StringName &p_method, int p_elements, int p_tasks_needed, const Variant &p_userdata, const PoolIntArray &p_dependencies);
+
+protected:
+	static void _bind_methods();
+
+public:
+	static WorkerThreadPool *get_singleton();
+
+	TaskID add_native_task(TaskFunc p_func, void *p_userdata, const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+	TaskID add_native_group_task(GroupFunc p_func, void *p_userdata, uint32_t p_elements, int p_tasks_needed = -1, const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+
+	TaskID add_task(Object *p_instance, const StringName &p_method, const Variant &p_userdata = Variant(), const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+	TaskID add_group_task(Object *p_instance, const StringName &p_method, uint32_t p_elements, int p_tasks_needed = -1, const Variant &p_userdata = Variant(), const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+
+	bool is_task_completed(TaskID p_task) const;
+	Error wait_for_task_completion(TaskID p_task);
+	bool process_pending_task(); // runs one queued task on the calling thread, for waits that can't use wait_for_task_completion()
+
+	int get_thread_count() const;
+	bool is_worker_thread() const;
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
@@ -37,6 +37,7 @@
 #include "core/engine.h"
 #include "core/func_ref.h"
 #include "core/input_map.h"
+#include "core/io/compression.h"
 #include "core/io/config_file.h"
 #include "core/io/http_client.h"
 #include "core/io/image_loader.h"
@@ -59,6 +60,7 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
@@ -82,6 +84,8 @@ static _JSON *_json = NULL;
 
 static IP *ip = NULL;
 
+static WorkerThreadPool *worker_thread_pool = NULL;
+
 static _Geometry *_geometry = NULL;
 
 extern Mutex *_global_mutex;
@@ -95,7 +99,7 @@ void register_core_types() {
 
 	ObjectDB::setup();
 	ResourceCache::setup();
-	MemoryPool::setup();
+	ResourceLoader::initialize();
 
 	_global_mutex = Mutex::create();
 
@@ -205,6 +209,11 @@ void register_core_settings() {
 	//since in register core types, globals may not e present
 	GLOBAL_DEF_RST("network/limits/packet_peer_stream/max_buffer_po2", (16));
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/packet_peer_stream/max_buffer_po2", PropertyInfo(Variant::INT, "network/limits/packet_peer_stream/max_buffer_po2", PROPERTY_HINT_RANGE, "0,64,1,or_greater"));
+
+	GLOBAL_DEF_RST("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads", PropertyInfo(Variant::INT, "threading/worker_pool/max_threads", PROPERTY_HINT_RANGE, "-1,256,1,or_greater"));
+
+	GLOBAL_DEF("application/run/lazy_subresources", false);
 }
 
 void register_core_singletons() {
@@ -223,6 +232,21 @@ void register_core_singletons() {
 	ClassDB::register_class<InputMap>();
 	ClassDB::register_class<_JSON>();
 	ClassDB::register_class<Expression>();
+	ClassDB::register_virtual_class<WorkerThreadPool>();
+
+	//project settings are loaded by now, so the thread count can be honored
+	worker_thread_pool = memnew(WorkerThreadPool);
+	worker_thread_pool->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+
+	String zstd_dictionary = GLOBAL_GET("compression/formats/zstd/dictionary");
+	if (zstd_dictionary != "") {
+		Vector<uint8_t> dictionary = FileAccess::get_file_as_array(zstd_dictionary);
+		if (dictionary.empty()) {
+			ERR_PRINTS("Can't read the zstd dictionary, resources will be compressed without it: " + zstd_dictionary);
+		} else if (Compression::set_zstd_dictionary(dictionary) != OK) {
+			ERR_PRINTS("Invalid zstd dictionary, resources will be compressed without it: " + zstd_dictionary);
+		}
+	}
 
 	Engine::get_singleton()->add_singleton(Engine::Singleton("ProjectSettings", ProjectSettings::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("IP", IP::get_singleton()));
@@ -237,10 +261,21 @@ void register_core_singletons() {
 	Engine::get_singleton()->add_singleton(Engine::Singleton("Input", Input::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("InputMap", InputMap::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("JSON", _JSON::get_singleton()));
+	Engine::get_singleton()->add_singleton(Engine::Singleton("WorkerThreadPool", WorkerThreadPool::get_singleton()));
 }
 
 void unregister_core_types() {
 
+	//pending threaded loads still run on the pool
+	ResourceLoader::finalize();
+
+	if (worker_thread_pool) {
+		memdelete(worker_thread_pool);
+		worker_thread_pool = NULL;
+	}
+
+	Compression::clear_zstd_dictionaries();
+
 	memdelete(_resource_loader);
 	memdelete(_resource_saver);
 	memdelete(_os);
@@ -93,6 +93,9 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	return *pw;
 }
 
+static _ALWAYS_INLINE_ void atomic_memory_barrier() {
+}
+
 #elif defined(__GNUC__)
 
 /* Implementation for GCC & Clang */
@@ -148,6 +151,12 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	}
 }
 
+// full barrier, for publishing data that other threads read without locking
+static _ALWAYS_INLINE_ void atomic_memory_barrier() {
+
+	__sync_synchronize();
+}
+
 #elif defined(_MSC_VER)
 // For MSVC use a separate compilation unit to prevent windows.h from polluting
 // the global namespace.
@@ -165,6 +174,8 @@ uint64_t atomic_sub(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_add(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_exchange_if_greater(volatile uint64_t *pw, volatile uint64_t val);
 
+void atomic_memory_barrier();
+
 #else
 //no threads supported?
 #error Must provide atomic functions for this platform or compiler!
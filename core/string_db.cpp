@@ -40,10 +40,12 @@ StaticCString StaticCString::create(const char *p_ptr) {
 }
 
 StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+uint32_t StringName::_readers[STRING_TABLE_LEN];
+StringName::_Data *StringName::_retired = NULL;
 
-StringName _scs_create(const char *p_chr) {
+StringName _scs_create(const char *p_chr, bool p_static) {
 
-	return (p_chr[0] ? StringName(StaticCString::create(p_chr)) : StringName());
+	return (p_chr[0] ? StringName(StaticCString::create(p_chr), p_static) : StringName());
 }
 
 bool StringName::configured = false;
@@ -57,6 +59,7 @@ void StringName::setup() {
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
 		_table[i] = NULL;
+		_readers[i] = 0;
 	}
 	configured = true;
 }
@@ -71,12 +74,14 @@ void StringName::cleanup() {
 		while (_table[i]) {
 
 			_Data *d = _table[i];
-			lost_strings++;
-			if (OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
+			if (!d->is_static) {
+				lost_strings++;
+				if (OS::get_singleton()->is_stdout_verbose()) {
+					if (d->cname) {
+						print_line("Orphan StringName: " + String(d->cname));
+					} else {
+						print_line("Orphan StringName: " + String(d->name));
+					}
 				}
 			}
 
@@ -84,14 +89,80 @@ void StringName::cleanup() {
 			memdelete(d);
 		}
 	}
+	while (_retired) {
+
+		_Data *d = _retired;
+		_retired = _retired->next_retired;
+		memdelete(d);
+	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+	configured = false; // static names destroyed after this point must not touch the table
 	lock->unlock();
 
 	memdelete(lock);
 }
 
+template <class T>
+StringName::_Data *StringName::_lookup(uint32_t p_hash, const T &p_name) {
+
+	uint32_t idx = p_hash & STRING_TABLE_MASK;
+
+	atomic_increment(&_readers[idx]);
+
+	_Data *data = _table[idx];
+
+	while (data) {
+
+		// compare hash first
+		if (data->hash == p_hash && data->get_name() == p_name)
+			break;
+		data = data->next;
+	}
+
+	if (data && !data->refcount.ref()) {
+		data = NULL; // being removed, a new entry will replace it
+	}
+
+	atomic_decrement(&_readers[idx]);
+
+	return data;
+}
+
+void StringName::_insert(_Data *p_data) {
+
+	// called with the lock held, the entry must be complete before it can be reached
+	uint32_t idx = p_data->idx;
+	p_data->next = _table[idx];
+	p_data->prev = NULL;
+
+	atomic_memory_barrier();
+
+	if (_table[idx])
+		_table[idx]->prev = p_data;
+	_table[idx] = p_data;
+}
+
+void StringName::_free_retired() {
+
+	// called with the lock held, after entries were unlinked
+	atomic_memory_barrier();
+
+	_Data **retired = &_retired;
+
+	while (*retired) {
+
+		_Data *d = *retired;
+		if (_readers[d->idx] == 0) {
+			*retired = d->next_retired;
+			memdelete(d);
+		} else {
+			retired = &d->next_retired;
+		}
+	}
+}
+
 void StringName::unref() {
 
 	ERR_FAIL_COND(!configured);
@@ -112,7 +183,12 @@ void StringName::unref() {
 		if (_data->next) {
 			_data->next->prev = _data->prev;
 		}
-		memdelete(_data);
+
+		// lookups may still be walking through it, its next pointer is left intact
+		_data->next_retired = _retired;
+		_retired = _data;
+		_free_retired();
+
 		lock->unlock();
 	}
 
@@ -184,47 +260,33 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
+	_data = _lookup(hash, p_name);
+	if (_data)
+		return; // exists
 
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
+	lock->lock();
 
+	// look again, another thread may have added it meanwhile
+	_data = _lookup(hash, p_name);
 	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
+		lock->unlock();
+		return;
 	}
 
 	_data = memnew(_Data);
 	_data->name = p_name;
 	_data->refcount.init();
 	_data->hash = hash;
-	_data->idx = idx;
+	_data->idx = hash & STRING_TABLE_MASK;
 	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
+	_insert(_data);
 
 	lock->unlock();
 }
 
-StringName::StringName(const StaticCString &p_static_string) {
+StringName::StringName(const StaticCString &p_static_string, bool p_static) {
 
 	_data = NULL;
 
@@ -232,44 +294,32 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_static_string.ptr);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_data = _lookup(hash, p_static_string.ptr);
 
-	_data = _table[idx];
+	if (!_data) {
 
-	while (_data) {
+		lock->lock();
 
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
-	}
+		// look again, another thread may have added it meanwhile
+		_data = _lookup(hash, p_static_string.ptr);
+		if (!_data) {
 
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
+			_data = memnew(_Data);
+			_data->refcount.init();
+			_data->hash = hash;
+			_data->idx = hash & STRING_TABLE_MASK;
+			_data->cname = p_static_string.ptr;
+			_insert(_data);
 		}
-	}
 
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
+		lock->unlock();
+	}
 
-	lock->unlock();
+	if (p_static) {
+		_data->is_static = true;
+	}
 }
 
 StringName::StringName(const String &p_name) {
@@ -281,41 +331,28 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_data = _lookup(hash, p_name);
+	if (_data)
+		return; // exists
 
-	_data = _table[idx];
-
-	while (_data) {
-
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
+	lock->lock();
 
+	// look again, another thread may have added it meanwhile
+	_data = _lookup(hash, p_name);
 	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
+		lock->unlock();
+		return;
 	}
 
 	_data = memnew(_Data);
 	_data->name = p_name;
 	_data->refcount.init();
 	_data->hash = hash;
-	_data->idx = idx;
+	_data->idx = hash & STRING_TABLE_MASK;
 	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
+	_insert(_data);
 
 	lock->unlock();
 }
@@ -328,29 +365,11 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-
-		return StringName(_data);
+	_Data *data = _lookup(String::hash(p_name), p_name);
+	if (data) {
+		return StringName(data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -362,56 +381,22 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
+	_Data *data = _lookup(String::hash(p_name), p_name);
+	if (data) {
+		return StringName(data);
 	}
 
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
-	}
-
-	lock->unlock();
 	return StringName(); //does not exist
 }
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
+	_Data *data = _lookup(p_name.hash(), p_name);
+	if (data) {
+		return StringName(data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -422,5 +407,7 @@ StringName::StringName() {
 
 StringName::~StringName() {
 
-	unref();
+	if (likely(configured)) {
+		unref();
+	}
 }
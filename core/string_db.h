@@ -61,17 +61,25 @@ class StringName {
 		String get_name() const { return cname ? String(cname) : name; }
 		int idx;
 		uint32_t hash;
+		bool is_static; // held until exit, not reported as orphan
 		_Data *prev;
 		_Data *next;
+		_Data *next_retired;
 		_Data() {
 			cname = NULL;
-			next = prev = NULL;
+			next = prev = next_retired = NULL;
 			idx = 0;
 			hash = 0;
+			is_static = false;
 		}
 	};
 
+	// Lookups don't lock: they walk a bucket while its reader count is raised, and a
+	// removed entry is only freed once no reader can still be on its bucket.
+	// Insertions and removals are serialized by the lock.
 	static _Data *_table[STRING_TABLE_LEN];
+	static uint32_t _readers[STRING_TABLE_LEN];
+	static _Data *_retired;
 
 	_Data *_data;
 
@@ -81,6 +89,11 @@ class StringName {
 		uint32_t hash;
 	};
 
+	template <class T>
+	static _Data *_lookup(uint32_t p_hash, const T &p_name);
+	static void _insert(_Data *p_data);
+	static void _free_retired();
+
 	void unref();
 	friend void register_core_types();
 	friend void unregister_core_types();
@@ -162,11 +175,15 @@ public:
 	StringName(const char *p_name);
 	StringName(const StringName &p_name);
 	StringName(const String &p_name);
-	StringName(const StaticCString &p_static_string);
+	StringName(const StaticCString &p_static_string, bool p_static = false);
 	StringName();
 	~StringName();
 };
 
-StringName _scs_create(const char *p_chr);
+StringName _scs_create(const char *p_chr, bool p_static = false);
+
+// Interns a string literal once and keeps it until exit, avoiding the table lookup of
+// constructing a StringName from it every time. Meant for names used on hot paths.
+#define SNAME(m_arg) ([]() -> const StringName & { static StringName sname = _scs_create(m_arg, true); return sname; })()
 
 #endif
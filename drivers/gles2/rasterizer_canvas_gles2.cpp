@@ -77,6 +77,9 @@ void RasterizerCanvasGLES2::_set_uniforms() {
 
 void RasterizerCanvasGLES2::canvas_begin() {
 
+	// read every frame, so batched and unbatched output can be compared at runtime
+	batch.enabled = GLOBAL_GET("rendering/quality/2d/use_batching");
+
 	state.canvas_shader.bind();
 	if (storage->frame.current_rt) {
 		glBindFramebuffer(GL_FRAMEBUFFER, storage->frame.current_rt->fbo);
@@ -286,6 +289,7 @@ void RasterizerCanvasGLES2::_draw_polygon(const int *p_indices, int p_index_coun
 	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(int) * p_index_count, p_indices);
 
 	glDrawElements(GL_TRIANGLES, p_index_count, GL_UNSIGNED_INT, 0);
+	storage->info.render.draw_call_count++;
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -325,6 +329,7 @@ void RasterizerCanvasGLES2::_draw_generic(GLuint p_primitive, int p_vertex_count
 	}
 
 	glDrawArrays(p_primitive, 0, p_vertex_count);
+	storage->info.render.draw_call_count++;
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -386,6 +391,7 @@ void RasterizerCanvasGLES2::_draw_gui_primitive(int p_points, const Vector2 *p_v
 	}
 
 	glDrawArrays(prim[p_points], 0, p_points);
+	storage->info.render.draw_call_count++;
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -400,15 +406,200 @@ static const GLenum gl_primitive[] = {
 	GL_TRIANGLE_FAN
 };
 
+RasterizerStorageGLES2::Texture *RasterizerCanvasGLES2::_batch_get_texture(const RID &p_texture) {
+
+	if (batch.vertex_count && p_texture == batch.texture)
+		return batch.texture_ptr;
+
+	RasterizerStorageGLES2::Texture *texture = storage->texture_owner.getornull(p_texture);
+	return texture ? texture->get_ptr() : NULL;
+}
+
+RasterizerCanvasGLES2::BatchVertex *RasterizerCanvasGLES2::_batch_alloc(const RID &p_texture, const RID &p_normal_map, const Size2 &p_texpixel_size, int p_vertex_count) {
+
+	if (p_vertex_count > batch.max_vertices)
+		return NULL; // too large to batch, draw on its own
+
+	if (batch.vertex_count) {
+		if (p_texture != batch.texture || p_normal_map != batch.normal_map || p_texpixel_size != batch.texpixel_size || batch.vertex_count + p_vertex_count > batch.max_vertices) {
+			_batch_flush();
+		}
+	}
+
+	if (!batch.vertex_count) {
+		batch.texture_ptr = _batch_get_texture(p_texture);
+		batch.texture = p_texture;
+		batch.normal_map = p_normal_map;
+		batch.texpixel_size = p_texpixel_size;
+	}
+
+	BatchVertex *vertices = &batch.vertices[batch.vertex_count];
+	batch.vertex_count += p_vertex_count;
+	return vertices;
+}
+
+bool RasterizerCanvasGLES2::_batch_add_command(Item::Command *p_command) {
+
+	switch (p_command->type) {
+
+		case Item::Command::TYPE_RECT: {
+
+			Item::CommandRect *rect = static_cast<Item::CommandRect *>(p_command);
+
+			RasterizerStorageGLES2::Texture *texture = _batch_get_texture(rect->texture);
+			if (texture && rect->flags & CANVAS_RECT_TILE && !(texture->flags & VS::TEXTURE_FLAG_REPEAT))
+				return false; // repeat is enabled just for this draw
+
+			Size2 texpixel_size = texture ? Size2(1.0 / texture->width, 1.0 / texture->height) : Size2();
+			BatchVertex *vertices = _batch_alloc(rect->texture, rect->normal_map, texpixel_size, 6);
+			if (!vertices)
+				return false;
+
+			_get_rect_batch_vertices(rect, texture != NULL, texpixel_size, batch.transform, vertices);
+			return true;
+
+		} break;
+		case Item::Command::TYPE_NINEPATCH: {
+
+			Item::CommandNinePatch *np = static_cast<Item::CommandNinePatch *>(p_command);
+
+			RasterizerStorageGLES2::Texture *texture = _batch_get_texture(np->texture);
+			if (!texture)
+				return false;
+
+			Size2 texpixel_size(1.0 / texture->width, 1.0 / texture->height);
+			int index_count = 18 * 3 - (np->draw_center ? 0 : 6);
+			BatchVertex *vertices = _batch_alloc(np->texture, np->normal_map, texpixel_size, index_count);
+			if (!vertices)
+				return false;
+
+			Rect2 source = np->source;
+			if (source.size.x == 0 && source.size.y == 0) {
+				source.size.x = texture->width;
+				source.size.y = texture->height;
+			}
+
+			_get_ninepatch_batch_vertices(np, source, texpixel_size, batch.transform, vertices);
+			return true;
+
+		} break;
+		case Item::Command::TYPE_POLYGON: {
+
+			Item::CommandPolygon *polygon = static_cast<Item::CommandPolygon *>(p_command);
+
+			if (polygon->bones.size() && polygon->weights.size())
+				return false;
+
+			RasterizerStorageGLES2::Texture *texture = _batch_get_texture(polygon->texture);
+			Size2 texpixel_size = texture ? Size2(1.0 / texture->width, 1.0 / texture->height) : Size2();
+			BatchVertex *vertices = _batch_alloc(polygon->texture, polygon->normal_map, texpixel_size, polygon->count);
+			if (!vertices)
+				return false;
+
+			const int *indices = polygon->indices.ptr();
+			const Vector2 *points = polygon->points.ptr();
+			const Vector2 *uvs = polygon->uvs.ptr();
+			const Color *colors = polygon->colors.ptr();
+			int color_count = polygon->colors.size();
+
+			for (int i = 0; i < polygon->count; i++) {
+
+				int index = indices[i];
+				vertices[i].vertex = batch.transform.xform(points[index]);
+				vertices[i].color = color_count == 1 ? colors[0] : (color_count ? colors[index] : Color(1, 1, 1, 1));
+				vertices[i].uv = uvs ? uvs[index] : Vector2();
+			}
+			return true;
+
+		} break;
+		case Item::Command::TYPE_TRANSFORM: {
+
+			if (!batch.canvas_space)
+				return false;
+
+			// later vertices are transformed on the CPU, the uniform is for commands that aren't batched
+			Item::CommandTransform *transform = static_cast<Item::CommandTransform *>(p_command);
+			state.uniforms.extra_matrix = transform->xform;
+			state.canvas_shader.set_uniform(CanvasShaderGLES2::EXTRA_MATRIX, state.uniforms.extra_matrix);
+			batch.transform = state.uniforms.modelview_matrix * state.uniforms.extra_matrix;
+			return true;
+
+		} break;
+		default: {
+		}
+	}
+
+	return false;
+}
+
+void RasterizerCanvasGLES2::_batch_flush() {
+
+	if (!batch.vertex_count)
+		return;
+
+	state.canvas_shader.set_conditional(CanvasShaderGLES2::USE_TEXTURE_RECT, false);
+	if (state.canvas_shader.bind()) {
+		_set_uniforms();
+		state.canvas_shader.use_material((void *)batch.material);
+	}
+
+	_bind_canvas_texture(batch.texture, batch.normal_map);
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::COLOR_TEXPIXEL_SIZE, batch.texpixel_size);
+
+	if (batch.canvas_space) {
+		state.canvas_shader.set_uniform(CanvasShaderGLES2::MODELVIEW_MATRIX, Transform2D());
+		state.canvas_shader.set_uniform(CanvasShaderGLES2::EXTRA_MATRIX, Transform2D());
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, data.polygon_buffer);
+	//orphan the old contents, so there is no need to wait for the previous draw
+	glBufferData(GL_ARRAY_BUFFER, data.polygon_buffer_size, NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(BatchVertex) * batch.vertex_count, batch.vertices);
+
+	glEnableVertexAttribArray(VS::ARRAY_VERTEX);
+	glVertexAttribPointer(VS::ARRAY_VERTEX, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), NULL);
+	glEnableVertexAttribArray(VS::ARRAY_COLOR);
+	glVertexAttribPointer(VS::ARRAY_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (uint8_t *)0 + sizeof(Vector2));
+	glEnableVertexAttribArray(VS::ARRAY_TEX_UV);
+	glVertexAttribPointer(VS::ARRAY_TEX_UV, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (uint8_t *)0 + sizeof(Vector2) + sizeof(Color));
+	glDisableVertexAttribArray(VS::ARRAY_WEIGHTS);
+	glDisableVertexAttribArray(VS::ARRAY_BONES);
+
+	glDrawArrays(GL_TRIANGLES, 0, batch.vertex_count);
+
+	// the immediate path expects the color to come from the generic attribute
+	glDisableVertexAttribArray(VS::ARRAY_COLOR);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (batch.canvas_space) {
+		state.canvas_shader.set_uniform(CanvasShaderGLES2::MODELVIEW_MATRIX, state.uniforms.modelview_matrix);
+		state.canvas_shader.set_uniform(CanvasShaderGLES2::EXTRA_MATRIX, state.uniforms.extra_matrix);
+	}
+
+	storage->info.render.draw_call_count++;
+
+	batch.vertex_count = 0;
+}
+
 void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip, RasterizerStorageGLES2::Material *p_material) {
 
 	int command_count = p_item->commands.size();
 	Item::Command **commands = p_item->commands.ptrw();
 
+	batch.material = p_material;
+	batch.transform = batch.canvas_space ? state.uniforms.modelview_matrix : Transform2D();
+
 	for (int i = 0; i < command_count; i++) {
 
 		Item::Command *command = commands[i];
 
+		if (batch.enabled) {
+			if (_batch_add_command(command))
+				continue;
+
+			_batch_flush();
+		}
+
 		switch (command->type) {
 
 			case Item::Command::TYPE_LINE: {
@@ -465,49 +656,16 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 					state.canvas_shader.use_material((void *)p_material);
 				}
 
-				Size2 abs_size = r->rect.size.abs();
-				Vector2 points[4] = {
-					r->rect.position,
-					r->rect.position + Vector2(abs_size.x, 0.0),
-					r->rect.position + abs_size,
-					r->rect.position + Vector2(0.0, abs_size.y),
-				};
-
-				if (r->rect.size.x < 0) {
-					SWAP(points[0], points[1]);
-					SWAP(points[2], points[3]);
-				}
-				if (r->rect.size.y < 0) {
-					SWAP(points[0], points[3]);
-					SWAP(points[1], points[2]);
-				}
+				Vector2 points[4];
+				_get_rect_points(r->rect, points);
 
 				RasterizerStorageGLES2::Texture *texture = _bind_canvas_texture(r->texture, r->normal_map);
 
 				if (texture) {
 					Size2 texpixel_size(1.0 / texture->width, 1.0 / texture->height);
 
-					Rect2 src_rect = (r->flags & CANVAS_RECT_REGION) ? Rect2(r->source.position * texpixel_size, r->source.size * texpixel_size) : Rect2(0, 0, 1, 1);
-
-					Vector2 uvs[4] = {
-						src_rect.position,
-						src_rect.position + Vector2(src_rect.size.x, 0.0),
-						src_rect.position + src_rect.size,
-						src_rect.position + Vector2(0.0, src_rect.size.y),
-					};
-
-					if (r->flags & CANVAS_RECT_FLIP_H) {
-						SWAP(uvs[0], uvs[1]);
-						SWAP(uvs[2], uvs[3]);
-					}
-					if (r->flags & CANVAS_RECT_FLIP_V) {
-						SWAP(uvs[0], uvs[3]);
-						SWAP(uvs[1], uvs[2]);
-					}
-
-					if (r->flags & CANVAS_RECT_TRANSPOSE) {
-						SWAP(uvs[1], uvs[3]);
-					}
+					Vector2 uvs[4];
+					_get_rect_uvs(r, texpixel_size, uvs);
 
 					state.canvas_shader.set_uniform(CanvasShaderGLES2::COLOR_TEXPIXEL_SIZE, texpixel_size);
 
@@ -559,6 +717,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 					state.canvas_shader.set_uniform(CanvasShaderGLES2::SRC_RECT, Color(0, 0, 1, 1));
 
 					glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+					storage->info.render.draw_call_count++;
 				} else {
 
 					bool untile = false;
@@ -601,6 +760,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 					state.canvas_shader.set_uniform(CanvasShaderGLES2::SRC_RECT, Color(src_rect.position.x, src_rect.position.y, src_rect.size.x, src_rect.size.y));
 
 					glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+					storage->info.render.draw_call_count++;
 
 					if (untile) {
 						glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -649,113 +809,17 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 
 				// this buffer contains [ POS POS UV UV ] *
 
-				float buffer[16 * 2 + 16 * 2];
-
-				{
-
-					// first row
-
-					buffer[(0 * 4 * 4) + 0] = np->rect.position.x;
-					buffer[(0 * 4 * 4) + 1] = np->rect.position.y;
-
-					buffer[(0 * 4 * 4) + 2] = source.position.x * texpixel_size.x;
-					buffer[(0 * 4 * 4) + 3] = source.position.y * texpixel_size.y;
-
-					buffer[(0 * 4 * 4) + 4] = np->rect.position.x + np->margin[MARGIN_LEFT];
-					buffer[(0 * 4 * 4) + 5] = np->rect.position.y;
-
-					buffer[(0 * 4 * 4) + 6] = (source.position.x + np->margin[MARGIN_LEFT]) * texpixel_size.x;
-					buffer[(0 * 4 * 4) + 7] = source.position.y * texpixel_size.y;
-
-					buffer[(0 * 4 * 4) + 8] = np->rect.position.x + np->rect.size.x - np->margin[MARGIN_RIGHT];
-					buffer[(0 * 4 * 4) + 9] = np->rect.position.y;
-
-					buffer[(0 * 4 * 4) + 10] = (source.position.x + source.size.x - np->margin[MARGIN_RIGHT]) * texpixel_size.x;
-					buffer[(0 * 4 * 4) + 11] = source.position.y * texpixel_size.y;
-
-					buffer[(0 * 4 * 4) + 12] = np->rect.position.x + np->rect.size.x;
-					buffer[(0 * 4 * 4) + 13] = np->rect.position.y;
-
-					buffer[(0 * 4 * 4) + 14] = (source.position.x + source.size.x) * texpixel_size.x;
-					buffer[(0 * 4 * 4) + 15] = source.position.y * texpixel_size.y;
-
-					// second row
-
-					buffer[(1 * 4 * 4) + 0] = np->rect.position.x;
-					buffer[(1 * 4 * 4) + 1] = np->rect.position.y + np->margin[MARGIN_TOP];
-
-					buffer[(1 * 4 * 4) + 2] = source.position.x * texpixel_size.x;
-					buffer[(1 * 4 * 4) + 3] = (source.position.y + np->margin[MARGIN_TOP]) * texpixel_size.y;
-
-					buffer[(1 * 4 * 4) + 4] = np->rect.position.x + np->margin[MARGIN_LEFT];
-					buffer[(1 * 4 * 4) + 5] = np->rect.position.y + np->margin[MARGIN_TOP];
-
-					buffer[(1 * 4 * 4) + 6] = (source.position.x + np->margin[MARGIN_LEFT]) * texpixel_size.x;
-					buffer[(1 * 4 * 4) + 7] = (source.position.y + np->margin[MARGIN_TOP]) * texpixel_size.y;
-
-					buffer[(1 * 4 * 4) + 8] = np->rect.position.x + np->rect.size.x - np->margin[MARGIN_RIGHT];
-					buffer[(1 * 4 * 4) + 9] = np->rect.position.y + np->margin[MARGIN_TOP];
-
-					buffer[(1 * 4 * 4) + 10] = (source.position.x + source.size.x - np->margin[MARGIN_RIGHT]) * texpixel_size.x;
-					buffer[(1 * 4 * 4) + 11] = (source.position.y + np->margin[MARGIN_TOP]) * texpixel_size.y;
-
-					buffer[(1 * 4 * 4) + 12] = np->rect.position.x + np->rect.size.x;
-					buffer[(1 * 4 * 4) + 13] = np->rect.position.y + np->margin[MARGIN_TOP];
-
-					buffer[(1 * 4 * 4) + 14] = (source.position.x + source.size.x) * texpixel_size.x;
-					buffer[(1 * 4 * 4) + 15] = (source.position.y + np->margin[MARGIN_TOP]) * texpixel_size.y;
-
-					// third row
-
-					buffer[(2 * 4 * 4) + 0] = np->rect.position.x;
-					buffer[(2 * 4 * 4) + 1] = np->rect.position.y + np->rect.size.y - np->margin[MARGIN_BOTTOM];
-
-					buffer[(2 * 4 * 4) + 2] = source.position.x * texpixel_size.x;
-					buffer[(2 * 4 * 4) + 3] = (source.position.y + source.size.y - np->margin[MARGIN_BOTTOM]) * texpixel_size.y;
-
-					buffer[(2 * 4 * 4) + 4] = np->rect.position.x + np->margin[MARGIN_LEFT];
-					buffer[(2 * 4 * 4) + 5] = np->rect.position.y + np->rect.size.y - np->margin[MARGIN_BOTTOM];
-
-					buffer[(2 * 4 * 4) + 6] = (source.position.x + np->margin[MARGIN_LEFT]) * texpixel_size.x;
-					buffer[(2 * 4 * 4) + 7] = (source.position.y + source.size.y - np->margin[MARGIN_BOTTOM]) * texpixel_size.y;
-
-					buffer[(2 * 4 * 4) + 8] = np->rect.position.x + np->rect.size.x - np->margin[MARGIN_RIGHT];
-					buffer[(2 * 4 * 4) + 9] = np->rect.position.y + np->rect.size.y - np->margin[MARGIN_BOTTOM];
-
-					buffer[(2 * 4 * 4) + 10] = (source.position.x + source.size.x - np->margin[MARGIN_RIGHT]) * texpixel_size.x;
-					buffer[(2 * 4 * 4) + 11] = (source.position.y + source.size.y - np->margin[MARGIN_BOTTOM]) * texpixel_size.y;
-
-					buffer[(2 * 4 * 4) + 12] = np->rect.position.x + np->rect.size.x;
-					buffer[(2 * 4 * 4) + 13] = np->rect.position.y + np->rect.size.y - np->margin[MARGIN_BOTTOM];
+				Vector2 points[16];
+				Vector2 uvs[16];
+				_get_ninepatch_grid(np, source, texpixel_size, points, uvs);
 
-					buffer[(2 * 4 * 4) + 14] = (source.position.x + source.size.x) * texpixel_size.x;
-					buffer[(2 * 4 * 4) + 15] = (source.position.y + source.size.y - np->margin[MARGIN_BOTTOM]) * texpixel_size.y;
-
-					// fourth row
-
-					buffer[(3 * 4 * 4) + 0] = np->rect.position.x;
-					buffer[(3 * 4 * 4) + 1] = np->rect.position.y + np->rect.size.y;
-
-					buffer[(3 * 4 * 4) + 2] = source.position.x * texpixel_size.x;
-					buffer[(3 * 4 * 4) + 3] = (source.position.y + source.size.y) * texpixel_size.y;
-
-					buffer[(3 * 4 * 4) + 4] = np->rect.position.x + np->margin[MARGIN_LEFT];
-					buffer[(3 * 4 * 4) + 5] = np->rect.position.y + np->rect.size.y;
-
-					buffer[(3 * 4 * 4) + 6] = (source.position.x + np->margin[MARGIN_LEFT]) * texpixel_size.x;
-					buffer[(3 * 4 * 4) + 7] = (source.position.y + source.size.y) * texpixel_size.y;
-
-					buffer[(3 * 4 * 4) + 8] = np->rect.position.x + np->rect.size.x - np->margin[MARGIN_RIGHT];
-					buffer[(3 * 4 * 4) + 9] = np->rect.position.y + np->rect.size.y;
-
-					buffer[(3 * 4 * 4) + 10] = (source.position.x + source.size.x - np->margin[MARGIN_RIGHT]) * texpixel_size.x;
-					buffer[(3 * 4 * 4) + 11] = (source.position.y + source.size.y) * texpixel_size.y;
-
-					buffer[(3 * 4 * 4) + 12] = np->rect.position.x + np->rect.size.x;
-					buffer[(3 * 4 * 4) + 13] = np->rect.position.y + np->rect.size.y;
+				float buffer[16 * 2 + 16 * 2];
 
-					buffer[(3 * 4 * 4) + 14] = (source.position.x + source.size.x) * texpixel_size.x;
-					buffer[(3 * 4 * 4) + 15] = (source.position.y + source.size.y) * texpixel_size.y;
+				for (int j = 0; j < 16; j++) {
+					buffer[j * 4 + 0] = points[j].x;
+					buffer[j * 4 + 1] = points[j].y;
+					buffer[j * 4 + 2] = uvs[j].x;
+					buffer[j * 4 + 3] = uvs[j].y;
 				}
 
 				glBindBuffer(GL_ARRAY_BUFFER, data.ninepatch_vertices);
@@ -770,6 +834,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 				glVertexAttribPointer(VS::ARRAY_TEX_UV, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (uint8_t *)0 + (sizeof(float) * 2));
 
 				glDrawElements(GL_TRIANGLES, 18 * 3 - (np->draw_center ? 0 : 6), GL_UNSIGNED_BYTE, NULL);
+				storage->info.render.draw_call_count++;
 
 				glBindBuffer(GL_ARRAY_BUFFER, 0);
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -877,8 +942,10 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 
 						if (s->index_array_len > 0) {
 							glDrawElements(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0);
+							storage->info.render.draw_call_count++;
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
+							storage->info.render.draw_call_count++;
 						}
 					}
 
@@ -998,8 +1065,10 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 
 						if (s->index_array_len > 0) {
 							glDrawElements(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, 0);
+							storage->info.render.draw_call_count++;
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
+							storage->info.render.draw_call_count++;
 						}
 					}
 				}
@@ -1113,6 +1182,11 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 			} break;
 		}
 	}
+
+	// a batch in canvas space stays open, the next item may add to it
+	if (!batch.canvas_space || reclip) {
+		_batch_flush();
+	}
 }
 
 void RasterizerCanvasGLES2::_copy_texscreen(const Rect2 &p_rect) {
@@ -1145,6 +1219,17 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 
 		Item *ci = p_item_list;
 
+		if (batch.vertex_count) {
+			// the open batch is in canvas space, it takes this item's commands too
+			// unless the clip, material, skeleton or modulate differ
+			Item *owner = ci->material_owner ? ci->material_owner : ci;
+			Color modulate(ci->final_modulate.r * p_modulate.r, ci->final_modulate.g * p_modulate.g, ci->final_modulate.b * p_modulate.b, ci->final_modulate.a * p_modulate.a);
+			bool join = ci->final_clip_owner == current_clip && !ci->copy_back_buffer && !ci->skeleton.is_valid() && !storage->material_owner.getornull(owner->material) && modulate == state.uniforms.final_modulate;
+			if (!join) {
+				_batch_flush();
+			}
+		}
+
 		if (current_clip != ci->final_clip_owner) {
 
 			current_clip = ci->final_clip_owner;
@@ -1333,6 +1418,9 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 
 		_set_uniforms();
 
+		// lights redraw the item in local space, so only unlit items without a material are batched across items
+		batch.canvas_space = batch.enabled && !material_ptr && !skeleton && !p_light;
+
 		if (unshaded || (state.uniforms.final_modulate.a > 0.001 && (!shader_cache || shader_cache->canvas_item.light_mode != RasterizerStorageGLES2::Shader::CanvasItem::LIGHT_MODE_LIGHT_ONLY) && !ci->light_masked))
 			_canvas_item_render_commands(p_item_list, NULL, reclip, material_ptr);
 
@@ -1502,6 +1590,8 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 		p_item_list = p_item_list->next;
 	}
 
+	_batch_flush();
+
 	if (current_clip) {
 		glDisable(GL_SCISSOR_TEST);
 	}
@@ -1763,52 +1853,7 @@ void RasterizerCanvasGLES2::initialize() {
 		// element buffer
 		glGenBuffers(1, &data.ninepatch_elements);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ninepatch_elements);
-
-#define _EIDX(y, x) (y * 4 + x)
-		uint8_t elems[3 * 2 * 9] = {
-
-			// first row
-
-			_EIDX(0, 0), _EIDX(0, 1), _EIDX(1, 1),
-			_EIDX(1, 1), _EIDX(1, 0), _EIDX(0, 0),
-
-			_EIDX(0, 1), _EIDX(0, 2), _EIDX(1, 2),
-			_EIDX(1, 2), _EIDX(1, 1), _EIDX(0, 1),
-
-			_EIDX(0, 2), _EIDX(0, 3), _EIDX(1, 3),
-			_EIDX(1, 3), _EIDX(1, 2), _EIDX(0, 2),
-
-			// second row
-
-			_EIDX(1, 0), _EIDX(1, 1), _EIDX(2, 1),
-			_EIDX(2, 1), _EIDX(2, 0), _EIDX(1, 0),
-
-			// the center one would be here, but we'll put it at the end
-			// so it's easier to disable the center and be able to use
-			// one draw call for both
-
-			_EIDX(1, 2), _EIDX(1, 3), _EIDX(2, 3),
-			_EIDX(2, 3), _EIDX(2, 2), _EIDX(1, 2),
-
-			// third row
-
-			_EIDX(2, 0), _EIDX(2, 1), _EIDX(3, 1),
-			_EIDX(3, 1), _EIDX(3, 0), _EIDX(2, 0),
-
-			_EIDX(2, 1), _EIDX(2, 2), _EIDX(3, 2),
-			_EIDX(3, 2), _EIDX(3, 1), _EIDX(2, 1),
-
-			_EIDX(2, 2), _EIDX(2, 3), _EIDX(3, 3),
-			_EIDX(3, 3), _EIDX(3, 2), _EIDX(2, 2),
-
-			// center field
-
-			_EIDX(1, 1), _EIDX(1, 2), _EIDX(2, 2),
-			_EIDX(2, 2), _EIDX(2, 1), _EIDX(1, 1)
-		};
-#undef _EIDX
-
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elems), elems, GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(ninepatch_indices), ninepatch_indices, GL_STATIC_DRAW);
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
@@ -1824,10 +1869,31 @@ void RasterizerCanvasGLES2::initialize() {
 	state.lens_shader.init();
 
 	state.canvas_shader.set_conditional(CanvasShaderGLES2::USE_PIXEL_SNAP, GLOBAL_DEF("rendering/quality/2d/use_pixel_snap", false));
+
+	batch.enabled = GLOBAL_DEF("rendering/quality/2d/use_batching", true);
+	batch.max_vertices = data.polygon_buffer_size / sizeof(BatchVertex);
+	batch.vertices = memnew_arr(BatchVertex, batch.max_vertices);
+	batch.vertex_count = 0;
+	batch.texture_ptr = NULL;
+	batch.material = NULL;
+	batch.canvas_space = false;
 }
 
 void RasterizerCanvasGLES2::finalize() {
+
+	if (batch.vertices) {
+		memdelete_arr(batch.vertices);
+		batch.vertices = NULL;
+	}
 }
 
 RasterizerCanvasGLES2::RasterizerCanvasGLES2() {
+
+	batch.enabled = false;
+	batch.vertices = NULL;
+	batch.vertex_count = 0;
+	batch.max_vertices = 0;
+	batch.texture_ptr = NULL;
+	batch.material = NULL;
+	batch.canvas_space = false;
 }
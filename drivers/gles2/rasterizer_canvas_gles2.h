@@ -93,6 +93,25 @@ public:
 
 	} state;
 
+	// consecutive rects, ninepatches and polygons sharing a texture are merged into a single draw call,
+	// across canvas items too when their vertices can be transformed on the CPU (see canvas_space)
+	struct Batch {
+
+		bool enabled;
+		BatchVertex *vertices;
+		int vertex_count;
+		int max_vertices;
+
+		RID texture;
+		RID normal_map;
+		RasterizerStorageGLES2::Texture *texture_ptr;
+		Size2 texpixel_size;
+		RasterizerStorageGLES2::Material *material;
+		bool canvas_space; // vertices are in canvas space, drawn without the item matrices
+		Transform2D transform; // from the current item's commands to the batch vertices
+
+	} batch;
+
 	typedef void Texture;
 
 	RasterizerSceneGLES2 *scene_render;
@@ -112,6 +131,11 @@ public:
 	_FORCE_INLINE_ void _draw_polygon(const int *p_indices, int p_index_count, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor, const float *p_weights = NULL, const int *p_bones = NULL);
 	_FORCE_INLINE_ void _draw_generic(GLuint p_primitive, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor);
 
+	_FORCE_INLINE_ RasterizerStorageGLES2::Texture *_batch_get_texture(const RID &p_texture);
+	_FORCE_INLINE_ BatchVertex *_batch_alloc(const RID &p_texture, const RID &p_normal_map, const Size2 &p_texpixel_size, int p_vertex_count);
+	_FORCE_INLINE_ bool _batch_add_command(Item::Command *p_command);
+	void _batch_flush();
+
 	_FORCE_INLINE_ void _canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip, RasterizerStorageGLES2::Material *p_material);
 	_FORCE_INLINE_ void _copy_texscreen(const Rect2 &p_rect);
 
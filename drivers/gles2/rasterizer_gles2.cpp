@@ -465,6 +465,8 @@ void RasterizerGLES2::end_frame(bool p_swap_buffers) {
 }
 
 void RasterizerGLES2::finalize() {
+
+	canvas->finalize();
 }
 
 Rasterizer *RasterizerGLES2::_create_current() {
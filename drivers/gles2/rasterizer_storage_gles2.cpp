@@ -4622,7 +4622,19 @@ int RasterizerStorageGLES2::get_captured_render_info(VS::RenderInfo p_info) {
 }
 
 int RasterizerStorageGLES2::get_render_info(VS::RenderInfo p_info) {
-	return 0;
+
+	switch (p_info) {
+		case VS::INFO_DRAW_CALLS_IN_FRAME:
+			return info.render_final.draw_call_count; // only canvas draws are counted for now
+		case VS::INFO_VIDEO_MEM_USED:
+			return info.vertex_mem + info.texture_mem;
+		case VS::INFO_TEXTURE_MEM_USED:
+			return info.texture_mem;
+		case VS::INFO_VERTEX_MEM_USED:
+			return info.vertex_mem;
+		default:
+			return 0; //no idea
+	}
 }
 
 void RasterizerStorageGLES2::initialize() {
@@ -144,6 +144,9 @@ void RasterizerCanvasGLES3::light_internal_free(RID p_rid) {
 
 void RasterizerCanvasGLES3::canvas_begin() {
 
+	// read every frame, so batched and unbatched output can be compared at runtime
+	batch.enabled = GLOBAL_GET("rendering/quality/2d/use_batching");
+
 	if (storage->frame.current_rt && storage->frame.clear_request) {
 		// a clear request may be pending, so do it
 
@@ -184,6 +187,7 @@ void RasterizerCanvasGLES3::canvas_begin() {
 	state.using_texture_rect = true;
 	state.using_ninepatch = false;
 	state.using_skeleton = false;
+	state.using_light_pass = false;
 }
 
 void RasterizerCanvasGLES3::canvas_end() {
@@ -394,6 +398,7 @@ void RasterizerCanvasGLES3::_draw_polygon(const int *p_indices, int p_index_coun
 	glDrawElements(GL_TRIANGLES, p_index_count, GL_UNSIGNED_INT, 0);
 
 	storage->frame.canvas_draw_commands++;
+	storage->info.render.draw_call_count++;
 
 	if (p_bones && p_weights) {
 		//not used so often, so disable when used
@@ -447,6 +452,7 @@ void RasterizerCanvasGLES3::_draw_generic(GLuint p_primitive, int p_vertex_count
 	glDrawArrays(p_primitive, 0, p_vertex_count);
 
 	storage->frame.canvas_draw_commands++;
+	storage->info.render.draw_call_count++;
 
 	glBindVertexArray(0);
 }
@@ -507,6 +513,7 @@ void RasterizerCanvasGLES3::_draw_gui_primitive(int p_points, const Vector2 *p_v
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	storage->frame.canvas_draw_commands++;
+	storage->info.render.draw_call_count++;
 }
 
 static const GLenum gl_primitive[] = {
@@ -519,6 +526,237 @@ static const GLenum gl_primitive[] = {
 	GL_TRIANGLE_FAN
 };
 
+RasterizerStorageGLES3::Texture *RasterizerCanvasGLES3::_batch_get_texture(const RID &p_texture) {
+
+	if (batch.vertex_count && p_texture == batch.texture)
+		return batch.texture_ptr;
+
+	RasterizerStorageGLES3::Texture *texture = storage->texture_owner.getornull(p_texture);
+	return texture ? texture->get_ptr() : NULL;
+}
+
+RasterizerCanvasGLES3::BatchVertex *RasterizerCanvasGLES3::_batch_alloc(const RID &p_texture, const RID &p_normal_map, const Size2 &p_texpixel_size, int p_vertex_count) {
+
+	if (p_vertex_count > batch.max_vertices)
+		return NULL; // too large to batch, draw on its own
+
+	if (batch.vertex_count) {
+		if (p_texture != batch.texture || p_normal_map != batch.normal_map || p_texpixel_size != batch.texpixel_size || batch.vertex_count + p_vertex_count > batch.max_vertices) {
+			_batch_flush();
+		}
+	}
+
+	if (!batch.vertex_count) {
+		batch.texture_ptr = _batch_get_texture(p_texture);
+		batch.texture = p_texture;
+		batch.normal_map = p_normal_map;
+		batch.texpixel_size = p_texpixel_size;
+	}
+
+	BatchVertex *vertices = &batch.vertices[batch.vertex_count];
+	batch.vertex_count += p_vertex_count;
+	return vertices;
+}
+
+void RasterizerCanvasGLES3::_batch_add_quad(BatchVertex *p_vertices, const Vector2 p_points[4], const Vector2 p_uvs[4], const Color &p_color) {
+
+	static const int quad_indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	for (int i = 0; i < 6; i++) {
+		p_vertices[i].vertex = p_points[quad_indices[i]];
+		p_vertices[i].color = p_color;
+		p_vertices[i].uv = p_uvs[quad_indices[i]];
+	}
+}
+
+bool RasterizerCanvasGLES3::_batch_add_command(Item::Command *p_command) {
+
+	switch (p_command->type) {
+
+		case Item::Command::TYPE_RECT: {
+
+			Item::CommandRect *rect = static_cast<Item::CommandRect *>(p_command);
+
+			if (rect->flags & CANVAS_RECT_CLIP_UV)
+				return false; // clipping is done by the texture rect shader
+			if (state.using_light_pass && rect->flags & (CANVAS_RECT_FLIP_H | CANVAS_RECT_FLIP_V | CANVAS_RECT_TRANSPOSE))
+				return false; // the texture rect shader also flips the normals for lighting
+
+			RasterizerStorageGLES3::Texture *texture = _batch_get_texture(rect->texture);
+			if (texture && rect->flags & CANVAS_RECT_TILE && !(texture->flags & VS::TEXTURE_FLAG_REPEAT))
+				return false; // repeat is enabled just for this draw
+
+			Size2 texpixel_size = texture ? Size2(1.0 / texture->width, 1.0 / texture->height) : Size2(1, 1);
+			BatchVertex *vertices = _batch_alloc(rect->texture, rect->normal_map, texpixel_size, 6);
+			if (!vertices)
+				return false;
+
+			Rect2 dst_rect = rect->rect;
+			if (dst_rect.size.width < 0) {
+				dst_rect.position.x += dst_rect.size.width;
+				dst_rect.size.width *= -1;
+			}
+			if (dst_rect.size.height < 0) {
+				dst_rect.position.y += dst_rect.size.height;
+				dst_rect.size.height *= -1;
+			}
+
+			Rect2 src_rect = Rect2(0, 0, 1, 1);
+			bool flip_h = false;
+			bool flip_v = false;
+			bool transpose = false;
+
+			if (texture) {
+				if (rect->flags & CANVAS_RECT_REGION) {
+					src_rect = Rect2(rect->source.position * texpixel_size, rect->source.size * texpixel_size);
+				}
+				flip_h = rect->flags & CANVAS_RECT_FLIP_H;
+				flip_v = rect->flags & CANVAS_RECT_FLIP_V;
+				transpose = rect->flags & CANVAS_RECT_TRANSPOSE;
+			}
+
+			// same mapping as the texture rect shader, flips mirror the vertices and transpose swaps the uvs
+			static const Vector2 corners[4] = { Vector2(0, 0), Vector2(1, 0), Vector2(1, 1), Vector2(0, 1) };
+			Vector2 points[4];
+			Vector2 uvs[4];
+
+			for (int i = 0; i < 4; i++) {
+				const Vector2 &corner = corners[i];
+				points[i] = dst_rect.position + dst_rect.size * Vector2(flip_h ? 1.0 - corner.x : corner.x, flip_v ? 1.0 - corner.y : corner.y);
+				uvs[i] = src_rect.position + src_rect.size * (transpose ? Vector2(corner.y, corner.x) : corner);
+			}
+
+			_batch_add_quad(vertices, points, uvs, rect->modulate);
+			return true;
+
+		} break;
+		case Item::Command::TYPE_NINEPATCH: {
+
+			Item::CommandNinePatch *np = static_cast<Item::CommandNinePatch *>(p_command);
+
+			if (np->axis_x != VS::NINE_PATCH_STRETCH || np->axis_y != VS::NINE_PATCH_STRETCH)
+				return false; // tiling is done by the ninepatch shader
+
+			RasterizerStorageGLES3::Texture *texture = _batch_get_texture(np->texture);
+			if (!texture)
+				return false;
+
+			Rect2 source = np->source != Rect2() ? np->source : Rect2(0, 0, texture->width, texture->height);
+			const Rect2 &dst = np->rect;
+			float margin_left = np->margin[MARGIN_LEFT];
+			float margin_top = np->margin[MARGIN_TOP];
+			float margin_right = np->margin[MARGIN_RIGHT];
+			float margin_bottom = np->margin[MARGIN_BOTTOM];
+
+			if (dst.size.width < margin_left + margin_right || dst.size.height < margin_top + margin_bottom)
+				return false; // margins overlap, the shader handles it differently
+
+			BatchVertex *vertices = _batch_alloc(np->texture, np->normal_map, Size2(1.0 / source.size.width, 1.0 / source.size.height), np->draw_center ? 9 * 6 : 8 * 6);
+			if (!vertices)
+				return false;
+
+			// margins are drawn at their pixel size, the rest is stretched
+			Size2 texpixel_size(1.0 / texture->width, 1.0 / texture->height);
+			float x[4] = { dst.position.x, dst.position.x + margin_left, dst.position.x + dst.size.width - margin_right, dst.position.x + dst.size.width };
+			float y[4] = { dst.position.y, dst.position.y + margin_top, dst.position.y + dst.size.height - margin_bottom, dst.position.y + dst.size.height };
+			float u[4] = { source.position.x, source.position.x + margin_left, source.position.x + source.size.width - margin_right, source.position.x + source.size.width };
+			float v[4] = { source.position.y, source.position.y + margin_top, source.position.y + source.size.height - margin_bottom, source.position.y + source.size.height };
+
+			for (int j = 0; j < 3; j++) {
+				for (int i = 0; i < 3; i++) {
+
+					if (i == 1 && j == 1 && !np->draw_center)
+						continue;
+
+					Vector2 points[4] = {
+						Vector2(x[i], y[j]),
+						Vector2(x[i + 1], y[j]),
+						Vector2(x[i + 1], y[j + 1]),
+						Vector2(x[i], y[j + 1])
+					};
+					Vector2 uvs[4] = {
+						Vector2(u[i], v[j]) * texpixel_size,
+						Vector2(u[i + 1], v[j]) * texpixel_size,
+						Vector2(u[i + 1], v[j + 1]) * texpixel_size,
+						Vector2(u[i], v[j + 1]) * texpixel_size
+					};
+
+					_batch_add_quad(vertices, points, uvs, np->color);
+					vertices += 6;
+				}
+			}
+			return true;
+
+		} break;
+		case Item::Command::TYPE_POLYGON: {
+
+			Item::CommandPolygon *polygon = static_cast<Item::CommandPolygon *>(p_command);
+
+			if (polygon->bones.size() && polygon->weights.size())
+				return false;
+#ifdef GLES_OVER_GL
+			if (polygon->antialiased)
+				return false;
+#endif
+
+			RasterizerStorageGLES3::Texture *texture = _batch_get_texture(polygon->texture);
+			Size2 texpixel_size = texture ? Size2(1.0 / texture->width, 1.0 / texture->height) : Size2(1, 1);
+			BatchVertex *vertices = _batch_alloc(polygon->texture, polygon->normal_map, texpixel_size, polygon->count);
+			if (!vertices)
+				return false;
+
+			const int *indices = polygon->indices.ptr();
+			const Vector2 *points = polygon->points.ptr();
+			const Vector2 *uvs = polygon->uvs.ptr();
+			const Color *colors = polygon->colors.ptr();
+			int color_count = polygon->colors.size();
+
+			for (int i = 0; i < polygon->count; i++) {
+
+				int index = indices[i];
+				vertices[i].vertex = points[index];
+				vertices[i].color = color_count == 1 ? colors[0] : (color_count ? colors[index] : Color(1, 1, 1, 1));
+				vertices[i].uv = uvs ? uvs[index] : Vector2();
+			}
+			return true;
+
+		} break;
+		default: {
+		}
+	}
+
+	return false;
+}
+
+void RasterizerCanvasGLES3::_batch_flush() {
+
+	if (!batch.vertex_count)
+		return;
+
+	_set_texture_rect_mode(false);
+	_bind_canvas_texture(batch.texture, batch.normal_map);
+	state.canvas_shader.set_uniform(CanvasShaderGLES3::COLOR_TEXPIXEL_SIZE, batch.texpixel_size);
+
+	if (state.using_skeleton) {
+		glVertexAttribI4ui(VS::ARRAY_BONES, 0, 0, 0, 0);
+		glVertexAttrib4f(VS::ARRAY_WEIGHTS, 0, 0, 0, 0);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, data.polygon_buffer);
+	//orphan the old contents, so there is no need to wait for the previous draw
+	glBufferData(GL_ARRAY_BUFFER, data.polygon_buffer_size, NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(BatchVertex) * batch.vertex_count, batch.vertices);
+	glBindVertexArray(data.polygon_buffer_quad_arrays[3]); //vertex, color and uv
+	glDrawArrays(GL_TRIANGLES, 0, batch.vertex_count);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	storage->frame.canvas_draw_commands++;
+	storage->info.render.draw_call_count++;
+
+	batch.vertex_count = 0;
+}
+
 void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip) {
 
 	int cc = p_item->commands.size();
@@ -528,6 +766,13 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 
 		Item::Command *c = commands[i];
 
+		if (batch.enabled) {
+			if (_batch_add_command(c))
+				continue;
+
+			_batch_flush();
+		}
+
 		switch (c->type) {
 			case Item::Command::TYPE_LINE: {
 
@@ -713,6 +958,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 				}
 
 				storage->frame.canvas_draw_commands++;
+				storage->info.render.draw_call_count++;
 
 			} break;
 
@@ -756,6 +1002,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
 				storage->frame.canvas_draw_commands++;
+				storage->info.render.draw_call_count++;
 			} break;
 
 			case Item::Command::TYPE_PRIMITIVE: {
@@ -830,6 +1077,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
 						}
+						storage->info.render.draw_call_count++;
 
 						glBindVertexArray(0);
 					}
@@ -943,6 +1191,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 					} else {
 						glDrawArraysInstanced(gl_primitive[s->primitive], 0, s->array_len, amount);
 					}
+					storage->info.render.draw_call_count++;
 
 					glBindVertexArray(0);
 				}
@@ -1024,6 +1273,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 					glVertexAttribDivisor(12, 1);
 
 					glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, amount);
+					storage->info.render.draw_call_count++;
 				} else {
 					//split
 
@@ -1048,6 +1298,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 						glVertexAttribDivisor(12, 1);
 
 						glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, amount - split);
+						storage->info.render.draw_call_count++;
 					}
 
 					if (split > 0) {
@@ -1068,6 +1319,7 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 						glVertexAttribDivisor(12, 1);
 
 						glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, split);
+						storage->info.render.draw_call_count++;
 					}
 				}
 
@@ -1140,6 +1392,8 @@ void RasterizerCanvasGLES3::_canvas_item_render_commands(Item *p_item, Item *cur
 			} break;
 		}
 	}
+
+	_batch_flush();
 }
 
 void RasterizerCanvasGLES3::_copy_texscreen(const Rect2 &p_rect) {
@@ -1597,7 +1851,9 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
 					}
 
 					glActiveTexture(GL_TEXTURE0);
+					state.using_light_pass = true;
 					_canvas_item_render_commands(ci, current_clip, reclip); //redraw using light
+					state.using_light_pass = false;
 				}
 
 				light = light->next_ptr;
@@ -2107,6 +2363,12 @@ void RasterizerCanvasGLES3::initialize() {
 	state.canvas_shadow_shader.set_conditional(CanvasShadowShaderGLES3::USE_RGBA_SHADOWS, storage->config.use_rgba_2d_shadows);
 
 	state.canvas_shader.set_conditional(CanvasShaderGLES3::USE_PIXEL_SNAP, GLOBAL_DEF("rendering/quality/2d/use_pixel_snap", false));
+
+	batch.enabled = GLOBAL_DEF("rendering/quality/2d/use_batching", true);
+	batch.max_vertices = data.polygon_buffer_size / sizeof(BatchVertex);
+	batch.vertices = memnew_arr(BatchVertex, batch.max_vertices);
+	batch.vertex_count = 0;
+	batch.texture_ptr = NULL;
 }
 
 void RasterizerCanvasGLES3::finalize() {
@@ -2118,7 +2380,18 @@ void RasterizerCanvasGLES3::finalize() {
 	glDeleteVertexArrays(1, &data.canvas_quad_array);
 
 	glDeleteVertexArrays(1, &data.polygon_buffer_pointer_array);
+
+	if (batch.vertices) {
+		memdelete_arr(batch.vertices);
+		batch.vertices = NULL;
+	}
 }
 
 RasterizerCanvasGLES3::RasterizerCanvasGLES3() {
+
+	state.using_light_pass = false;
+	batch.enabled = false;
+	batch.vertices = NULL;
+	batch.vertex_count = 0;
+	batch.max_vertices = 0;
 }
@@ -91,8 +91,32 @@ public:
 		Transform2D skeleton_transform;
 		Transform2D skeleton_transform_inverse;
 
+		bool using_light_pass;
+
 	} state;
 
+	// consecutive rects, ninepatches and polygons sharing a texture are merged into a single draw call
+	struct BatchVertex {
+
+		Vector2 vertex;
+		Color color;
+		Vector2 uv;
+	};
+
+	struct Batch {
+
+		bool enabled;
+		BatchVertex *vertices;
+		int vertex_count;
+		int max_vertices;
+
+		RID texture;
+		RID normal_map;
+		RasterizerStorageGLES3::Texture *texture_ptr;
+		Size2 texpixel_size;
+
+	} batch;
+
 	RasterizerStorageGLES3 *storage;
 
 	struct LightInternal : public RID_Data {
@@ -132,6 +156,12 @@ public:
 	_FORCE_INLINE_ void _draw_polygon(const int *p_indices, int p_index_count, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor, const int *p_bones, const float *p_weights);
 	_FORCE_INLINE_ void _draw_generic(GLuint p_primitive, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor);
 
+	_FORCE_INLINE_ RasterizerStorageGLES3::Texture *_batch_get_texture(const RID &p_texture);
+	_FORCE_INLINE_ BatchVertex *_batch_alloc(const RID &p_texture, const RID &p_normal_map, const Size2 &p_texpixel_size, int p_vertex_count);
+	_FORCE_INLINE_ void _batch_add_quad(BatchVertex *p_vertices, const Vector2 p_points[4], const Vector2 p_uvs[4], const Color &p_color);
+	_FORCE_INLINE_ bool _batch_add_command(Item::Command *p_command);
+	void _batch_flush();
+
 	_FORCE_INLINE_ void _canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip);
 	_FORCE_INLINE_ void _copy_texscreen(const Rect2 &p_rect);
 
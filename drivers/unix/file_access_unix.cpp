@@ -39,6 +39,7 @@
 #include <sys/types.h>
 
 #if defined(UNIX_ENABLED)
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -66,6 +67,7 @@ void FileAccessUnix::check_errors() const {
 
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 
+	_unmap();
 	if (f)
 		fclose(f);
 	f = NULL;
@@ -126,6 +128,7 @@ void FileAccessUnix::close() {
 	if (!f)
 		return;
 
+	_unmap();
 	fclose(f);
 	f = NULL;
 
@@ -227,6 +230,43 @@ int FileAccessUnix::get_buffer(uint8_t *p_dst, int p_length) const {
 	return read;
 };
 
+const uint8_t *FileAccessUnix::get_mapped_buffer() {
+
+#if defined(UNIX_ENABLED)
+	if (mapped)
+		return mapped;
+
+	ERR_FAIL_COND_V(!f, NULL);
+	if (flags != READ)
+		return NULL;
+
+	size_t len = get_len();
+	if (len == 0)
+		return NULL;
+
+	void *m = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (m == MAP_FAILED)
+		return NULL;
+
+	mapped = (uint8_t *)m;
+	mapped_len = len;
+	return mapped;
+#else
+	return NULL;
+#endif
+}
+
+void FileAccessUnix::_unmap() {
+
+#if defined(UNIX_ENABLED)
+	if (mapped) {
+		munmap(mapped, mapped_len);
+		mapped = NULL;
+		mapped_len = 0;
+	}
+#endif
+}
+
 Error FileAccessUnix::get_error() const {
 
 	return last_error;
@@ -312,6 +352,8 @@ CloseNotificationFunc FileAccessUnix::close_notification_func = NULL;
 FileAccessUnix::FileAccessUnix() :
 		f(NULL),
 		flags(0),
+		mapped(NULL),
+		mapped_len(0),
 		last_error(OK) {
 }
 
@@ -48,7 +48,10 @@ class FileAccessUnix : public FileAccess {
 
 	FILE *f;
 	int flags;
+	uint8_t *mapped;
+	size_t mapped_len;
 	void check_errors() const;
+	void _unmap();
 	mutable Error last_error;
 	String save_path;
 	String path;
@@ -75,6 +78,7 @@ public:
 
 	virtual uint8_t get_8() const; ///< get a byte
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *get_mapped_buffer();
 
 	virtual Error get_error() const; ///< get last error
 
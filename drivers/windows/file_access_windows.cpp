@@ -35,6 +35,7 @@
 #include "core/os/os.h"
 #include "core/print_string.h"
 
+#include <io.h>
 #include <shlwapi.h>
 #include <windows.h>
 
@@ -130,6 +131,7 @@ void FileAccessWindows::close() {
 	if (!f)
 		return;
 
+	_unmap();
 	fclose(f);
 	f = NULL;
 
@@ -251,6 +253,46 @@ int FileAccessWindows::get_buffer(uint8_t *p_dst, int p_length) const {
 	return read;
 };
 
+const uint8_t *FileAccessWindows::get_mapped_buffer() {
+
+#ifndef UWP_ENABLED
+	if (mapped)
+		return mapped;
+
+	ERR_FAIL_COND_V(!f, NULL);
+	if (flags != READ)
+		return NULL;
+
+	if (get_len() == 0)
+		return NULL;
+
+	HANDLE file = (HANDLE)_get_osfhandle(_fileno(f));
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+		return NULL;
+
+	// the view keeps the mapping object alive
+	mapped = (uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	return mapped;
+#else
+	return NULL;
+#endif
+}
+
+void FileAccessWindows::_unmap() {
+
+#ifndef UWP_ENABLED
+	if (mapped) {
+		UnmapViewOfFile(mapped);
+		mapped = NULL;
+	}
+#endif
+}
+
 Error FileAccessWindows::get_error() const {
 
 	return last_error;
@@ -310,6 +352,7 @@ uint64_t FileAccessWindows::_get_modified_time(const String &p_file) {
 FileAccessWindows::FileAccessWindows() :
 		f(NULL),
 		flags(0),
+		mapped(NULL),
 		last_error(OK) {
 }
 FileAccessWindows::~FileAccessWindows() {
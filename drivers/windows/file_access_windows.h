@@ -46,7 +46,9 @@ class FileAccessWindows : public FileAccess {
 
 	FILE *f;
 	int flags;
+	uint8_t *mapped;
 	void check_errors() const;
+	void _unmap();
 	mutable Error last_error;
 	String path;
 	String path_src;
@@ -69,6 +71,7 @@ public:
 
 	virtual uint8_t get_8() const; ///< get a byte
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *get_mapped_buffer();
 
 	virtual Error get_error() const; ///< get last error
 
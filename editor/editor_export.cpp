@@ -31,6 +31,7 @@
 #include "editor_export.h"
 
 #include "core/io/config_file.h"
+#include "core/io/file_access_pack.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/io/zip_io.h"
@@ -292,8 +293,20 @@ Error EditorExportPlatform::_save_pack_file(void *p_userdata, const String &p_pa
 	sd.path_utf8 = p_path.utf8();
 	sd.ofs = pd->f->get_position();
 	sd.size = p_data.size();
+	sd.compressed = false;
+
+	if (pd->compress) {
+		Vector<uint8_t> stored = PackedSourcePCK::compress_file(p_data.ptr(), p_data.size());
+		if (stored.size()) {
+			pd->f->store_buffer(stored.ptr(), stored.size());
+			sd.size = stored.size();
+			sd.compressed = true;
+		}
+	}
 
-	pd->f->store_buffer(p_data.ptr(), p_data.size());
+	if (!sd.compressed) {
+		pd->f->store_buffer(p_data.ptr(), p_data.size());
+	}
 	int pad = _get_pad(PCK_PADDING, sd.size);
 	for (int i = 0; i < pad; i++) {
 		pd->f->store_8(0);
@@ -372,6 +385,8 @@ Ref<EditorExportPreset> EditorExportPlatform::create_preset() {
 
 	List<ExportOption> options;
 	get_export_options(&options);
+	// every platform writes its pack with save_pack()
+	options.push_back(ExportOption(PropertyInfo(Variant::BOOL, "binary_format/compress_pack"), false));
 
 	for (List<ExportOption>::Element *E = options.front(); E; E = E->next()) {
 
@@ -856,6 +871,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 	pd.ep = &ep;
 	pd.f = ftmp;
 	pd.so_files = p_so_files;
+	pd.compress = p_preset->get("binary_format/compress_pack");
 
 	Error err = export_project_files(p_preset, _save_pack_file, &pd, _add_shared_object);
 
@@ -869,7 +885,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
 	ERR_FAIL_COND_V(!f, ERR_CANT_CREATE)
 	f->store_32(0x43504447); //GDPK
-	f->store_32(1); //pack version
+	f->store_32(pd.compress ? PACK_FORMAT_VERSION : PACK_FORMAT_VERSION_UNCOMPRESSED); //pack version
 	f->store_32(VERSION_MAJOR);
 	f->store_32(VERSION_MINOR);
 	f->store_32(0); //hmph
@@ -891,6 +907,9 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 		header_size += 8; // offset to file _with_ header size included
 		header_size += 8; // size of file
 		header_size += 16; // md5
+		if (pd.compress) {
+			header_size += 4; // flags
+		}
 	}
 
 	size_t header_padding = _get_pad(PCK_PADDING, header_size);
@@ -909,6 +928,9 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 		f->store_64(pd.file_ofs[i].ofs + header_padding + header_size);
 		f->store_64(pd.file_ofs[i].size); // pay attention here, this is where file is
 		f->store_buffer(pd.file_ofs[i].md5.ptr(), 16); //also save md5 for file
+		if (pd.compress) {
+			f->store_32(pd.file_ofs[i].compressed ? PACK_FILE_COMPRESSED : 0);
+		}
 	}
 
 	for (uint32_t j = 0; j < header_padding; j++) {
@@ -148,6 +148,7 @@ private:
 
 		uint64_t ofs;
 		uint64_t size;
+		bool compressed;
 		Vector<uint8_t> md5;
 		CharString path_utf8;
 
@@ -160,6 +161,7 @@ private:
 
 		FileAccess *f;
 		Vector<SavedData> file_ofs;
+		bool compress;
 		EditorProgress *ep;
 		Vector<SharedObject> *so_files;
 	};
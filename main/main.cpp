@@ -1987,6 +1987,7 @@ void Main::cleanup() {
 	OS::get_singleton()->_execpath = "";
 	OS::get_singleton()->_local_clipboard = "";
 
+	ResourceLoader::clear_thread_load_tasks();
 	ResourceLoader::clear_translation_remaps();
 	ResourceLoader::clear_path_remaps();
 
@@ -2041,6 +2042,16 @@ void Main::cleanup() {
 		OS::get_singleton()->set_restart_on_exit(false, List<String>()); //clear list (uses memory)
 	}
 
+#if defined(SMALL_ALLOCATOR_ENABLED) && defined(DEBUG_ENABLED)
+	if (OS::get_singleton()->is_stdout_verbose()) {
+		print_line("Small allocator (size: blocks in use / allocations / spans):");
+		for (int i = 0; i < Memory::get_small_alloc_class_count(); i++) {
+			Memory::SmallAllocStats stats = Memory::get_small_alloc_stats(i);
+			print_line("\t" + itos(stats.size) + ": " + itos(stats.used) + " / " + itos(stats.allocs) + " / " + itos(stats.spans));
+		}
+	}
+#endif
+
 	unregister_core_driver_types();
 	unregister_core_types();
 
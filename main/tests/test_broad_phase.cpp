@@ -0,0 +1,378 @@
+/*************************************************************************/
+/*  test_broad_phase.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_broad_phase.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/set.h"
+#include "servers/physics/broad_phase_bvh.h"
+#include "servers/physics/broad_phase_octree.h"
+#include "servers/physics/collision_object_sw.h"
+
+namespace TestBroadPhase {
+
+class BenchmarkObject : public CollisionObjectSW {
+
+protected:
+	virtual void _shapes_changed() {}
+
+public:
+	int index;
+
+	virtual void set_space(SpaceSW *p_space) {}
+
+	BenchmarkObject() :
+			CollisionObjectSW(TYPE_BODY) {
+		index = 0;
+	}
+};
+
+// pair state as reported by the callbacks of one broadphase
+struct PairTracker {
+
+	Set<uint64_t> pairs;
+	Set<uint64_t> paired; // since the last clear_events()
+	Set<uint64_t> unpaired;
+	int pair_events;
+	int unpair_events;
+	bool consistent; // no pair reported twice, no unpair without a pair
+
+	static uint64_t key(CollisionObjectSW *A, CollisionObjectSW *B) {
+
+		uint32_t a = static_cast<BenchmarkObject *>(A)->index;
+		uint32_t b = static_cast<BenchmarkObject *>(B)->index;
+		if (a > b) {
+			SWAP(a, b);
+		}
+		return (uint64_t(a) << 32) | b;
+	}
+
+	static void *pair_callback(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_userdata) {
+
+		PairTracker *self = (PairTracker *)p_userdata;
+		uint64_t k = key(A, B);
+		if (self->pairs.has(k)) {
+			self->consistent = false;
+		}
+		self->pairs.insert(k);
+		self->paired.insert(k);
+		self->pair_events++;
+		return NULL;
+	}
+
+	static void unpair_callback(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+		PairTracker *self = (PairTracker *)p_userdata;
+		uint64_t k = key(A, B);
+		if (!self->pairs.has(k)) {
+			self->consistent = false;
+		}
+		self->pairs.erase(k);
+		self->unpaired.insert(k);
+		self->unpair_events++;
+	}
+
+	void clear_events() {
+
+		paired.clear();
+		unpaired.clear();
+	}
+
+	PairTracker() {
+		pair_events = 0;
+		unpair_events = 0;
+		consistent = true;
+	}
+};
+
+// runs the octree and the BVH side by side on the same scene and checks they agree on the pairs.
+// the octree pairs exactly the overlapping proxies, the BVH keeps a pair until the fat AABBs
+// separate, so its pairs are a superset and it only pairs when the octree does.
+static bool compare(int p_proxies, int p_static_proxies, int p_steps) {
+
+	BroadPhaseSW *broad_phases[2] = { BroadPhaseOctree::_create(), BroadPhaseBVH::_create() };
+	PairTracker trackers[2];
+	PairTracker &octree = trackers[0];
+	PairTracker &bvh = trackers[1];
+
+	for (int k = 0; k < 2; k++) {
+		broad_phases[k]->set_pair_callback(PairTracker::pair_callback, &trackers[k]);
+		broad_phases[k]->set_unpair_callback(PairTracker::unpair_callback, &trackers[k]);
+	}
+
+	RandomPCG rng(0x5678);
+	real_t world_size = Math::pow(p_proxies * 8.0, 1.0 / 3.0);
+	Vector3 box_size(1, 1, 1);
+	int count = p_proxies + p_static_proxies;
+
+	Vector<BenchmarkObject *> objects;
+	Vector<BroadPhaseSW::ID> ids[2];
+	Vector<Vector3> positions;
+	Vector<Vector3> velocities;
+
+	for (int i = 0; i < count; i++) {
+
+		BenchmarkObject *object = memnew(BenchmarkObject);
+		object->index = i;
+		objects.push_back(object);
+
+		Vector3 pos(rng.randf() * world_size, rng.randf() * world_size, rng.randf() * world_size);
+		positions.push_back(pos);
+		velocities.push_back(Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * 4.0);
+
+		for (int k = 0; k < 2; k++) {
+			BroadPhaseSW::ID id = broad_phases[k]->create(object);
+			ids[k].push_back(id);
+			broad_phases[k]->set_static(id, i >= p_proxies);
+			broad_phases[k]->move(id, AABB(pos, box_size));
+		}
+	}
+
+	bool pass = true;
+	const real_t delta = 1.0 / 60.0;
+
+	for (int step = 0; step <= p_steps; step++) {
+
+		if (step > 0) {
+
+			for (int k = 0; k < 2; k++) {
+				trackers[k].clear_events();
+			}
+
+			for (int i = 0; i < p_proxies; i++) {
+
+				Vector3 &pos = positions.write[i];
+				Vector3 &vel = velocities.write[i];
+				pos += vel * delta;
+				for (int j = 0; j < 3; j++) {
+					if (pos[j] < 0 || pos[j] > world_size) {
+						vel[j] = -vel[j];
+					}
+				}
+				for (int k = 0; k < 2; k++) {
+					broad_phases[k]->move(ids[k][i], AABB(pos, box_size));
+				}
+			}
+		}
+
+		for (int k = 0; k < 2; k++) {
+			broad_phases[k]->update();
+		}
+
+		for (Set<uint64_t>::Element *E = octree.pairs.front(); E; E = E->next()) {
+			pass = pass && bvh.pairs.has(E->get());
+		}
+		for (Set<uint64_t>::Element *E = bvh.paired.front(); E; E = E->next()) {
+			pass = pass && octree.paired.has(E->get());
+		}
+		for (Set<uint64_t>::Element *E = bvh.unpaired.front(); E; E = E->next()) {
+			pass = pass && !octree.pairs.has(E->get());
+		}
+	}
+
+	// final pairs against brute force, static proxies do not pair with each other
+	int overlaps = 0;
+	for (int i = 0; i < p_proxies; i++) {
+
+		AABB a(positions[i], box_size);
+		for (int j = i + 1; j < count; j++) {
+
+			uint64_t k = (uint64_t(i) << 32) | j;
+			bool overlap = a.intersects(AABB(positions[j], box_size));
+			overlaps += overlap;
+			pass = pass && octree.pairs.has(k) == overlap;
+			if (!overlap && bvh.pairs.has(k)) {
+				// the fat AABB grows a unit box by 0.1 on each side, and the box may have moved by as much inside it
+				pass = pass && a.grow(0.2).intersects(AABB(positions[j], box_size).grow(0.2));
+			}
+		}
+	}
+	pass = pass && octree.pairs.size() == overlaps;
+	pass = pass && octree.consistent && bvh.consistent;
+
+	for (int i = 0; i < count; i++) {
+		for (int k = 0; k < 2; k++) {
+			broad_phases[k]->remove(ids[k][i]);
+		}
+		memdelete(objects[i]);
+	}
+	for (int k = 0; k < 2; k++) {
+		memdelete(broad_phases[k]);
+	}
+
+	// removing the proxies unpairs everything
+	pass = pass && octree.pairs.empty() && bvh.pairs.empty();
+	pass = pass && octree.consistent && bvh.consistent;
+
+	OS::get_singleton()->print("	overlaps at end: %i; octree: %i pair, %i unpair events; BVH: %i pair, %i unpair events\n", overlaps, octree.pair_events, octree.unpair_events, bvh.pair_events, bvh.unpair_events);
+
+	return pass;
+}
+
+struct Benchmark {
+
+	int pairs;
+	int pair_events;
+	int unpair_events;
+
+	static void *pair_callback(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_userdata) {
+
+		Benchmark *self = (Benchmark *)p_userdata;
+		self->pairs++;
+		self->pair_events++;
+		return NULL;
+	}
+
+	static void unpair_callback(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+		Benchmark *self = (Benchmark *)p_userdata;
+		self->pairs--;
+		self->unpair_events++;
+	}
+
+	uint64_t run(BroadPhaseSW *p_broad_phase, int p_proxies, int p_static_proxies, int p_steps) {
+
+		pairs = 0;
+		pair_events = 0;
+		unpair_events = 0;
+
+		p_broad_phase->set_pair_callback(pair_callback, this);
+		p_broad_phase->set_unpair_callback(unpair_callback, this);
+
+		// same seed for every broadphase, so they all see the same scene
+		RandomPCG rng(0x1234);
+
+		// keep density constant, about one proxy per 8 cubic units
+		real_t world_size = Math::pow(p_proxies * 8.0, 1.0 / 3.0);
+		Vector3 box_size(1, 1, 1);
+
+		Vector<BenchmarkObject *> objects;
+		Vector<BroadPhaseSW::ID> ids;
+		Vector<Vector3> positions;
+		Vector<Vector3> velocities;
+
+		for (int i = 0; i < p_proxies + p_static_proxies; i++) {
+
+			BenchmarkObject *object = memnew(BenchmarkObject);
+			objects.push_back(object);
+			BroadPhaseSW::ID id = p_broad_phase->create(object);
+			ids.push_back(id);
+
+			Vector3 pos(rng.randf() * world_size, rng.randf() * world_size, rng.randf() * world_size);
+			positions.push_back(pos);
+			velocities.push_back(Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * 4.0);
+
+			p_broad_phase->set_static(id, i >= p_proxies);
+			p_broad_phase->move(id, AABB(pos, box_size));
+		}
+		p_broad_phase->update();
+
+		CollisionObjectSW *results[256];
+		int result_indices[256];
+		int culled = 0;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+		const real_t delta = 1.0 / 60.0;
+		for (int step = 0; step < p_steps; step++) {
+
+			for (int i = 0; i < p_proxies; i++) {
+
+				Vector3 &pos = positions.write[i];
+				Vector3 &vel = velocities.write[i];
+				pos += vel * delta;
+				for (int j = 0; j < 3; j++) {
+					if (pos[j] < 0 || pos[j] > world_size) {
+						vel[j] = -vel[j];
+					}
+				}
+				p_broad_phase->move(ids[i], AABB(pos, box_size));
+			}
+
+			p_broad_phase->update();
+
+			// a few queries per step, like raycasts from game code
+			for (int i = 0; i < 64; i++) {
+				Vector3 from = positions[rng.rand() % p_proxies];
+				culled += p_broad_phase->cull_segment(from, from + Vector3(10, 0, 0), results, 256, result_indices);
+				culled += p_broad_phase->cull_aabb(AABB(from, Vector3(4, 4, 4)), results, 256, result_indices);
+			}
+		}
+
+		uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+		int final_pairs = pairs;
+
+		for (int i = 0; i < ids.size(); i++) {
+			p_broad_phase->remove(ids[i]);
+			memdelete(objects[i]);
+		}
+
+		OS::get_singleton()->print("\t\tpairs at end: %i, pair events: %i, unpair events: %i, culled: %i\n", final_pairs, pair_events, unpair_events, culled);
+
+		return elapsed;
+	}
+};
+
+MainLoop *test() {
+
+	static const int proxy_counts[] = { 1000, 10000, 20000, 0 };
+	const int steps = 60;
+
+	OS::get_singleton()->print("Comparing octree and BVH pairs\n");
+	bool pass = compare(2000, 500, 240);
+	OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+	for (int i = 0; proxy_counts[i]; i++) {
+
+		int proxies = proxy_counts[i];
+		int static_proxies = proxies / 4;
+
+		OS::get_singleton()->print("%i moving proxies, %i static, %i steps\n", proxies, static_proxies, steps);
+
+		Benchmark benchmark;
+
+		BroadPhaseSW *octree = BroadPhaseOctree::_create();
+		OS::get_singleton()->print("\tOctree:\n");
+		uint64_t octree_time = benchmark.run(octree, proxies, static_proxies, steps);
+		memdelete(octree);
+		OS::get_singleton()->print("\t\t%.2f ms/step\n", octree_time / 1000.0 / steps);
+
+		BroadPhaseSW *bvh = BroadPhaseBVH::_create();
+		OS::get_singleton()->print("\tBVH:\n");
+		uint64_t bvh_time = benchmark.run(bvh, proxies, static_proxies, steps);
+		memdelete(bvh);
+		OS::get_singleton()->print("\t\t%.2f ms/step\n", bvh_time / 1000.0 / steps);
+	}
+
+	return NULL;
+}
+
+} // namespace TestBroadPhase
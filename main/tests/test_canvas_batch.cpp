@@ -0,0 +1,221 @@
+/*************************************************************************/
+/*  test_canvas_batch.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_canvas_batch.h"
+
+#include "core/os/os.h"
+#include "servers/visual/rasterizer.h"
+
+namespace TestCanvasBatch {
+
+typedef RasterizerCanvas::BatchVertex BatchVertex;
+
+// a 64x32 texture
+static const Size2 texpixel_size(1.0 / 64, 1.0 / 32);
+
+static bool equal(const Vector2 &p_a, const Vector2 &p_b) {
+
+	return Math::is_equal_approx(p_a.x, p_b.x) && Math::is_equal_approx(p_a.y, p_b.y);
+}
+
+// what the immediate path draws for a rect: a fan over the 4 points
+static bool check_rect(const RasterizerCanvas::Item::CommandRect &p_rect, bool p_textured, const Transform2D &p_xform) {
+
+	Vector2 points[4];
+	RasterizerCanvas::_get_rect_points(p_rect.rect, points);
+	Vector2 uvs[4] = { Vector2(0, 0), Vector2(1, 0), Vector2(1, 1), Vector2(0, 1) };
+	if (p_textured) {
+		RasterizerCanvas::_get_rect_uvs(&p_rect, texpixel_size, uvs);
+	}
+
+	BatchVertex vertices[6];
+	RasterizerCanvas::_get_rect_batch_vertices(&p_rect, p_textured, texpixel_size, p_xform, vertices);
+
+	bool ok = true;
+	for (int i = 0; i < 2; i++) {
+		int fan[3] = { 0, i + 1, i + 2 };
+		for (int j = 0; j < 3; j++) {
+			const BatchVertex &v = vertices[i * 3 + j];
+			ok = ok && equal(v.vertex, p_xform.xform(points[fan[j]]));
+			ok = ok && equal(v.uv, uvs[fan[j]]);
+			ok = ok && v.color == p_rect.modulate;
+		}
+	}
+	return ok;
+}
+
+// what the immediate path draws for a ninepatch: the grid through the index buffer
+static bool check_ninepatch(const RasterizerCanvas::Item::CommandNinePatch &p_np, const Rect2 &p_source, const Transform2D &p_xform) {
+
+	Vector2 points[16];
+	Vector2 uvs[16];
+	RasterizerCanvas::_get_ninepatch_grid(&p_np, p_source, texpixel_size, points, uvs);
+
+	BatchVertex vertices[54];
+	int count = RasterizerCanvas::_get_ninepatch_batch_vertices(&p_np, p_source, texpixel_size, p_xform, vertices);
+
+	bool ok = count == 18 * 3 - (p_np.draw_center ? 0 : 6);
+	for (int i = 0; i < count && ok; i++) {
+		int index = RasterizerCanvas::ninepatch_indices[i];
+		ok = ok && equal(vertices[i].vertex, p_xform.xform(points[index]));
+		ok = ok && equal(vertices[i].uv, uvs[index]);
+		ok = ok && vertices[i].color == p_np.color;
+	}
+
+	// the triangles cover the rect once, less the center when it isn't drawn
+	float area = 0;
+	for (int i = 0; i < count; i += 3) {
+		area += Math::abs((points[RasterizerCanvas::ninepatch_indices[i + 1]] - points[RasterizerCanvas::ninepatch_indices[i]]).cross(points[RasterizerCanvas::ninepatch_indices[i + 2]] - points[RasterizerCanvas::ninepatch_indices[i]])) * 0.5;
+	}
+	Rect2 center(points[5], points[10] - points[5]);
+	float expected = p_np.rect.get_area() - (p_np.draw_center ? 0 : center.get_area());
+	ok = ok && Math::is_equal_approx(area, expected);
+
+	return ok;
+}
+
+static RasterizerCanvas::Item::CommandRect make_rect(const Rect2 &p_rect, uint8_t p_flags) {
+
+	RasterizerCanvas::Item::CommandRect rect;
+	rect.rect = p_rect;
+	rect.source = Rect2(8, 4, 16, 8);
+	rect.modulate = Color(1, 0.5, 0.25, 0.75);
+	rect.flags = p_flags;
+	return rect;
+}
+
+static bool test_rects() {
+
+	const Rect2 rects[] = { Rect2(10, 20, 30, 40), Rect2(10, 20, -30, 40), Rect2(10, 20, 30, -40), Rect2(10, 20, -30, -40) };
+	const uint8_t flags[] = {
+		0,
+		RasterizerCanvas::CANVAS_RECT_FLIP_H,
+		RasterizerCanvas::CANVAS_RECT_FLIP_V,
+		RasterizerCanvas::CANVAS_RECT_TRANSPOSE,
+		RasterizerCanvas::CANVAS_RECT_FLIP_H | RasterizerCanvas::CANVAS_RECT_TRANSPOSE,
+		RasterizerCanvas::CANVAS_RECT_REGION,
+		RasterizerCanvas::CANVAS_RECT_REGION | RasterizerCanvas::CANVAS_RECT_FLIP_V | RasterizerCanvas::CANVAS_RECT_TRANSPOSE,
+	};
+	// an item transform, and an item transform with a transform command on top
+	const Transform2D xforms[] = { Transform2D(), Transform2D(0.5, Vector2(100, -50)), Transform2D(0.5, Vector2(100, -50)) * Transform2D(-1.25, Vector2(3, 7)) };
+
+	bool ok = true;
+	for (int r = 0; r < 4; r++) {
+		for (int f = 0; f < 7; f++) {
+			for (int x = 0; x < 3; x++) {
+				ok = ok && check_rect(make_rect(rects[r], flags[f]), true, xforms[x]);
+				ok = ok && check_rect(make_rect(rects[r], flags[f]), false, xforms[x]);
+			}
+		}
+	}
+
+	// the helpers themselves, on known values
+	Vector2 points[4];
+	Vector2 uvs[4];
+	RasterizerCanvas::_get_rect_points(Rect2(10, 20, -30, 40), points);
+	ok = ok && equal(points[0], Vector2(40, 20)) && equal(points[1], Vector2(10, 20));
+
+	RasterizerCanvas::Item::CommandRect rect = make_rect(Rect2(0, 0, 1, 1), RasterizerCanvas::CANVAS_RECT_FLIP_H);
+	RasterizerCanvas::_get_rect_uvs(&rect, texpixel_size, uvs);
+	ok = ok && equal(uvs[0], Vector2(1, 0)) && equal(uvs[2], Vector2(0, 1));
+
+	rect.flags = RasterizerCanvas::CANVAS_RECT_TRANSPOSE;
+	RasterizerCanvas::_get_rect_uvs(&rect, texpixel_size, uvs);
+	ok = ok && equal(uvs[1], Vector2(0, 1)) && equal(uvs[3], Vector2(1, 0));
+
+	rect.flags = RasterizerCanvas::CANVAS_RECT_REGION;
+	RasterizerCanvas::_get_rect_uvs(&rect, texpixel_size, uvs);
+	ok = ok && equal(uvs[0], Vector2(0.125, 0.125)) && equal(uvs[2], Vector2(0.375, 0.375));
+
+	return ok;
+}
+
+static bool test_ninepatches() {
+
+	RasterizerCanvas::Item::CommandNinePatch np;
+	np.rect = Rect2(5, 10, 200, 100);
+	np.margin[MARGIN_LEFT] = 4;
+	np.margin[MARGIN_TOP] = 6;
+	np.margin[MARGIN_RIGHT] = 8;
+	np.margin[MARGIN_BOTTOM] = 10;
+	np.color = Color(0.5, 1, 1, 0.5);
+
+	const Rect2 sources[] = { Rect2(0, 0, 64, 32), Rect2(16, 8, 32, 16) };
+	const Transform2D xforms[] = { Transform2D(), Transform2D(0.5, Vector2(100, -50)) * Transform2D(-1.25, Vector2(3, 7)) };
+
+	bool ok = true;
+	for (int c = 0; c < 2; c++) {
+		np.draw_center = c == 0;
+		for (int s = 0; s < 2; s++) {
+			for (int x = 0; x < 2; x++) {
+				ok = ok && check_ninepatch(np, sources[s], xforms[x]);
+			}
+		}
+	}
+
+	// the corners keep their size in both the rect and the texture
+	Vector2 points[16];
+	Vector2 uvs[16];
+	RasterizerCanvas::_get_ninepatch_grid(&np, sources[1], texpixel_size, points, uvs);
+	ok = ok && equal(points[5], Vector2(9, 16)) && equal(points[10], Vector2(197, 100));
+	ok = ok && equal(uvs[0], Vector2(0.25, 0.25)) && equal(uvs[5], Vector2(20.0 / 64, 14.0 / 32)) && equal(uvs[15], Vector2(0.75, 0.75));
+
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_rects,
+	test_ninepatches,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestCanvasBatch
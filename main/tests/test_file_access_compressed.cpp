@@ -0,0 +1,316 @@
+/*************************************************************************/
+/*  test_file_access_compressed.cpp                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_file_access_compressed.h"
+
+#include "core/io/compression.h"
+#include "core/io/file_access_compressed.h"
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+
+namespace TestFileAccessCompressed {
+
+enum {
+	BLOCK_SIZE = 4096
+};
+
+// A small dictionary trained with `zstd --train --maxdict=256` on lines like the ones make_data() writes.
+static const uint8_t dictionary_data[] = {
+	0x37, 0xa4, 0x30, 0xec, 0xf5, 0xa6, 0x7a, 0x16, 0x09, 0x10, 0x10, 0xdf, 0x30, 0x33, 0x33, 0xb3,
+	0x77, 0x0a, 0x33, 0xf1, 0x78, 0x3c, 0x1e, 0x8f, 0xc7, 0xe3, 0xf1, 0x78, 0x3c, 0xcf, 0xf3, 0xbc,
+	0xf7, 0xd4, 0x42, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41,
+	0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0xa1, 0x50, 0x28, 0x14,
+	0x0a, 0x85, 0x42, 0xa1, 0x50, 0x28, 0x14, 0x0a, 0x85, 0xa2, 0x28, 0x8a, 0xa2, 0x28, 0x4a, 0x29,
+	0x7d, 0x74, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xe1,
+	0xe1, 0xe1, 0xe1, 0xe1, 0xe1, 0xf1, 0x78, 0x3c, 0x1e, 0x8f, 0xc7, 0xe3, 0xf1, 0x78, 0x9e, 0xe7,
+	0x79, 0xef, 0x01, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x6c,
+	0x5f, 0x33, 0x22, 0x20, 0x3d, 0x20, 0x35, 0x32, 0x5d, 0x20, 0x5b, 0x73, 0x63, 0x72, 0x69, 0x70,
+	0x74, 0x20, 0x22, 0x70, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x30, 0x22, 0x20, 0x3d,
+	0x20, 0x38, 0x34, 0x5d, 0x20, 0x5b, 0x6e, 0x6f, 0x64, 0x65, 0x20, 0x22, 0x73, 0x68, 0x61, 0x64,
+	0x65, 0x37, 0x5d, 0x20, 0x5b, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x22, 0x76, 0x65, 0x63,
+	0x74, 0x6f, 0x72, 0x5f, 0x37, 0x22, 0x20, 0x3d, 0x20, 0x35, 0x36, 0x5d, 0x20, 0x5b, 0x76, 0x65,
+	0x63, 0x74, 0x6f, 0x72, 0x20, 0x22, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x5f, 0x37, 0x22, 0x20,
+	0x3d, 0x20, 0x37, 0x37, 0x5d, 0x20, 0x5b, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x66, 0x6f, 0x72, 0x6d,
+	0x20, 0x22, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x5f, 0x32, 0x22, 0x20, 0x3d, 0x20, 0x34, 0x30,
+};
+
+static Vector<uint8_t> make_data(int p_size, uint32_t p_seed) {
+
+	static const char *words[] = { "node", "shader", "script", "texture", "material", "signal", "vector", "transform" };
+
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	RandomPCG rng(p_seed);
+	int ofs = 0;
+	while (ofs < p_size) {
+		String item = "[" + String(words[rng.rand() % 8]) + " \"" + String(words[rng.rand() % 8]) + "_" + itos(rng.rand() % 8) + "\" = " + itos(rng.rand() % 100) + "] ";
+		CharString utf8 = item.utf8();
+		for (int i = 0; i < utf8.length() && ofs < p_size; i++) {
+			data.write[ofs++] = utf8[i];
+		}
+	}
+	return data;
+}
+
+static String get_path(const String &p_name) {
+
+	return OS::get_singleton()->get_user_data_dir().plus_file("test_file_access_compressed_" + p_name + ".bin");
+}
+
+static bool write_file(const String &p_path, const Vector<uint8_t> &p_data, Compression::Mode p_mode, bool p_use_dictionary, uint32_t p_seed) {
+
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->configure("GCPF", p_mode, BLOCK_SIZE, p_use_dictionary);
+	if (fac->_open(p_path, FileAccess::WRITE) != OK) {
+		memdelete(fac);
+		return false;
+	}
+
+	// pieces of any length, and single bytes, so writes cross block boundaries every way
+	RandomPCG rng(p_seed);
+	int ofs = 0;
+	while (ofs < p_data.size()) {
+		if (rng.rand() % 4 == 0) {
+			fac->store_8(p_data[ofs++]);
+		} else {
+			int length = rng.rand() % (BLOCK_SIZE * 3);
+			length = MIN(length, p_data.size() - ofs);
+			fac->store_buffer(p_data.ptr() + ofs, length);
+			ofs += length;
+		}
+	}
+
+	fac->close();
+	memdelete(fac);
+	return true;
+}
+
+static FileAccessCompressed *open_file(const String &p_path, Compression::Mode p_mode) {
+
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->configure("GCPF", p_mode, BLOCK_SIZE);
+	if (fac->_open(p_path, FileAccess::READ) != OK) {
+		memdelete(fac);
+		return NULL;
+	}
+	return fac;
+}
+
+static bool check_sequential(FileAccess *p_file, const Vector<uint8_t> &p_data, uint32_t p_seed) {
+
+	bool ok = p_file->get_len() == (size_t)p_data.size();
+	ok = ok && p_file->get_position() == 0;
+	ok = ok && !p_file->eof_reached();
+
+	Vector<uint8_t> read;
+	read.resize(BLOCK_SIZE * 3);
+
+	// reads ending exactly at the end don't reach EOF, the next one does
+	RandomPCG rng(p_seed);
+	int ofs = 0;
+	while (ok && ofs < p_data.size()) {
+		int length = rng.rand() % 3 == 0 ? 1 : rng.rand() % (BLOCK_SIZE * 3);
+		int expected = MIN(length, p_data.size() - ofs);
+
+		ok = ok && p_file->get_buffer(read.ptrw(), length) == expected;
+		ok = ok && (expected == 0 || memcmp(read.ptr(), p_data.ptr() + ofs, expected) == 0);
+		ofs += expected;
+		ok = ok && p_file->get_position() == (size_t)ofs;
+		ok = ok && p_file->eof_reached() == (length > expected);
+	}
+
+	p_file->get_8();
+	ok = ok && p_file->eof_reached();
+	ok = ok && p_file->get_position() == (size_t)p_data.size();
+
+	return ok;
+}
+
+static bool check_seeks(FileAccess *p_file, const Vector<uint8_t> &p_data, uint32_t p_seed) {
+
+	Vector<uint8_t> read;
+	read.resize(BLOCK_SIZE * 80);
+
+	RandomPCG rng(p_seed);
+	bool ok = true;
+	for (int i = 0; i < 200 && ok; i++) {
+
+		// mostly short reads anywhere, sometimes long ones spanning several windows
+		int from = rng.rand() % (p_data.size() + 1);
+		int length = rng.rand() % (i % 10 == 0 ? BLOCK_SIZE * 80 : BLOCK_SIZE);
+		int expected = MIN(length, p_data.size() - from);
+
+		if (i % 3 == 0) {
+			p_file->seek_end(from - p_data.size());
+		} else {
+			p_file->seek(from);
+		}
+		ok = ok && p_file->get_position() == (size_t)from;
+		ok = ok && !p_file->eof_reached();
+
+		ok = ok && p_file->get_buffer(read.ptrw(), length) == expected;
+		ok = ok && (expected == 0 || memcmp(read.ptr(), p_data.ptr() + from, expected) == 0);
+		ok = ok && p_file->get_position() == (size_t)(from + expected);
+		ok = ok && p_file->eof_reached() == (length > expected);
+	}
+
+	return ok;
+}
+
+static bool test_round_trips() {
+
+	const int sizes[] = { 0, 1, BLOCK_SIZE * 8, BLOCK_SIZE * 8 + 123, BLOCK_SIZE * 70 + 5 };
+	const Compression::Mode modes[] = { Compression::MODE_ZSTD, Compression::MODE_DEFLATE, Compression::MODE_FASTLZ, Compression::MODE_GZIP };
+	String path = get_path("round_trip");
+
+	bool ok = true;
+	for (int m = 0; m < 4 && ok; m++) {
+		for (int s = 0; s < 5 && ok; s++) {
+
+			uint32_t seed = m * 5 + s;
+			Vector<uint8_t> data = make_data(sizes[s], seed);
+			ok = write_file(path, data, modes[m], false, seed);
+
+			FileAccessCompressed *fac = ok ? open_file(path, modes[m]) : NULL;
+			ok = fac && check_sequential(fac, data, seed) && check_seeks(fac, data, seed);
+			if (fac)
+				memdelete(fac);
+		}
+	}
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(path);
+	memdelete(da);
+
+	return ok;
+}
+
+static bool test_without_worker_threads() {
+
+	// blocks are decoded and read ahead by the waiting thread alone, as with NO_THREADS
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	int thread_count = pool->get_thread_count();
+	pool->finish();
+	pool->init(0);
+
+	bool ok = test_round_trips();
+
+	pool->finish();
+	pool->init(thread_count);
+
+	return ok;
+}
+
+static bool test_dictionary() {
+
+	Vector<uint8_t> dictionary;
+	dictionary.resize(sizeof(dictionary_data));
+	copymem(dictionary.ptrw(), dictionary_data, sizeof(dictionary_data));
+	ERR_FAIL_COND_V(Compression::set_zstd_dictionary(dictionary) != OK, false);
+
+	String with_path = get_path("with_dictionary");
+	String without_path = get_path("without_dictionary");
+	Vector<uint8_t> with_data = make_data(BLOCK_SIZE * 8 + 123, 1);
+	Vector<uint8_t> without_data = make_data(BLOCK_SIZE * 8 + 45, 2);
+
+	bool ok = write_file(with_path, with_data, Compression::MODE_ZSTD, true, 1);
+	ok = ok && write_file(without_path, without_data, Compression::MODE_ZSTD, false, 2);
+
+	// frames with and without the dictionary read back side by side
+	FileAccessCompressed *with_file = open_file(with_path, Compression::MODE_ZSTD);
+	FileAccessCompressed *without_file = open_file(without_path, Compression::MODE_ZSTD);
+	ok = ok && with_file && without_file;
+	ok = ok && check_sequential(with_file, with_data, 3) && check_sequential(without_file, without_data, 4);
+	ok = ok && check_seeks(without_file, without_data, 5) && check_seeks(with_file, with_data, 6);
+	if (with_file)
+		memdelete(with_file);
+	if (without_file)
+		memdelete(without_file);
+
+	// once the dictionary is gone only the file written without it still reads
+	Compression::set_zstd_dictionary(Vector<uint8_t>());
+	Compression::clear_zstd_dictionaries();
+
+	without_file = open_file(without_path, Compression::MODE_ZSTD);
+	ok = ok && without_file && check_sequential(without_file, without_data, 7);
+	if (without_file)
+		memdelete(without_file);
+
+	with_file = open_file(with_path, Compression::MODE_ZSTD);
+	if (with_file) {
+		Vector<uint8_t> read;
+		read.resize(with_data.size());
+		with_file->get_buffer(read.ptrw(), read.size());
+		ok = ok && memcmp(read.ptr(), with_data.ptr(), read.size()) != 0;
+		memdelete(with_file);
+	}
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(with_path);
+	da->remove(without_path);
+	memdelete(da);
+
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_round_trips,
+	test_without_worker_threads,
+	test_dictionary,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestFileAccessCompressed
@@ -40,6 +40,7 @@
 #include "modules/gdscript/gdscript_compiler.h"
 #include "modules/gdscript/gdscript_parser.h"
 #include "modules/gdscript/gdscript_tokenizer.h"
+#include "scene/2d/node_2d.h"
 
 namespace TestGDScript {
 
@@ -563,10 +564,20 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 			switch (code[ip]) {
 
-				case GDScriptFunction::OPCODE_OPERATOR: {
+				case GDScriptFunction::OPCODE_OPERATOR:
+				case GDScriptFunction::OPCODE_OPERATOR_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_REAL:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
 
 					int op = code[ip + 1];
-					txt += "op ";
+					switch (code[ip]) {
+						case GDScriptFunction::OPCODE_OPERATOR_INT: txt += "op-int "; break;
+						case GDScriptFunction::OPCODE_OPERATOR_REAL: txt += "op-real "; break;
+						case GDScriptFunction::OPCODE_OPERATOR_VECTOR2: txt += "op-vector2 "; break;
+						case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: txt += "op-vector3 "; break;
+						default: txt += "op ";
+					}
 
 					String opname = Variant::get_operator_name(Variant::Operator(op));
 
@@ -578,9 +589,10 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr += 5;
 
 				} break;
-				case GDScriptFunction::OPCODE_SET: {
+				case GDScriptFunction::OPCODE_SET:
+				case GDScriptFunction::OPCODE_SET_ARRAY_INDEX: {
 
-					txt += "set ";
+					txt += code[ip] == GDScriptFunction::OPCODE_SET ? "set " : "set-array ";
 					txt += DADDR(1);
 					txt += "[";
 					txt += DADDR(2);
@@ -589,9 +601,10 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr += 4;
 
 				} break;
-				case GDScriptFunction::OPCODE_GET: {
+				case GDScriptFunction::OPCODE_GET:
+				case GDScriptFunction::OPCODE_GET_ARRAY_INDEX: {
 
-					txt += " get ";
+					txt += code[ip] == GDScriptFunction::OPCODE_GET ? " get " : " get-array ";
 					txt += DADDR(3);
 					txt += "=";
 					txt += DADDR(1);
@@ -742,7 +755,7 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 					int argc = code[ip + 1];
 					if (ret) {
-						txt += DADDR(4 + argc) + "=";
+						txt += DADDR(5 + argc) + "=";
 					}
 
 					txt += DADDR(2) + ".";
@@ -752,11 +765,11 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					for (int i = 0; i < argc; i++) {
 						if (i > 0)
 							txt += ", ";
-						txt += DADDR(4 + i);
+						txt += DADDR(5 + i);
 					}
 					txt += ")";
 
-					incr = 5 + argc;
+					incr = 6 + argc;
 
 				} break;
 				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
@@ -879,6 +892,29 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 						txt = "";
 					incr += 2;
 				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_JUMP_IF_NOT: {
+
+					txt += " op " + DADDR(4) + " = " + DADDR(2) + " " + Variant::get_operator_name(Variant::Operator(code[ip + 1])) + " " + DADDR(3);
+					txt += ", jump-if-not " + DADDR(6) + " to " + itos(code[ip + 7]);
+					incr += 8;
+				} break;
+				case GDScriptFunction::OPCODE_GET_MEMBER_OPERATOR: {
+
+					txt += " get_member " + DADDR(2) + "=[\"" + func.get_global_name(code[ip + 1]) + "\"]";
+					txt += ", op " + DADDR(7) + " = " + DADDR(5) + " " + Variant::get_operator_name(Variant::Operator(code[ip + 4])) + " " + DADDR(6);
+					incr += 8;
+				} break;
+				case GDScriptFunction::OPCODE_GET_NAMED_OPERATOR: {
+
+					txt += " get_named " + DADDR(3) + "=" + DADDR(1) + "[\"" + func.get_global_name(code[ip + 2]) + "\"]";
+					txt += ", op " + DADDR(8) + " = " + DADDR(6) + " " + Variant::get_operator_name(Variant::Operator(code[ip + 5])) + " " + DADDR(7);
+					incr += 9;
+				} break;
+				case GDScriptFunction::OPCODE_INCREMENT_LOCAL: {
+
+					txt += " increment " + DADDR(2) + " " + Variant::get_operator_name(Variant::Operator(code[ip + 1])) + " " + DADDR(3);
+					incr += 8;
+				} break;
 				case GDScriptFunction::OPCODE_END: {
 
 					txt += " end";
@@ -906,8 +942,161 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+static const char *benchmark_code =
+		"extends Node2D\n"
+		"\n"
+		"signal step(value)\n"
+		"\n"
+		"var velocity = Vector2(1.5, -2.0)\n"
+		"var offset = Vector2(0.25, 0.5)\n"
+		"var total = 0\n"
+		"\n"
+		"func loop_compare(n):\n"
+		"\tvar i = 0\n"
+		"\twhile i < n:\n"
+		"\t\ti += 1\n"
+		"\treturn i\n"
+		"\n"
+		"func member_math(n):\n"
+		"\tvar acc = 0.0\n"
+		"\tfor i in range(n):\n"
+		"\t\tacc += velocity.x * 2.0\n"
+		"\treturn acc\n"
+		"\n"
+		"func property_math(n):\n"
+		"\tvar acc = Vector2()\n"
+		"\tfor i in range(n):\n"
+		"\t\tacc += position + offset\n"
+		"\treturn acc\n"
+		"\n"
+		"func add(a, b):\n"
+		"\treturn a + b\n"
+		"\n"
+		"func calls(n):\n"
+		"\tvar acc = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tacc = add(acc, i)\n"
+		"\treturn acc\n"
+		"\n"
+		"func typed_loop(n: int) -> int:\n"
+		"\tvar i: int = 0\n"
+		"\twhile i < n:\n"
+		"\t\ti += 1\n"
+		"\treturn i\n"
+		"\n"
+		"func typed_vector_math(n: int) -> Vector2:\n"
+		"\tvar acc: Vector2 = Vector2()\n"
+		"\tvar step: Vector2 = Vector2(0.5, 0.25)\n"
+		"\tvar i: int = 0\n"
+		"\twhile i < n:\n"
+		"\t\tacc = acc + step * 2.0\n"
+		"\t\ti += 1\n"
+		"\treturn acc\n"
+		"\n"
+		"func typed_array(n: int) -> int:\n"
+		"\tvar arr: Array = [1, 2, 3, 4]\n"
+		"\tvar i: int = 0\n"
+		"\twhile i < n:\n"
+		"\t\tvar k: int = i % 4\n"
+		"\t\tarr[k] = arr[k] + 1\n"
+		"\t\ti += 1\n"
+		"\treturn arr[0]\n"
+		"\n"
+		"func typed_calls(n: int) -> float:\n"
+		"\tvar node: Node2D = self\n"
+		"\tvar acc: float = 0.0\n"
+		"\tvar i: int = 0\n"
+		"\twhile i < n:\n"
+		"\t\tacc = acc + node.get_rotation()\n"
+		"\t\ti += 1\n"
+		"\treturn acc\n"
+		"\n"
+		"func yielder(n):\n"
+		"\tvar acc = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tacc += i\n"
+		"\t\tyield()\n"
+		"\treturn acc\n"
+		"\n"
+		"func yields(n):\n"
+		"\tvar state = yielder(n)\n"
+		"\twhile typeof(state) == TYPE_OBJECT:\n"
+		"\t\tstate = state.resume()\n"
+		"\treturn state\n"
+		"\n"
+		"func signal_yielder(n):\n"
+		"\tfor i in range(n):\n"
+		"\t\ttotal += yield(self, \"step\")\n"
+		"\n"
+		"func signal_yields(n):\n"
+		"\ttotal = 0\n"
+		"\tsignal_yielder(n)\n"
+		"\tfor i in range(n):\n"
+		"\t\temit_signal(\"step\", i)\n"
+		"\treturn total\n";
+
+static Ref<GDScript> _benchmark_compile(bool p_lowering) {
+
+	GDScriptParser parser;
+	Error err = parser.parse(benchmark_code);
+	if (err) {
+		print_line("Parse Error:\n" + itos(parser.get_error_line()) + ":" + itos(parser.get_error_column()) + ":" + parser.get_error());
+		return Ref<GDScript>();
+	}
+
+	Ref<GDScript> script;
+	script.instance();
+
+	GDScriptCompiler gdc;
+	gdc.set_lowering_enabled(p_lowering);
+	err = gdc.compile(&parser, script.ptr());
+	if (err) {
+		print_line("Compile Error:\n" + itos(gdc.get_error_line()) + ":" + itos(gdc.get_error_column()) + ":" + gdc.get_error());
+		return Ref<GDScript>();
+	}
+
+	return script;
+}
+
+static void _benchmark() {
+
+	static const char *functions[] = { "loop_compare", "member_math", "property_math", "calls", "typed_loop", "typed_vector_math", "typed_array", "typed_calls", "yields", "signal_yields", NULL };
+	const int iterations = 1000000;
+
+	Ref<GDScript> plain = _benchmark_compile(false);
+	Ref<GDScript> lowered = _benchmark_compile(true);
+	ERR_FAIL_COND(plain.is_null() || lowered.is_null());
+
+	Node2D *plain_node = memnew(Node2D);
+	plain_node->set_script(plain.get_ref_ptr());
+	Node2D *lowered_node = memnew(Node2D);
+	lowered_node->set_script(lowered.get_ref_ptr());
+
+	for (int i = 0; functions[i]; i++) {
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		Variant plain_result = plain_node->call(functions[i], iterations);
+		uint64_t plain_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		from = OS::get_singleton()->get_ticks_usec();
+		Variant lowered_result = lowered_node->call(functions[i], iterations);
+		uint64_t lowered_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		print_line(String(functions[i]) + ": " + itos(plain_usec) + " usec plain, " + itos(lowered_usec) + " usec lowered" + (plain_result == lowered_result ? String() : String(" - RESULT MISMATCH: ") + String(plain_result) + " != " + String(lowered_result)));
+	}
+
+	memdelete(plain_node);
+	memdelete(lowered_node);
+}
+
 MainLoop *test(TestType p_type) {
 
+	if (p_type == TEST_BENCHMARK) {
+
+		_benchmark();
+		return NULL;
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
@@ -34,17 +34,25 @@
 #ifdef DEBUG_ENABLED
 
 #include "test_astar.h"
+#include "test_broad_phase.h"
+#include "test_canvas_batch.h"
+#include "test_file_access_compressed.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_image.h"
 #include "test_math.h"
+#include "test_message_queue.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
+#include "test_pack.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
+#include "test_resource_format_binary.h"
 #include "test_shader_lang.h"
+#include "test_spatial_index.h"
 #include "test_string.h"
+#include "test_worker_thread_pool.h"
 
 const char **tests_get_names() {
 
@@ -53,6 +61,7 @@ const char **tests_get_names() {
 		"math",
 		"physics",
 		"physics_2d",
+		"physics_2d_stress",
 		"render",
 		"oa_hash_map",
 		"gui",
@@ -61,9 +70,18 @@ const char **tests_get_names() {
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_benchmark",
 		"image",
 		"ordered_hash_map",
 		"astar",
+		"broad_phase",
+		"spatial_index",
+		"pack",
+		"file_access_compressed",
+		"canvas_batch",
+		"resource_format_binary",
+		"worker_thread_pool",
+		"message_queue",
 		NULL
 	};
 
@@ -92,6 +110,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_2d_stress") {
+
+		return TestPhysics2D::test_stress();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
@@ -134,6 +157,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
 	if (p_test == "image") {
 
 		return TestImage::test();
@@ -149,6 +177,46 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "broad_phase") {
+
+		return TestBroadPhase::test();
+	}
+
+	if (p_test == "spatial_index") {
+
+		return TestSpatialIndex::test();
+	}
+
+	if (p_test == "pack") {
+
+		return TestPack::test();
+	}
+
+	if (p_test == "file_access_compressed") {
+
+		return TestFileAccessCompressed::test();
+	}
+
+	if (p_test == "canvas_batch") {
+
+		return TestCanvasBatch::test();
+	}
+
+	if (p_test == "resource_format_binary") {
+
+		return TestResourceFormatBinary::test();
+	}
+
+	if (p_test == "worker_thread_pool") {
+
+		return TestWorkerThreadPool::test();
+	}
+
+	if (p_test == "message_queue") {
+
+		return TestMessageQueue::test();
+	}
+
 	return NULL;
 }
 
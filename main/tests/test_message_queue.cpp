@@ -0,0 +1,256 @@
+/*************************************************************************/
+/*  test_message_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_message_queue.h"
+
+#include "core/class_db.h"
+#include "core/message_queue.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+
+namespace TestMessageQueue {
+
+enum {
+	MESSAGES_PER_FRAME = 1000000,
+	MAX_THREADS = 8,
+	MARK_INTERVAL = 1000, // one in every this many messages is a notification
+	NOTIFICATION_MARK = 1000
+};
+
+// Receives the deferred calls of a frame and checks that the messages of every
+// thread arrive in the order they were pushed, and each of them exactly once.
+// The calls to first() and last() are pushed by the main thread around the
+// other threads, so they check the order across threads.
+class Recorder : public Object {
+
+	GDCLASS(Recorder, Object);
+
+	uint32_t next[MAX_THREADS];
+	uint32_t calls;
+	uint32_t expected_calls;
+	uint32_t late_calls;
+	uint32_t errors;
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("record", "thread", "sequence"), &Recorder::record);
+		ClassDB::bind_method(D_METHOD("late"), &Recorder::late);
+		ClassDB::bind_method(D_METHOD("first"), &Recorder::first);
+		ClassDB::bind_method(D_METHOD("last"), &Recorder::last);
+	}
+
+	void _notification(int p_what) {
+
+		if (p_what != NOTIFICATION_MARK)
+			return;
+
+		// only the main thread sends them, in place of a call
+		if (next[0] % MARK_INTERVAL != MARK_INTERVAL - 1) {
+			errors++;
+		}
+		next[0]++;
+		calls++;
+	}
+
+public:
+	void record(int p_thread, int p_sequence) {
+
+		if (p_thread < 0 || p_thread >= MAX_THREADS) {
+			errors++;
+			return;
+		}
+
+		if (uint32_t(p_sequence) != next[p_thread]) {
+			errors++;
+		}
+		next[p_thread] = p_sequence + 1;
+
+		if (calls == 0) {
+			// pushed while flushing, must come after everything already queued
+			MessageQueue::get_singleton()->push_call(this, "late");
+		}
+		calls++;
+	}
+
+	void late() {
+
+		if (calls != expected_calls) {
+			errors++;
+		}
+		late_calls++;
+	}
+
+	void first() {
+
+		if (calls != 0) {
+			errors++;
+		}
+	}
+
+	void last() {
+
+		if (calls != expected_calls) {
+			errors++;
+		}
+	}
+
+	void begin_frame(uint32_t p_expected_calls) {
+
+		for (int i = 0; i < MAX_THREADS; i++) {
+			next[i] = 0;
+		}
+		calls = 0;
+		expected_calls = p_expected_calls;
+		late_calls = 0;
+		errors = 0;
+	}
+
+	bool end_frame(int p_threads, uint32_t p_per_thread) const {
+
+		bool ok = errors == 0 && calls == expected_calls && late_calls == 1;
+		for (int i = 0; i < p_threads; i++) {
+			ok = ok && next[i] == p_per_thread;
+		}
+		return ok;
+	}
+
+	Recorder() {
+		begin_frame(0);
+	}
+};
+
+struct PushData {
+
+	ObjectID target;
+	StringName method;
+	int thread;
+	int count;
+	bool notifications;
+};
+
+static void push_messages(void *p_userdata) {
+
+	PushData *data = (PushData *)p_userdata;
+	MessageQueue *mq = MessageQueue::get_singleton();
+
+	for (int i = 0; i < data->count; i++) {
+		if (data->notifications && i % MARK_INTERVAL == MARK_INTERVAL - 1) {
+			mq->push_notification(data->target, NOTIFICATION_MARK);
+		} else {
+			mq->push_call(data->target, data->method, data->thread, i);
+		}
+	}
+}
+
+// Pushes a frame worth of messages, from the main thread alone or split among
+// p_threads threads, then flushes them.
+static bool run(Recorder *p_recorder, int p_threads, int p_frames) {
+
+	MessageQueue *mq = MessageQueue::get_singleton();
+	int threads = MAX(p_threads, 1);
+	int per_thread = MESSAGES_PER_FRAME / threads;
+
+	PushData data[MAX_THREADS];
+	for (int i = 0; i < threads; i++) {
+		data[i].target = p_recorder->get_instance_id();
+		data[i].method = "record";
+		data[i].thread = i;
+		data[i].count = per_thread;
+		data[i].notifications = p_threads == 0;
+	}
+
+	bool ok = true;
+
+	for (int frame = 0; frame < p_frames; frame++) {
+
+		p_recorder->begin_frame(per_thread * threads);
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+		if (p_threads == 0) {
+			push_messages(&data[0]);
+		} else {
+			mq->push_call(p_recorder, "first");
+
+			Thread *pushers[MAX_THREADS];
+			for (int i = 0; i < p_threads; i++) {
+				pushers[i] = Thread::create(push_messages, &data[i]);
+			}
+			for (int i = 0; i < p_threads; i++) {
+				Thread::wait_to_finish(pushers[i]);
+				memdelete(pushers[i]);
+			}
+
+			mq->push_call(p_recorder, "last");
+		}
+
+		uint64_t pushed = OS::get_singleton()->get_ticks_usec();
+		mq->flush();
+		uint64_t flushed = OS::get_singleton()->get_ticks_usec();
+
+		bool frame_ok = p_recorder->end_frame(p_threads, per_thread);
+		ok = ok && frame_ok;
+
+		// the buffers grow on the first frame only, later ones reuse them
+		OS::get_singleton()->print("\t\tframe %i: push %.2f ms, flush %.2f ms, max buffer usage %i KB, static memory %i KB%s\n",
+				frame, (pushed - begin) / 1000.0, (flushed - pushed) / 1000.0, mq->get_max_buffer_usage() / 1024,
+				OS::get_singleton()->get_static_memory_usage() / 1024, frame_ok ? "" : " (out of order or missing)");
+	}
+
+	return ok;
+}
+
+MainLoop *test() {
+
+	static const int thread_counts[] = { 0, 1, 4, 8, -1 };
+	const int frames = 4;
+
+	ClassDB::register_class<Recorder>();
+	Recorder *recorder = memnew(Recorder);
+
+	for (int i = 0; thread_counts[i] >= 0; i++) {
+
+		if (thread_counts[i] == 0) {
+			OS::get_singleton()->print("%i deferred calls and notifications per frame from the main thread\n", MESSAGES_PER_FRAME);
+		} else {
+			OS::get_singleton()->print("%i deferred calls per frame from %i threads\n", MESSAGES_PER_FRAME, thread_counts[i]);
+		}
+
+		bool pass = run(recorder, thread_counts[i], frames);
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+	}
+
+	memdelete(recorder);
+
+	return NULL;
+}
+
+} // namespace TestMessageQueue
@@ -121,6 +121,35 @@ MainLoop *test() {
 		delete[] keys;
 	}
 
+	// lazy allocation, pointer lookup and clearing
+	{
+		OAHashMap<String, String> map(0);
+
+		OS::get_singleton()->print("empty capacity %d, has \"a\" %d\n", map.get_capacity(), map.has("a"));
+
+		for (int i = 0; i < 100; i++) {
+			map.set(itos(i), "v" + itos(i));
+		}
+		for (int i = 0; i < 100; i += 3) {
+			map.remove(itos(i));
+		}
+
+		int found = 0;
+		for (int i = 0; i < 100; i++) {
+			String *v = map.lookup_ptr(itos(i));
+			if ((v != NULL) != (i % 3 != 0) || (v && *v != "v" + itos(i)))
+				OS::get_singleton()->print("wrong lookup for %d\n", i);
+			if (v)
+				found++;
+		}
+		OS::get_singleton()->print("elements %d == %d.\n", map.get_num_elements(), found);
+
+		map.clear();
+		OS::get_singleton()->print("cleared capacity %d, elements %d\n", map.get_capacity(), map.get_num_elements());
+		map.set("again", "yes");
+		OS::get_singleton()->print("map[\"again\"] = %s\n", map.lookup_ptr("again")->utf8().get_data());
+	}
+
 	return NULL;
 }
 } // namespace TestOAHashMap
@@ -0,0 +1,196 @@
+/*************************************************************************/
+/*  test_pack.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_pack.h"
+
+#include "core/io/file_access_pack.h"
+#include "core/io/pck_packer.h"
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+
+namespace TestPack {
+
+// Opens the packed files either from the pack mapping, when there is one, or
+// through a file handle, so both ways of reading them can be checked.
+class TestSourcePCK : public PackedSourcePCK {
+public:
+	bool mapped;
+
+	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file) {
+
+		PackedData::PackedFile file = *p_file;
+		if (!mapped)
+			file.data = NULL;
+		return memnew(FileAccessPack(p_path, file));
+	}
+
+	TestSourcePCK() {
+		mapped = true;
+	}
+};
+
+static Vector<uint8_t> make_data(int p_size, int p_noise_block, uint32_t p_seed) {
+
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	RandomPCG rng(p_seed);
+	for (int i = 0; i < p_size; i++) {
+		// short runs compress well, the noise block doesn't compress at all
+		bool noise = i / PACK_COMPRESSED_BLOCK_SIZE == p_noise_block;
+		data.write[i] = noise ? (rng.rand() & 0xFF) : ((i / 64 + p_seed) & 0x0F);
+	}
+	return data;
+}
+
+static bool check_file(const String &p_path, const Vector<uint8_t> &p_data, uint32_t p_seed) {
+
+	FileAccess *f = PackedData::get_singleton()->try_open_path(p_path);
+	if (!f)
+		return false;
+
+	bool ok = f->get_len() == (size_t)p_data.size();
+
+	Vector<uint8_t> read;
+	read.resize(p_data.size() + 1);
+	ok = ok && f->get_buffer(read.ptrw(), p_data.size() + 1) == p_data.size();
+	ok = ok && f->eof_reached();
+	ok = ok && (p_data.size() == 0 || memcmp(read.ptr(), p_data.ptr(), p_data.size()) == 0);
+
+	// random seeks, with reads up to a few blocks long
+	RandomPCG rng(p_seed);
+	for (int i = 0; i < 200 && ok; i++) {
+
+		int from = rng.rand() % (p_data.size() + 1);
+		int length = rng.rand() % (PACK_COMPRESSED_BLOCK_SIZE * 3);
+		int expected = MIN(length, p_data.size() - from);
+
+		f->seek(from);
+		ok = ok && f->get_position() == (size_t)from;
+		ok = ok && f->get_buffer(read.ptrw(), length) == expected;
+		ok = ok && (expected == 0 || memcmp(read.ptr(), p_data.ptr() + from, expected) == 0);
+	}
+
+	memdelete(f);
+	return ok;
+}
+
+static bool test_round_trip(bool p_compress) {
+
+	ERR_FAIL_COND_V(!PackedData::get_singleton(), false);
+
+	const int sizes[] = { 0, 1, PACK_COMPRESSED_BLOCK_SIZE, PACK_COMPRESSED_BLOCK_SIZE * 5 + 7, PACK_COMPRESSED_BLOCK_SIZE * 3 };
+	const int noise_blocks[] = { -1, -1, -1, -1, 1 };
+	const int file_count = sizeof(sizes) / sizeof(sizes[0]);
+
+	String prefix = p_compress ? "compressed" : "stored";
+	String pack_path = OS::get_singleton()->get_user_data_dir().plus_file("test_pack_" + prefix + ".pck");
+	Vector<Vector<uint8_t> > contents;
+	Vector<String> sources;
+
+	PCKPacker packer;
+	bool ok = packer.pck_start(pack_path, 16, p_compress) == OK;
+
+	for (int i = 0; i < file_count && ok; i++) {
+
+		contents.push_back(make_data(sizes[i], noise_blocks[i], i));
+		sources.push_back(OS::get_singleton()->get_user_data_dir().plus_file("test_pack_" + itos(i) + ".bin"));
+
+		FileAccess *f = FileAccess::open(sources[i], FileAccess::WRITE);
+		if (!f)
+			return false;
+		f->store_buffer(contents[i].ptr(), contents[i].size());
+		memdelete(f);
+
+		ok = packer.add_file("res://test_pack/" + prefix + "_" + itos(i) + ".bin", sources[i]) == OK;
+	}
+	ok = ok && packer.flush() == OK;
+
+	TestSourcePCK *source = memnew(TestSourcePCK);
+	PackedData::get_singleton()->add_pack_source(source);
+	ok = ok && source->try_open_pack(pack_path);
+
+	for (int mapped = 0; mapped < 2; mapped++) {
+
+		source->mapped = mapped;
+		for (int i = 0; i < file_count && ok; i++) {
+			ok = check_file("res://test_pack/" + prefix + "_" + itos(i) + ".bin", contents[i], i + mapped * file_count);
+		}
+	}
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	for (int i = 0; i < sources.size(); i++) {
+		da->remove(sources[i]);
+	}
+	da->remove(pack_path);
+	memdelete(da);
+
+	return ok;
+}
+
+static bool test_stored() {
+
+	return test_round_trip(false);
+}
+
+static bool test_compressed() {
+
+	return test_round_trip(true);
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_stored,
+	test_compressed,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestPack
@@ -31,6 +31,7 @@
 #include "test_physics_2d.h"
 
 #include "core/map.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
@@ -426,10 +427,137 @@ public:
 	TestPhysics2DMainLoop() {}
 };
 
+// headless benchmark, lots of small circles bouncing around in a closed box,
+// stresses the broadphase far more than the solver
+class TestPhysics2DStressMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysics2DStressMainLoop, MainLoop);
+
+	enum {
+		BODY_COUNT = 20000,
+		STEPS = 120,
+	};
+
+	RID space;
+	RID circle_shape;
+	RID wall_shapes[4];
+	Vector<RID> bodies;
+
+	void _add_wall(int p_index, const Vector2 &p_normal, real_t p_d) {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		Array arr;
+		arr.push_back(p_normal);
+		arr.push_back(p_d);
+
+		wall_shapes[p_index] = ps->line_shape_create();
+		ps->shape_set_data(wall_shapes[p_index], arr);
+
+		RID wall = ps->body_create();
+		ps->body_set_mode(wall, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_add_shape(wall, wall_shapes[p_index]);
+		ps->body_set_space(wall, space);
+		bodies.push_back(wall);
+	}
+
+public:
+	virtual void init() {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		space = ps->space_create();
+		ps->space_set_active(space, true);
+		ps->set_active(true);
+		ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY, 0);
+
+		const real_t radius = 4;
+		// about one circle every 24x24 units
+		const real_t size = Math::sqrt((real_t)BODY_COUNT) * 24;
+
+		_add_wall(0, Vector2(1, 0), 0);
+		_add_wall(1, Vector2(-1, 0), -size);
+		_add_wall(2, Vector2(0, 1), 0);
+		_add_wall(3, Vector2(0, -1), -size);
+
+		circle_shape = ps->circle_shape_create();
+		ps->shape_set_data(circle_shape, radius);
+
+		RandomPCG rng(0x2d);
+
+		for (int i = 0; i < BODY_COUNT; i++) {
+
+			RID body = ps->body_create();
+			ps->body_add_shape(body, circle_shape);
+			ps->body_set_space(body, space);
+			ps->body_set_param(body, Physics2DServer::BODY_PARAM_BOUNCE, 1.0);
+			ps->body_set_state(body, Physics2DServer::BODY_STATE_CAN_SLEEP, false);
+			ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(radius + rng.randf() * (size - radius * 2), radius + rng.randf() * (size - radius * 2))));
+			ps->body_set_state(body, Physics2DServer::BODY_STATE_LINEAR_VELOCITY, Vector2(rng.randf() - 0.5, rng.randf() - 0.5) * 200.0);
+			bodies.push_back(body);
+		}
+
+		OS::get_singleton()->print("%i circles, %i steps\n", (int)BODY_COUNT, (int)STEPS);
+
+		const float delta = 1.0 / 60.0;
+		uint64_t total = 0;
+		uint64_t worst = 0;
+
+		for (int i = 0; i < STEPS; i++) {
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+			// same order as the main loop
+			ps->sync();
+			ps->flush_queries();
+			ps->end_sync();
+			ps->step(delta);
+
+			uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+			total += elapsed;
+			worst = MAX(worst, elapsed);
+		}
+
+		OS::get_singleton()->print("\t%.2f ms/step average, %.2f ms worst\n", total / 1000.0 / STEPS, worst / 1000.0);
+		OS::get_singleton()->print("\tcollision pairs: %i, active objects: %i, islands: %i\n", ps->get_process_info(Physics2DServer::INFO_COLLISION_PAIRS), ps->get_process_info(Physics2DServer::INFO_ACTIVE_OBJECTS), ps->get_process_info(Physics2DServer::INFO_ISLAND_COUNT));
+	}
+
+	virtual bool iteration(float p_time) {
+
+		return true; // all done in init
+	}
+
+	virtual bool idle(float p_time) {
+
+		return true;
+	}
+
+	virtual void finish() {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		ps->free(circle_shape);
+		for (int i = 0; i < 4; i++) {
+			ps->free(wall_shapes[i]);
+		}
+		ps->free(space);
+	}
+
+	TestPhysics2DStressMainLoop() {}
+};
+
 namespace TestPhysics2D {
 
 MainLoop *test() {
 
 	return memnew(TestPhysics2DMainLoop);
 }
+
+MainLoop *test_stress() {
+
+	return memnew(TestPhysics2DStressMainLoop);
+}
 } // namespace TestPhysics2D
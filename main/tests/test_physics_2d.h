@@ -36,6 +36,7 @@
 namespace TestPhysics2D {
 
 MainLoop *test();
+MainLoop *test_stress();
 }
 
 #endif // TEST_PHYSICS_2D_H
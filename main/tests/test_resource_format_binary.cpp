@@ -0,0 +1,446 @@
+/*************************************************************************/
+/*  test_resource_format_binary.cpp                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_resource_format_binary.h"
+
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "scene/resources/scene_format_text.h"
+
+namespace TestResourceFormatBinary {
+
+// Resources keep their test data in metadata, which is saved like any other
+// property, so plain Resource objects can be used and nothing needs registering.
+
+static String get_path(const String &p_name) {
+
+	return OS::get_singleton()->get_user_data_dir().plus_file("test_resource_format_binary_" + p_name);
+}
+
+static String filler(int p_length) {
+
+	String s;
+	for (int i = 0; i < p_length; i++) {
+		s += "_";
+	}
+	return s;
+}
+
+static void remove_file(const String &p_path) {
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(p_path);
+	memdelete(da);
+}
+
+static RES load_uncached(const String &p_path, bool p_lazy) {
+
+	ProjectSettings *settings = ProjectSettings::get_singleton();
+	Variant lazy = settings->get("application/run/lazy_subresources");
+	settings->set("application/run/lazy_subresources", p_lazy);
+	RES res = ResourceLoader::load(p_path, "", true);
+	settings->set("application/run/lazy_subresources", lazy);
+	return res;
+}
+
+// Variant comparison is by reference for arrays, dictionaries and objects
+static bool same(const Variant &p_a, const Variant &p_b) {
+
+	if (p_a.get_type() != p_b.get_type())
+		return false;
+
+	switch (p_a.get_type()) {
+
+		case Variant::ARRAY: {
+
+			Array a = p_a;
+			Array b = p_b;
+			if (a.size() != b.size())
+				return false;
+			for (int i = 0; i < a.size(); i++) {
+				if (!same(a[i], b[i]))
+					return false;
+			}
+			return true;
+		} break;
+		case Variant::DICTIONARY: {
+
+			Dictionary a = p_a;
+			Dictionary b = p_b;
+			return same(a.keys(), b.keys()) && same(a.values(), b.values());
+		} break;
+		case Variant::OBJECT: {
+
+			RES a = p_a;
+			RES b = p_b;
+			if (a.is_null() || b.is_null())
+				return a.is_null() && b.is_null();
+
+			return a->get_class() == b->get_class() && same(a->get_meta("data"), b->get_meta("data"));
+		} break;
+		default: {
+			return p_a.hash_compare(p_b);
+		}
+	}
+}
+
+// the first values of each array, as stored in the file
+static void append_reals(Vector<uint8_t> &r_pattern, const real_t *p_reals, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		const uint8_t *bytes = (const uint8_t *)&p_reals[i];
+		for (uint32_t j = 0; j < sizeof(real_t); j++) {
+			r_pattern.push_back(bytes[j]);
+		}
+	}
+}
+
+// reals with few digits, so they also survive being saved as text
+static real_t random_real(RandomPCG &p_rng) {
+
+	return (int(p_rng.rand() % 2048) - 1024) / 16.0;
+}
+
+static Array make_pool_arrays(uint32_t p_seed, Vector<Vector<uint8_t> > *r_patterns) {
+
+	RandomPCG rng(p_seed);
+	int size = 5 + rng.rand() % 50;
+
+	PoolByteArray bytes;
+	PoolIntArray ints;
+	PoolRealArray reals;
+	PoolStringArray strings;
+	PoolVector2Array vector2s;
+	PoolVector3Array vector3s;
+	PoolColorArray colors;
+	for (int i = 0; i < size; i++) {
+		bytes.push_back(rng.rand());
+		ints.push_back(rng.rand());
+		reals.push_back(random_real(rng));
+		strings.push_back(String("string ") + itos(rng.rand()));
+		vector2s.push_back(Vector2(random_real(rng), random_real(rng)));
+		vector3s.push_back(Vector3(random_real(rng), random_real(rng), random_real(rng)));
+		colors.push_back(Color(random_real(rng), random_real(rng), random_real(rng), random_real(rng)));
+	}
+
+	if (r_patterns) {
+		Vector<uint8_t> pattern;
+		for (int i = 0; i < 4; i++) {
+			pattern.push_back(bytes[i]);
+		}
+		r_patterns->push_back(pattern);
+
+		pattern.clear();
+		for (int i = 0; i < 4; i++) {
+			int value = ints[i];
+			for (int j = 0; j < 4; j++) {
+				pattern.push_back((value >> (j * 8)) & 0xFF);
+			}
+		}
+		r_patterns->push_back(pattern);
+
+		pattern.clear();
+		real_t first_reals[4] = { reals[0], reals[1], reals[2], reals[3] };
+		append_reals(pattern, first_reals, 4);
+		r_patterns->push_back(pattern);
+
+		pattern.clear();
+		real_t first_vector2s[4] = { vector2s[0].x, vector2s[0].y, vector2s[1].x, vector2s[1].y };
+		append_reals(pattern, first_vector2s, 4);
+		r_patterns->push_back(pattern);
+
+		pattern.clear();
+		real_t first_vector3s[6] = { vector3s[0].x, vector3s[0].y, vector3s[0].z, vector3s[1].x, vector3s[1].y, vector3s[1].z };
+		append_reals(pattern, first_vector3s, 6);
+		r_patterns->push_back(pattern);
+
+		pattern.clear();
+		real_t first_color[4] = { colors[0].r, colors[0].g, colors[0].b, colors[0].a };
+		append_reals(pattern, first_color, 4);
+		r_patterns->push_back(pattern);
+	}
+
+	// odd sized strings and bytes in between, so no array would start aligned by chance
+	Array arrays;
+	arrays.push_back(filler(p_seed % 16));
+	arrays.push_back(bytes);
+	arrays.push_back(filler(rng.rand() % 16));
+	arrays.push_back(ints);
+	arrays.push_back(strings);
+	arrays.push_back(reals);
+	arrays.push_back(filler(rng.rand() % 16));
+	arrays.push_back(vector2s);
+	arrays.push_back(vector3s);
+	arrays.push_back(colors);
+	return arrays;
+}
+
+static RES make_resource(uint32_t p_seed, Vector<Vector<uint8_t> > *r_patterns) {
+
+	Array arrays = make_pool_arrays(p_seed, r_patterns);
+
+	// the same arrays, nested in arrays and dictionaries
+	Dictionary nested;
+	nested["arrays"] = make_pool_arrays(p_seed + 1000, r_patterns);
+	nested[filler(p_seed % 7)] = make_pool_arrays(p_seed + 2000, r_patterns);
+	Array outer;
+	outer.push_back(nested);
+	arrays.push_back(outer);
+
+	RES res;
+	res.instance();
+	res->set_meta("data", arrays);
+	return res;
+}
+
+static bool check_aligned(const String &p_path, const Vector<Vector<uint8_t> > &p_patterns) {
+
+	Vector<uint8_t> data = FileAccess::get_file_as_array(p_path);
+
+	bool ok = data.size() > 0;
+	for (int i = 0; i < p_patterns.size() && ok; i++) {
+		const Vector<uint8_t> &pattern = p_patterns[i];
+		int found = -1;
+		for (int j = 0; j + pattern.size() <= data.size(); j++) {
+			if (memcmp(data.ptr() + j, pattern.ptr(), pattern.size()) == 0) {
+				found = j;
+				break;
+			}
+		}
+		ok = found > 0 && found % 16 == 0;
+	}
+	return ok;
+}
+
+static uint32_t get_format_version(const String &p_path) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	ERR_FAIL_COND_V(!f, 0);
+	f->seek(20); // magic, endianness, 64 bits, major and minor version
+	uint32_t version = f->get_32();
+	memdelete(f);
+	return version;
+}
+
+static bool test_pool_arrays() {
+
+	String path = get_path("pool_arrays.res");
+
+	bool ok = true;
+	for (uint32_t seed = 0; seed < 16 && ok; seed++) {
+
+		Vector<Vector<uint8_t> > patterns;
+		RES res = make_resource(seed, &patterns);
+
+		ok = ResourceSaver::save(path, res) == OK;
+		ok = ok && get_format_version(path) == 4;
+		ok = ok && check_aligned(path, patterns);
+		ok = ok && same(res, load_uncached(path, false));
+
+		// the other endianness takes the per element path both ways
+		ok = ok && ResourceSaver::save(path, res, ResourceSaver::FLAG_SAVE_BIG_ENDIAN) == OK;
+		ok = ok && same(res, load_uncached(path, false));
+	}
+
+	remove_file(path);
+	return ok;
+}
+
+static bool test_compressed() {
+
+	String path = get_path("compressed.res");
+	RES res = make_resource(7, NULL);
+
+	bool ok = ResourceSaver::save(path, res, ResourceSaver::FLAG_COMPRESS) == OK;
+
+	FileAccess *f = FileAccess::open(path, FileAccess::READ);
+	ok = ok && f;
+	if (f) {
+		uint8_t magic[4];
+		f->get_buffer(magic, 4);
+		ok = ok && memcmp(magic, "RSCC", 4) == 0;
+		memdelete(f);
+	}
+
+	// lazy loading is ignored for compressed files, the result must not differ
+	ok = ok && same(res, load_uncached(path, false));
+	ok = ok && same(res, load_uncached(path, true));
+
+	remove_file(path);
+	return ok;
+}
+
+static bool test_rename_dependencies() {
+
+	// paths as the file stores them
+	String path = ProjectSettings::get_singleton()->localize_path(get_path("renamed.res"));
+	String dependency_path = ProjectSettings::get_singleton()->localize_path(get_path("dependency.res"));
+
+	RES dependency = make_resource(3, NULL);
+	bool ok = ResourceSaver::save(dependency_path, dependency) == OK;
+	dependency->set_path(dependency_path);
+
+	// the table grows by every length modulo the alignment, the arrays after it must stay aligned
+	for (int i = 0; i < 16 && ok; i++) {
+
+		Vector<Vector<uint8_t> > patterns;
+		RES res = make_resource(100 + i, &patterns);
+		Array data = res->get_meta("data");
+		data.push_back(dependency);
+
+		ok = ResourceSaver::save(path, res) == OK;
+
+		String renamed_path = ProjectSettings::get_singleton()->localize_path(get_path("dependency_" + filler(i) + ".res"));
+		ok = ok && ResourceSaver::save(renamed_path, dependency) == OK;
+
+		Map<String, String> renames;
+		renames[dependency_path] = renamed_path;
+		ok = ok && ResourceLoader::rename_dependencies(path, renames) == OK;
+		ok = ok && get_format_version(path) == 4;
+		ok = ok && check_aligned(path, patterns);
+
+		RES loaded = load_uncached(path, false);
+		ok = ok && same(res, loaded);
+		if (ok) {
+			Array loaded_data = loaded->get_meta("data");
+			RES loaded_dependency = loaded_data[loaded_data.size() - 1];
+			ok = loaded_dependency.is_valid() && loaded_dependency->get_path() == renamed_path;
+		}
+
+		remove_file(renamed_path);
+	}
+
+	remove_file(path);
+	remove_file(dependency_path);
+	return ok;
+}
+
+static bool test_lazy_subresources() {
+
+	String path = get_path("subresources.res");
+
+	// leaves shared by the branches and the root
+	Vector<RES> leaves;
+	for (int i = 0; i < 6; i++) {
+		leaves.push_back(make_resource(200 + i, NULL));
+	}
+	Array branches;
+	for (int i = 0; i < 4; i++) {
+		RES branch = make_resource(300 + i, NULL);
+		Array data = branch->get_meta("data");
+		data.push_back(leaves[(i * 2) % 6]);
+		data.push_back(leaves[(i * 2 + 1) % 6]);
+		branches.push_back(branch);
+	}
+	RES root = make_resource(400, NULL);
+	Array data = root->get_meta("data");
+	data.push_back(branches);
+	data.push_back(leaves[5]);
+
+	bool ok = ResourceSaver::save(path, root) == OK;
+
+	RES eager = load_uncached(path, false);
+	RES lazy = load_uncached(path, true);
+	ok = ok && same(root, eager) && same(root, lazy);
+
+	// a leaf shared by two branches is still one resource either way
+	RES loaded[2] = { eager, lazy };
+	for (int i = 0; i < 2 && ok; i++) {
+		Array loaded_data = loaded[i]->get_meta("data");
+		Array loaded_branches = loaded_data[loaded_data.size() - 2];
+		RES last_leaf = loaded_data[loaded_data.size() - 1];
+		Array first_branch = RES(loaded_branches[0])->get_meta("data");
+		Array third_branch = RES(loaded_branches[2])->get_meta("data");
+		RES leaf = first_branch[first_branch.size() - 1];
+		ok = leaf.is_valid() && RES(third_branch[third_branch.size() - 1]) == last_leaf && leaf != last_leaf;
+	}
+
+	remove_file(path);
+	return ok;
+}
+
+static bool test_text_to_binary() {
+
+	String text_path = get_path("converted.tres");
+	String path = get_path("converted.res");
+
+	Vector<Vector<uint8_t> > patterns;
+	RES res = make_resource(11, &patterns);
+	Array data = res->get_meta("data");
+	data.push_back(make_resource(12, &patterns));
+
+	bool ok = ResourceSaver::save(text_path, res) == OK;
+	ok = ok && ResourceFormatLoaderText::convert_file_to_binary(text_path, path) == OK;
+	ok = ok && get_format_version(path) == 4;
+	ok = ok && check_aligned(path, patterns);
+	ok = ok && same(res, load_uncached(path, false));
+	ok = ok && same(res, load_uncached(path, true));
+
+	remove_file(text_path);
+	remove_file(path);
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_pool_arrays,
+	test_compressed,
+	test_rename_dependencies,
+	test_lazy_subresources,
+	test_text_to_binary,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestResourceFormatBinary
@@ -0,0 +1,393 @@
+/*************************************************************************/
+/*  test_spatial_index.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_spatial_index.h"
+
+#include "core/math/bvh.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/octree.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/set.h"
+
+namespace TestSpatialIndex {
+
+// masks as used by the visual server, geometry is culled and pairs with lights
+enum {
+	TYPE_GEOMETRY = 1,
+	TYPE_LIGHT = 2,
+};
+
+struct BenchmarkInstance {
+	int index;
+};
+
+struct Benchmark {
+
+	int pairs;
+	int pair_events;
+
+	static void *pair_callback(void *p_self, uint32_t, BenchmarkInstance *p_A, int, uint32_t, BenchmarkInstance *p_B, int) {
+
+		Benchmark *self = (Benchmark *)p_self;
+		self->pairs++;
+		self->pair_events++;
+		return NULL;
+	}
+
+	static void unpair_callback(void *p_self, uint32_t, BenchmarkInstance *p_A, int, uint32_t, BenchmarkInstance *p_B, int, void *) {
+
+		Benchmark *self = (Benchmark *)p_self;
+		self->pairs--;
+	}
+
+	template <class I>
+	uint64_t run(I *p_index, int p_instances, int p_lights, int p_frames) {
+
+		pairs = 0;
+		pair_events = 0;
+
+		p_index->set_pair_callback(pair_callback, this);
+		p_index->set_unpair_callback(unpair_callback, this);
+
+		// same seed for every index, so they all see the same scene
+		RandomPCG rng(0x1234);
+
+		real_t world_size = Math::pow(p_instances * 16.0, 1.0 / 3.0);
+		Vector3 box_size(1, 1, 1);
+		Vector3 light_size(12, 12, 12);
+		int count = p_instances + p_lights;
+
+		Vector<BenchmarkInstance> instances;
+		Vector<uint32_t> ids;
+		Vector<Vector3> positions;
+		Vector<Vector3> velocities;
+		instances.resize(count);
+		ids.resize(count);
+
+		for (int i = 0; i < count; i++) {
+
+			bool light = i >= p_instances;
+			instances.write[i].index = i;
+
+			Vector3 pos(rng.randf() * world_size, rng.randf() * world_size, rng.randf() * world_size);
+			positions.push_back(pos);
+			velocities.push_back(Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * 4.0);
+
+			if (light) {
+				ids.write[i] = p_index->create(&instances.write[i], AABB(pos, light_size), 0, true, TYPE_LIGHT, TYPE_GEOMETRY);
+			} else {
+				ids.write[i] = p_index->create(&instances.write[i], AABB(pos, box_size), 0, false, TYPE_GEOMETRY, 0);
+			}
+		}
+
+		CameraMatrix projection;
+		projection.set_perspective(70, 16.0 / 9.0, 0.05, world_size * 0.5);
+
+		BenchmarkInstance **results = memnew_arr(BenchmarkInstance *, count);
+		int culled = 0;
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+		const real_t delta = 1.0 / 60.0;
+		for (int frame = 0; frame < p_frames; frame++) {
+
+			for (int i = 0; i < count; i++) {
+
+				Vector3 &pos = positions.write[i];
+				Vector3 &vel = velocities.write[i];
+				pos += vel * delta;
+				for (int j = 0; j < 3; j++) {
+					if (pos[j] < 0 || pos[j] > world_size) {
+						vel[j] = -vel[j];
+					}
+				}
+				p_index->move(ids[i], AABB(pos, i >= p_instances ? light_size : box_size));
+			}
+
+			// camera orbiting the center of the world, culling everything like the main pass
+			real_t angle = frame * 0.05;
+			Vector3 center = Vector3(1, 1, 1) * world_size * 0.5;
+			Transform camera;
+			camera.origin = center + Vector3(Math::cos(angle), 0, Math::sin(angle)) * world_size * 0.4;
+			camera = camera.looking_at(center, Vector3(0, 1, 0));
+
+			Vector<Plane> planes = projection.get_projection_planes(camera);
+			culled += p_index->cull_convex(planes, results, count);
+		}
+
+		uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+		int final_pairs = pairs;
+
+		for (int i = 0; i < count; i++) {
+			p_index->erase(ids[i]);
+		}
+		memdelete_arr(results);
+
+		OS::get_singleton()->print("\t\tpairs at end: %i, pair events: %i, culled: %i\n", final_pairs, pair_events, culled);
+
+		return elapsed;
+	}
+};
+
+// pairs as reported by the callbacks of one index
+struct PairTracker {
+
+	Set<uint64_t> pairs;
+	bool consistent; // no pair reported twice, no unpair without a pair
+
+	static uint64_t key(BenchmarkInstance *p_A, BenchmarkInstance *p_B) {
+
+		uint32_t a = p_A->index;
+		uint32_t b = p_B->index;
+		if (a > b) {
+			SWAP(a, b);
+		}
+		return (uint64_t(a) << 32) | b;
+	}
+
+	static void *pair_callback(void *p_self, uint32_t, BenchmarkInstance *p_A, int, uint32_t, BenchmarkInstance *p_B, int) {
+
+		PairTracker *self = (PairTracker *)p_self;
+		uint64_t k = key(p_A, p_B);
+		if (self->pairs.has(k)) {
+			self->consistent = false;
+		}
+		self->pairs.insert(k);
+		return NULL;
+	}
+
+	static void unpair_callback(void *p_self, uint32_t, BenchmarkInstance *p_A, int, uint32_t, BenchmarkInstance *p_B, int, void *) {
+
+		PairTracker *self = (PairTracker *)p_self;
+		uint64_t k = key(p_A, p_B);
+		if (!self->pairs.has(k)) {
+			self->consistent = false;
+		}
+		self->pairs.erase(k);
+	}
+
+	PairTracker() {
+		consistent = true;
+	}
+};
+
+static bool _same_results(BenchmarkInstance **p_a, int p_a_count, BenchmarkInstance **p_b, int p_b_count) {
+
+	Set<int> a;
+	Set<int> b;
+	for (int i = 0; i < p_a_count; i++) {
+		a.insert(p_a[i]->index);
+	}
+	for (int i = 0; i < p_b_count; i++) {
+		b.insert(p_b[i]->index);
+	}
+	if (a.size() != p_a_count || b.size() != p_b_count || a.size() != b.size()) {
+		return false; // duplicated results, or different counts
+	}
+	for (Set<int>::Element *E = a.front(); E; E = E->next()) {
+		if (!b.has(E->get())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// runs the octree and the BVH side by side on the same scene, they must return the same
+// instances for every query and report the same pairs
+static bool compare(int p_instances, int p_lights, int p_frames) {
+
+	Octree<BenchmarkInstance, true> octree;
+	BVH<BenchmarkInstance> bvh;
+	PairTracker octree_pairs;
+	PairTracker bvh_pairs;
+
+	octree.set_pair_callback(PairTracker::pair_callback, &octree_pairs);
+	octree.set_unpair_callback(PairTracker::unpair_callback, &octree_pairs);
+	bvh.set_pair_callback(PairTracker::pair_callback, &bvh_pairs);
+	bvh.set_unpair_callback(PairTracker::unpair_callback, &bvh_pairs);
+
+	RandomPCG rng(0x5678);
+
+	real_t world_size = Math::pow(p_instances * 16.0, 1.0 / 3.0);
+	Vector3 box_size(1, 1, 1);
+	Vector3 light_size(12, 12, 12);
+	int count = p_instances + p_lights;
+
+	Vector<BenchmarkInstance> instances;
+	Vector<OctreeElementID> octree_ids;
+	Vector<BVHElementID> bvh_ids;
+	Vector<Vector3> positions;
+	Vector<Vector3> velocities;
+	instances.resize(count);
+
+	for (int i = 0; i < count; i++) {
+
+		bool light = i >= p_instances;
+		instances.write[i].index = i;
+
+		Vector3 pos(rng.randf() * world_size, rng.randf() * world_size, rng.randf() * world_size);
+		positions.push_back(pos);
+		velocities.push_back(Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * 4.0);
+
+		if (light) {
+			octree_ids.push_back(octree.create(&instances.write[i], AABB(pos, light_size), 0, true, TYPE_LIGHT, TYPE_GEOMETRY));
+			bvh_ids.push_back(bvh.create(&instances.write[i], AABB(pos, light_size), 0, true, TYPE_LIGHT, TYPE_GEOMETRY));
+		} else {
+			octree_ids.push_back(octree.create(&instances.write[i], AABB(pos, box_size), 0, false, TYPE_GEOMETRY, 0));
+			bvh_ids.push_back(bvh.create(&instances.write[i], AABB(pos, box_size), 0, false, TYPE_GEOMETRY, 0));
+		}
+	}
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, world_size * 0.5);
+
+	// a convex with more planes than fit in the BVH plane mask, around the center of the world
+	Vector3 center = Vector3(1, 1, 1) * world_size * 0.5;
+	Vector<Plane> sphere;
+	for (int i = 0; i < 40; i++) {
+		real_t y = 1.0 - (i + 0.5) * 2.0 / 40;
+		real_t r = Math::sqrt(1.0 - y * y);
+		real_t angle = i * 2.39996;
+		Vector3 normal(Math::cos(angle) * r, y, Math::sin(angle) * r);
+		sphere.push_back(Plane(normal, normal.dot(center) + world_size * 0.2));
+	}
+
+	BenchmarkInstance **octree_results = memnew_arr(BenchmarkInstance *, count);
+	BenchmarkInstance **bvh_results = memnew_arr(BenchmarkInstance *, count);
+
+	bool pass = true;
+	const real_t delta = 1.0 / 60.0;
+
+	for (int frame = 0; frame < p_frames; frame++) {
+
+		for (int i = 0; i < count; i++) {
+
+			Vector3 &pos = positions.write[i];
+			Vector3 &vel = velocities.write[i];
+			pos += vel * delta;
+			for (int j = 0; j < 3; j++) {
+				if (pos[j] < 0 || pos[j] > world_size) {
+					vel[j] = -vel[j];
+				}
+			}
+			AABB aabb(pos, i >= p_instances ? light_size : box_size);
+			octree.move(octree_ids[i], aabb);
+			bvh.move(bvh_ids[i], aabb);
+		}
+
+		real_t angle = frame * 0.05;
+		Transform camera;
+		camera.origin = center + Vector3(Math::cos(angle), 0, Math::sin(angle)) * world_size * 0.4;
+		camera = camera.looking_at(center, Vector3(0, 1, 0));
+		Vector<Plane> planes = projection.get_projection_planes(camera);
+
+		int a = octree.cull_convex(planes, octree_results, count);
+		int b = bvh.cull_convex(planes, bvh_results, count);
+		pass = pass && _same_results(octree_results, a, bvh_results, b);
+
+		// only lights
+		a = octree.cull_convex(planes, octree_results, count, TYPE_LIGHT);
+		b = bvh.cull_convex(planes, bvh_results, count, TYPE_LIGHT);
+		pass = pass && _same_results(octree_results, a, bvh_results, b);
+
+		a = octree.cull_convex(sphere, octree_results, count);
+		b = bvh.cull_convex(sphere, bvh_results, count);
+		pass = pass && _same_results(octree_results, a, bvh_results, b);
+
+		Vector3 from = positions[rng.rand() % count];
+		AABB box(from, Vector3(6, 6, 6));
+		a = octree.cull_aabb(box, octree_results, count);
+		b = bvh.cull_aabb(box, bvh_results, count);
+		pass = pass && _same_results(octree_results, a, bvh_results, b);
+
+		Vector3 to = from + Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * world_size;
+		a = octree.cull_segment(from, to, octree_results, count);
+		b = bvh.cull_segment(from, to, bvh_results, count);
+		pass = pass && _same_results(octree_results, a, bvh_results, b);
+
+		a = octree.cull_point(from + Vector3(0.5, 0.5, 0.5), octree_results, count);
+		b = bvh.cull_point(from + Vector3(0.5, 0.5, 0.5), bvh_results, count);
+		pass = pass && _same_results(octree_results, a, bvh_results, b);
+
+		pass = pass && octree_pairs.pairs.size() == bvh_pairs.pairs.size();
+		for (Set<uint64_t>::Element *E = octree_pairs.pairs.front(); E; E = E->next()) {
+			pass = pass && bvh_pairs.pairs.has(E->get());
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		octree.erase(octree_ids[i]);
+		bvh.erase(bvh_ids[i]);
+	}
+	memdelete_arr(octree_results);
+	memdelete_arr(bvh_results);
+
+	pass = pass && octree_pairs.pairs.empty() && bvh_pairs.pairs.empty();
+	pass = pass && octree_pairs.consistent && bvh_pairs.consistent;
+
+	return pass;
+}
+
+MainLoop *test() {
+
+	static const int instance_counts[] = { 1000, 10000, 50000, 0 };
+	const int lights = 64;
+	const int frames = 60;
+
+	OS::get_singleton()->print("Comparing octree and BVH results\n");
+	bool pass = compare(2000, lights, 240);
+	OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+	for (int i = 0; instance_counts[i]; i++) {
+
+		int instances = instance_counts[i];
+
+		OS::get_singleton()->print("%i moving instances, %i lights, %i frames\n", instances, lights, frames);
+
+		Benchmark benchmark;
+
+		Octree<BenchmarkInstance, true> *octree = memnew((Octree<BenchmarkInstance, true>));
+		OS::get_singleton()->print("\tOctree:\n");
+		uint64_t octree_time = benchmark.run(octree, instances, lights, frames);
+		memdelete(octree);
+		OS::get_singleton()->print("\t\t%.2f ms/frame\n", octree_time / 1000.0 / frames);
+
+		BVH<BenchmarkInstance> *bvh = memnew(BVH<BenchmarkInstance>);
+		OS::get_singleton()->print("\tBVH:\n");
+		uint64_t bvh_time = benchmark.run(bvh, instances, lights, frames);
+		memdelete(bvh);
+		OS::get_singleton()->print("\t\t%.2f ms/frame\n", bvh_time / 1000.0 / frames);
+	}
+
+	return NULL;
+}
+
+} // namespace TestSpatialIndex
@@ -0,0 +1,421 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_worker_thread_pool.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/os/semaphore.h"
+#include "core/os/worker_thread_pool.h"
+
+namespace TestWorkerThreadPool {
+
+// The work of one task, a single task being a group of one element. Every
+// element counts its runs, and only then counts itself as finished, so a task
+// reported complete before all its elements are done shows up as unfinished.
+struct Job {
+
+	uint32_t elements;
+	uint32_t *runs;
+	volatile uint32_t finished;
+	volatile uint32_t waiter_runs;
+	volatile uint32_t errors;
+	Vector<Job *> dependencies; // must have finished before any element starts
+
+	void setup(uint32_t p_elements) {
+
+		elements = p_elements;
+		runs = memnew_arr(uint32_t, MAX(elements, 1U));
+		for (uint32_t i = 0; i < elements; i++) {
+			runs[i] = 0;
+		}
+	}
+
+	bool check() const {
+
+		if (errors || finished != elements)
+			return false;
+		for (uint32_t i = 0; i < elements; i++) {
+			if (runs[i] != 1)
+				return false;
+		}
+		return true;
+	}
+
+	Job() {
+		elements = 0;
+		runs = NULL;
+		finished = 0;
+		waiter_runs = 0;
+		errors = 0;
+	}
+
+	~Job() {
+		if (runs)
+			memdelete_arr(runs);
+	}
+};
+
+static void job_element(void *p_userdata, uint32_t p_index) {
+
+	Job *job = (Job *)p_userdata;
+	if (p_index >= job->elements) {
+		atomic_increment(&job->errors);
+		return;
+	}
+
+	for (int i = 0; i < job->dependencies.size(); i++) {
+		if (job->dependencies[i]->finished != job->dependencies[i]->elements) {
+			atomic_increment(&job->errors);
+		}
+	}
+
+	atomic_increment(&job->runs[p_index]);
+	if (!WorkerThreadPool::get_singleton()->is_worker_thread()) {
+		atomic_increment(&job->waiter_runs);
+	}
+
+	// enough work for the runners and the waiter to interleave
+	volatile uint32_t x = p_index;
+	for (int i = 0; i < 256; i++) {
+		x = x * 1664525 + 1013904223;
+	}
+
+	atomic_increment(&job->finished);
+}
+
+static void job_task(void *p_userdata) {
+
+	job_element(p_userdata, 0);
+}
+
+static bool test_group_tasks() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	const int job_count = 256;
+	Job *jobs = memnew_arr(Job, job_count);
+	Vector<WorkerThreadPool::TaskID> ids;
+
+	RandomPCG rng(1);
+	for (int i = 0; i < job_count; i++) {
+		// a few empty and single element groups, and a varying number of runners
+		uint32_t elements = i % 16 == 0 ? i / 64 : rng.rand() % 2048;
+		int tasks_needed = i % 3 == 0 ? -1 : 1 + i % 7;
+		jobs[i].setup(elements);
+		ids.push_back(pool->add_native_group_task(&job_element, &jobs[i], elements, tasks_needed));
+	}
+
+	bool ok = true;
+	// not in the order they were added, so some are waited for while others still run
+	for (int i = 0; i < job_count; i++) {
+		int index = (i * 7) % job_count;
+		ok = ok && ids[index] != WorkerThreadPool::INVALID_TASK_ID;
+		ok = pool->wait_for_task_completion(ids[index]) == OK && ok;
+		ok = ok && jobs[index].check();
+	}
+
+	memdelete_arr(jobs);
+	return ok;
+}
+
+struct Blocker {
+
+	Semaphore *release;
+	volatile uint32_t started;
+};
+
+static void block_worker(void *p_userdata) {
+
+	Blocker *blocker = (Blocker *)p_userdata;
+	atomic_increment(&blocker->started);
+	blocker->release->wait();
+}
+
+static bool test_waiter_runs_elements() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	// keep every worker busy, so the waiter is the only one left to run the group
+	Blocker blocker;
+	blocker.release = Semaphore::create();
+	blocker.started = 0;
+
+	Vector<WorkerThreadPool::TaskID> blocker_ids;
+	for (int i = 0; i < pool->get_thread_count(); i++) {
+		blocker_ids.push_back(pool->add_native_task(&block_worker, &blocker));
+	}
+	while (blocker.started < (uint32_t)blocker_ids.size()) {
+		OS::get_singleton()->delay_usec(100);
+	}
+
+	Job job;
+	job.setup(1000);
+	WorkerThreadPool::TaskID id = pool->add_native_group_task(&job_element, &job, job.elements);
+	bool ok = id != WorkerThreadPool::INVALID_TASK_ID;
+	ok = ok && pool->wait_for_task_completion(id) == OK;
+	ok = ok && job.check() && job.waiter_runs == job.elements;
+
+	for (int i = 0; i < blocker_ids.size(); i++) {
+		blocker.release->post();
+	}
+	for (int i = 0; i < blocker_ids.size(); i++) {
+		ok = pool->wait_for_task_completion(blocker_ids[i]) == OK && ok;
+	}
+	memdelete(blocker.release);
+
+	return ok;
+}
+
+// Waits for its child from within a task, and the innermost one for a group.
+struct NestedTask {
+
+	NestedTask *child;
+	Job job;
+	bool failed;
+};
+
+static void nested_task(void *p_userdata) {
+
+	NestedTask *task = (NestedTask *)p_userdata;
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	WorkerThreadPool::TaskID id;
+	if (task->child) {
+		id = pool->add_native_task(&nested_task, task->child);
+	} else {
+		id = pool->add_native_group_task(&job_element, &task->job, task->job.elements);
+	}
+
+	bool ok = id != WorkerThreadPool::INVALID_TASK_ID && pool->wait_for_task_completion(id) == OK;
+	task->failed = !ok || (task->child ? task->child->failed : !task->job.check());
+}
+
+static bool test_nested_waits() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	// more chains than workers, so workers waiting for their children pick up other chains
+	const int chain_count = 48;
+	const int depth = 3;
+	NestedTask *tasks = memnew_arr(NestedTask, chain_count * depth);
+	Vector<WorkerThreadPool::TaskID> ids;
+
+	for (int i = 0; i < chain_count; i++) {
+		for (int j = 0; j < depth; j++) {
+			NestedTask &task = tasks[i * depth + j];
+			task.child = j < depth - 1 ? &tasks[i * depth + j + 1] : NULL;
+			task.failed = true;
+			if (!task.child) {
+				task.job.setup(64 + i * 8);
+			}
+		}
+		ids.push_back(pool->add_native_task(&nested_task, &tasks[i * depth]));
+	}
+
+	bool ok = true;
+	for (int i = 0; i < chain_count; i++) {
+		ok = ok && ids[i] != WorkerThreadPool::INVALID_TASK_ID;
+		ok = pool->wait_for_task_completion(ids[i]) == OK && ok;
+		ok = ok && !tasks[i * depth].failed;
+	}
+
+	memdelete_arr(tasks);
+	return ok;
+}
+
+static bool test_dependency_chains() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	const int chain_count = 8;
+	const int chain_length = 16;
+	Job *jobs = memnew_arr(Job, chain_count * chain_length + 2);
+	Vector<WorkerThreadPool::TaskID> ids;
+	ids.resize(chain_count * chain_length + 2);
+
+	// a dependency that is already complete, but not waited for yet
+	Job &first = jobs[chain_count * chain_length];
+	first.setup(1);
+	WorkerThreadPool::TaskID first_id = pool->add_native_task(&job_task, &first);
+	ERR_FAIL_COND_V(first_id == WorkerThreadPool::INVALID_TASK_ID, false);
+	while (!pool->is_task_completed(first_id)) {
+		if (!pool->process_pending_task()) {
+			OS::get_singleton()->delay_usec(100);
+		}
+	}
+	ids.write[chain_count * chain_length] = first_id;
+
+	// the chains are added side by side, alternating single and group tasks
+	for (int j = 0; j < chain_length; j++) {
+		for (int i = 0; i < chain_count; i++) {
+			int index = i * chain_length + j;
+			int previous = j > 0 ? index - 1 : chain_count * chain_length;
+
+			Vector<WorkerThreadPool::TaskID> dependencies;
+			dependencies.push_back(ids[previous]);
+			jobs[index].dependencies.push_back(&jobs[previous]);
+
+			if (j % 2) {
+				jobs[index].setup(1);
+				ids.write[index] = pool->add_native_task(&job_task, &jobs[index], dependencies);
+			} else {
+				jobs[index].setup(100 + i * 50);
+				ids.write[index] = pool->add_native_group_task(&job_element, &jobs[index], jobs[index].elements, -1, dependencies);
+			}
+		}
+	}
+
+	// and joined by a group depending on the end of every chain
+	Job &last = jobs[chain_count * chain_length + 1];
+	last.setup(500);
+	Vector<WorkerThreadPool::TaskID> last_dependencies;
+	for (int i = 0; i < chain_count; i++) {
+		int index = i * chain_length + chain_length - 1;
+		last_dependencies.push_back(ids[index]);
+		last.dependencies.push_back(&jobs[index]);
+	}
+	ids.write[chain_count * chain_length + 1] = pool->add_native_group_task(&job_element, &last, last.elements, -1, last_dependencies);
+
+	// waiting for the last one first has the waiter wait on unfinished dependencies
+	bool ok = true;
+	for (int i = ids.size() - 1; i >= 0; i--) {
+		ok = ok && ids[i] != WorkerThreadPool::INVALID_TASK_ID;
+		ok = pool->wait_for_task_completion(ids[i]) == OK && ok;
+		ok = ok && jobs[i].check();
+	}
+
+	memdelete_arr(jobs);
+	return ok;
+}
+
+static bool test_unknown_dependencies() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	OS::get_singleton()->print("\t(the errors printed below are expected)\n");
+
+	Job done;
+	done.setup(1);
+	WorkerThreadPool::TaskID done_id = pool->add_native_task(&job_task, &done);
+	bool ok = pool->wait_for_task_completion(done_id) == OK && done.check();
+
+	Job pending;
+	pending.setup(10);
+	WorkerThreadPool::TaskID pending_id = pool->add_native_group_task(&job_element, &pending, pending.elements);
+	ok = ok && pending_id != WorkerThreadPool::INVALID_TASK_ID;
+
+	Job rejected;
+	rejected.setup(10);
+
+	WorkerThreadPool::TaskID unknown_ids[3] = { done_id, WorkerThreadPool::INVALID_TASK_ID, pending_id + 1000 };
+	for (int i = 0; i < 3; i++) {
+		// a valid dependency next to the unknown one must not matter
+		Vector<WorkerThreadPool::TaskID> dependencies;
+		dependencies.push_back(pending_id);
+		dependencies.push_back(unknown_ids[i]);
+
+		ok = ok && pool->add_native_task(&job_task, &rejected, dependencies) == WorkerThreadPool::INVALID_TASK_ID;
+		ok = ok && pool->add_native_group_task(&job_element, &rejected, rejected.elements, -1, dependencies) == WorkerThreadPool::INVALID_TASK_ID;
+	}
+
+	// nor can a task be waited for twice
+	ok = ok && pool->wait_for_task_completion(done_id) == ERR_INVALID_PARAMETER;
+
+	ok = pool->wait_for_task_completion(pending_id) == OK && ok;
+	ok = ok && pending.check();
+
+	// nothing rejected was queued
+	while (pool->process_pending_task()) {
+	}
+	ok = ok && rejected.finished == 0 && rejected.errors == 0;
+
+	return ok;
+}
+
+static bool test_without_worker_threads() {
+
+	// everything runs on the waiting threads, as with NO_THREADS
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, false);
+
+	int thread_count = pool->get_thread_count();
+	pool->finish();
+	pool->init(0);
+
+	bool ok = test_group_tasks();
+	ok = test_waiter_runs_elements() && ok;
+	ok = test_nested_waits() && ok;
+	ok = test_dependency_chains() && ok;
+
+	pool->finish();
+	pool->init(thread_count);
+
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_group_tasks,
+	test_waiter_runs_elements,
+	test_nested_waits,
+	test_dependency_chains,
+	test_unknown_dependencies,
+	test_without_worker_threads,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+	return NULL;
+}
+
+} // namespace TestWorkerThreadPool
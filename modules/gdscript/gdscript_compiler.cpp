@@ -74,6 +74,60 @@ void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::N
 	}
 }
 
+static GDScriptFunction::Opcode _get_operator_opcode(Variant::Operator p_op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) {
+
+	// pick a form specialized on the operand types when the parser knows them, the VM still checks them
+	if (!p_a.has_type || !p_b.has_type || p_a.kind != GDScriptParser::DataType::BUILTIN || p_b.kind != GDScriptParser::DataType::BUILTIN) {
+		return GDScriptFunction::OPCODE_OPERATOR;
+	}
+
+	Variant::Type type_a = p_a.builtin_type;
+	Variant::Type type_b = p_b.builtin_type;
+
+	bool arithmetic = p_op == Variant::OP_ADD || p_op == Variant::OP_SUBTRACT || p_op == Variant::OP_MULTIPLY || p_op == Variant::OP_DIVIDE;
+	bool comparison = p_op >= Variant::OP_EQUAL && p_op <= Variant::OP_GREATER_EQUAL;
+	bool scalar_a = type_a == Variant::INT || type_a == Variant::REAL;
+	bool scalar_b = type_b == Variant::INT || type_b == Variant::REAL;
+
+	if (type_a == Variant::INT && type_b == Variant::INT) {
+		bool bitwise = p_op == Variant::OP_MODULE || (p_op >= Variant::OP_SHIFT_LEFT && p_op <= Variant::OP_BIT_XOR);
+		if (arithmetic || comparison || bitwise) {
+			return GDScriptFunction::OPCODE_OPERATOR_INT;
+		}
+	} else if (scalar_a && scalar_b) {
+		if (arithmetic || comparison) {
+			return GDScriptFunction::OPCODE_OPERATOR_REAL;
+		}
+	} else if (type_a == Variant::VECTOR2 || type_b == Variant::VECTOR2 || type_a == Variant::VECTOR3 || type_b == Variant::VECTOR3) {
+
+		Variant::Type vector = (type_a == Variant::VECTOR2 || type_b == Variant::VECTOR2) ? Variant::VECTOR2 : Variant::VECTOR3;
+		bool supported = false;
+
+		if (type_a == vector && type_b == vector) {
+			supported = arithmetic || p_op == Variant::OP_EQUAL || p_op == Variant::OP_NOT_EQUAL;
+		} else if (type_a == vector && scalar_b) {
+			supported = p_op == Variant::OP_MULTIPLY || p_op == Variant::OP_DIVIDE;
+		} else if (scalar_a && type_b == vector) {
+			supported = p_op == Variant::OP_MULTIPLY;
+		}
+
+		if (supported) {
+			return vector == Variant::VECTOR2 ? GDScriptFunction::OPCODE_OPERATOR_VECTOR2 : GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+		}
+	}
+
+	return GDScriptFunction::OPCODE_OPERATOR;
+}
+
+static bool _is_typed_array_index(const GDScriptParser::Node *p_base, const GDScriptParser::Node *p_index) {
+
+	GDScriptParser::DataType base_type = p_base->get_datatype();
+	GDScriptParser::DataType index_type = p_index->get_datatype();
+
+	return base_type.has_type && base_type.kind == GDScriptParser::DataType::BUILTIN && base_type.builtin_type == Variant::ARRAY &&
+		   index_type.has_type && index_type.kind == GDScriptParser::DataType::BUILTIN && index_type.builtin_type == Variant::INT;
+}
+
 bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size() != 1, false);
@@ -104,7 +158,7 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, on->arguments[0]->get_datatype(), on->arguments[1]->get_datatype())); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
@@ -663,11 +717,25 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
+						// every call site gets an inline cache, those on a base statically typed as a native class start resolved
+						GDScriptParser::DataType base_type = instance->get_datatype();
+						int cache;
+						if (instance->type != GDScriptParser::Node::TYPE_SELF && base_type.has_type && !base_type.is_meta_type && base_type.kind == GDScriptParser::DataType::NATIVE) {
+
+							StringName native_type = base_type.native_type;
+							cache = codegen.add_call_cache(native_type, ClassDB::get_method(native_type, static_cast<GDScriptParser::IdentifierNode *>(on->arguments[1])->name));
+						} else {
+							cache = codegen.add_call_cache();
+						}
+
 						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
 						codegen.opcodes.push_back(on->arguments.size() - 2);
 						codegen.alloc_call(on->arguments.size() - 2);
-						for (int i = 0; i < arguments.size(); i++)
+						for (int i = 0; i < arguments.size(); i++) {
 							codegen.opcodes.push_back(arguments[i]);
+							if (i == 1)
+								codegen.opcodes.push_back(cache);
+						}
 					}
 				} break;
 				case GDScriptParser::OperatorNode::OP_YIELD: {
@@ -754,7 +822,13 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
-					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+					if (named) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED); // perform operator
+					} else if (_is_typed_array_index(on->arguments[0], on->arguments[1])) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_ARRAY_INDEX);
+					} else {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET);
+					}
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
 
@@ -1102,7 +1176,13 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						if (set_value < 0) //error
 							return set_value;
 
-						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+						if (named) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_NAMED);
+						} else if (_is_typed_array_index(op->arguments[0], op->arguments[1])) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_ARRAY_INDEX);
+						} else {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET);
+						}
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
 						codegen.opcodes.push_back(set_value);
@@ -1760,6 +1840,29 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_global_names_ptr = NULL;
 		gdfunc->_global_names_count = 0;
 	}
+	//call caches
+	if (codegen.call_caches.size()) {
+
+		gdfunc->call_caches.resize(codegen.call_caches.size());
+		for (int i = 0; i < codegen.call_caches.size(); i++) {
+
+			GDScriptFunction::CallCache *entry = NULL;
+			if (codegen.call_caches[i].first != StringName()) {
+				entry = memnew(GDScriptFunction::CallCache);
+				entry->class_name = codegen.call_caches[i].first;
+				entry->method = codegen.call_caches[i].second;
+				entry->misses = 0;
+				gdfunc->call_cache_entries.push_back(entry);
+			}
+			gdfunc->call_caches.write[i] = entry;
+		}
+		gdfunc->_call_caches_ptr = gdfunc->call_caches.ptrw();
+		gdfunc->_call_cache_count = gdfunc->call_caches.size();
+
+	} else {
+		gdfunc->_call_caches_ptr = NULL;
+		gdfunc->_call_cache_count = 0;
+	}
 
 #ifdef TOOLS_ENABLED
 	// Named globals
@@ -1795,6 +1898,11 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_default_arg_ptr = NULL;
 	}
 
+	if (lowering_enabled) {
+		// line opcodes are only needed to report the current line to the debugger
+		gdfunc->_lower_code(!ScriptDebugger::get_singleton());
+	}
+
 	gdfunc->_argument_count = p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size = codegen.stack_max;
 	gdfunc->_call_size = codegen.call_max;
@@ -2226,5 +2334,17 @@ int GDScriptCompiler::get_error_column() const {
 	return err_column;
 }
 
+void GDScriptCompiler::set_lowering_enabled(bool p_enabled) {
+
+	lowering_enabled = p_enabled;
+}
+
+bool GDScriptCompiler::is_lowering_enabled() const {
+
+	return lowering_enabled;
+}
+
 GDScriptCompiler::GDScriptCompiler() {
+
+	lowering_enabled = true;
 }
@@ -114,6 +114,13 @@ class GDScriptCompiler {
 			return ret;
 		}
 
+		Vector<Pair<StringName, MethodBind *> > call_caches;
+
+		int add_call_cache(const StringName &p_class = StringName(), MethodBind *p_method = NULL) {
+			call_caches.push_back(Pair<StringName, MethodBind *>(p_class, p_method));
+			return call_caches.size() - 1;
+		}
+
 		int get_constant_pos(const Variant &p_constant) {
 			if (constant_map.has(p_constant))
 				return constant_map[p_constant];
@@ -156,6 +163,7 @@ class GDScriptCompiler {
 	int err_column;
 	StringName source;
 	String error;
+	bool lowering_enabled;
 
 public:
 	Error compile(const GDScriptParser *p_parser, GDScript *p_script, bool p_keep_state = false);
@@ -164,6 +172,9 @@ public:
 	int get_error_line() const;
 	int get_error_column() const;
 
+	void set_lowering_enabled(bool p_enabled);
+	bool is_lowering_enabled() const;
+
 	GDScriptCompiler();
 };
 
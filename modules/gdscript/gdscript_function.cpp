@@ -133,6 +133,161 @@ Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_insta
 	return NULL;
 }
 
+Variant *GDScriptFunction::_get_operand(Variant *const *p_bases, int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const {
+
+	//bases are resolved once per call, addressing modes without one (or in an invalid context) take the slow path
+	int type = (p_address & ADDR_TYPE_MASK) >> ADDR_BITS;
+	Variant *base = p_bases[type];
+	if (likely(base != NULL)) {
+		int address = p_address & ADDR_MASK;
+#ifdef DEBUG_ENABLED
+		switch (type) {
+			case ADDR_TYPE_MEMBER: {
+				ERR_FAIL_INDEX_V(address, p_instance->members.size(), NULL);
+			} break;
+			case ADDR_TYPE_LOCAL_CONSTANT: {
+				ERR_FAIL_INDEX_V(address, _constant_count, NULL);
+			} break;
+			case ADDR_TYPE_STACK:
+			case ADDR_TYPE_STACK_VARIABLE: {
+				ERR_FAIL_INDEX_V(address, _stack_size, NULL);
+			} break;
+		}
+#endif
+		return &base[address];
+	}
+
+	return _get_variant(p_address, p_instance, p_script, self, p_stack, r_error);
+}
+
+bool GDScriptFunction::_evaluate_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst, String &r_error) const {
+
+	bool valid;
+#ifdef DEBUG_ENABLED
+
+	Variant ret;
+	Variant::evaluate(p_op, *p_a, *p_b, ret, valid);
+	if (!valid) {
+
+		if (ret.get_type() == Variant::STRING) {
+			//return a string when invalid with the error
+			r_error = ret;
+			r_error += " in operator '" + Variant::get_operator_name(p_op) + "'.";
+		} else {
+			r_error = "Invalid operands '" + Variant::get_type_name(p_a->get_type()) + "' and '" + Variant::get_type_name(p_b->get_type()) + "' in operator '" + Variant::get_operator_name(p_op) + "'.";
+		}
+		return false;
+	}
+	*r_dst = ret;
+#else
+	Variant::evaluate(p_op, *p_a, *p_b, *r_dst, valid);
+#endif
+	return true;
+}
+
+// Fast paths for the type-specialized operator opcodes, they return false for anything they don't
+// handle (including division by zero) so the generic evaluation can take care of it, errors included.
+
+static _FORCE_INLINE_ bool _evaluate_int_operator(Variant::Operator p_op, int64_t p_a, int64_t p_b, Variant *r_dst) {
+
+	switch (p_op) {
+		case Variant::OP_EQUAL: *r_dst = p_a == p_b; return true;
+		case Variant::OP_NOT_EQUAL: *r_dst = p_a != p_b; return true;
+		case Variant::OP_LESS: *r_dst = p_a < p_b; return true;
+		case Variant::OP_LESS_EQUAL: *r_dst = p_a <= p_b; return true;
+		case Variant::OP_GREATER: *r_dst = p_a > p_b; return true;
+		case Variant::OP_GREATER_EQUAL: *r_dst = p_a >= p_b; return true;
+		case Variant::OP_ADD: *r_dst = p_a + p_b; return true;
+		case Variant::OP_SUBTRACT: *r_dst = p_a - p_b; return true;
+		case Variant::OP_MULTIPLY: *r_dst = p_a * p_b; return true;
+		case Variant::OP_DIVIDE: {
+			if (p_b == 0)
+				return false;
+			*r_dst = p_a / p_b;
+			return true;
+		}
+		case Variant::OP_MODULE: {
+			if (p_b == 0)
+				return false;
+			*r_dst = p_a % p_b;
+			return true;
+		}
+		case Variant::OP_SHIFT_LEFT: *r_dst = p_a << p_b; return true;
+		case Variant::OP_SHIFT_RIGHT: *r_dst = p_a >> p_b; return true;
+		case Variant::OP_BIT_AND: *r_dst = p_a & p_b; return true;
+		case Variant::OP_BIT_OR: *r_dst = p_a | p_b; return true;
+		case Variant::OP_BIT_XOR: *r_dst = p_a ^ p_b; return true;
+		default: return false;
+	}
+}
+
+static _FORCE_INLINE_ bool _evaluate_real_operator(Variant::Operator p_op, double p_a, double p_b, Variant *r_dst) {
+
+	switch (p_op) {
+		case Variant::OP_EQUAL: *r_dst = p_a == p_b; return true;
+		case Variant::OP_NOT_EQUAL: *r_dst = p_a != p_b; return true;
+		case Variant::OP_LESS: *r_dst = p_a < p_b; return true;
+		case Variant::OP_LESS_EQUAL: *r_dst = p_a <= p_b; return true;
+		case Variant::OP_GREATER: *r_dst = p_a > p_b; return true;
+		case Variant::OP_GREATER_EQUAL: *r_dst = p_a >= p_b; return true;
+		case Variant::OP_ADD: *r_dst = p_a + p_b; return true;
+		case Variant::OP_SUBTRACT: *r_dst = p_a - p_b; return true;
+		case Variant::OP_MULTIPLY: *r_dst = p_a * p_b; return true;
+		case Variant::OP_DIVIDE: {
+			if (p_b == 0)
+				return false;
+			*r_dst = p_a / p_b;
+			return true;
+		}
+		default: return false;
+	}
+}
+
+template <class T>
+static _FORCE_INLINE_ bool _evaluate_vector_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant::Type p_type, Variant *r_dst) {
+
+	Variant::Type type_a = p_a->get_type();
+	Variant::Type type_b = p_b->get_type();
+
+	if (type_a == p_type && type_b == p_type) {
+
+		T a = *p_a;
+		T b = *p_b;
+
+		switch (p_op) {
+			case Variant::OP_EQUAL: *r_dst = a == b; return true;
+			case Variant::OP_NOT_EQUAL: *r_dst = a != b; return true;
+			case Variant::OP_ADD: *r_dst = a + b; return true;
+			case Variant::OP_SUBTRACT: *r_dst = a - b; return true;
+			case Variant::OP_MULTIPLY: *r_dst = a * b; return true;
+			case Variant::OP_DIVIDE: *r_dst = a / b; return true;
+			default: return false;
+		}
+	}
+
+	if (type_a == p_type && (type_b == Variant::REAL || type_b == Variant::INT)) {
+
+		T a = *p_a;
+		real_t b = *p_b;
+
+		switch (p_op) {
+			case Variant::OP_MULTIPLY: *r_dst = a * b; return true;
+			case Variant::OP_DIVIDE: *r_dst = a / b; return true;
+			default: return false;
+		}
+	}
+
+	if (type_b == p_type && (type_a == Variant::REAL || type_a == Variant::INT) && p_op == Variant::OP_MULTIPLY) {
+
+		T b = *p_b;
+		real_t a = *p_a;
+		*r_dst = b * a;
+		return true;
+	}
+
+	return false;
+}
+
 String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const {
 
 	String err_text;
@@ -225,6 +380,16 @@ static String _get_var_type(const Variant *p_type) {
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
+		&&OPCODE_OPERATOR_INT,                \
+		&&OPCODE_OPERATOR_REAL,               \
+		&&OPCODE_OPERATOR_VECTOR2,            \
+		&&OPCODE_OPERATOR_VECTOR3,            \
+		&&OPCODE_GET_ARRAY_INDEX,             \
+		&&OPCODE_SET_ARRAY_INDEX,             \
+		&&OPCODE_OPERATOR_JUMP_IF_NOT,        \
+		&&OPCODE_GET_MEMBER_OPERATOR,         \
+		&&OPCODE_GET_NAMED_OPERATOR,          \
+		&&OPCODE_INCREMENT_LOCAL,             \
 		&&OPCODE_END                          \
 	};
 
@@ -376,6 +541,19 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	String err_text;
 
+	// direct bases for the addressing modes that can be indexed, the rest are looked up on access
+	Variant *address_bases[ADDR_TYPE_NIL + 1];
+	address_bases[ADDR_TYPE_SELF] = p_instance ? &self : NULL;
+	address_bases[ADDR_TYPE_CLASS] = &script->_static_ref;
+	address_bases[ADDR_TYPE_MEMBER] = p_instance ? p_instance->members.ptrw() : NULL;
+	address_bases[ADDR_TYPE_CLASS_CONSTANT] = NULL;
+	address_bases[ADDR_TYPE_LOCAL_CONSTANT] = _constants_ptr;
+	address_bases[ADDR_TYPE_STACK] = stack;
+	address_bases[ADDR_TYPE_STACK_VARIABLE] = stack;
+	address_bases[ADDR_TYPE_GLOBAL] = NULL; // the global array may grow while running
+	address_bases[ADDR_TYPE_NAMED_GLOBAL] = NULL;
+	address_bases[ADDR_TYPE_NIL] = &nil;
+
 #ifdef DEBUG_ENABLED
 
 	if (ScriptDebugger::get_singleton())
@@ -393,18 +571,27 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #define CHECK_SPACE(m_space) \
 	GD_ERR_BREAK((ip + m_space) > _code_size)
 
-#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                       \
-	Variant *m_v;                                                                              \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, stack, err_text); \
-	if (unlikely(!m_v))                                                                        \
+#define GET_VARIANT_PTR(m_v, m_code_ofs)                                                                      \
+	Variant *m_v;                                                                                             \
+	m_v = _get_operand(address_bases, _code_ptr[ip + m_code_ofs], p_instance, script, self, stack, err_text); \
+	if (unlikely(!m_v))                                                                                       \
 		OPCODE_BREAK;
 
+// anything that runs other code can reload the script (tool scripts, live editing), which reallocates the members of its instances
+#define REFRESH_MEMBER_BASE                                            \
+	if (p_instance) {                                                  \
+		address_bases[ADDR_TYPE_MEMBER] = p_instance->members.ptrw(); \
+	}
+
 #else
 #define GD_ERR_BREAK(m_cond)
 #define CHECK_SPACE(m_space)
 #define GET_VARIANT_PTR(m_v, m_code_ofs) \
 	Variant *m_v;                        \
-	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, script, self, stack, err_text);
+	m_v = _get_operand(address_bases, _code_ptr[ip + m_code_ofs], p_instance, script, self, stack, err_text);
+
+// scripts are only reloaded in debug builds
+#define REFRESH_MEMBER_BASE
 
 #endif
 
@@ -435,7 +622,6 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				CHECK_SPACE(5);
 
-				bool valid;
 				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
 				GD_ERR_BREAK(op >= Variant::OP_MAX);
 
@@ -443,27 +629,12 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_VARIANT_PTR(b, 3);
 				GET_VARIANT_PTR(dst, 4);
 
-#ifdef DEBUG_ENABLED
-
-				Variant ret;
-				Variant::evaluate(op, *a, *b, ret, valid);
-#else
-				Variant::evaluate(op, *a, *b, *dst, valid);
-#endif
-#ifdef DEBUG_ENABLED
-				if (!valid) {
-
-					if (ret.get_type() == Variant::STRING) {
-						//return a string when invalid with the error
-						err_text = ret;
-						err_text += " in operator '" + Variant::get_operator_name(op) + "'.";
-					} else {
-						err_text = "Invalid operands '" + Variant::get_type_name(a->get_type()) + "' and '" + Variant::get_type_name(b->get_type()) + "' in operator '" + Variant::get_operator_name(op) + "'.";
-					}
+				if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
 					OPCODE_BREAK;
+
+				if (op == Variant::OP_IN) {
+					REFRESH_MEMBER_BASE; // reads a property, when the right side is an object
 				}
-				*dst = ret;
-#endif
 				ip += 5;
 			}
 			DISPATCH_OPCODE;
@@ -569,6 +740,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += 4;
 			}
 			DISPATCH_OPCODE;
@@ -602,6 +774,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += 4;
 			}
 			DISPATCH_OPCODE;
@@ -628,6 +801,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += 4;
 			}
 			DISPATCH_OPCODE;
@@ -663,6 +837,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += 4;
 			}
 			DISPATCH_OPCODE;
@@ -688,6 +863,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += 3;
 			}
 			DISPATCH_OPCODE;
@@ -709,6 +885,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += 3;
 			}
 			DISPATCH_OPCODE;
@@ -773,6 +950,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif // DEBUG_ENABLED
 
+				REFRESH_MEMBER_BASE;
 				ip += 4;
 			}
 			DISPATCH_OPCODE;
@@ -876,6 +1054,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
+				REFRESH_MEMBER_BASE;
 				ip += 4;
 			}
 			DISPATCH_OPCODE;
@@ -980,6 +1159,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
+				REFRESH_MEMBER_BASE;
 				ip += 4 + argc;
 				//construct a basic type
 			}
@@ -1032,18 +1212,20 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN;
 
 				int argc = _code_ptr[ip + 1];
 				GET_VARIANT_PTR(base, 2);
 				int nameg = _code_ptr[ip + 3];
+				int cacheg = _code_ptr[ip + 4];
 
 				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
+				GD_ERR_BREAK(cacheg < 0 || cacheg >= _call_cache_count);
 
 				GD_ERR_BREAK(argc < 0);
-				ip += 4;
+				ip += 5;
 				CHECK_SPACE(argc + 1);
 				Variant **argptrs = call_args;
 
@@ -1060,8 +1242,31 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 
 #endif
+				// native methods of objects skip the script and class lookups of Object::call
+				Object *obj = base->get_type() == Variant::OBJECT ? base->operator Object *() : NULL;
+#ifdef DEBUG_ENABLED
+				if (obj && ScriptDebugger::get_singleton() && !base->is_ref() && !ObjectDB::instance_validate(obj)) {
+					obj = NULL; // let the regular call report it
+				}
+#endif
+				MethodBind *method = obj ? _get_cached_method(cacheg, obj, *methodname) : NULL;
+
 				Variant::CallError err;
-				if (call_ret) {
+				if (method) {
+#ifdef DEBUG_ENABLED
+					// as Object::call does, so freeing the object from inside the method is an error, not a crash
+					_ObjectDebugLock obj_lock(obj);
+#endif
+
+					if (call_ret) {
+
+						GET_VARIANT_PTR(ret, argc);
+						*ret = method->call(obj, (const Variant **)argptrs, argc, err);
+					} else {
+
+						method->call(obj, (const Variant **)argptrs, argc, err);
+					}
+				} else if (call_ret) {
 
 					GET_VARIANT_PTR(ret, argc);
 					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
@@ -1106,6 +1311,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 
 				//_call_func(NULL,base,*methodname,ip,argc,p_instance,stack);
+				REFRESH_MEMBER_BASE;
 				ip += argc + 1;
 			}
 			DISPATCH_OPCODE;
@@ -1146,6 +1352,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
+				REFRESH_MEMBER_BASE;
 				ip += argc + 1;
 			}
 			DISPATCH_OPCODE;
@@ -1227,6 +1434,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 
+				REFRESH_MEMBER_BASE;
 				ip += 4 + argc;
 			}
 			DISPATCH_OPCODE;
@@ -1403,7 +1611,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_VARIANT_PTR(container, 2);
 
 				bool valid;
-				if (!container->iter_init(*counter, valid)) {
+				bool more = container->iter_init(*counter, valid);
+				REFRESH_MEMBER_BASE;
+				if (!more) {
 #ifdef DEBUG_ENABLED
 					if (!valid) {
 						err_text = "Unable to iterate on object of type  " + Variant::get_type_name(container->get_type()) + "'.";
@@ -1423,6 +1633,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 						OPCODE_BREAK;
 					}
 #endif
+					REFRESH_MEMBER_BASE;
 					ip += 5; //skip regular iterate which is always next
 				}
 			}
@@ -1436,7 +1647,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_VARIANT_PTR(container, 2);
 
 				bool valid;
-				if (!container->iter_next(*counter, valid)) {
+				bool more = container->iter_next(*counter, valid);
+				REFRESH_MEMBER_BASE;
+				if (!more) {
 #ifdef DEBUG_ENABLED
 					if (!valid) {
 						err_text = "Unable to iterate on object of type  " + Variant::get_type_name(container->get_type()) + "' (type changed since first iteration?).";
@@ -1456,6 +1669,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 						OPCODE_BREAK;
 					}
 #endif
+					REFRESH_MEMBER_BASE;
 					ip += 5; //loop again
 				}
 			}
@@ -1519,6 +1733,322 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_INT) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(a->get_type() != Variant::INT || b->get_type() != Variant::INT || !_evaluate_int_operator(op, *a, *b, dst))) {
+
+					if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+						OPCODE_BREAK;
+				}
+
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_REAL) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				// mixed with ints is fine, both ints is not (the result would be an int)
+				Variant::Type type_a = a->get_type();
+				Variant::Type type_b = b->get_type();
+				bool numeric = (type_a == Variant::REAL && (type_b == Variant::REAL || type_b == Variant::INT)) || (type_a == Variant::INT && type_b == Variant::REAL);
+
+				if (unlikely(!numeric || !_evaluate_real_operator(op, *a, *b, dst))) {
+
+					if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+						OPCODE_BREAK;
+				}
+
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VECTOR2) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_vector_operator<Vector2>(op, a, b, Variant::VECTOR2, dst))) {
+
+					if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+						OPCODE_BREAK;
+				}
+
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VECTOR3) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (unlikely(!_evaluate_vector_operator<Vector3>(op, a, b, Variant::VECTOR3, dst))) {
+
+					if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+						OPCODE_BREAK;
+				}
+
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_ARRAY_INDEX) {
+
+				CHECK_SPACE(3);
+
+				GET_VARIANT_PTR(src, 1);
+				GET_VARIANT_PTR(index, 2);
+				GET_VARIANT_PTR(dst, 3);
+
+				if (likely(src->get_type() == Variant::ARRAY && index->get_type() == Variant::INT)) {
+
+					// arrays are shared, the local only holds a reference
+					Array array = *src;
+					int idx = *index;
+					if (idx < 0)
+						idx += array.size();
+
+					if (likely(idx >= 0 && idx < array.size())) {
+						*dst = array[idx];
+						ip += 4;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				bool valid;
+				Variant ret = src->get(*index, &valid);
+#ifdef DEBUG_ENABLED
+				if (!valid) {
+					String v = index->operator String();
+					if (v != "") {
+						v = "'" + v + "'";
+					} else {
+						v = "of type '" + _get_var_type(index) + "'";
+					}
+					err_text = "Invalid get index " + v + " (on base: '" + _get_var_type(src) + "').";
+					OPCODE_BREAK;
+				}
+#endif
+				*dst = ret;
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_SET_ARRAY_INDEX) {
+
+				CHECK_SPACE(3);
+
+				GET_VARIANT_PTR(dst, 1);
+				GET_VARIANT_PTR(index, 2);
+				GET_VARIANT_PTR(value, 3);
+
+				if (likely(dst->get_type() == Variant::ARRAY && index->get_type() == Variant::INT)) {
+
+					Array array = *dst;
+					int idx = *index;
+					if (idx < 0)
+						idx += array.size();
+
+					if (likely(idx >= 0 && idx < array.size())) {
+						array[idx] = *value;
+						ip += 4;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				bool valid;
+				dst->set(*index, *value, &valid);
+#ifdef DEBUG_ENABLED
+				if (!valid) {
+					String v = index->operator String();
+					if (v != "") {
+						v = "'" + v + "'";
+					} else {
+						v = "of type '" + _get_var_type(index) + "'";
+					}
+					err_text = "Invalid set index " + v + " (on base: '" + _get_var_type(dst) + "') with value of type '" + _get_var_type(value) + "'";
+					OPCODE_BREAK;
+				}
+#endif
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_JUMP_IF_NOT) {
+
+				// an operator followed by a jump-if-not on its result
+				CHECK_SPACE(8);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (!(a->get_type() == Variant::INT && b->get_type() == Variant::INT && _evaluate_int_operator(op, *a, *b, dst))) {
+
+					if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+						OPCODE_BREAK;
+
+					if (op == Variant::OP_IN) {
+						REFRESH_MEMBER_BASE; // reads a property, when the right side is an object
+					}
+				}
+
+				if (!dst->booleanize()) {
+					int to = _code_ptr[ip + 7];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 8;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_MEMBER_OPERATOR) {
+
+				// a property of the owner read into a temporary, followed by an operator
+				CHECK_SPACE(8);
+				int indexname = _code_ptr[ip + 1];
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				const StringName *index = &_global_names_ptr[indexname];
+				GET_VARIANT_PTR(src, 2);
+
+#ifndef DEBUG_ENABLED
+				ClassDB::get_property(p_instance->owner, *index, *src);
+#else
+				bool ok = ClassDB::get_property(p_instance->owner, *index, *src);
+				if (!ok) {
+					err_text = "Internal error getting property: " + String(*index);
+					OPCODE_BREAK;
+				}
+#endif
+				REFRESH_MEMBER_BASE;
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 4];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 5);
+				GET_VARIANT_PTR(b, 6);
+				GET_VARIANT_PTR(dst, 7);
+
+				if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+					OPCODE_BREAK;
+
+				if (op == Variant::OP_IN) {
+					REFRESH_MEMBER_BASE; // reads a property, when the right side is an object
+				}
+				ip += 8;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_NAMED_OPERATOR) {
+
+				// a named index read into a temporary, followed by an operator
+				CHECK_SPACE(9);
+
+				GET_VARIANT_PTR(src, 1);
+				GET_VARIANT_PTR(tmp, 3);
+
+				int indexname = _code_ptr[ip + 2];
+
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				const StringName *index = &_global_names_ptr[indexname];
+
+				bool valid;
+#ifdef DEBUG_ENABLED
+				//allow better error message in cases where src and dst are the same stack position
+				Variant ret = src->get_named(*index, &valid);
+
+				if (!valid) {
+					if (src->has_method(*index)) {
+						err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "'). Did you mean '." + index->operator String() + "()' or funcref(obj, \"" + index->operator String() + "\") ?";
+					} else {
+						err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "').";
+					}
+					OPCODE_BREAK;
+				}
+				*tmp = ret;
+#else
+				*tmp = src->get_named(*index, &valid);
+#endif
+				REFRESH_MEMBER_BASE;
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 5];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+
+				GET_VARIANT_PTR(a, 6);
+				GET_VARIANT_PTR(b, 7);
+				GET_VARIANT_PTR(dst, 8);
+
+				if (unlikely(!_evaluate_operator(op, a, b, dst, err_text)))
+					OPCODE_BREAK;
+
+				if (op == Variant::OP_IN) {
+					REFRESH_MEMBER_BASE; // reads a property, when the right side is an object
+				}
+				ip += 9;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_INCREMENT_LOCAL) {
+
+				// a local variable incremented or decremented by a constant, through a temporary which is not read afterwards
+				CHECK_SPACE(8);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GET_VARIANT_PTR(var, 2);
+				GET_VARIANT_PTR(step, 3);
+
+				if (likely(var->get_type() == Variant::INT && step->get_type() == Variant::INT)) {
+
+					int64_t value = *var;
+					int64_t increment = *step;
+					*var = op == Variant::OP_ADD ? value + increment : value - increment;
+				} else {
+
+					GET_VARIANT_PTR(tmp, 4);
+					if (unlikely(!_evaluate_operator(op, var, step, tmp, err_text)))
+						OPCODE_BREAK;
+
+					*var = *tmp;
+				}
+
+				ip += 8;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_END) {
 #ifdef DEBUG_ENABLED
 				exit_ok = true;
@@ -1552,7 +2082,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		String err_func = name;
 		if (p_instance && p_instance->script->name != "")
 			err_func = p_instance->script->name + "." + err_func;
-		int err_line = line;
+		int err_line = line_table.empty() ? line : _get_line(ip);
 		if (err_text == "") {
 			err_text = "Internal Script Error! - opcode #" + itos(last_opcode) + " (report please).";
 		}
@@ -1711,11 +2241,281 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+MethodBind *GDScriptFunction::_get_cached_method(int p_cache, Object *p_object, const StringName &p_method) {
+
+	const StringName &class_name = p_object->get_class_name();
+	CallCache *cache = _call_caches_ptr[p_cache];
+	MethodBind *method;
+
+	if (likely(cache && cache->class_name == class_name)) {
+
+		method = cache->method;
+	} else {
+
+		if (cache && cache->misses >= CALL_CACHE_MAX_MISSES) {
+			return NULL;
+		}
+
+		if (Object::cast_to<Script>(p_object)) {
+			// scripts override Object::call to reach their static functions first, so never call around it
+			method = NULL;
+		} else {
+			method = ClassDB::get_method(class_name, p_method);
+		}
+
+		CallCache *entry = memnew(CallCache);
+		entry->class_name = class_name;
+		entry->method = method;
+		entry->misses = cache ? cache->misses + 1 : 0;
+
+		// the entry is complete before the lock is taken, so other threads never see it half written
+		if (GDScriptLanguage::get_singleton()->lock) {
+			GDScriptLanguage::get_singleton()->lock->lock();
+		}
+		call_cache_entries.push_back(entry);
+		_call_caches_ptr[p_cache] = entry;
+
+		if (GDScriptLanguage::get_singleton()->lock) {
+			GDScriptLanguage::get_singleton()->lock->unlock();
+		}
+	}
+
+	if (method && p_object->get_script_instance() && p_object->get_script_instance()->has_method(p_method)) {
+		return NULL; // overridden by the script
+	}
+
+	return method;
+}
+
+int GDScriptFunction::_get_line(int p_ip) const {
+
+	// last line entry at or before the instruction
+	int line = _initial_line;
+	int low = 0;
+	int high = line_table.size() - 1;
+
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		if (line_table[middle].first <= p_ip) {
+			line = line_table[middle].second;
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	return line;
+}
+
+static int _get_opcode_size(const int *p_code, int p_ip, int p_code_size) {
+
+	switch (p_code[p_ip]) {
+		case GDScriptFunction::OPCODE_OPERATOR:
+		case GDScriptFunction::OPCODE_OPERATOR_INT:
+		case GDScriptFunction::OPCODE_OPERATOR_REAL:
+		case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+		case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: return 5;
+		case GDScriptFunction::OPCODE_EXTENDS_TEST:
+		case GDScriptFunction::OPCODE_IS_BUILTIN:
+		case GDScriptFunction::OPCODE_SET:
+		case GDScriptFunction::OPCODE_GET:
+		case GDScriptFunction::OPCODE_SET_NAMED:
+		case GDScriptFunction::OPCODE_GET_NAMED:
+		case GDScriptFunction::OPCODE_GET_ARRAY_INDEX:
+		case GDScriptFunction::OPCODE_SET_ARRAY_INDEX: return 4;
+		case GDScriptFunction::OPCODE_SET_MEMBER:
+		case GDScriptFunction::OPCODE_GET_MEMBER:
+		case GDScriptFunction::OPCODE_ASSIGN: return 3;
+		case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+		case GDScriptFunction::OPCODE_ASSIGN_FALSE: return 2;
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN:
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_NATIVE:
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_SCRIPT:
+		case GDScriptFunction::OPCODE_CAST_TO_BUILTIN:
+		case GDScriptFunction::OPCODE_CAST_TO_NATIVE:
+		case GDScriptFunction::OPCODE_CAST_TO_SCRIPT: return 4;
+		case GDScriptFunction::OPCODE_CONSTRUCT: return p_ip + 2 < p_code_size ? 4 + p_code[p_ip + 2] : 0;
+		case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY: return p_ip + 1 < p_code_size ? 3 + p_code[p_ip + 1] : 0;
+		case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY: return p_ip + 1 < p_code_size ? 3 + p_code[p_ip + 1] * 2 : 0;
+		case GDScriptFunction::OPCODE_CALL:
+		case GDScriptFunction::OPCODE_CALL_RETURN: return p_ip + 1 < p_code_size ? 6 + p_code[p_ip + 1] : 0;
+		case GDScriptFunction::OPCODE_CALL_BUILT_IN:
+		case GDScriptFunction::OPCODE_CALL_SELF_BASE: return p_ip + 2 < p_code_size ? 4 + p_code[p_ip + 2] : 0;
+		case GDScriptFunction::OPCODE_YIELD: return 1; // always followed by OPCODE_YIELD_RESUME, where execution continues
+		case GDScriptFunction::OPCODE_YIELD_SIGNAL: return 3;
+		case GDScriptFunction::OPCODE_YIELD_RESUME:
+		case GDScriptFunction::OPCODE_JUMP: return 2;
+		case GDScriptFunction::OPCODE_JUMP_IF:
+		case GDScriptFunction::OPCODE_JUMP_IF_NOT: return 3;
+		case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: return 1;
+		case GDScriptFunction::OPCODE_RETURN: return 2;
+		case GDScriptFunction::OPCODE_ITERATE_BEGIN:
+		case GDScriptFunction::OPCODE_ITERATE: return 5;
+		case GDScriptFunction::OPCODE_ASSERT: return 2;
+		case GDScriptFunction::OPCODE_BREAKPOINT: return 1;
+		case GDScriptFunction::OPCODE_LINE: return 2;
+		case GDScriptFunction::OPCODE_END: return 1;
+	}
+
+	return 0; // unknown, or not expected before lowering
+}
+
+static int _get_jump_operand(const int *p_code, int p_ip) {
+
+	switch (p_code[p_ip]) {
+		case GDScriptFunction::OPCODE_JUMP: return 1;
+		case GDScriptFunction::OPCODE_JUMP_IF:
+		case GDScriptFunction::OPCODE_JUMP_IF_NOT: return 2;
+		case GDScriptFunction::OPCODE_ITERATE_BEGIN:
+		case GDScriptFunction::OPCODE_ITERATE: return 3;
+	}
+
+	return 0;
+}
+
+void GDScriptFunction::_lower_code(bool p_strip_lines) {
+
+	int code_size = code.size();
+	if (!code_size)
+		return;
+
+	const int *code_ptr = code.ptr();
+
+	enum {
+		FLAG_INSTRUCTION = 1,
+		FLAG_JUMP_TARGET = 2
+	};
+
+	// find the instructions and what jumps where, leave the code untouched if anything looks unexpected
+
+	Vector<uint8_t> flags;
+	flags.resize(code_size + 1);
+	for (int i = 0; i <= code_size; i++) {
+		flags.write[i] = 0;
+	}
+
+	for (int ip = 0; ip < code_size;) {
+
+		int size = _get_opcode_size(code_ptr, ip, code_size);
+		ERR_FAIL_COND(size <= 0 || ip + size > code_size);
+
+		flags.write[ip] |= FLAG_INSTRUCTION;
+
+		int jump_operand = _get_jump_operand(code_ptr, ip);
+		if (jump_operand) {
+			int to = code_ptr[ip + jump_operand];
+			ERR_FAIL_COND(to < 0 || to > code_size);
+			flags.write[to] |= FLAG_JUMP_TARGET;
+		}
+
+		ip += size;
+	}
+
+	for (int i = 0; i < default_arguments.size(); i++) {
+		ERR_FAIL_INDEX(default_arguments[i], code_size + 1);
+		flags.write[default_arguments[i]] |= FLAG_JUMP_TARGET;
+	}
+
+	for (int i = 0; i < code_size; i++) {
+		ERR_FAIL_COND((flags[i] & FLAG_JUMP_TARGET) && !(flags[i] & FLAG_INSTRUCTION));
+	}
+
+	// copy the instructions without the line opcodes, fusing the sequences that have a superinstruction
+
+	Vector<int> lowered;
+	Vector<int> remap; // old ip to new ip
+	Vector<int> jumps; // positions in the lowered code that still hold an old ip
+	Vector<Pair<int, int> > lines;
+
+	remap.resize(code_size + 1);
+
+	for (int ip = 0; ip < code_size;) {
+
+		int opcode = code_ptr[ip];
+		int size = _get_opcode_size(code_ptr, ip, code_size);
+		int pos = lowered.size();
+
+		remap.write[ip] = pos;
+
+		if (opcode == OPCODE_LINE && p_strip_lines) {
+			lines.push_back(Pair<int, int>(pos, code_ptr[ip + 1]));
+			ip += size;
+			continue;
+		}
+
+		for (int i = 0; i < size; i++) {
+			lowered.push_back(code_ptr[ip + i]);
+		}
+
+		int jump_operand = _get_jump_operand(code_ptr, ip);
+		if (jump_operand) {
+			jumps.push_back(pos + jump_operand);
+		}
+
+		// the superinstructions keep the layout of the instructions they replace, so only the first opcode changes,
+		// but nothing may jump between the two
+		int next = ip + size;
+		if (next < code_size && !(flags[next] & FLAG_JUMP_TARGET)) {
+
+			const int *a = &code_ptr[ip];
+			const int *b = &code_ptr[next];
+
+			// the fused forms have the integer fast path, but not the other typed ones
+			bool generic_or_int = a[0] == OPCODE_OPERATOR || a[0] == OPCODE_OPERATOR_INT;
+
+			if (generic_or_int && b[0] == OPCODE_JUMP_IF_NOT && b[1] == a[4]) {
+
+				lowered.write[pos] = OPCODE_OPERATOR_JUMP_IF_NOT;
+
+			} else if (generic_or_int && b[0] == OPCODE_ASSIGN && (a[1] == Variant::OP_ADD || a[1] == Variant::OP_SUBTRACT) && b[1] == a[2] && b[2] == a[4] && a[2] != a[4]) {
+
+				// only locals stepped by an integer constant, which are the loop counters
+				int var_type = (a[2] & ADDR_TYPE_MASK) >> ADDR_BITS;
+				int step_type = (a[3] & ADDR_TYPE_MASK) >> ADDR_BITS;
+				int step = a[3] & ADDR_MASK;
+				int tmp_type = (a[4] & ADDR_TYPE_MASK) >> ADDR_BITS;
+
+				if (var_type == ADDR_TYPE_STACK_VARIABLE && tmp_type == ADDR_TYPE_STACK && step_type == ADDR_TYPE_LOCAL_CONSTANT && step < constants.size() && constants[step].get_type() == Variant::INT) {
+					lowered.write[pos] = OPCODE_INCREMENT_LOCAL;
+				}
+
+			} else if (a[0] == OPCODE_GET_MEMBER && b[0] == OPCODE_OPERATOR && (b[2] == a[2] || b[3] == a[2])) {
+
+				lowered.write[pos] = OPCODE_GET_MEMBER_OPERATOR;
+
+			} else if (a[0] == OPCODE_GET_NAMED && b[0] == OPCODE_OPERATOR && (b[2] == a[3] || b[3] == a[3])) {
+
+				lowered.write[pos] = OPCODE_GET_NAMED_OPERATOR;
+			}
+		}
+
+		ip += size;
+	}
+
+	remap.write[code_size] = lowered.size();
+
+	for (int i = 0; i < jumps.size(); i++) {
+		lowered.write[jumps[i]] = remap[lowered[jumps[i]]];
+	}
+
+	for (int i = 0; i < default_arguments.size(); i++) {
+		default_arguments.write[i] = remap[default_arguments[i]];
+	}
+
+	code = lowered;
+	_code_ptr = code.ptr();
+	_code_size = code.size();
+	_default_arg_ptr = default_arguments.size() ? default_arguments.ptr() : NULL;
+	line_table = lines;
+}
+
 GDScriptFunction::GDScriptFunction() :
 		function_list(this) {
 
 	_stack_size = 0;
 	_call_size = 0;
+	_call_caches_ptr = NULL;
+	_call_cache_count = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1744,6 +2544,11 @@ GDScriptFunction::GDScriptFunction() :
 }
 
 GDScriptFunction::~GDScriptFunction() {
+
+	for (List<CallCache *>::Element *E = call_cache_entries.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -41,6 +41,7 @@
 
 class GDScriptInstance;
 class GDScript;
+class MethodBind;
 
 struct GDScriptDataType {
 	bool has_type;
@@ -173,6 +174,18 @@ public:
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
+		// forms specialized by the compiler from static types, they check the types at runtime and fall back to the generic code
+		OPCODE_OPERATOR_INT,
+		OPCODE_OPERATOR_REAL,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
+		OPCODE_GET_ARRAY_INDEX,
+		OPCODE_SET_ARRAY_INDEX,
+		// superinstructions, only emitted by the lowering pass over the regular opcodes they replace
+		OPCODE_OPERATOR_JUMP_IF_NOT,
+		OPCODE_GET_MEMBER_OPERATOR,
+		OPCODE_GET_NAMED_OPERATOR,
+		OPCODE_INCREMENT_LOCAL,
 		OPCODE_END
 	};
 
@@ -200,6 +213,19 @@ public:
 		StringName identifier;
 	};
 
+	// Inline cache of a call site: the native method resolved for the last class seen there.
+	// Entries are never modified once published, a miss replaces the whole entry.
+	struct CallCache {
+
+		StringName class_name;
+		MethodBind *method; // NULL if the class has no native method with that name
+		int misses;
+	};
+
+	enum {
+		CALL_CACHE_MAX_MISSES = 4 // sites seeing more classes than this are left to Object::call
+	};
+
 private:
 	friend class GDScriptCompiler;
 
@@ -210,6 +236,8 @@ private:
 	int _constant_count;
 	const StringName *_global_names_ptr;
 	int _global_names_count;
+	CallCache **_call_caches_ptr;
+	int _call_cache_count;
 #ifdef TOOLS_ENABLED
 	const StringName *_named_globals_ptr;
 	int _named_globals_count;
@@ -230,6 +258,8 @@ private:
 	StringName name;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
+	Vector<CallCache *> call_caches; // current entry of each call site
+	List<CallCache *> call_cache_entries; // all the entries ever created, readers may still hold replaced ones
 #ifdef TOOLS_ENABLED
 	Vector<StringName> named_globals;
 #endif
@@ -243,10 +273,17 @@ private:
 #endif
 
 	List<StackDebug> stack_debug;
+	Vector<Pair<int, int> > line_table; // (ip, line), used instead of line opcodes when those are stripped
 
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
+	_FORCE_INLINE_ Variant *_get_operand(Variant *const *p_bases, int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
+	_FORCE_INLINE_ bool _evaluate_operator(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
+	MethodBind *_get_cached_method(int p_cache, Object *p_object, const StringName &p_method);
+	int _get_line(int p_ip) const;
+	void _lower_code(bool p_strip_lines);
+
 	friend class GDScriptLanguage;
 
 	SelfList<GDScriptFunction> function_list;
@@ -65,7 +65,7 @@ int godot_icall_GD_hash(MonoObject *p_var) {
 	return GDMonoMarshal::mono_object_to_variant(p_var).hash();
 }
 
-MonoObject *godot_icall_GD_instance_from_id(int p_instance_id) {
+MonoObject *godot_icall_GD_instance_from_id(uint64_t p_instance_id) {
 	return GDMonoUtils::unmanaged_get_managed(ObjectDB::get_instance(p_instance_id));
 }
 
@@ -158,9 +158,18 @@ static Ref<Image> _webp_mem_loader_func(const uint8_t *p_png, int p_size) {
 
 Error ImageLoaderWEBP::load_image(Ref<Image> p_image, FileAccess *f, bool p_force_linear, float p_scale) {
 
-	PoolVector<uint8_t> src_image;
 	int src_image_len = f->get_len();
 	ERR_FAIL_COND_V(src_image_len == 0, ERR_FILE_CORRUPT);
+
+	const uint8_t *mapped = f->get_mapped_buffer();
+	if (mapped) {
+		// decode straight from the mapped file, it stays valid until closed
+		Error err = webp_load_image_from_buffer(p_image.ptr(), mapped, src_image_len);
+		f->close();
+		return err;
+	}
+
+	PoolVector<uint8_t> src_image;
 	src_image.resize(src_image_len);
 
 	PoolVector<uint8_t>::Write w = src_image.write();
@@ -85,7 +85,7 @@ private:
 	struct TrackNodeCache {
 
 		NodePath path;
-		uint32_t id;
+		ObjectID id;
 		RES resource;
 		Node *node;
 		Spatial *spatial;
@@ -152,7 +152,7 @@ private:
 
 	struct TrackNodeCacheKey {
 
-		uint32_t id;
+		ObjectID id;
 		int bone_idx;
 
 		inline bool operator<(const TrackNodeCacheKey &p_right) const {
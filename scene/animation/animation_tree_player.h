@@ -78,7 +78,7 @@ private:
 
 	struct TrackKey {
 
-		uint32_t id;
+		ObjectID id;
 		StringName subpath_concatenated;
 		int bone_idx;
 
@@ -95,7 +95,7 @@ private:
 	};
 
 	struct Track {
-		uint32_t id;
+		ObjectID id;
 		Object *object;
 		Spatial *spatial;
 		Skeleton *skeleton;
@@ -34,13 +34,13 @@
 
 Size2 Button::get_minimum_size() const {
 
-	Size2 minsize = get_font("font")->get_string_size(xl_text);
+	Size2 minsize = get_font(SNAME("font"))->get_string_size(xl_text);
 	if (clip_text)
 		minsize.width = 0;
 
 	Ref<Texture> _icon;
-	if (icon.is_null() && has_icon("icon"))
-		_icon = Control::get_icon("icon");
+	if (icon.is_null() && has_icon(SNAME("icon")))
+		_icon = Control::get_icon(SNAME("icon"));
 	else
 		_icon = icon;
 
@@ -49,10 +49,10 @@ Size2 Button::get_minimum_size() const {
 		minsize.height = MAX(minsize.height, _icon->get_height());
 		minsize.width += _icon->get_width();
 		if (xl_text != "")
-			minsize.width += get_constant("hseparation");
+			minsize.width += get_constant(SNAME("hseparation"));
 	}
 
-	return get_stylebox("normal")->get_minimum_size() + minsize;
+	return get_stylebox(SNAME("normal"))->get_minimum_size() + minsize;
 }
 
 void Button::_set_internal_margin(Margin p_margin, float p_value) {
@@ -75,89 +75,89 @@ void Button::_notification(int p_what) {
 		Color color;
 		Color color_icon(1, 1, 1, 1);
 
-		Ref<StyleBox> style = get_stylebox("normal");
+		Ref<StyleBox> style = get_stylebox(SNAME("normal"));
 
 		switch (get_draw_mode()) {
 
 			case DRAW_NORMAL: {
 
-				style = get_stylebox("normal");
+				style = get_stylebox(SNAME("normal"));
 				if (!flat)
 					style->draw(ci, Rect2(Point2(0, 0), size));
-				color = get_color("font_color");
-				if (has_color("icon_color_normal"))
-					color_icon = get_color("icon_color_normal");
+				color = get_color(SNAME("font_color"));
+				if (has_color(SNAME("icon_color_normal")))
+					color_icon = get_color(SNAME("icon_color_normal"));
 			} break;
 			case DRAW_HOVER_PRESSED: {
-				if (has_stylebox("hover_pressed") && has_stylebox_override("hover_pressed")) {
-					style = get_stylebox("hover_pressed");
+				if (has_stylebox(SNAME("hover_pressed")) && has_stylebox_override("hover_pressed")) {
+					style = get_stylebox(SNAME("hover_pressed"));
 					if (!flat)
 						style->draw(ci, Rect2(Point2(0, 0), size));
-					if (has_color("font_color_hover_pressed"))
-						color = get_color("font_color_hover_pressed");
+					if (has_color(SNAME("font_color_hover_pressed")))
+						color = get_color(SNAME("font_color_hover_pressed"));
 					else
-						color = get_color("font_color");
-					if (has_color("icon_color_hover_pressed"))
-						color_icon = get_color("icon_color_hover_pressed");
+						color = get_color(SNAME("font_color"));
+					if (has_color(SNAME("icon_color_hover_pressed")))
+						color_icon = get_color(SNAME("icon_color_hover_pressed"));
 
 					break;
 				}
 			}
 			case DRAW_PRESSED: {
 
-				style = get_stylebox("pressed");
+				style = get_stylebox(SNAME("pressed"));
 				if (!flat)
 					style->draw(ci, Rect2(Point2(0, 0), size));
-				if (has_color("font_color_pressed"))
-					color = get_color("font_color_pressed");
+				if (has_color(SNAME("font_color_pressed")))
+					color = get_color(SNAME("font_color_pressed"));
 				else
-					color = get_color("font_color");
-				if (has_color("icon_color_pressed"))
-					color_icon = get_color("icon_color_pressed");
+					color = get_color(SNAME("font_color"));
+				if (has_color(SNAME("icon_color_pressed")))
+					color_icon = get_color(SNAME("icon_color_pressed"));
 
 			} break;
 			case DRAW_HOVER: {
 
-				style = get_stylebox("hover");
+				style = get_stylebox(SNAME("hover"));
 				if (!flat)
 					style->draw(ci, Rect2(Point2(0, 0), size));
-				color = get_color("font_color_hover");
-				if (has_color("icon_color_hover"))
-					color_icon = get_color("icon_color_hover");
+				color = get_color(SNAME("font_color_hover"));
+				if (has_color(SNAME("icon_color_hover")))
+					color_icon = get_color(SNAME("icon_color_hover"));
 
 			} break;
 			case DRAW_DISABLED: {
 
-				style = get_stylebox("disabled");
+				style = get_stylebox(SNAME("disabled"));
 				if (!flat)
 					style->draw(ci, Rect2(Point2(0, 0), size));
-				color = get_color("font_color_disabled");
-				if (has_color("icon_color_disabled"))
-					color_icon = get_color("icon_color_disabled");
+				color = get_color(SNAME("font_color_disabled"));
+				if (has_color(SNAME("icon_color_disabled")))
+					color_icon = get_color(SNAME("icon_color_disabled"));
 
 			} break;
 		}
 
 		if (has_focus()) {
 
-			Ref<StyleBox> style = get_stylebox("focus");
+			Ref<StyleBox> style = get_stylebox(SNAME("focus"));
 			style->draw(ci, Rect2(Point2(), size));
 		}
 
-		Ref<Font> font = get_font("font");
+		Ref<Font> font = get_font(SNAME("font"));
 		Ref<Texture> _icon;
-		if (icon.is_null() && has_icon("icon"))
-			_icon = Control::get_icon("icon");
+		if (icon.is_null() && has_icon(SNAME("icon")))
+			_icon = Control::get_icon(SNAME("icon"));
 		else
 			_icon = icon;
 
-		Point2 icon_ofs = (!_icon.is_null()) ? Point2(_icon->get_width() + get_constant("hseparation"), 0) : Point2();
+		Point2 icon_ofs = (!_icon.is_null()) ? Point2(_icon->get_width() + get_constant(SNAME("hseparation")), 0) : Point2();
 		int text_clip = size.width - style->get_minimum_size().width - icon_ofs.width;
 		Point2 text_ofs = (size - style->get_minimum_size() - icon_ofs - font->get_string_size(xl_text) - Point2(_internal_margin[MARGIN_RIGHT] - _internal_margin[MARGIN_LEFT], 0)) / 2.0;
 
 		switch (align) {
 			case ALIGN_LEFT: {
-				text_ofs.x = style->get_margin(MARGIN_LEFT) + icon_ofs.x + _internal_margin[MARGIN_LEFT] + get_constant("hseparation");
+				text_ofs.x = style->get_margin(MARGIN_LEFT) + icon_ofs.x + _internal_margin[MARGIN_LEFT] + get_constant(SNAME("hseparation"));
 				text_ofs.y += style->get_offset().y;
 			} break;
 			case ALIGN_CENTER: {
@@ -168,7 +168,7 @@ void Button::_notification(int p_what) {
 			} break;
 			case ALIGN_RIGHT: {
 				if (_internal_margin[MARGIN_RIGHT] > 0) {
-					text_ofs.x = size.x - style->get_margin(MARGIN_RIGHT) - font->get_string_size(xl_text).x - _internal_margin[MARGIN_RIGHT] - get_constant("hseparation");
+					text_ofs.x = size.x - style->get_margin(MARGIN_RIGHT) - font->get_string_size(xl_text).x - _internal_margin[MARGIN_RIGHT] - get_constant(SNAME("hseparation"));
 				} else {
 					text_ofs.x = size.x - style->get_margin(MARGIN_RIGHT) - font->get_string_size(xl_text).x;
 				}
@@ -184,7 +184,7 @@ void Button::_notification(int p_what) {
 			if (is_disabled())
 				color_icon.a = 0.4;
 			if (_internal_margin[MARGIN_LEFT] > 0) {
-				_icon->draw(ci, style->get_offset() + Point2(_internal_margin[MARGIN_LEFT] + get_constant("hseparation"), Math::floor((valign - _icon->get_height()) / 2.0)), color_icon);
+				_icon->draw(ci, style->get_offset() + Point2(_internal_margin[MARGIN_LEFT] + get_constant(SNAME("hseparation")), Math::floor((valign - _icon->get_height()) / 2.0)), color_icon);
 			} else {
 				_icon->draw(ci, style->get_offset() + Point2(0, Math::floor((valign - _icon->get_height()) / 2.0)), color_icon);
 			}
@@ -57,7 +57,7 @@ bool Label::is_uppercase() const {
 
 int Label::get_line_height() const {
 
-	return get_font("font")->get_height();
+	return get_font(SNAME("font"))->get_height();
 }
 
 void Label::_notification(int p_what) {
@@ -86,14 +86,14 @@ void Label::_notification(int p_what) {
 
 		Size2 string_size;
 		Size2 size = get_size();
-		Ref<StyleBox> style = get_stylebox("normal");
-		Ref<Font> font = get_font("font");
-		Color font_color = get_color("font_color");
-		Color font_color_shadow = get_color("font_color_shadow");
-		bool use_outline = get_constant("shadow_as_outline");
-		Point2 shadow_ofs(get_constant("shadow_offset_x"), get_constant("shadow_offset_y"));
-		int line_spacing = get_constant("line_spacing");
-		Color font_outline_modulate = get_color("font_outline_modulate");
+		Ref<StyleBox> style = get_stylebox(SNAME("normal"));
+		Ref<Font> font = get_font(SNAME("font"));
+		Color font_color = get_color(SNAME("font_color"));
+		Color font_color_shadow = get_color(SNAME("font_color_shadow"));
+		bool use_outline = get_constant(SNAME("shadow_as_outline"));
+		Point2 shadow_ofs(get_constant(SNAME("shadow_offset_x")), get_constant(SNAME("shadow_offset_y")));
+		int line_spacing = get_constant(SNAME("line_spacing"));
+		Color font_outline_modulate = get_color(SNAME("font_outline_modulate"));
 
 		style->draw(ci, Rect2(Point2(0, 0), get_size()));
 
@@ -293,7 +293,7 @@ void Label::_notification(int p_what) {
 
 Size2 Label::get_minimum_size() const {
 
-	Size2 min_style = get_stylebox("normal")->get_minimum_size();
+	Size2 min_style = get_stylebox(SNAME("normal"))->get_minimum_size();
 
 	// don't want to mutable everything
 	if (word_cache_dirty)
@@ -311,7 +311,7 @@ Size2 Label::get_minimum_size() const {
 
 int Label::get_longest_line_width() const {
 
-	Ref<Font> font = get_font("font");
+	Ref<Font> font = get_font(SNAME("font"));
 	int max_line_width = 0;
 	int line_width = 0;
 
@@ -355,9 +355,9 @@ int Label::get_line_count() const {
 
 int Label::get_visible_line_count() const {
 
-	int line_spacing = get_constant("line_spacing");
-	int font_h = get_font("font")->get_height() + line_spacing;
-	int lines_visible = (get_size().height - get_stylebox("normal")->get_minimum_size().height + line_spacing) / font_h;
+	int line_spacing = get_constant(SNAME("line_spacing"));
+	int font_h = get_font(SNAME("font"))->get_height() + line_spacing;
+	int lines_visible = (get_size().height - get_stylebox(SNAME("normal"))->get_minimum_size().height + line_spacing) / font_h;
 
 	if (lines_visible > line_count)
 		lines_visible = line_count;
@@ -377,9 +377,9 @@ void Label::regenerate_word_cache() {
 		memdelete(current);
 	}
 
-	Ref<StyleBox> style = get_stylebox("normal");
+	Ref<StyleBox> style = get_stylebox(SNAME("normal"));
 	int width = autowrap ? (get_size().width - style->get_minimum_size().width) : get_longest_line_width();
-	Ref<Font> font = get_font("font");
+	Ref<Font> font = get_font(SNAME("font"));
 
 	int current_word_size = 0;
 	int word_pos = 0;
@@ -387,7 +387,7 @@ void Label::regenerate_word_cache() {
 	int space_count = 0;
 	// ceiling to ensure autowrapping does not cut text
 	int space_width = Math::ceil(font->get_char_size(' ').width);
-	int line_spacing = get_constant("line_spacing");
+	int line_spacing = get_constant(SNAME("line_spacing"));
 	line_count = 1;
 	total_char_cache = 0;
 
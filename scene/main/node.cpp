@@ -33,6 +33,7 @@
 #include "core/core_string_names.h"
 #include "core/io/resource_loader.h"
 #include "core/message_queue.h"
+#include "core/os/thread.h"
 #include "core/print_string.h"
 #include "instance_placeholder.h"
 #include "scene/resources/packed_scene.h"
@@ -337,6 +338,11 @@ void Node::move_child(Node *p_child, int p_pos) {
 	data.children.remove(p_child->data.pos);
 	data.children.insert(p_pos, p_child);
 
+	//with repeated names the first one wins, and that may have changed now
+	if (data.child_index && data.child_index_has_duplicates)
+		_child_index_rebuild();
+	_tree_structure_changed();
+
 	if (data.tree) {
 		data.tree->tree_changed();
 	}
@@ -844,6 +850,28 @@ void Node::set_process_priority(int p_priority) {
 		data.tree->make_group_changed("physics_process_internal");
 }
 
+void Node::set_process_thread_safe(bool p_enable) {
+
+	if (data.process_thread_safe == p_enable)
+		return;
+
+	data.process_thread_safe = p_enable;
+
+	if (!data.tree)
+		return;
+
+	if (is_processing())
+		data.tree->make_group_changed("idle_process");
+
+	if (is_physics_processing())
+		data.tree->make_group_changed("physics_process");
+}
+
+bool Node::is_process_thread_safe() const {
+
+	return data.process_thread_safe;
+}
+
 void Node::set_process_input(bool p_enable) {
 
 	if (p_enable == data.input)
@@ -906,10 +934,16 @@ StringName Node::get_name() const {
 
 void Node::_set_name_nocheck(const StringName &p_name) {
 
+	StringName old_name = data.name;
 	data.name = p_name;
+
+	if (data.parent && data.parent->data.child_index)
+		data.parent->_child_index_rename(this, old_name);
+	_tree_structure_changed();
 }
 
 String Node::invalid_character = ". : @ / \"";
+uint64_t Node::tree_structure_version = 1;
 
 bool Node::_validate_node_name(String &p_name) {
 	String name = p_name;
@@ -928,12 +962,16 @@ void Node::set_name(const String &p_name) {
 	_validate_node_name(name);
 
 	ERR_FAIL_COND(name == "");
+	StringName old_name = data.name;
 	data.name = name;
 
 	if (data.parent) {
 
 		data.parent->_validate_child_name(this);
+		if (data.parent->data.child_index)
+			data.parent->_child_index_rename(this, old_name);
 	}
+	_tree_structure_changed();
 
 	propagate_notification(NOTIFICATION_PATH_CHANGED);
 
@@ -984,6 +1022,10 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
 		if (p_child->data.name == StringName() || p_child->data.name.operator String()[0] == '@') {
 			//new unique name must be assigned
 			unique = false;
+		} else if (data.child_index && !data.child_index_has_duplicates) {
+			//the index still has the old name of a child being renamed, so finding it only means the name did not change
+			Node *const *existing = data.child_index->lookup_ptr(p_child->data.name);
+			unique = !existing || *existing == p_child;
 		} else {
 			//check if exists
 			Node **children = data.children.ptrw();
@@ -1110,6 +1152,12 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 	p_child->data.pos = data.children.size();
 	data.children.push_back(p_child);
 	p_child->data.parent = this;
+
+	if (data.child_index)
+		_child_index_add(p_child);
+	else if (data.children.size() >= CHILD_INDEX_MIN_CHILDREN)
+		_child_index_rebuild();
+	_tree_structure_changed();
 	p_child->notification(NOTIFICATION_PARENTED);
 
 	if (data.tree) {
@@ -1238,6 +1286,10 @@ void Node::remove_child(Node *p_child) {
 
 	data.children.remove(idx);
 
+	if (data.child_index)
+		_child_index_remove(p_child);
+	_tree_structure_changed();
+
 	//update pointer and size
 	child_count = data.children.size();
 	children = data.children.ptrw();
@@ -1270,8 +1322,77 @@ Node *Node::get_child(int p_index) const {
 	return data.children[p_index];
 }
 
+void Node::_child_index_rebuild() {
+
+	if (!data.child_index)
+		data.child_index = memnew(ChildIndex(data.children.size() * 2));
+	else
+		data.child_index->clear();
+
+	data.child_index_has_duplicates = false;
+
+	int cc = data.children.size();
+	Node *const *cd = data.children.ptr();
+
+	for (int i = 0; i < cc; i++) {
+		_child_index_add(cd[i]);
+	}
+}
+
+void Node::_child_index_add(Node *p_child) {
+
+	//children are appended, so one already indexed under this name comes first
+	if (data.child_index->has(p_child->data.name)) {
+		data.child_index_has_duplicates = true;
+		return;
+	}
+
+	data.child_index->insert(p_child->data.name, p_child);
+}
+
+void Node::_child_index_remove(Node *p_child) {
+
+	if (data.children.size() < CHILD_INDEX_MIN_CHILDREN / 2) {
+		memdelete(data.child_index);
+		data.child_index = NULL;
+		data.child_index_has_duplicates = false;
+		return;
+	}
+
+	if (data.child_index_has_duplicates) {
+		//another child may share the name and take over
+		_child_index_rebuild();
+		return;
+	}
+
+	data.child_index->remove(p_child->data.name);
+}
+
+void Node::_child_index_rename(Node *p_child, const StringName &p_old_name) {
+
+	if (data.child_index_has_duplicates) {
+		_child_index_rebuild();
+		return;
+	}
+
+	data.child_index->remove(p_old_name);
+
+	if (data.child_index->has(p_child->data.name)) {
+		//clashes with a sibling, which one comes first depends on the order
+		_child_index_rebuild();
+		return;
+	}
+
+	data.child_index->insert(p_child->data.name, p_child);
+}
+
 Node *Node::_get_child_by_name(const StringName &p_name) const {
 
+	if (data.child_index) {
+		Node *const *child = data.child_index->lookup_ptr(p_name);
+		return child ? *child : NULL;
+	}
+
 	int cc = data.children.size();
 	Node *const *cd = data.children.ptr();
 
@@ -1290,6 +1411,18 @@ Node *Node::_get_node(const NodePath &p_path) const {
 		ERR_FAIL_V(NULL);
 	}
 
+	//the cache is only touched from the main thread, as thread-safe process callbacks may resolve paths concurrently
+	int name_count = p_path.get_name_count();
+	bool use_cache = name_count > 1 && Thread::get_caller_id() == Thread::get_main_id();
+	uint32_t slot = 0;
+
+	if (use_cache) {
+		slot = p_path.hash() & (GET_NODE_CACHE_SIZE - 1);
+		const GetNodeCache *cache = data.get_node_cache;
+		if (cache && cache->version[slot] == tree_structure_version && cache->path[slot] == p_path)
+			return cache->node[slot];
+	}
+
 	Node *current = NULL;
 	Node *root = NULL;
 
@@ -1302,7 +1435,7 @@ Node *Node::_get_node(const NodePath &p_path) const {
 			root = root->data.parent; //start from root
 	}
 
-	for (int i = 0; i < p_path.get_name_count(); i++) {
+	for (int i = 0; i < name_count; i++) {
 
 		StringName name = p_path.get_name(i);
 		Node *next = NULL;
@@ -1324,18 +1457,7 @@ Node *Node::_get_node(const NodePath &p_path) const {
 
 		} else {
 
-			next = NULL;
-
-			for (int j = 0; j < current->data.children.size(); j++) {
-
-				Node *child = current->data.children[j];
-
-				if (child->data.name == name) {
-
-					next = child;
-					break;
-				}
-			}
+			next = current->_get_child_by_name(name);
 			if (next == NULL) {
 				return NULL;
 			};
@@ -1343,6 +1465,17 @@ Node *Node::_get_node(const NodePath &p_path) const {
 		current = next;
 	}
 
+	if (use_cache && current) {
+
+		if (!data.get_node_cache)
+			data.get_node_cache = memnew(GetNodeCache);
+
+		GetNodeCache *cache = data.get_node_cache;
+		cache->path[slot] = p_path;
+		cache->node[slot] = current;
+		cache->version[slot] = tree_structure_version;
+	}
+
 	return current;
 }
 
@@ -2714,6 +2847,8 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_process_delta_time"), &Node::get_process_delta_time);
 	ClassDB::bind_method(D_METHOD("set_process", "enable"), &Node::set_process);
 	ClassDB::bind_method(D_METHOD("set_process_priority", "priority"), &Node::set_process_priority);
+	ClassDB::bind_method(D_METHOD("set_process_thread_safe", "enable"), &Node::set_process_thread_safe);
+	ClassDB::bind_method(D_METHOD("is_process_thread_safe"), &Node::is_process_thread_safe);
 	ClassDB::bind_method(D_METHOD("is_processing"), &Node::is_processing);
 	ClassDB::bind_method(D_METHOD("set_process_input", "enable"), &Node::set_process_input);
 	ClassDB::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
@@ -2867,6 +3002,10 @@ Node::Node() {
 	data.physics_process = false;
 	data.idle_process = false;
 	data.process_priority = 0;
+	data.process_thread_safe = false;
+	data.child_index = NULL;
+	data.child_index_has_duplicates = false;
+	data.get_node_cache = NULL;
 	data.physics_process_internal = false;
 	data.idle_process_internal = false;
 	data.inside_tree = false;
@@ -2895,6 +3034,11 @@ Node::~Node() {
 	data.owned.clear();
 	data.children.clear();
 
+	if (data.child_index)
+		memdelete(data.child_index);
+	if (data.get_node_cache)
+		memdelete(data.get_node_cache);
+
 	ERR_FAIL_COND(data.parent);
 	ERR_FAIL_COND(data.children.size());
 }
@@ -34,6 +34,7 @@
 #include "core/class_db.h"
 #include "core/map.h"
 #include "core/node_path.h"
+#include "core/oa_hash_map.h"
 #include "core/object.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
@@ -76,6 +77,13 @@ public:
 	};
 
 private:
+	enum {
+		CHILD_INDEX_MIN_CHILDREN = 16, // below this, scanning the children is as fast as hashing
+		GET_NODE_CACHE_SIZE = 4 // resolved paths remembered per node, direct mapped by path hash
+	};
+
+	typedef OAHashMap<StringName, Node *> ChildIndex;
+
 	struct GroupData {
 
 		bool persistent;
@@ -83,6 +91,21 @@ private:
 		GroupData() { persistent = false; }
 	};
 
+	// Multi-name paths resolved from this node, valid while tree_structure_version is unchanged.
+	struct GetNodeCache {
+
+		NodePath path[GET_NODE_CACHE_SIZE];
+		Node *node[GET_NODE_CACHE_SIZE];
+		uint64_t version[GET_NODE_CACHE_SIZE];
+
+		GetNodeCache() {
+			for (int i = 0; i < GET_NODE_CACHE_SIZE; i++) {
+				node[i] = NULL;
+				version[i] = 0;
+			}
+		}
+	};
+
 	struct Data {
 
 		String filename;
@@ -94,6 +117,8 @@ private:
 		Node *parent;
 		Node *owner;
 		Vector<Node *> children; // list of children
+		ChildIndex *child_index; // first child with each name, only once there are many children
+		bool child_index_has_duplicates; // names not validated on add may repeat, the first child wins like a scan
 		int pos;
 		int depth;
 		int blocked; // safeguard that throws an error when attempting to modify the tree in a harmful way while being traversed.
@@ -124,6 +149,7 @@ private:
 		bool physics_process;
 		bool idle_process;
 		int process_priority;
+		bool process_thread_safe;
 
 		bool physics_process_internal;
 		bool idle_process_internal;
@@ -139,9 +165,12 @@ private:
 		bool display_folded;
 
 		mutable NodePath *path_cache;
+		mutable GetNodeCache *get_node_cache;
 
 	} data;
 
+	static uint64_t tree_structure_version; // bumped whenever any node gains, loses, moves or renames a child
+
 	enum NameCasing {
 		NAME_CASING_PASCAL_CASE,
 		NAME_CASING_CAMEL_CASE,
@@ -156,6 +185,12 @@ private:
 	Node *_get_node(const NodePath &p_path) const;
 	Node *_get_child_by_name(const StringName &p_name) const;
 
+	void _child_index_rebuild();
+	void _child_index_add(Node *p_child);
+	void _child_index_remove(Node *p_child);
+	void _child_index_rename(Node *p_child, const StringName &p_old_name);
+	_FORCE_INLINE_ static void _tree_structure_changed() { atomic_increment(&tree_structure_version); }
+
 	void _replace_connections_target(Node *p_new_target);
 
 	void _validate_child_name(Node *p_child, bool p_force_human_readable = false);
@@ -330,6 +365,9 @@ public:
 
 	void set_process_priority(int p_priority);
 
+	void set_process_thread_safe(bool p_enable);
+	bool is_process_thread_safe() const;
+
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
 
@@ -35,6 +35,7 @@
 #include "core/message_queue.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
+#include "core/os/threaded_array_processor.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
 #include "editor/editor_node.h"
@@ -119,6 +120,7 @@ SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_nod
 	E->get().nodes.push_back(p_node);
 	//E->get().last_tree_version=0;
 	E->get().changed = true;
+	E->get().process_flags_changed = true;
 	return &E->get();
 }
 
@@ -127,9 +129,20 @@ void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
 	ERR_FAIL_COND(!E);
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.empty())
+	Group &g = E->get();
+	int idx = g.nodes.find(p_node);
+	if (idx == -1)
+		return;
+
+	g.nodes.remove(idx);
+	if (g.nodes.empty()) {
 		group_map.erase(E);
+		return;
+	}
+
+	//removing keeps the order, so the flags stay valid if they were
+	if (!g.process_flags_changed)
+		g.process_flags.remove(idx);
 }
 
 void SceneTree::make_group_changed(const StringName &p_group) {
@@ -189,6 +202,25 @@ void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
 		node_sort.sort(nodes, node_count);
 	}
 	g.changed = false;
+	g.process_flags_changed = true;
+}
+
+void SceneTree::_update_process_flags(Group &g) {
+
+	if (!g.process_flags_changed)
+		return;
+
+	int node_count = g.nodes.size();
+	g.process_flags.resize(node_count);
+
+	const Node *const *nodes = g.nodes.ptr();
+	uint8_t *flags = g.process_flags.ptrw();
+
+	for (int i = 0; i < node_count; i++) {
+		flags[i] = nodes[i]->is_process_thread_safe() ? PROCESS_FLAG_THREAD_SAFE : 0;
+	}
+
+	g.process_flags_changed = false;
 }
 
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
@@ -227,7 +259,7 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 	_update_group_order(g);
 
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -282,7 +314,7 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 	_update_group_order(g);
 
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -331,7 +363,7 @@ void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group
 	_update_group_order(g);
 
 	Vector<Node *> nodes_copy = g.nodes;
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 	int node_count = nodes_copy.size();
 
 	call_lock++;
@@ -470,8 +502,8 @@ bool SceneTree::iteration(float p_time) {
 
 	emit_signal("physics_frame");
 
-	_notify_group_pause("physics_process_internal", Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
-	_notify_group_pause("physics_process", Node::NOTIFICATION_PHYSICS_PROCESS);
+	_notify_group_pause(physics_process_internal_name, Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
+	_notify_group_pause(physics_process_name, Node::NOTIFICATION_PHYSICS_PROCESS);
 	_flush_ugc();
 	MessageQueue::get_singleton()->flush(); //small little hack
 	flush_transform_notifications();
@@ -506,8 +538,8 @@ bool SceneTree::idle(float p_time) {
 
 	flush_transform_notifications();
 
-	_notify_group_pause("idle_process_internal", Node::NOTIFICATION_INTERNAL_PROCESS);
-	_notify_group_pause("idle_process", Node::NOTIFICATION_PROCESS);
+	_notify_group_pause(idle_process_internal_name, Node::NOTIFICATION_INTERNAL_PROCESS);
+	_notify_group_pause(idle_process_name, Node::NOTIFICATION_PROCESS);
 
 	Size2 win_size = Size2(OS::get_singleton()->get_window_size().width, OS::get_singleton()->get_window_size().height);
 
@@ -905,7 +937,7 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 	Vector<Node *> nodes_copy = g.nodes;
 
 	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
 
 	Variant arg = p_input;
 	const Variant *v[1] = { &arg };
@@ -944,18 +976,39 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 
 	_update_group_order(g, p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
 
+	//only the script callbacks can be declared thread-safe, internal processing always runs serially
+	bool use_flags = p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS;
+	if (use_flags)
+		_update_process_flags(g);
+
 	//copy, so copy on write happens in case something is removed from process while being called
 	//performance is not lost because only if something is added/removed the vector is copied.
 	Vector<Node *> nodes_copy = g.nodes;
+	Vector<uint8_t> flags_copy;
+	if (use_flags)
+		flags_copy = g.process_flags;
 
+	//read through ptr(), ptrw() would make the copy unique and allocate every frame
 	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	Node *const *nodes = nodes_copy.ptr();
+	const uint8_t *flags = use_flags ? flags_copy.ptr() : NULL;
 
 	call_lock++;
 
-	for (int i = 0; i < node_count; i++) {
+	int i = 0;
+	while (i < node_count) {
 
-		Node *n = nodes[i];
+		if (flags && (flags[i] & PROCESS_FLAG_THREAD_SAFE)) {
+			//consecutive thread-safe nodes are notified together, the nodes around them keep their order
+			int from = i;
+			while (i < node_count && (flags[i] & PROCESS_FLAG_THREAD_SAFE))
+				i++;
+
+			_notify_thread_safe_run(&nodes[from], i - from, p_notification);
+			continue;
+		}
+
+		Node *n = nodes[i++];
 		if (call_lock && call_skip.has(n))
 			continue;
 
@@ -973,6 +1026,68 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 		call_skip.clear();
 }
 
+void SceneTree::_notify_process_batch(uint32_t p_chunk, ProcessBatch *p_batch) {
+
+	int from = p_chunk * PROCESS_THREAD_CHUNK_SIZE;
+	int to = MIN(from + PROCESS_THREAD_CHUNK_SIZE, p_batch->count);
+
+	for (int i = from; i < to; i++) {
+		p_batch->nodes[i]->notification(p_batch->notification);
+	}
+}
+
+void SceneTree::_notify_thread_safe_run(Node *const *p_nodes, int p_count, int p_notification) {
+
+	if (p_count <= PROCESS_THREAD_CHUNK_SIZE) {
+		//not worth waking up the workers
+		for (int i = 0; i < p_count; i++) {
+
+			Node *n = p_nodes[i];
+			if (call_skip.has(n))
+				continue;
+			if (!n->can_process())
+				continue;
+			if (!n->can_process_notification(p_notification))
+				continue;
+
+			n->notification(p_notification);
+		}
+		return;
+	}
+
+	//filter on this thread, the checks read state that only the main thread may touch
+	if (process_batch.size() < p_count)
+		process_batch.resize(p_count);
+
+	Node **batch = process_batch.ptrw();
+	int count = 0;
+
+	for (int i = 0; i < p_count; i++) {
+
+		Node *n = p_nodes[i];
+		if (call_skip.has(n))
+			continue;
+		if (!n->can_process())
+			continue;
+		if (!n->can_process_notification(p_notification))
+			continue;
+
+		batch[count++] = n;
+	}
+
+	ProcessBatch data;
+	data.nodes = batch;
+	data.count = count;
+	data.notification = p_notification;
+
+	uint32_t chunk_count = (count + PROCESS_THREAD_CHUNK_SIZE - 1) / PROCESS_THREAD_CHUNK_SIZE;
+	if (chunk_count > 1) {
+		thread_process_array(chunk_count, this, &SceneTree::_notify_process_batch, &data);
+	} else {
+		_notify_process_batch(0, &data);
+	}
+}
+
 /*
 void SceneMainLoop::_update_listener_2d() {
 
@@ -1965,6 +2080,10 @@ SceneTree::SceneTree() {
 	tree_changed_name = "tree_changed";
 	node_added_name = "node_added";
 	node_removed_name = "node_removed";
+	idle_process_name = "idle_process";
+	idle_process_internal_name = "idle_process_internal";
+	physics_process_name = "physics_process";
+	physics_process_internal_name = "physics_process_internal";
 	ugc_locked = false;
 	call_lock = 0;
 	root_lock = 0;
@@ -95,12 +95,29 @@ public:
 	};
 
 private:
+	enum {
+		PROCESS_FLAG_THREAD_SAFE = 1,
+		PROCESS_THREAD_CHUNK_SIZE = 64 // nodes notified per worker task
+	};
+
 	struct Group {
 
 		Vector<Node *> nodes;
+		Vector<uint8_t> process_flags; // parallel to nodes, PROCESS_FLAG_*, only kept for the process groups
 		//uint64_t last_tree_version;
 		bool changed;
-		Group() { changed = false; };
+		bool process_flags_changed;
+		Group() {
+			changed = false;
+			process_flags_changed = true;
+		};
+	};
+
+	struct ProcessBatch {
+
+		Node **nodes;
+		int count;
+		int notification;
 	};
 
 	Viewport *root;
@@ -128,6 +145,11 @@ private:
 	StringName node_added_name;
 	StringName node_removed_name;
 
+	StringName idle_process_name;
+	StringName idle_process_internal_name;
+	StringName physics_process_name;
+	StringName physics_process_internal_name;
+
 	bool use_font_oversampling;
 	int64_t current_frame;
 	int64_t current_event;
@@ -148,6 +170,8 @@ private:
 	int call_lock;
 	Set<Node *> call_skip; //skip erased nodes
 
+	Vector<Node *> process_batch; // scratch list for the thread-safe runs, kept to avoid allocating each frame
+
 	StretchMode stretch_mode;
 	StretchAspect stretch_aspect;
 	Size2i stretch_min;
@@ -162,6 +186,9 @@ private:
 	void _flush_ugc();
 
 	_FORCE_INLINE_ void _update_group_order(Group &g, bool p_use_priority = false);
+	void _update_process_flags(Group &g);
+	void _notify_process_batch(uint32_t p_chunk, ProcessBatch *p_batch);
+	void _notify_thread_safe_run(Node *const *p_nodes, int p_count, int p_notification);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -921,7 +921,7 @@ Error ResourceInteractiveLoaderText::save_as_binary(FileAccess *p_f, const Strin
 	wf->store_32(0); //64 bits file, false for now
 	wf->store_32(VERSION_MAJOR);
 	wf->store_32(VERSION_MINOR);
-	static const int save_format_version = 3; //use format version 3 for saving
+	static const int save_format_version = 4; //use format version 4 for saving
 	wf->store_32(save_format_version);
 
 	bs_save_unicode_string(wf.f, is_scene ? "PackedScene" : resource_type);
@@ -1142,6 +1142,11 @@ Error ResourceInteractiveLoaderText::save_as_binary(FileAccess *p_f, const Strin
 
 	wf2->close();
 
+	//arrays are aligned within the temp file, so it has to start aligned too
+	while (wf->get_position() % ResourceFormatSaverBinaryInstance::ARRAY_ALIGNMENT) {
+		wf->store_8(0);
+	}
+
 	size_t offset_from = wf->get_position();
 	wf->seek(sub_res_count_pos); //plus one because the saved one
 	wf->store_32(local_offsets.size());
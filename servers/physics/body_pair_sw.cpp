@@ -221,6 +221,8 @@ real_t combine_friction(BodySW *A, BodySW *B) {
 
 bool BodyPairSW::setup(real_t p_step) {
 
+	check_ccd = false;
+
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
@@ -252,16 +254,8 @@ bool BodyPairSW::setup(real_t p_step) {
 
 	if (!collided) {
 
-		//test ccd (currently just a raycast)
-
-		if (A->is_continuous_collision_detection_enabled() && A->get_mode() > PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC) {
-			_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B);
-		}
-
-		if (B->is_continuous_collision_detection_enabled() && B->get_mode() > PhysicsServer::BODY_MODE_KINEMATIC && A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC) {
-			_test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A);
-		}
-
+		//ccd changes the body velocity, so it's tested in pre_solve()
+		check_ccd = true;
 		return false;
 	}
 
@@ -298,6 +292,62 @@ bool BodyPairSW::setup(real_t p_step) {
 
 		c.active = true;
 
+		c.rA = global_A - A->get_center_of_mass();
+		c.rB = global_B - B->get_center_of_mass() - offset_B;
+
+		// Precompute normal mass, tangent mass, and bias.
+		Vector3 inertia_A = A->get_inv_inertia_tensor().xform(c.rA.cross(c.normal));
+		Vector3 inertia_B = B->get_inv_inertia_tensor().xform(c.rB.cross(c.normal));
+		real_t kNormal = A->get_inv_mass() + B->get_inv_mass();
+		kNormal += c.normal.dot(inertia_A.cross(c.rA)) + c.normal.dot(inertia_B.cross(c.rB));
+		c.mass_normal = 1.0f / kNormal;
+
+		c.bias = -bias * inv_dt * MIN(0.0f, -depth + max_penetration);
+		c.depth = depth;
+	}
+
+	return true;
+}
+
+bool BodyPairSW::pre_solve(real_t p_step) {
+
+	if (!collided) {
+
+		if (!check_ccd)
+			return false;
+
+		//test ccd (currently just a raycast)
+
+		Transform xform_A = Transform(A->get_transform().basis, Vector3()) * A->get_shape_transform(shape_A);
+		Transform xform_Bu = B->get_transform();
+		xform_Bu.origin -= A->get_transform().get_origin();
+		Transform xform_B = xform_Bu * B->get_shape_transform(shape_B);
+
+		if (A->is_continuous_collision_detection_enabled() && A->get_mode() > PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC) {
+			_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B);
+		}
+
+		if (B->is_continuous_collision_detection_enabled() && B->get_mode() > PhysicsServer::BODY_MODE_KINEMATIC && A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC) {
+			_test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A);
+		}
+
+		return false;
+	}
+
+	Vector3 offset_A = A->get_transform().get_origin();
+	Transform xform_Au = Transform(A->get_transform().basis, Vector3());
+	Transform xform_Bu = B->get_transform();
+	xform_Bu.origin -= offset_A;
+
+	for (int i = 0; i < contact_count; i++) {
+
+		Contact &c = contacts[i];
+		if (!c.active)
+			continue;
+
+		Vector3 global_A = xform_Au.xform(c.local_A);
+		Vector3 global_B = xform_Bu.xform(c.local_B);
+
 #ifdef DEBUG_ENABLED
 
 		if (space->is_debugging_contacts()) {
@@ -306,33 +356,18 @@ bool BodyPairSW::setup(real_t p_step) {
 		}
 #endif
 
-		c.rA = global_A - A->get_center_of_mass();
-		c.rB = global_B - B->get_center_of_mass() - offset_B;
-
 		// contact query reporting...
 
 		if (A->can_report_contacts()) {
 			Vector3 crA = A->get_angular_velocity().cross(c.rA) + A->get_linear_velocity();
-			A->add_contact(global_A, -c.normal, depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crA);
+			A->add_contact(global_A, -c.normal, c.depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crA);
 		}
 
 		if (B->can_report_contacts()) {
 			Vector3 crB = B->get_angular_velocity().cross(c.rB) + B->get_linear_velocity();
-			B->add_contact(global_B, c.normal, depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crB);
+			B->add_contact(global_B, c.normal, c.depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crB);
 		}
 
-		c.active = true;
-
-		// Precompute normal mass, tangent mass, and bias.
-		Vector3 inertia_A = A->get_inv_inertia_tensor().xform(c.rA.cross(c.normal));
-		Vector3 inertia_B = B->get_inv_inertia_tensor().xform(c.rB.cross(c.normal));
-		real_t kNormal = A->get_inv_mass() + B->get_inv_mass();
-		kNormal += c.normal.dot(inertia_A.cross(c.rA)) + c.normal.dot(inertia_B.cross(c.rB));
-		c.mass_normal = 1.0f / kNormal;
-
-		c.bias = -bias * inv_dt * MIN(0.0f, -depth + max_penetration);
-		c.depth = depth;
-
 		Vector3 j_vec = c.normal * c.acc_normal_impulse + c.acc_tangent_impulse;
 		A->apply_impulse(c.rA + A->get_center_of_mass(), -j_vec);
 		B->apply_impulse(c.rB + B->get_center_of_mass(), j_vec);
@@ -486,6 +521,7 @@ BodyPairSW::BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B) :
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	check_ccd = false;
 }
 
 BodyPairSW::~BodyPairSW() {
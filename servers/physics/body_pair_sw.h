@@ -76,6 +76,7 @@ class BodyPairSW : public ConstraintSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	bool check_ccd;
 
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
 
@@ -88,6 +89,7 @@ class BodyPairSW : public ConstraintSW {
 
 public:
 	bool setup(real_t p_step);
+	bool pre_solve(real_t p_step);
 	void solve(real_t p_step);
 
 	BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B);
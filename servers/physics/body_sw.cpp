@@ -560,14 +560,23 @@ void BodySW::integrate_forces(real_t p_step) {
 	biased_angular_velocity = Vector3();
 	biased_linear_velocity = Vector3();
 
-	if (do_motion) { //shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
-	}
+	//shapes temporarily extend for raycast, the broadphase is updated later from a single thread
+	pending_motion = motion;
+	motion_pending = do_motion;
 
 	def_area = NULL; // clear the area, so it is set in the next frame
 	contact_count = 0;
 }
 
+void BodySW::apply_pending_motion() {
+
+	if (!motion_pending)
+		return;
+
+	_update_shapes_with_motion(pending_motion);
+	motion_pending = false;
+}
+
 void BodySW::integrate_velocities(real_t p_step) {
 
 	if (mode == PhysicsServer::BODY_MODE_STATIC)
@@ -780,6 +789,7 @@ BodySW::BodySW() :
 	island_list_next = NULL;
 	first_time_kinematic = false;
 	first_integration = false;
+	motion_pending = false;
 	_set_static(false);
 
 	contact_count = 0;
@@ -89,6 +89,9 @@ class BodySW : public CollisionObjectSW {
 
 	bool first_integration;
 
+	Vector3 pending_motion;
+	bool motion_pending;
+
 	bool continuous_cd;
 	bool can_sleep;
 	bool first_time_kinematic;
@@ -221,19 +224,30 @@ public:
 		linear_velocity += p_j * _inv_mass;
 	}
 
+	// Static and kinematic bodies can be shared by islands solved in parallel, so they are never written to.
+
 	_FORCE_INLINE_ void apply_impulse(const Vector3 &p_pos, const Vector3 &p_j) {
 
+		if (mode <= PhysicsServer::BODY_MODE_KINEMATIC)
+			return;
+
 		linear_velocity += p_j * _inv_mass;
 		angular_velocity += _inv_inertia_tensor.xform((p_pos - center_of_mass).cross(p_j));
 	}
 
 	_FORCE_INLINE_ void apply_torque_impulse(const Vector3 &p_j) {
 
+		if (mode <= PhysicsServer::BODY_MODE_KINEMATIC)
+			return;
+
 		angular_velocity += _inv_inertia_tensor.xform(p_j);
 	}
 
 	_FORCE_INLINE_ void apply_bias_impulse(const Vector3 &p_pos, const Vector3 &p_j, real_t p_max_delta_av = -1.0) {
 
+		if (mode <= PhysicsServer::BODY_MODE_KINEMATIC)
+			return;
+
 		biased_linear_velocity += p_j * _inv_mass;
 		if (p_max_delta_av != 0.0) {
 			Vector3 delta_av = _inv_inertia_tensor.xform((p_pos - center_of_mass).cross(p_j));
@@ -306,6 +320,7 @@ public:
 	bool is_axis_locked(PhysicsServer::BodyAxis p_axis) const;
 
 	void integrate_forces(real_t p_step);
+	void apply_pending_motion();
 	void integrate_velocities(real_t p_step);
 
 	_FORCE_INLINE_ Vector3 get_velocity_in_local_point(const Vector3 &rel_pos) const {
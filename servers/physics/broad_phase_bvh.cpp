@@ -0,0 +1,476 @@
+/*************************************************************************/
+/*  broad_phase_bvh.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_bvh.h"
+
+void BroadPhaseBVH::_insert_proxy(ID p_id) {
+
+	Proxy &p = proxies.write[p_id - 1];
+	Tree &tree = _get_tree(p);
+
+	int leaf = tree.allocate_node();
+	tree.nodes[leaf].aabb = Tree::fatten(p.aabb);
+	tree.nodes[leaf].id = p_id;
+	tree.nodes[leaf].dirty = true;
+	tree.insert_leaf(leaf);
+	p.leaf = leaf;
+}
+
+void BroadPhaseBVH::_mark_moved(ID p_id) {
+
+	Proxy &p = proxies.write[p_id - 1];
+	if (p.moved)
+		return;
+
+	p.moved = true;
+	moved.push_back(p_id);
+}
+
+void BroadPhaseBVH::_pair(ID p_a, ID p_b) {
+
+	uint64_t key = _pair_key(p_a, p_b);
+	if (pair_map.has(key))
+		return;
+
+	if (p_a > p_b) {
+		SWAP(p_a, p_b);
+	}
+
+	Proxy &pa = proxies.write[p_a - 1];
+	Proxy &pb = proxies.write[p_b - 1];
+
+	void *data = NULL;
+	if (pair_callback) {
+		data = pair_callback(pa.object, pa.subindex, pb.object, pb.subindex, pair_userdata);
+	}
+
+	pair_map.set(key, data);
+	pa.pairs.push_back(p_b);
+	pb.pairs.push_back(p_a);
+}
+
+void BroadPhaseBVH::_unpair(ID p_a, ID p_b) {
+
+	uint64_t key = _pair_key(p_a, p_b);
+	void **data = pair_map.getptr(key);
+	ERR_FAIL_COND(!data);
+
+	if (p_a > p_b) {
+		SWAP(p_a, p_b);
+	}
+
+	Proxy &pa = proxies.write[p_a - 1];
+	Proxy &pb = proxies.write[p_b - 1];
+
+	if (unpair_callback) {
+		unpair_callback(pa.object, pa.subindex, pb.object, pb.subindex, *data, unpair_userdata);
+	}
+
+	pair_map.erase(key);
+	pa.pairs.erase(p_b);
+	pb.pairs.erase(p_a);
+}
+
+void BroadPhaseBVH::_find_pairs(Tree &p_tree_a, Tree &p_tree_b) {
+
+	if (p_tree_a.root == -1 || p_tree_b.root == -1)
+		return;
+
+	bool self = &p_tree_a == &p_tree_b;
+	const Node *nodes_a = p_tree_a.nodes;
+	const Node *nodes_b = p_tree_b.nodes;
+
+	if (!nodes_a[p_tree_a.root].dirty && !nodes_b[p_tree_b.root].dirty)
+		return; // nothing moved in either tree
+	if (!self && !nodes_a[p_tree_a.root].aabb.intersects(nodes_b[p_tree_b.root].aabb))
+		return;
+
+	int stack_size = 0;
+	int stack_capacity = pair_stack.size();
+	NodePair *stack = pair_stack.ptrw();
+
+#define PUSH_PAIR(m_a, m_b)                                \
+	{                                                      \
+		if (stack_size == stack_capacity) {                \
+			stack_capacity = MAX(stack_capacity * 2, 64);  \
+			pair_stack.resize(stack_capacity);             \
+			stack = pair_stack.ptrw();                     \
+		}                                                  \
+		stack[stack_size].a = m_a;                         \
+		stack[stack_size].b = m_b;                         \
+		stack_size++;                                      \
+	}
+
+// only pushes branches that overlap and where at least one side moved
+#define PUSH_PAIR_IF_OVERLAPS(m_a, m_b)                                                            \
+	{                                                                                              \
+		const Node &pa = nodes_a[m_a];                                                             \
+		const Node &pb = nodes_b[m_b];                                                             \
+		if ((pa.dirty || pb.dirty) && pa.aabb.intersects(pb.aabb)) {                              \
+			PUSH_PAIR(m_a, m_b);                                                                   \
+		}                                                                                          \
+	}
+
+	PUSH_PAIR(p_tree_a.root, p_tree_b.root);
+
+	while (stack_size) {
+
+		stack_size--;
+		int ia = stack[stack_size].a;
+		int ib = stack[stack_size].b;
+		const Node &a = nodes_a[ia];
+		const Node &b = nodes_b[ib];
+
+		if (self && ia == ib) {
+			// pairs inside a single subtree
+			if (a.is_leaf() || !a.dirty)
+				continue;
+
+			PUSH_PAIR(a.children[0], a.children[0]);
+			PUSH_PAIR(a.children[1], a.children[1]);
+			PUSH_PAIR_IF_OVERLAPS(a.children[0], a.children[1]);
+			continue;
+		}
+
+		if (a.is_leaf() && b.is_leaf()) {
+
+			const Proxy &pa = proxies[a.id - 1];
+			const Proxy &pb = proxies[b.id - 1];
+
+			if (pa.object == pb.object)
+				continue;
+			if (!pa.aabb.intersects(pb.aabb))
+				continue;
+
+			_pair(a.id, b.id);
+
+		} else if (b.is_leaf() || (!a.is_leaf() && a.height >= b.height)) {
+
+			PUSH_PAIR_IF_OVERLAPS(a.children[0], ib);
+			PUSH_PAIR_IF_OVERLAPS(a.children[1], ib);
+		} else {
+
+			PUSH_PAIR_IF_OVERLAPS(ia, b.children[0]);
+			PUSH_PAIR_IF_OVERLAPS(ia, b.children[1]);
+		}
+	}
+
+#undef PUSH_PAIR_IF_OVERLAPS
+#undef PUSH_PAIR
+}
+
+BroadPhaseSW::ID BroadPhaseBVH::create(CollisionObjectSW *p_object, int p_subindex) {
+
+	ERR_FAIL_COND_V(!p_object, 0);
+
+	ID id;
+	if (free_ids.size()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.resize(free_ids.size() - 1);
+	} else {
+		proxies.push_back(Proxy());
+		id = proxies.size();
+	}
+
+	Proxy &p = proxies.write[id - 1];
+	p.object = p_object;
+	p.subindex = p_subindex;
+
+	// not inserted in a tree until it gets an AABB
+	return id;
+}
+
+void BroadPhaseBVH::move(ID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_COND(p_id == 0 || (int)p_id > proxies.size());
+	Proxy &p = proxies.write[p_id - 1];
+	ERR_FAIL_COND(!p.object);
+
+	p.aabb = p_aabb;
+
+	if (p.leaf == -1) {
+
+		_insert_proxy(p_id);
+	} else {
+
+		Tree &tree = _get_tree(p);
+		if (tree.nodes[p.leaf].aabb.encloses(p_aabb)) {
+			// still inside the fat AABB, the tree does not change
+			tree.mark_dirty(p.leaf);
+		} else {
+			tree.remove_leaf(p.leaf);
+			tree.nodes[p.leaf].aabb = Tree::fatten(p_aabb);
+			tree.nodes[p.leaf].dirty = true;
+			tree.insert_leaf(p.leaf);
+		}
+	}
+
+	_mark_moved(p_id);
+}
+
+void BroadPhaseBVH::set_static(ID p_id, bool p_static) {
+
+	ERR_FAIL_COND(p_id == 0 || (int)p_id > proxies.size());
+	Proxy &p = proxies.write[p_id - 1];
+	ERR_FAIL_COND(!p.object);
+
+	if (p.is_static == p_static)
+		return;
+
+	if (p.leaf != -1) {
+
+		Tree &tree = _get_tree(p);
+		tree.remove_leaf(p.leaf);
+		tree.free_node(p.leaf);
+		p.leaf = -1;
+		p.is_static = p_static;
+		_insert_proxy(p_id);
+	} else {
+		p.is_static = p_static;
+	}
+
+	// pairs between two static proxies are dropped on the next update
+	_mark_moved(p_id);
+}
+
+void BroadPhaseBVH::remove(ID p_id) {
+
+	ERR_FAIL_COND(p_id == 0 || (int)p_id > proxies.size());
+	Proxy &p = proxies.write[p_id - 1];
+	ERR_FAIL_COND(!p.object);
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	while (p.pairs.size()) {
+		_unpair(p_id, p.pairs[p.pairs.size() - 1]);
+	}
+
+	if (p.leaf != -1) {
+		Tree &tree = _get_tree(p);
+		tree.remove_leaf(p.leaf);
+		tree.free_node(p.leaf);
+	}
+
+	// may still be in the moved list, update() skips proxies without an object
+	p = Proxy();
+	free_ids.push_back(p_id);
+}
+
+CollisionObjectSW *BroadPhaseBVH::get_object(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || (int)p_id > proxies.size(), NULL);
+	const Proxy &p = proxies[p_id - 1];
+	ERR_FAIL_COND_V(!p.object, NULL);
+	return p.object;
+}
+
+bool BroadPhaseBVH::is_static(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || (int)p_id > proxies.size(), false);
+	return proxies[p_id - 1].is_static;
+}
+
+int BroadPhaseBVH::get_subindex(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || (int)p_id > proxies.size(), -1);
+	return proxies[p_id - 1].subindex;
+}
+
+template <class T>
+int BroadPhaseBVH::_cull(const T &p_tester, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	int rc = 0;
+	if (p_max_results <= 0)
+		return 0;
+
+	Tree *trees[2] = { &dynamic_tree, &static_tree };
+
+	for (int t = 0; t < 2; t++) {
+
+		const Tree &tree = *trees[t];
+		if (tree.root == -1)
+			continue;
+
+		int stack_size = 0;
+		if (cull_stack.size() < 64) {
+			cull_stack.resize(64);
+		}
+		cull_stack.write[stack_size++] = tree.root;
+
+		while (stack_size) {
+
+			const Node &node = tree.nodes[cull_stack[--stack_size]];
+			if (!p_tester(node.aabb))
+				continue;
+
+			if (node.is_leaf()) {
+
+				const Proxy &p = proxies[node.id - 1];
+				if (!p_tester(p.aabb))
+					continue;
+
+				p_results[rc] = p.object;
+				if (p_result_indices) {
+					p_result_indices[rc] = p.subindex;
+				}
+				rc++;
+				if (rc >= p_max_results)
+					return rc;
+
+			} else {
+
+				if (stack_size + 2 > cull_stack.size()) {
+					cull_stack.resize(cull_stack.size() * 2);
+				}
+				int *stack = cull_stack.ptrw();
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	return rc;
+}
+
+struct _BVHCullPoint {
+
+	Vector3 point;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+};
+
+struct _BVHCullSegment {
+
+	Vector3 from;
+	Vector3 to;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+};
+
+struct _BVHCullAABB {
+
+	AABB aabb;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects(aabb); }
+};
+
+int BroadPhaseBVH::cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullPoint tester;
+	tester.point = p_point;
+	return _cull(tester, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseBVH::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullSegment tester;
+	tester.from = p_from;
+	tester.to = p_to;
+	return _cull(tester, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseBVH::cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullAABB tester;
+	tester.aabb = p_aabb;
+	return _cull(tester, p_results, p_max_results, p_result_indices);
+}
+
+void BroadPhaseBVH::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+
+void BroadPhaseBVH::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhaseBVH::update() {
+
+	if (moved.empty())
+		return;
+
+	// new pairs, only branches touched since the last update are visited
+	_find_pairs(dynamic_tree, dynamic_tree);
+	_find_pairs(dynamic_tree, static_tree);
+
+	// pairs are kept until the fat AABBs separate, so jitter does not recreate them every step
+	for (int i = 0; i < moved.size(); i++) {
+
+		ID id = moved[i];
+		Proxy &p = proxies.write[id - 1];
+		if (!p.object)
+			continue;
+
+		for (int j = p.pairs.size() - 1; j >= 0; j--) {
+
+			ID other_id = p.pairs[j];
+			const Proxy &other = proxies[other_id - 1];
+
+			bool keep = !(p.is_static && other.is_static);
+			if (keep) {
+				const AABB &fat_a = _get_tree(p).nodes[p.leaf].aabb;
+				const AABB &fat_b = _get_tree(other).nodes[other.leaf].aabb;
+				keep = fat_a.intersects(fat_b);
+			}
+
+			if (!keep) {
+				_unpair(id, other_id);
+			}
+		}
+	}
+
+	if (dynamic_tree.root != -1) {
+		dynamic_tree.clear_dirty(dynamic_tree.root);
+	}
+	if (static_tree.root != -1) {
+		static_tree.clear_dirty(static_tree.root);
+	}
+
+	for (int i = 0; i < moved.size(); i++) {
+		proxies.write[moved[i] - 1].moved = false;
+	}
+	moved.resize(0);
+}
+
+BroadPhaseSW *BroadPhaseBVH::_create() {
+
+	return memnew(BroadPhaseBVH);
+}
+
+BroadPhaseBVH::BroadPhaseBVH() {
+
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
+}
+
+BroadPhaseBVH::~BroadPhaseBVH() {
+}
@@ -0,0 +1,135 @@
+/*************************************************************************/
+/*  broad_phase_bvh.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2018 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2018 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_BVH_H
+#define BROAD_PHASE_BVH_H
+
+#include "broad_phase_sw.h"
+#include "core/hash_map.h"
+#include "core/math/aabb_tree.h"
+#include "core/vector.h"
+
+/*
+	Dynamic AABB tree broadphase.
+
+	Leaves store "fat" AABBs (the real AABB grown by a margin), so a proxy that moves
+	inside its fat AABB only marks its branch dirty instead of being reinserted.
+	Static and dynamic proxies live in separate trees, and pairs are found in update()
+	by traversing dynamic-vs-dynamic and dynamic-vs-static at once, skipping every
+	branch that has not been touched since the previous update.
+*/
+
+class BroadPhaseBVH : public BroadPhaseSW {
+
+	typedef AABBTree<ID> Tree;
+	typedef Tree::Node Node;
+
+	struct Proxy {
+
+		CollisionObjectSW *object;
+		int subindex;
+		AABB aabb;
+		int leaf;
+		bool is_static;
+		bool moved;
+		Vector<ID> pairs;
+
+		Proxy() {
+			object = NULL;
+			subindex = 0;
+			leaf = -1;
+			is_static = false;
+			moved = false;
+		}
+	};
+
+	Tree dynamic_tree;
+	Tree static_tree;
+
+	Vector<Proxy> proxies;
+	Vector<ID> free_ids;
+	Vector<ID> moved;
+
+	HashMap<uint64_t, void *> pair_map;
+
+	struct NodePair {
+		int a;
+		int b;
+	};
+
+	Vector<NodePair> pair_stack;
+	Vector<int> cull_stack;
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	_FORCE_INLINE_ static uint64_t _pair_key(ID p_a, ID p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	}
+
+	_FORCE_INLINE_ Tree &_get_tree(const Proxy &p_proxy) { return p_proxy.is_static ? static_tree : dynamic_tree; }
+
+	void _insert_proxy(ID p_id);
+	void _mark_moved(ID p_id);
+	void _pair(ID p_a, ID p_b);
+	void _unpair(ID p_a, ID p_b);
+	void _find_pairs(Tree &p_tree_a, Tree &p_tree_b);
+
+	template <class T>
+	int _cull(const T &p_tester, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices);
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObjectSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObjectSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhaseSW *_create();
+	BroadPhaseBVH();
+	~BroadPhaseBVH();
+};
+
+#endif // BROAD_PHASE_BVH_H
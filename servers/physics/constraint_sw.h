@@ -76,7 +76,10 @@ public:
 	_FORCE_INLINE_ void disable_collisions_between_bodies(const bool p_disabled) { disabled_collisions_between_bodies = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled_collisions_between_bodies() const { return disabled_collisions_between_bodies; }
 
+	// setup() may run on several threads at once, so it must not modify anything but the constraint itself.
+	// Anything touching the bodies, areas or space belongs in pre_solve(), which is called serially afterwards.
 	virtual bool setup(real_t p_step) = 0;
+	virtual bool pre_solve(real_t p_step) { return true; }
 	virtual void solve(real_t p_step) = 0;
 
 	virtual ~ConstraintSW() {}
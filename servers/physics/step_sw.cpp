@@ -32,6 +32,7 @@
 #include "joints_sw.h"
 
 #include "core/os/os.h"
+#include "core/os/threaded_array_processor.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
 
@@ -59,11 +60,11 @@ void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **
 	}
 }
 
-void StepSW::_setup_island(ConstraintSW *p_island, real_t p_delta) {
+void StepSW::_pre_solve_island(ConstraintSW *p_island) {
 
 	ConstraintSW *ci = p_island;
 	while (ci) {
-		ci->setup(p_delta);
+		ci->pre_solve(delta);
 		//todo remove from island if process fails
 		ci = ci->get_island_next();
 	}
@@ -144,12 +145,43 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 	}
 }
 
+void StepSW::_integrate_forces_task(uint32_t p_index, void *p_userdata) {
+
+	active_bodies[p_index]->integrate_forces(delta);
+}
+
+void StepSW::_setup_constraint_task(uint32_t p_index, void *p_userdata) {
+
+	all_constraints[p_index]->setup(delta);
+}
+
+void StepSW::_solve_island_task(uint32_t p_index, void *p_userdata) {
+
+	//iterating each island separatedly improves cache efficiency
+	_solve_island(constraint_islands[p_index], iterations, delta);
+}
+
+void StepSW::_process_batch(uint32_t p_count, uint32_t p_min_parallel, void (StepSW::*p_method)(uint32_t, void *)) {
+
+	if (p_count < p_min_parallel) {
+		for (uint32_t i = 0; i < p_count; i++) {
+			(this->*p_method)(i, NULL);
+		}
+		return;
+	}
+
+	thread_process_array(p_count, this, p_method, (void *)NULL);
+}
+
 void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	delta = p_delta;
+	iterations = p_iterations;
+
 	const SelfList<BodySW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -162,11 +194,24 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	const SelfList<BodySW> *b = body_list->first();
 	while (b) {
 
-		b->self()->integrate_forces(p_delta);
+		if (active_count == active_bodies.size()) {
+			active_bodies.resize(MAX(active_count * 2, 16));
+		}
+		active_bodies.write[active_count] = b->self();
 		b = b->next();
 		active_count++;
 	}
 
+	_process_batch(active_count, MIN_PARALLEL_BATCH, &StepSW::_integrate_forces_task);
+
+	//the broadphase can only be updated from one thread
+	for (int i = 0; i < active_count; i++) {
+		active_bodies[i]->apply_pending_motion();
+	}
+
+	//broadphases that defer pairing need to report it before islands are generated
+	p_space->update();
+
 	p_space->set_active_objects(active_count);
 
 	{ //profile
@@ -230,15 +275,39 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
+	int constraint_count = 0;
+	int constraint_island_count = 0;
+
 	{
 		ConstraintSW *ci = constraint_island_list;
 		while (ci) {
 
-			_setup_island(ci, p_delta);
+			if (constraint_island_count == constraint_islands.size()) {
+				constraint_islands.resize(MAX(constraint_island_count * 2, 16));
+			}
+			constraint_islands.write[constraint_island_count++] = ci;
+
+			ConstraintSW *c = ci;
+			while (c) {
+				if (constraint_count == all_constraints.size()) {
+					all_constraints.resize(MAX(constraint_count * 2, 16));
+				}
+				all_constraints.write[constraint_count++] = c;
+				c = c->get_island_next();
+			}
+
 			ci = ci->get_island_list_next();
 		}
 	}
 
+	//narrow phase, only touches the constraints themselves so it can run for all of them at once
+	_process_batch(constraint_count, MIN_PARALLEL_BATCH, &StepSW::_setup_constraint_task);
+
+	//contact reporting, area changes and warm starting modify bodies and areas shared between islands
+	for (int i = 0; i < constraint_island_count; i++) {
+		_pre_solve_island(constraint_islands[i]);
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(SpaceSW::ELAPSED_TIME_SETUP_CONSTRAINTS, profile_endtime - profile_begtime);
@@ -247,14 +316,8 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	//islands don't share dynamic bodies, so they can be solved at the same time
+	_process_batch(constraint_island_count, 2, &StepSW::_solve_island_task);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -288,7 +351,6 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 		profile_begtime = profile_endtime;
 	}
 
-	p_space->update();
 	p_space->unlock();
 	_step++;
 }
@@ -296,4 +358,6 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	delta = 0;
+	iterations = 0;
 }
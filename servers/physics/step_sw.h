@@ -35,13 +35,30 @@
 
 class StepSW {
 
+	enum {
+		MIN_PARALLEL_BATCH = 32 // below this, processing is not worth splitting across threads
+	};
+
 	uint64_t _step;
 
+	real_t delta;
+	int iterations;
+
+	// these only grow, to avoid reallocating every step
+	Vector<BodySW *> active_bodies;
+	Vector<ConstraintSW *> all_constraints;
+	Vector<ConstraintSW *> constraint_islands;
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
-	void _setup_island(ConstraintSW *p_island, real_t p_delta);
+	void _pre_solve_island(ConstraintSW *p_island);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(BodySW *p_island, real_t p_delta);
 
+	void _integrate_forces_task(uint32_t p_index, void *p_userdata);
+	void _setup_constraint_task(uint32_t p_index, void *p_userdata);
+	void _solve_island_task(uint32_t p_index, void *p_userdata);
+	void _process_batch(uint32_t p_count, uint32_t p_min_parallel, void (StepSW::*p_method)(uint32_t, void *));
+
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
 	StepSW();
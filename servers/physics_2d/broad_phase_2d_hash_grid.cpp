@@ -33,66 +33,110 @@
 
 #define LARGE_ELEMENT_FI 1.01239812
 
+int BroadPhase2DHashGrid::_ref_inc(RefList &p_list, Element *p_element) {
+
+	int idx = _ref_find(p_list, p_element);
+	if (idx < 0) {
+		RefEntry re;
+		re.element = p_element;
+		re.ref = 1;
+		p_list.insert(-idx - 1, re);
+		return 1;
+	}
+
+	return ++p_list.write[idx].ref;
+}
+
+int BroadPhase2DHashGrid::_ref_dec(RefList &p_list, Element *p_element) {
+
+	int idx = _ref_find(p_list, p_element);
+	ERR_FAIL_COND_V(idx < 0, -1);
+
+	int ref = --p_list.write[idx].ref;
+	if (ref == 0) {
+		p_list.remove(idx);
+	}
+
+	return ref;
+}
+
 void BroadPhase2DHashGrid::_pair_attempt(Element *p_elem, Element *p_with) {
 
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+	int idx = _pair_find(p_elem, p_with);
 
 	ERR_FAIL_COND(p_elem->_static && p_with->_static);
 
-	if (!E) {
+	if (idx < 0) {
+
+		PairEntry pe;
+		pe.data = memnew(PairData);
 
-		PairData *pd = memnew(PairData);
-		p_elem->paired[p_with] = pd;
-		p_with->paired[p_elem] = pd;
+		pe.with = p_with;
+		p_elem->paired.insert(-idx - 1, pe);
+
+		pe.with = p_elem;
+		p_with->paired.insert(-_pair_find(p_with, p_elem) - 1, pe);
 	} else {
-		E->get()->rc++;
+		p_elem->paired[idx].data->rc++;
 	}
 }
 
 void BroadPhase2DHashGrid::_unpair_attempt(Element *p_elem, Element *p_with) {
 
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+	int idx = _pair_find(p_elem, p_with);
+
+	ERR_FAIL_COND(idx < 0); //this should really be paired..
 
-	ERR_FAIL_COND(!E); //this should really be paired..
+	PairData *pd = p_elem->paired[idx].data;
 
-	E->get()->rc--;
+	pd->rc--;
 
-	if (E->get()->rc == 0) {
+	if (pd->rc == 0) {
 
-		if (E->get()->colliding) {
+		if (pd->colliding) {
 			//uncollide
 			if (unpair_callback) {
-				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, E->get()->ud, unpair_userdata);
+				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, pd->ud, unpair_userdata);
 			}
 		}
 
-		memdelete(E->get());
-		p_elem->paired.erase(E);
-		p_with->paired.erase(p_elem);
+		memdelete(pd);
+		p_elem->paired.remove(idx);
+
+		int with_idx = _pair_find(p_with, p_elem);
+		if (with_idx >= 0) {
+			p_with->paired.remove(with_idx);
+		}
 	}
 }
 
 void BroadPhase2DHashGrid::_check_motion(Element *p_elem) {
 
-	for (Map<Element *, PairData *>::Element *E = p_elem->paired.front(); E; E = E->next()) {
+	const PairEntry *ptr = p_elem->paired.ptr();
+	int count = p_elem->paired.size();
+
+	for (int i = 0; i < count; i++) {
+
+		Element *with = ptr[i].with;
+		PairData *pd = ptr[i].data;
 
-		bool pairing = p_elem->aabb.intersects(E->key()->aabb);
+		bool pairing = p_elem->aabb.intersects(with->aabb);
 
-		if (pairing != E->get()->colliding) {
+		if (pairing != pd->colliding) {
 
 			if (pairing) {
 
 				if (pair_callback) {
-					E->get()->ud = pair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, pair_userdata);
+					pd->ud = pair_callback(p_elem->owner, p_elem->subindex, with->owner, with->subindex, pair_userdata);
 				}
 			} else {
 
 				if (unpair_callback) {
-					unpair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, E->get()->ud, unpair_userdata);
+					unpair_callback(p_elem->owner, p_elem->subindex, with->owner, with->subindex, pd->ud, unpair_userdata);
 				}
 			}
 
-			E->get()->colliding = pairing;
+			pd->colliding = pairing;
 		}
 	}
 }
@@ -102,21 +146,29 @@ void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, boo
 	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
 	if (sz.width * sz.height > large_object_min_surface) {
 		//large object, do not use grid, must check against all elements
-		for (Map<ID, Element>::Element *E = element_map.front(); E; E = E->next()) {
-			if (E->key() == p_elem->self)
+		for (int i = 0; i < elements.size(); i++) {
+			Element *e = elements[i];
+			if (!e)
+				continue;
+			if (e == p_elem)
 				continue; // do not pair against itself
-			if (E->get().owner == p_elem->owner)
+			if (e->aabb == Rect2())
+				continue; // not in the grid, will pair against this one when it enters
+			if (e->owner == p_elem->owner)
 				continue;
-			if (E->get()._static && p_static)
+			if (e->_static && p_static)
 				continue;
 
-			_pair_attempt(p_elem, &E->get());
+			_pair_attempt(p_elem, e);
 		}
 
-		large_elements[p_elem].inc();
+		_ref_inc(large_elements, p_elem);
 		return;
 	}
 
+	element_size_sum += MAX(p_rect.size.width, p_rect.size.height);
+	element_size_count++;
+
 	Point2i from = (p_rect.position / cell_size).floor();
 	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
 
@@ -128,55 +180,40 @@ void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, boo
 			pk.x = i;
 			pk.y = j;
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
-
-			while (pb) {
-
-				if (pb->key == pk) {
-					break;
-				}
-
-				pb = pb->next;
-			}
-
-			bool entered = false;
+			PosBin *pb = _get_bin(pk);
 
 			if (!pb) {
 				//does not exist, create!
 				pb = memnew(PosBin);
-				pb->key = pk;
-				pb->next = hash_table[idx];
-				hash_table[idx] = pb;
+				bins->insert(pk, pb);
+			} else if (pb->object_set.empty() && pb->static_object_set.empty()) {
+				empty_bins--;
 			}
 
-			if (p_static) {
-				if (pb->static_object_set[p_elem].inc() == 1) {
-					entered = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].inc() == 1) {
-
-					entered = true;
-				}
-			}
+			bool entered = _ref_inc(p_static ? pb->static_object_set : pb->object_set, p_elem) == 1;
 
 			if (entered) {
 
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+				const RefEntry *ptr = pb->object_set.ptr();
+				int count = pb->object_set.size();
+
+				for (int k = 0; k < count; k++) {
 
-					if (E->key()->owner == p_elem->owner)
+					if (ptr[k].element->owner == p_elem->owner)
 						continue;
-					_pair_attempt(p_elem, E->key());
+					_pair_attempt(p_elem, ptr[k].element);
 				}
 
 				if (!p_static) {
 
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
+					ptr = pb->static_object_set.ptr();
+					count = pb->static_object_set.size();
 
-						if (E->key()->owner == p_elem->owner)
+					for (int k = 0; k < count; k++) {
+
+						if (ptr[k].element->owner == p_elem->owner)
 							continue;
-						_pair_attempt(p_elem, E->key());
+						_pair_attempt(p_elem, ptr[k].element);
 					}
 				}
 			}
@@ -185,16 +222,18 @@ void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, boo
 
 	//pair separatedly with large elements
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (int i = 0; i < large_elements.size(); i++) {
+
+		Element *e = large_elements[i].element;
 
-		if (E->key() == p_elem)
+		if (e == p_elem)
 			continue; // do not pair against itself
-		if (E->key()->owner == p_elem->owner)
+		if (e->owner == p_elem->owner)
 			continue;
-		if (E->key()->_static && p_static)
+		if (e->_static && p_static)
 			continue;
 
-		_pair_attempt(E->key(), p_elem);
+		_pair_attempt(e, p_elem);
 	}
 }
 
@@ -204,19 +243,18 @@ void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool
 	if (sz.width * sz.height > large_object_min_surface) {
 
 		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
-		Map<Element *, PairData *>::Element *E = p_elem->paired.front();
-		while (E) {
-			Map<Element *, PairData *>::Element *next = E->next();
-			_unpair_attempt(p_elem, E->key());
-			E = next;
+		//going backwards, as unpairing only ever removes the current entry
+		for (int i = p_elem->paired.size() - 1; i >= 0; i--) {
+			_unpair_attempt(p_elem, p_elem->paired[i].with);
 		}
 
-		if (large_elements[p_elem].dec() == 0) {
-			large_elements.erase(p_elem);
-		}
+		_ref_dec(large_elements, p_elem);
 		return;
 	}
 
+	element_size_sum -= MAX(p_rect.size.width, p_rect.size.height);
+	element_size_count--;
+
 	Point2i from = (p_rect.position / cell_size).floor();
 	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
 
@@ -228,186 +266,242 @@ void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool
 			pk.x = i;
 			pk.y = j;
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
-
-			while (pb) {
-
-				if (pb->key == pk) {
-					break;
-				}
-
-				pb = pb->next;
-			}
+			PosBin *pb = _get_bin(pk);
 
 			ERR_CONTINUE(!pb); //should exist!!
 
-			bool exited = false;
-
-			if (p_static) {
-				if (pb->static_object_set[p_elem].dec() == 0) {
-
-					pb->static_object_set.erase(p_elem);
-					exited = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].dec() == 0) {
-
-					pb->object_set.erase(p_elem);
-					exited = true;
-				}
-			}
+			bool exited = _ref_dec(p_static ? pb->static_object_set : pb->object_set, p_elem) == 0;
 
 			if (exited) {
 
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+				const RefEntry *ptr = pb->object_set.ptr();
+				int count = pb->object_set.size();
 
-					if (E->key()->owner == p_elem->owner)
+				for (int k = 0; k < count; k++) {
+
+					if (ptr[k].element->owner == p_elem->owner)
 						continue;
-					_unpair_attempt(p_elem, E->key());
+					_unpair_attempt(p_elem, ptr[k].element);
 				}
 
 				if (!p_static) {
 
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
+					ptr = pb->static_object_set.ptr();
+					count = pb->static_object_set.size();
+
+					for (int k = 0; k < count; k++) {
 
-						if (E->key()->owner == p_elem->owner)
+						if (ptr[k].element->owner == p_elem->owner)
 							continue;
-						_unpair_attempt(p_elem, E->key());
+						_unpair_attempt(p_elem, ptr[k].element);
 					}
 				}
+
+				if (pb->object_set.empty() && pb->static_object_set.empty()) {
+					// keep it, it will most likely be used again soon
+					empty_bins++;
+				}
 			}
+		}
+	}
 
-			if (pb->object_set.empty() && pb->static_object_set.empty()) {
+	for (int i = 0; i < large_elements.size(); i++) {
 
-				if (hash_table[idx] == pb) {
-					hash_table[idx] = pb->next;
-				} else {
+		Element *e = large_elements[i].element;
 
-					PosBin *px = hash_table[idx];
+		if (e == p_elem)
+			continue; // do not pair against itself
+		if (e->owner == p_elem->owner)
+			continue;
+		if (e->_static && p_static)
+			continue;
 
-					while (px) {
+		//unpair from large elements
+		_unpair_attempt(p_elem, e);
+	}
+}
 
-						if (px->next == pb) {
-							px->next = pb->next;
-							break;
-						}
+void BroadPhase2DHashGrid::_purge_empty_bins() {
 
-						px = px->next;
-					}
+	PosBinMap *new_bins = memnew(PosBinMap(bin_map_capacity));
 
-					ERR_CONTINUE(!px);
-				}
+	for (PosBinMap::Iterator it = bins->iter(); it.valid; it = bins->next_iter(it)) {
 
-				memdelete(pb);
-			}
+		PosBin *pb = *it.value;
+		if (pb->object_set.empty() && pb->static_object_set.empty()) {
+			memdelete(pb);
+		} else {
+			new_bins->insert(*it.key, pb);
 		}
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
-		if (E->key() == p_elem)
-			continue; // do not pair against itself
-		if (E->key()->owner == p_elem->owner)
+	memdelete(bins);
+	bins = new_bins;
+	empty_bins = 0;
+}
+
+void BroadPhase2DHashGrid::_resize_cells(int p_cell_size) {
+
+	// All pairs keep their data (and collision state) but lose their references, then every
+	// element enters the new grid as if it was just added. Pairs no longer referenced are
+	// dropped afterwards, those can't be colliding as overlapping elements always share a cell.
+
+	for (int i = 0; i < elements.size(); i++) {
+
+		Element *e = elements[i];
+		if (!e)
+			continue;
+
+		for (int j = 0; j < e->paired.size(); j++) {
+			e->paired[j].data->rc = 0;
+		}
+	}
+
+	for (PosBinMap::Iterator it = bins->iter(); it.valid; it = bins->next_iter(it)) {
+		memdelete(*it.value);
+	}
+	memdelete(bins);
+	bins = memnew(PosBinMap(bin_map_capacity));
+	empty_bins = 0;
+
+	large_elements.clear();
+	element_size_sum = 0;
+	element_size_count = 0;
+
+	cell_size = p_cell_size;
+
+	Vector<Rect2> rects;
+	rects.resize(elements.size());
+
+	for (int i = 0; i < elements.size(); i++) {
+
+		Element *e = elements[i];
+		if (!e)
 			continue;
-		if (E->key()->_static && p_static)
+		rects.write[i] = e->aabb;
+		e->aabb = Rect2();
+	}
+
+	for (int i = 0; i < elements.size(); i++) {
+
+		Element *e = elements[i];
+		if (!e || rects[i] == Rect2())
+			continue;
+		_enter_grid(e, rects[i], e->_static);
+		e->aabb = rects[i];
+	}
+
+	for (int i = 0; i < elements.size(); i++) {
+
+		Element *e = elements[i];
+		if (!e)
 			continue;
 
-		//unpair from large elements
-		_unpair_attempt(p_elem, E->key());
+		for (int j = e->paired.size() - 1; j >= 0; j--) {
+
+			PairData *pd = e->paired[j].data;
+			if (pd->rc > 0)
+				continue;
+
+			// let the usual path release it
+			pd->rc = 1;
+			_unpair_attempt(e, e->paired[j].with);
+		}
 	}
 }
 
 BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_object, int p_subindex) {
 
-	current++;
+	ID id;
+	if (free_ids.size()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.resize(free_ids.size() - 1);
+	} else {
+		elements.push_back(NULL);
+		id = elements.size();
+	}
 
-	Element e;
-	e.owner = p_object;
-	e._static = false;
-	e.subindex = p_subindex;
-	e.self = current;
-	e.pass = 0;
+	Element *e = memnew(Element);
+	e->owner = p_object;
+	e->_static = false;
+	e->subindex = p_subindex;
+	e->self = id;
+	e->pass = 0;
 
-	element_map[current] = e;
-	return current;
+	elements.write[id - 1] = e;
+	return id;
 }
 
 void BroadPhase2DHashGrid::move(ID p_id, const Rect2 &p_aabb) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	Element &e = E->get();
-
-	if (p_aabb == e.aabb)
+	if (p_aabb == e->aabb)
 		return;
 
 	if (p_aabb != Rect2()) {
 
-		_enter_grid(&e, p_aabb, e._static);
+		_enter_grid(e, p_aabb, e->_static);
 	}
 
-	if (e.aabb != Rect2()) {
+	if (e->aabb != Rect2()) {
 
-		_exit_grid(&e, e.aabb, e._static);
+		_exit_grid(e, e->aabb, e->_static);
 	}
 
-	e.aabb = p_aabb;
-
-	_check_motion(&e);
+	e->aabb = p_aabb;
 
-	e.aabb = p_aabb;
+	_check_motion(e);
 }
 void BroadPhase2DHashGrid::set_static(ID p_id, bool p_static) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	Element &e = E->get();
-
-	if (e._static == p_static)
+	if (e->_static == p_static)
 		return;
 
-	if (e.aabb != Rect2())
-		_exit_grid(&e, e.aabb, e._static);
+	if (e->aabb != Rect2())
+		_exit_grid(e, e->aabb, e->_static);
 
-	e._static = p_static;
+	e->_static = p_static;
 
-	if (e.aabb != Rect2()) {
-		_enter_grid(&e, e.aabb, e._static);
-		_check_motion(&e);
+	if (e->aabb != Rect2()) {
+		_enter_grid(e, e->aabb, e->_static);
+		_check_motion(e);
 	}
 }
 void BroadPhase2DHashGrid::remove(ID p_id) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	if (e.aabb != Rect2())
-		_exit_grid(&e, e.aabb, e._static);
+	if (e->aabb != Rect2())
+		_exit_grid(e, e->aabb, e->_static);
 
-	element_map.erase(p_id);
+	elements.write[p_id - 1] = NULL;
+	free_ids.push_back(p_id);
+	memdelete(e);
 }
 
 CollisionObject2DSW *BroadPhase2DHashGrid::get_object(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, NULL);
-	return E->get().owner;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, NULL);
+	return e->owner;
 }
 bool BroadPhase2DHashGrid::is_static(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, false);
-	return E->get()._static;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, false);
+	return e->_static;
 }
 int BroadPhase2DHashGrid::get_subindex(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, -1);
-	return E->get().subindex;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, -1);
+	return e->subindex;
 }
 
 template <bool use_aabb, bool use_segment>
@@ -417,62 +511,61 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
 	pk.x = p_cell.x;
 	pk.y = p_cell.y;
 
-	uint32_t idx = pk.hash() % hash_table_size;
-	PosBin *pb = hash_table[idx];
-
-	while (pb) {
-
-		if (pb->key == pk) {
-			break;
-		}
-
-		pb = pb->next;
-	}
+	PosBin *pb = _get_bin(pk);
 
 	if (!pb)
 		return;
 
-	for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
+	const RefEntry *ptr = pb->object_set.ptr();
+	int count = pb->object_set.size();
+
+	for (int i = 0; i < count; i++) {
 
 		if (index >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+
+		Element *e = ptr[i].element;
+		if (e->pass == pass)
 			continue;
 
-		E->key()->pass = pass;
+		e->pass = pass;
 
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb))
+		if (use_aabb && !p_aabb.intersects(e->aabb))
 			continue;
 
-		if (use_segment && !E->key()->aabb.intersects_segment(p_from, p_to))
+		if (use_segment && !e->aabb.intersects_segment(p_from, p_to))
 			continue;
 
-		p_results[index] = E->key()->owner;
-		p_result_indices[index] = E->key()->subindex;
+		p_results[index] = e->owner;
+		p_result_indices[index] = e->subindex;
 		index++;
 	}
 
-	for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
+	ptr = pb->static_object_set.ptr();
+	count = pb->static_object_set.size();
+
+	for (int i = 0; i < count; i++) {
 
 		if (index >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+
+		Element *e = ptr[i].element;
+		if (e->pass == pass)
 			continue;
 
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb)) {
+		if (use_aabb && !p_aabb.intersects(e->aabb)) {
 			continue;
 		}
 
-		if (use_segment && !E->key()->aabb.intersects_segment(p_from, p_to))
+		if (use_segment && !e->aabb.intersects_segment(p_from, p_to))
 			continue;
 
-		E->key()->pass = pass;
-		p_results[index] = E->key()->owner;
-		p_result_indices[index] = E->key()->subindex;
+		e->pass = pass;
+		p_results[index] = e->owner;
+		p_result_indices[index] = e->subindex;
 		index++;
 	}
 }
-
 int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) {
 
 	pass++;
@@ -548,25 +641,27 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
 			break;
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (int i = 0; i < large_elements.size(); i++) {
 
 		if (cullcount >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+
+		Element *e = large_elements[i].element;
+		if (e->pass == pass)
 			continue;
 
-		E->key()->pass = pass;
+		e->pass = pass;
 
 		/*
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb))
+		if (use_aabb && !p_aabb.intersects(e->aabb))
 			continue;
 		*/
 
-		if (!E->key()->aabb.intersects_segment(p_from, p_to))
+		if (!e->aabb.intersects_segment(p_from, p_to))
 			continue;
 
-		p_results[cullcount] = E->key()->owner;
-		p_result_indices[cullcount] = E->key()->subindex;
+		p_results[cullcount] = e->owner;
+		p_result_indices[cullcount] = e->subindex;
 		cullcount++;
 	}
 
@@ -589,25 +684,27 @@ int BroadPhase2DHashGrid::cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p
 		}
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (int i = 0; i < large_elements.size(); i++) {
 
 		if (cullcount >= p_max_results)
 			break;
-		if (E->key()->pass == pass)
+
+		Element *e = large_elements[i].element;
+		if (e->pass == pass)
 			continue;
 
-		E->key()->pass = pass;
+		e->pass = pass;
 
-		if (!p_aabb.intersects(E->key()->aabb))
+		if (!p_aabb.intersects(e->aabb))
 			continue;
 
 		/*
-		if (!E->key()->aabb.intersects_segment(p_from,p_to))
+		if (!e->aabb.intersects_segment(p_from,p_to))
 			continue;
 		*/
 
-		p_results[cullcount] = E->key()->owner;
-		p_result_indices[cullcount] = E->key()->subindex;
+		p_results[cullcount] = e->owner;
+		p_result_indices[cullcount] = e->subindex;
 		cullcount++;
 	}
 	return cullcount;
@@ -625,6 +722,24 @@ void BroadPhase2DHashGrid::set_unpair_callback(UnpairCallback p_unpair_callback,
 }
 
 void BroadPhase2DHashGrid::update() {
+
+	if (adaptive_cell_size && element_size_count >= 64) {
+
+		// aim for cells about twice the size of the average element, only resizing once
+		// that drifts by more than a factor of two, as each resize rebuilds the whole grid
+		double average = element_size_sum / element_size_count;
+		if (average > cell_size || average * 4.0 < cell_size) {
+
+			int new_cell_size = CLAMP((int)next_power_of_2(MAX(1, (int)(average * 2.0))), 8, 4096);
+			if (new_cell_size != cell_size) {
+				_resize_cells(new_cell_size);
+			}
+		}
+	}
+
+	if (empty_bins > 1024 && empty_bins > (int)bins->get_num_elements() - empty_bins) {
+		_purge_empty_bins();
+	}
 }
 
 BroadPhase2DSW *BroadPhase2DHashGrid::_create() {
@@ -634,10 +749,11 @@ BroadPhase2DSW *BroadPhase2DHashGrid::_create() {
 
 BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
 
-	hash_table_size = GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096);
+	bin_map_capacity = GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/bp_hash_table_size", PropertyInfo(Variant::INT, "physics/2d/bp_hash_table_size", PROPERTY_HINT_RANGE, "0,8192,1,or_greater"));
-	hash_table_size = Math::larger_prime(hash_table_size);
-	hash_table = memnew_arr(PosBin *, hash_table_size);
+	bin_map_capacity = Math::larger_prime(bin_map_capacity);
+	bins = memnew(PosBinMap(bin_map_capacity));
+	empty_bins = 0;
 
 	cell_size = GLOBAL_DEF("physics/2d/cell_size", 128);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/cell_size", PropertyInfo(Variant::INT, "physics/2d/cell_size", PROPERTY_HINT_RANGE, "0,512,1,or_greater"));
@@ -645,24 +761,32 @@ BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
 	large_object_min_surface = GLOBAL_DEF("physics/2d/large_object_surface_threshold_in_cells", 512);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/large_object_surface_threshold_in_cells", PropertyInfo(Variant::INT, "physics/2d/large_object_surface_threshold_in_cells", PROPERTY_HINT_RANGE, "0,1024,1,or_greater"));
 
-	for (uint32_t i = 0; i < hash_table_size; i++)
-		hash_table[i] = NULL;
-	pass = 1;
+	adaptive_cell_size = GLOBAL_DEF("physics/2d/adaptive_cell_size", false);
+	element_size_sum = 0;
+	element_size_count = 0;
 
-	current = 0;
+	pass = 1;
 }
 
 BroadPhase2DHashGrid::~BroadPhase2DHashGrid() {
 
-	for (uint32_t i = 0; i < hash_table_size; i++) {
-		while (hash_table[i]) {
-			PosBin *pb = hash_table[i];
-			hash_table[i] = pb->next;
-			memdelete(pb);
-		}
+	for (PosBinMap::Iterator it = bins->iter(); it.valid; it = bins->next_iter(it)) {
+		memdelete(*it.value);
 	}
+	memdelete(bins);
+
+	for (int i = 0; i < elements.size(); i++) {
 
-	memdelete_arr(hash_table);
+		Element *e = elements[i];
+		if (!e)
+			continue;
+
+		for (int j = 0; j < e->paired.size(); j++) {
+			if (e->paired[j].with > e)
+				memdelete(e->paired[j].data); // shared, freed from the lower side only
+		}
+		memdelete(e);
+	}
 }
 
 /* 3D version of voxel traversal:
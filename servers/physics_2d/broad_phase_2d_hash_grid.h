@@ -32,7 +32,8 @@
 #define BROAD_PHASE_2D_HASH_GRID_H
 
 #include "broad_phase_2d_sw.h"
-#include "core/map.h"
+#include "core/oa_hash_map.h"
+#include "core/vector.h"
 
 class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
@@ -48,6 +49,14 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		}
 	};
 
+	struct Element;
+
+	struct PairEntry {
+
+		Element *with;
+		PairData *data;
+	};
+
 	struct Element {
 
 		ID self;
@@ -56,65 +65,78 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		Rect2 aabb;
 		int subindex;
 		uint64_t pass;
-		Map<Element *, PairData *> paired;
+		Vector<PairEntry> paired; // sorted by element, so lookups are a binary search
 	};
 
-	struct RC {
+	// elements in a cell, or the large element list, counted once per overlapping enter.
+	// sorted by element, so lookups are a binary search
+	struct RefEntry {
 
+		Element *element;
 		int ref;
+	};
 
-		_FORCE_INLINE_ int inc() {
-			ref++;
-			return ref;
+	typedef Vector<RefEntry> RefList;
+
+	_FORCE_INLINE_ static int _ref_find(const RefList &p_list, const Element *p_element) {
+
+		const RefEntry *ptr = p_list.ptr();
+		int low = 0;
+		int high = p_list.size() - 1;
+		while (low <= high) {
+			int middle = (low + high) / 2;
+			if (ptr[middle].element == p_element)
+				return middle;
+			if (ptr[middle].element < p_element)
+				low = middle + 1;
+			else
+				high = middle - 1;
 		}
-		_FORCE_INLINE_ int dec() {
-			ref--;
-			return ref;
+		return -(low + 1); // insertion point
+	}
+
+	static int _ref_inc(RefList &p_list, Element *p_element);
+	static int _ref_dec(RefList &p_list, Element *p_element);
+
+	_FORCE_INLINE_ static int _pair_find(const Element *p_elem, const Element *p_with) {
+
+		const PairEntry *ptr = p_elem->paired.ptr();
+		int low = 0;
+		int high = p_elem->paired.size() - 1;
+		while (low <= high) {
+			int middle = (low + high) / 2;
+			if (ptr[middle].with == p_with)
+				return middle;
+			if (ptr[middle].with < p_with)
+				low = middle + 1;
+			else
+				high = middle - 1;
 		}
+		return -(low + 1); // insertion point
+	}
 
-		_FORCE_INLINE_ RC() {
-			ref = 0;
-		}
-	};
+	// IDs index this directly (minus one), freed slots are reused
+	Vector<Element *> elements;
+	Vector<ID> free_ids;
+	RefList large_elements;
 
-	Map<ID, Element> element_map;
-	Map<Element *, RC> large_elements;
+	_FORCE_INLINE_ Element *_get_element(ID p_id) const {
 
-	ID current;
+		if (p_id == 0 || p_id > (ID)elements.size())
+			return NULL;
+		return elements[p_id - 1];
+	}
 
 	uint64_t pass;
 
-	struct PairKey {
-
-		union {
-			struct {
-				ID a;
-				ID b;
-			};
-			uint64_t key;
-		};
-
-		_FORCE_INLINE_ bool operator<(const PairKey &p_key) const {
-			return key < p_key.key;
-		}
-
-		PairKey() { key = 0; }
-		PairKey(ID p_a, ID p_b) {
-			if (p_a > p_b) {
-				a = p_b;
-				b = p_a;
-			} else {
-				a = p_a;
-				b = p_b;
-			}
-		}
-	};
-
-	Map<PairKey, PairData> pair_map;
-
 	int cell_size;
 	int large_object_min_surface;
 
+	// cells are resized to fit the average element when it drifts too far from the cell size
+	bool adaptive_cell_size;
+	double element_size_sum;
+	int element_size_count;
+
 	PairCallback pair_callback;
 	void *pair_userdata;
 	UnpairCallback unpair_callback;
@@ -152,16 +174,33 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		}
 	};
 
+	struct PosKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PosKey &p_key) { return p_key.hash(); }
+	};
+
 	struct PosBin {
 
-		PosKey key;
-		Map<Element *, RC> object_set;
-		Map<Element *, RC> static_object_set;
-		PosBin *next;
+		RefList object_set;
+		RefList static_object_set;
 	};
 
-	uint32_t hash_table_size;
-	PosBin **hash_table;
+	typedef OAHashMap<PosKey, PosBin *, PosKeyHasher> PosBinMap;
+
+	// empty bins are kept around since objects usually come back to the same cells,
+	// they are only purged once they outnumber the used ones
+	PosBinMap *bins;
+	uint32_t bin_map_capacity;
+	int empty_bins;
+
+	_FORCE_INLINE_ PosBin *_get_bin(const PosKey &p_key) {
+
+		PosBin *pb = NULL;
+		bins->lookup(p_key, pb);
+		return pb;
+	}
+
+	void _purge_empty_bins();
+	void _resize_cells(int p_cell_size);
 
 	void _pair_attempt(Element *p_elem, Element *p_with);
 	void _unpair_attempt(Element *p_elem, Element *p_with);
@@ -190,11 +190,11 @@ public:
 	virtual void body_set_shape_disabled(RID p_body, int p_shape_idx, bool p_disabled);
 	virtual void body_set_shape_as_one_way_collision(RID p_body, int p_shape_idx, bool p_enable);
 
-	virtual void body_attach_object_instance_id(RID p_body, uint32_t p_ID);
-	virtual uint32_t body_get_object_instance_id(RID p_body) const;
+	virtual void body_attach_object_instance_id(RID p_body, ObjectID p_ID);
+	virtual ObjectID body_get_object_instance_id(RID p_body) const;
 
-	virtual void body_attach_canvas_instance_id(RID p_body, uint32_t p_ID);
-	virtual uint32_t body_get_canvas_instance_id(RID p_body) const;
+	virtual void body_attach_canvas_instance_id(RID p_body, ObjectID p_ID);
+	virtual ObjectID body_get_canvas_instance_id(RID p_body) const;
 
 	virtual void body_set_continuous_collision_detection_mode(RID p_body, CCDMode p_mode);
 	virtual CCDMode body_get_continuous_collision_detection_mode(RID p_body) const;
@@ -54,6 +54,7 @@
 #include "audio_server.h"
 #include "core/script_debugger_remote.h"
 #include "physics/physics_server_sw.h"
+#include "physics/physics_server_wrap_mt.h"
 #include "physics_2d/physics_2d_server_sw.h"
 #include "physics_2d/physics_2d_server_wrap_mt.h"
 #include "physics_2d_server.h"
@@ -82,7 +83,7 @@ ShaderTypes *shader_types = NULL;
 
 PhysicsServer *_createGodotPhysicsCallback() {
 	WARN_PRINT("The GodotPhysics 3D physics engine is deprecated and will be removed in Godot 3.2. You should use the Bullet physics engine instead (configurable in your project settings).");
-	return memnew(PhysicsServerSW);
+	return PhysicsServerWrapMT::init_server<PhysicsServerSW>();
 }
 
 Physics2DServer *_createGodotPhysics2DCallback() {
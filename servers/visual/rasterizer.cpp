@@ -46,3 +46,163 @@ RasterizerStorage::RasterizerStorage() {
 
 	base_singleton = this;
 }
+
+// ninepatch grid vertices are indexed as (y * 4 + x)
+#define _EIDX(y, x) (y * 4 + x)
+const uint8_t RasterizerCanvas::ninepatch_indices[3 * 2 * 9] = {
+
+	// first row
+
+	_EIDX(0, 0), _EIDX(0, 1), _EIDX(1, 1),
+	_EIDX(1, 1), _EIDX(1, 0), _EIDX(0, 0),
+
+	_EIDX(0, 1), _EIDX(0, 2), _EIDX(1, 2),
+	_EIDX(1, 2), _EIDX(1, 1), _EIDX(0, 1),
+
+	_EIDX(0, 2), _EIDX(0, 3), _EIDX(1, 3),
+	_EIDX(1, 3), _EIDX(1, 2), _EIDX(0, 2),
+
+	// second row
+
+	_EIDX(1, 0), _EIDX(1, 1), _EIDX(2, 1),
+	_EIDX(2, 1), _EIDX(2, 0), _EIDX(1, 0),
+
+	// the center one would be here, but we'll put it at the end
+	// so it's easier to disable the center and be able to use
+	// one draw call for both
+
+	_EIDX(1, 2), _EIDX(1, 3), _EIDX(2, 3),
+	_EIDX(2, 3), _EIDX(2, 2), _EIDX(1, 2),
+
+	// third row
+
+	_EIDX(2, 0), _EIDX(2, 1), _EIDX(3, 1),
+	_EIDX(3, 1), _EIDX(3, 0), _EIDX(2, 0),
+
+	_EIDX(2, 1), _EIDX(2, 2), _EIDX(3, 2),
+	_EIDX(3, 2), _EIDX(3, 1), _EIDX(2, 1),
+
+	_EIDX(2, 2), _EIDX(2, 3), _EIDX(3, 3),
+	_EIDX(3, 3), _EIDX(3, 2), _EIDX(2, 2),
+
+	// center field
+
+	_EIDX(1, 1), _EIDX(1, 2), _EIDX(2, 2),
+	_EIDX(2, 2), _EIDX(2, 1), _EIDX(1, 1)
+};
+#undef _EIDX
+
+void RasterizerCanvas::_get_rect_points(const Rect2 &p_rect, Vector2 r_points[4]) {
+
+	Size2 abs_size = p_rect.size.abs();
+
+	r_points[0] = p_rect.position;
+	r_points[1] = p_rect.position + Vector2(abs_size.x, 0.0);
+	r_points[2] = p_rect.position + abs_size;
+	r_points[3] = p_rect.position + Vector2(0.0, abs_size.y);
+
+	if (p_rect.size.x < 0) {
+		SWAP(r_points[0], r_points[1]);
+		SWAP(r_points[2], r_points[3]);
+	}
+	if (p_rect.size.y < 0) {
+		SWAP(r_points[0], r_points[3]);
+		SWAP(r_points[1], r_points[2]);
+	}
+}
+
+void RasterizerCanvas::_get_rect_uvs(const Item::CommandRect *p_rect, const Size2 &p_texpixel_size, Vector2 r_uvs[4]) {
+
+	Rect2 src_rect = (p_rect->flags & CANVAS_RECT_REGION) ? Rect2(p_rect->source.position * p_texpixel_size, p_rect->source.size * p_texpixel_size) : Rect2(0, 0, 1, 1);
+
+	r_uvs[0] = src_rect.position;
+	r_uvs[1] = src_rect.position + Vector2(src_rect.size.x, 0.0);
+	r_uvs[2] = src_rect.position + src_rect.size;
+	r_uvs[3] = src_rect.position + Vector2(0.0, src_rect.size.y);
+
+	if (p_rect->flags & CANVAS_RECT_FLIP_H) {
+		SWAP(r_uvs[0], r_uvs[1]);
+		SWAP(r_uvs[2], r_uvs[3]);
+	}
+	if (p_rect->flags & CANVAS_RECT_FLIP_V) {
+		SWAP(r_uvs[0], r_uvs[3]);
+		SWAP(r_uvs[1], r_uvs[2]);
+	}
+
+	if (p_rect->flags & CANVAS_RECT_TRANSPOSE) {
+		SWAP(r_uvs[1], r_uvs[3]);
+	}
+}
+
+void RasterizerCanvas::_get_ninepatch_grid(const Item::CommandNinePatch *p_np, const Rect2 &p_source, const Size2 &p_texpixel_size, Vector2 r_points[16], Vector2 r_uvs[16]) {
+
+	const Rect2 &rect = p_np->rect;
+
+	float x[4] = {
+		rect.position.x,
+		rect.position.x + p_np->margin[MARGIN_LEFT],
+		rect.position.x + rect.size.x - p_np->margin[MARGIN_RIGHT],
+		rect.position.x + rect.size.x
+	};
+	float y[4] = {
+		rect.position.y,
+		rect.position.y + p_np->margin[MARGIN_TOP],
+		rect.position.y + rect.size.y - p_np->margin[MARGIN_BOTTOM],
+		rect.position.y + rect.size.y
+	};
+	float u[4] = {
+		p_source.position.x * p_texpixel_size.x,
+		(p_source.position.x + p_np->margin[MARGIN_LEFT]) * p_texpixel_size.x,
+		(p_source.position.x + p_source.size.x - p_np->margin[MARGIN_RIGHT]) * p_texpixel_size.x,
+		(p_source.position.x + p_source.size.x) * p_texpixel_size.x
+	};
+	float v[4] = {
+		p_source.position.y * p_texpixel_size.y,
+		(p_source.position.y + p_np->margin[MARGIN_TOP]) * p_texpixel_size.y,
+		(p_source.position.y + p_source.size.y - p_np->margin[MARGIN_BOTTOM]) * p_texpixel_size.y,
+		(p_source.position.y + p_source.size.y) * p_texpixel_size.y
+	};
+
+	for (int j = 0; j < 4; j++) {
+		for (int i = 0; i < 4; i++) {
+			r_points[j * 4 + i] = Vector2(x[i], y[j]);
+			r_uvs[j * 4 + i] = Vector2(u[i], v[j]);
+		}
+	}
+}
+
+void RasterizerCanvas::_get_rect_batch_vertices(const Item::CommandRect *p_rect, bool p_textured, const Size2 &p_texpixel_size, const Transform2D &p_xform, BatchVertex r_vertices[6]) {
+
+	Vector2 points[4];
+	_get_rect_points(p_rect->rect, points);
+
+	Vector2 uvs[4] = { Vector2(0, 0), Vector2(1, 0), Vector2(1, 1), Vector2(0, 1) };
+	if (p_textured) {
+		_get_rect_uvs(p_rect, p_texpixel_size, uvs);
+	}
+
+	// same triangles as the fan the immediate draw uses
+	static const int quad_indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	for (int i = 0; i < 6; i++) {
+		r_vertices[i].vertex = p_xform.xform(points[quad_indices[i]]);
+		r_vertices[i].color = p_rect->modulate;
+		r_vertices[i].uv = uvs[quad_indices[i]];
+	}
+}
+
+int RasterizerCanvas::_get_ninepatch_batch_vertices(const Item::CommandNinePatch *p_np, const Rect2 &p_source, const Size2 &p_texpixel_size, const Transform2D &p_xform, BatchVertex *r_vertices) {
+
+	Vector2 points[16];
+	Vector2 uvs[16];
+	_get_ninepatch_grid(p_np, p_source, p_texpixel_size, points, uvs);
+
+	int index_count = 18 * 3 - (p_np->draw_center ? 0 : 6);
+	for (int i = 0; i < index_count; i++) {
+		int index = ninepatch_indices[i];
+		r_vertices[i].vertex = p_xform.xform(points[index]);
+		r_vertices[i].color = p_np->color;
+		r_vertices[i].uv = uvs[index];
+	}
+	return index_count;
+}
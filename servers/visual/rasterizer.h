@@ -1047,6 +1047,25 @@ public:
 		}
 	};
 
+	// the immediate and the batched draws build their geometry with these,
+	// so a command produces the same triangles whether it is batched or not
+
+	struct BatchVertex {
+
+		Vector2 vertex;
+		Color color;
+		Vector2 uv;
+	};
+
+	static const uint8_t ninepatch_indices[3 * 2 * 9]; ///< into the 4x4 grid, the center is last so it can be left out
+
+	static void _get_rect_points(const Rect2 &p_rect, Vector2 r_points[4]);
+	static void _get_rect_uvs(const Item::CommandRect *p_rect, const Size2 &p_texpixel_size, Vector2 r_uvs[4]);
+	static void _get_ninepatch_grid(const Item::CommandNinePatch *p_np, const Rect2 &p_source, const Size2 &p_texpixel_size, Vector2 r_points[16], Vector2 r_uvs[16]);
+
+	static void _get_rect_batch_vertices(const Item::CommandRect *p_rect, bool p_textured, const Size2 &p_texpixel_size, const Transform2D &p_xform, BatchVertex r_vertices[6]);
+	static int _get_ninepatch_batch_vertices(const Item::CommandNinePatch *p_np, const Rect2 &p_source, const Size2 &p_texpixel_size, const Transform2D &p_xform, BatchVertex *r_vertices); ///< writes up to 54 vertices, returns how many
+
 	virtual void canvas_begin() = 0;
 	virtual void canvas_end() = 0;
 
@@ -30,6 +30,8 @@
 
 #include "visual_server_scene.h"
 #include "core/os/os.h"
+#include "core/os/threaded_array_processor.h"
+#include "core/project_settings.h"
 #include "visual_server_global.h"
 #include "visual_server_raster.h"
 /* CAMERA API */
@@ -246,8 +248,7 @@ RID VisualServerScene::scenario_create() {
 	RID scenario_rid = scenario_owner.make_rid(scenario);
 	scenario->self = scenario_rid;
 
-	scenario->octree.set_pair_callback(_instance_pair, this);
-	scenario->octree.set_unpair_callback(_instance_unpair, this);
+	scenario->spatial_partitioning.init(spatial_partitioning_type, this);
 	scenario->reflection_probe_shadow_atlas = VSG::scene_render->shadow_atlas_create();
 	VSG::scene_render->shadow_atlas_set_size(scenario->reflection_probe_shadow_atlas, 1024); //make enough shadows for close distance, don't bother with rest
 	VSG::scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 0, 4);
@@ -344,9 +345,9 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 			}
 		}
 
-		if (scenario && instance->octree_id) {
-			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (scenario && instance->spatial_partitioning_id) {
+			scenario->spatial_partitioning.erase(instance->spatial_partitioning_id); //make dependencies generated by the octree go away
+			instance->spatial_partitioning_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -492,9 +493,9 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 
 		instance->scenario->instances.remove(&instance->scenario_item);
 
-		if (instance->octree_id) {
-			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (instance->spatial_partitioning_id) {
+			instance->scenario->spatial_partitioning.erase(instance->spatial_partitioning_id); //make dependencies generated by the octree go away
+			instance->spatial_partitioning_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -631,26 +632,26 @@ void VisualServerScene::instance_set_visible(RID p_instance, bool p_visible) {
 
 	switch (instance->base_type) {
 		case VS::INSTANCE_LIGHT: {
-			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->spatial_partitioning_id && instance->scenario) {
+				instance->scenario->spatial_partitioning.set_pairable(instance->spatial_partitioning_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_REFLECTION_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->spatial_partitioning_id && instance->scenario) {
+				instance->scenario->spatial_partitioning.set_pairable(instance->spatial_partitioning_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_LIGHTMAP_CAPTURE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->spatial_partitioning_id && instance->scenario) {
+				instance->scenario->spatial_partitioning.set_pairable(instance->spatial_partitioning_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_GI_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
+			if (instance->spatial_partitioning_id && instance->scenario) {
+				instance->scenario->spatial_partitioning.set_pairable(instance->spatial_partitioning_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
 			}
 
 		} break;
@@ -753,7 +754,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_aabb(const AABB &p_aabb, RID
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_aabb(p_aabb, cull, 1024);
+	culled = scenario->spatial_partitioning.cull_aabb(p_aabb, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -776,7 +777,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_ray(const Vector3 &p_from, co
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
+	culled = scenario->spatial_partitioning.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 		Instance *instance = cull[i];
@@ -799,7 +800,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_convex(const Vector<Plane> &p
 	int culled = 0;
 	Instance *cull[1024];
 
-	culled = scenario->octree.cull_convex(p_convex, cull, 1024);
+	culled = scenario->spatial_partitioning.cull_convex(p_convex, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -927,7 +928,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		return;
 	}
 
-	if (p_instance->octree_id == 0) {
+	if (p_instance->spatial_partitioning_id == 0) {
 
 		uint32_t base_type = 1 << p_instance->base_type;
 		uint32_t pairable_mask = 0;
@@ -946,7 +947,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		}
 
 		// not inside octree
-		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		p_instance->spatial_partitioning_id = p_instance->scenario->spatial_partitioning.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
 
 	} else {
 
@@ -955,7 +956,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			return;
 		*/
 
-		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->spatial_partitioning.move(p_instance->spatial_partitioning_id, new_aabb);
 	}
 }
 
@@ -1264,6 +1265,110 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 	}
 }
 
+int VisualServerScene::_setup_cull_chunks(int p_count) {
+
+	int chunk_count = (p_count + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+	if (cull_chunks.size() < chunk_count) {
+		cull_chunks.resize(chunk_count);
+	}
+
+	CullChunk *chunks = cull_chunks.ptrw();
+	for (int i = 0; i < chunk_count; i++) {
+		chunks[i].from = i * CULL_CHUNK_SIZE;
+		chunks[i].to = MIN(p_count, (i + 1) * CULL_CHUNK_SIZE);
+		chunks[i].count = 0;
+		chunks[i].redraw = false;
+		chunks[i].animated = false;
+		chunks[i].range_max = -1e20;
+		chunks[i].deferred.clear();
+	}
+
+	return chunk_count;
+}
+
+int VisualServerScene::_join_cull_chunks(Instance **p_instances, int p_chunk_count) {
+
+	const CullChunk *chunks = cull_chunks.ptr();
+	int count = 0;
+
+	for (int i = 0; i < p_chunk_count; i++) {
+		if (count != chunks[i].from) {
+			movemem(&p_instances[count], &p_instances[chunks[i].from], chunks[i].count * sizeof(Instance *));
+		}
+		count += chunks[i].count;
+	}
+
+	return count;
+}
+
+void VisualServerScene::_shadow_cull_chunk(uint32_t p_chunk, ShadowCullData *p_data) {
+
+	CullChunk &chunk = p_data->chunks[p_chunk];
+	Instance **instances = p_data->instances;
+	int count = chunk.from;
+
+	for (int i = chunk.from; i < chunk.to; i++) {
+
+		Instance *instance = instances[i];
+		if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+			continue;
+		}
+
+		if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
+			chunk.animated = true;
+		}
+
+		if (p_data->use_range) {
+			float min, max;
+			instance->transformed_aabb.project_range_in_plane(p_data->range_plane, min, max);
+			if (max > chunk.range_max)
+				chunk.range_max = max;
+		}
+
+		// only written once per light, so this is safe as long as the lights are processed one by one
+		instance->depth = p_data->near_plane.distance_to(instance->transform.origin);
+		instance->depth_layer = 0;
+
+		instances[count++] = instance;
+	}
+
+	chunk.count = count - chunk.from;
+}
+
+int VisualServerScene::_cull_shadow_casters(Instance **p_instances, int p_count, const Plane &p_near_plane, bool &r_animated, const Plane *p_range_plane, float *r_range_max) {
+
+	if (p_count == 0)
+		return 0;
+
+	int chunk_count = _setup_cull_chunks(p_count);
+
+	ShadowCullData data;
+	data.chunks = cull_chunks.ptrw();
+	data.instances = p_instances;
+	data.near_plane = p_near_plane;
+	data.use_range = p_range_plane != NULL;
+	if (p_range_plane) {
+		data.range_plane = *p_range_plane;
+	}
+
+	if (chunk_count > 1) {
+		thread_process_array(chunk_count, this, &VisualServerScene::_shadow_cull_chunk, &data);
+	} else {
+		_shadow_cull_chunk(0, &data);
+	}
+
+	for (int i = 0; i < chunk_count; i++) {
+		if (data.chunks[i].animated) {
+			r_animated = true;
+		}
+		if (r_range_max && data.chunks[i].count && data.chunks[i].range_max > *r_range_max) {
+			*r_range_max = data.chunks[i].range_max;
+		}
+	}
+
+	return _join_cull_chunks(p_instances, chunk_count);
+}
+
 bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
 
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
@@ -1290,7 +1395,7 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
 				//optimize min/max
 				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = p_scenario->spatial_partitioning.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
 				//check distance max and min
 
@@ -1488,29 +1593,14 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = p_scenario->spatial_partitioning.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
 				Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
+				Plane range_plane(z_vec, 0);
 
-				for (int j = 0; j < cull_count; j++) {
-
-					float min, max;
-					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-						j--;
-						continue;
-					}
-
-					instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-					if (max > z_max)
-						z_max = max;
-				}
+				cull_count = _cull_shadow_casters(instance_shadow_cull_result, cull_count, near_plane, animated_material_found, &range_plane, &z_max);
 
 				{
 
@@ -1553,25 +1643,10 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 						planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
 						planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+						int cull_count = p_scenario->spatial_partitioning.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 						Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
 
-						for (int j = 0; j < cull_count; j++) {
-
-							Instance *instance = instance_shadow_cull_result[j];
-							if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-								cull_count--;
-								SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-								j--;
-							} else {
-								if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-									animated_material_found = true;
-								}
-
-								instance->depth = near_plane.distance_to(instance->transform.origin);
-								instance->depth_layer = 0;
-							}
-						}
+						cull_count = _cull_shadow_casters(instance_shadow_cull_result, cull_count, near_plane, animated_material_found);
 
 						VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i);
 						VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
@@ -1608,24 +1683,10 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 						Vector<Plane> planes = cm.get_projection_planes(xform);
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+						int cull_count = p_scenario->spatial_partitioning.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 						Plane near_plane(xform.origin, -xform.basis.get_axis(2));
-						for (int j = 0; j < cull_count; j++) {
-
-							Instance *instance = instance_shadow_cull_result[j];
-							if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-								cull_count--;
-								SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-								j--;
-							} else {
-								if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-									animated_material_found = true;
-								}
-								instance->depth = near_plane.distance_to(instance->transform.origin);
-								instance->depth_layer = 0;
-							}
-						}
+						cull_count = _cull_shadow_casters(instance_shadow_cull_result, cull_count, near_plane, animated_material_found);
 
 						VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i);
 						VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
@@ -1647,24 +1708,10 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+			int cull_count = p_scenario->spatial_partitioning.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
-			for (int j = 0; j < cull_count; j++) {
-
-				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-					j--;
-				} else {
-					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
-					}
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-				}
-			}
+			cull_count = _cull_shadow_casters(instance_shadow_cull_result, cull_count, near_plane, animated_material_found);
 
 			VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0);
 			VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
@@ -1799,6 +1846,103 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInter
 	_render_scene(cam_transform, camera_matrix, false, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
+void VisualServerScene::_update_instance_render_data(Instance *p_instance, const Plane &p_near_plane, float p_z_far) {
+
+	InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(p_instance->base_data);
+
+	if (geom->lighting_dirty) {
+		int l = 0;
+		//only called when lights AABB enter/exit this geometry
+		p_instance->light_instances.resize(geom->lighting.size());
+
+		for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+
+			InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+
+			p_instance->light_instances.write[l++] = light->instance;
+		}
+
+		geom->lighting_dirty = false;
+	}
+
+	if (geom->reflection_dirty) {
+		int l = 0;
+		//only called when reflection probe AABB enter/exit this geometry
+		p_instance->reflection_probe_instances.resize(geom->reflection_probes.size());
+
+		for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
+
+			InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+
+			p_instance->reflection_probe_instances.write[l++] = reflection_probe->instance;
+		}
+
+		geom->reflection_dirty = false;
+	}
+
+	if (geom->gi_probes_dirty) {
+		int l = 0;
+		//only called when reflection probe AABB enter/exit this geometry
+		p_instance->gi_probe_instances.resize(geom->gi_probes.size());
+
+		for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+
+			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+
+			p_instance->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+		}
+
+		geom->gi_probes_dirty = false;
+	}
+
+	p_instance->depth = p_near_plane.distance_to(p_instance->transform.origin);
+	p_instance->depth_layer = CLAMP(int(p_instance->depth * 16 / p_z_far), 0, 15);
+}
+
+void VisualServerScene::_post_cull_chunk(uint32_t p_chunk, PostCullData *p_data) {
+
+	CullChunk &chunk = p_data->chunks[p_chunk];
+	int count = chunk.from;
+
+	for (int i = chunk.from; i < chunk.to; i++) {
+
+		Instance *ins = instance_cull_result[i];
+
+		if ((p_data->layer_mask & ins->layer_mask) == 0 || !ins->visible) {
+			ins->last_render_pass = 0;
+			continue;
+		}
+
+		if (ins->base_type == VS::INSTANCE_LIGHT || ins->base_type == VS::INSTANCE_REFLECTION_PROBE || ins->base_type == VS::INSTANCE_GI_PROBE) {
+			//these touch lists shared by the whole scene
+			chunk.deferred.push_back(ins);
+			continue;
+		}
+
+		if (!((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) || ins->cast_shadows == VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+			ins->last_render_pass = 0;
+			continue;
+		}
+
+		if (ins->base_type == VS::INSTANCE_PARTICLES) {
+			//processing is requested to the storage
+			chunk.deferred.push_back(ins);
+			continue;
+		}
+
+		if (ins->redraw_if_visible) {
+			chunk.redraw = true;
+		}
+
+		_update_instance_render_data(ins, p_data->near_plane, p_data->z_far);
+
+		ins->last_render_pass = render_pass;
+		instance_cull_result[count++] = ins;
+	}
+
+	chunk.count = count - chunk.from;
+}
+
 void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
@@ -1819,7 +1963,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	instance_cull_count = scenario->spatial_partitioning.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -1838,148 +1982,119 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
-	for (int i = 0; i < instance_cull_count; i++) {
+	int chunk_count = _setup_cull_chunks(instance_cull_count);
 
-		Instance *ins = instance_cull_result[i];
+	if (chunk_count) {
 
-		bool keep = false;
+		//geometry is processed on the worker threads, anything else is deferred to this one
+		PostCullData data;
+		data.chunks = cull_chunks.ptrw();
+		data.layer_mask = camera_layer_mask;
+		data.near_plane = near_plane;
+		data.z_far = z_far;
 
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
+		if (chunk_count > 1) {
+			thread_process_array(chunk_count, this, &VisualServerScene::_post_cull_chunk, &data);
+		} else {
+			_post_cull_chunk(0, &data);
+		}
+	}
 
-			//failure
-		} else if (ins->base_type == VS::INSTANCE_LIGHT && ins->visible) {
+	instance_cull_count = _join_cull_chunks(instance_cull_result, chunk_count);
 
-			if (ins->visible && light_cull_count < MAX_LIGHTS_CULLED) {
+	for (int c = 0; c < chunk_count; c++) {
 
-				InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
+		const CullChunk &chunk = cull_chunks[c];
 
-				if (!light->geometries.empty()) {
-					//do not add this light if no geometry is affected by it..
-					light_cull_result[light_cull_count] = ins;
-					light_instance_cull_result[light_cull_count] = light->instance;
-					if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
-						VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
-					}
+		if (chunk.redraw) {
+			VisualServerRaster::redraw_request();
+		}
 
-					light_cull_count++;
-				}
-			}
-		} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE && ins->visible) {
+		for (int i = 0; i < chunk.deferred.size(); i++) {
 
-			if (ins->visible && reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
+			Instance *ins = chunk.deferred[i];
 
-				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
+			bool keep = false;
 
-				if (p_reflection_probe != reflection_probe->instance) {
-					//avoid entering The Matrix
+			if (ins->base_type == VS::INSTANCE_LIGHT) {
 
-					if (!reflection_probe->geometries.empty()) {
-						//do not add this light if no geometry is affected by it..
+				if (light_cull_count < MAX_LIGHTS_CULLED) {
 
-						if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
-							if (!reflection_probe->update_list.in_list()) {
-								reflection_probe->render_step = 0;
-								reflection_probe_render_list.add_last(&reflection_probe->update_list);
-							}
+					InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
 
-							reflection_probe->reflection_dirty = false;
+					if (!light->geometries.empty()) {
+						//do not add this light if no geometry is affected by it..
+						light_cull_result[light_cull_count] = ins;
+						light_instance_cull_result[light_cull_count] = light->instance;
+						if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
+							VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
 						}
 
-						if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
-							reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
-							reflection_probe_cull_count++;
-						}
+						light_cull_count++;
 					}
 				}
-			}
+			} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE) {
 
-		} else if (ins->base_type == VS::INSTANCE_GI_PROBE && ins->visible) {
+				if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
 
-			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
-			if (!gi_probe->update_element.in_list()) {
-				gi_probe_update_list.add(&gi_probe->update_element);
-			}
+					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
 
-		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+					if (p_reflection_probe != reflection_probe->instance) {
+						//avoid entering The Matrix
 
-			keep = true;
+						if (!reflection_probe->geometries.empty()) {
+							//do not add this light if no geometry is affected by it..
 
-			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
+							if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
+								if (!reflection_probe->update_list.in_list()) {
+									reflection_probe->render_step = 0;
+									reflection_probe_render_list.add_last(&reflection_probe->update_list);
+								}
 
-			if (ins->redraw_if_visible) {
-				VisualServerRaster::redraw_request();
-			}
+								reflection_probe->reflection_dirty = false;
+							}
 
-			if (ins->base_type == VS::INSTANCE_PARTICLES) {
-				//particles visible? process them
-				if (VSG::storage->particles_is_inactive(ins->base)) {
-					//but if nothing is going on, don't do it.
-					keep = false;
-				} else {
-					VSG::storage->particles_request_process(ins->base);
-					//particles visible? request redraw
-					VisualServerRaster::redraw_request();
+							if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
+								reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
+								reflection_probe_cull_count++;
+							}
+						}
+					}
 				}
-			}
-
-			if (geom->lighting_dirty) {
-				int l = 0;
-				//only called when lights AABB enter/exit this geometry
-				ins->light_instances.resize(geom->lighting.size());
 
-				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
-
-					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+			} else if (ins->base_type == VS::INSTANCE_GI_PROBE) {
 
-					ins->light_instances.write[l++] = light->instance;
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
+				if (!gi_probe->update_element.in_list()) {
+					gi_probe_update_list.add(&gi_probe->update_element);
 				}
 
-				geom->lighting_dirty = false;
-			}
-
-			if (geom->reflection_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
-
-				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
-
-					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+			} else if (ins->base_type == VS::INSTANCE_PARTICLES) {
 
-					ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
+				if (ins->redraw_if_visible) {
+					VisualServerRaster::redraw_request();
 				}
 
-				geom->reflection_dirty = false;
-			}
-
-			if (geom->gi_probes_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->gi_probe_instances.resize(geom->gi_probes.size());
+				//particles visible? process them
+				//but if nothing is going on, don't do it.
+				if (!VSG::storage->particles_is_inactive(ins->base)) {
 
-				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+					keep = true;
 
-					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+					VSG::storage->particles_request_process(ins->base);
+					//particles visible? request redraw
+					VisualServerRaster::redraw_request();
 
-					ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+					_update_instance_render_data(ins, near_plane, z_far);
 				}
-
-				geom->gi_probes_dirty = false;
 			}
 
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
-		}
-
-		if (!keep) {
-			// remove, no reason to keep
-			instance_cull_count--;
-			SWAP(instance_cull_result[i], instance_cull_result[instance_cull_count]);
-			i--;
-			ins->last_render_pass = 0; // make invalid
-		} else {
-
-			ins->last_render_pass = render_pass;
+			if (!keep) {
+				ins->last_render_pass = 0; // make invalid
+			} else {
+				ins->last_render_pass = render_pass;
+				instance_cull_result[instance_cull_count++] = ins;
+			}
 		}
 	}
 
@@ -3473,6 +3588,8 @@ VisualServerScene::VisualServerScene() {
 	probe_bake_thread_exit = false;
 #endif
 
+	spatial_partitioning_type = SpatialPartitioningType(int(GLOBAL_GET("rendering/quality/spatial_partitioning/scene_index")));
+
 	render_pass = 1;
 	singleton = this;
 }
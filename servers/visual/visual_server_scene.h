@@ -34,6 +34,7 @@
 #include "servers/visual/rasterizer.h"
 
 #include "core/allocators.h"
+#include "core/math/bvh.h"
 #include "core/math/geometry.h"
 #include "core/math/octree.h"
 #include "core/os/semaphore.h"
@@ -50,6 +51,7 @@ public:
 		MAX_REFLECTION_PROBES_CULLED = 4096,
 		MAX_ROOM_CULL = 32,
 		MAX_EXTERIOR_PORTALS = 128,
+		CULL_CHUNK_SIZE = 512,
 	};
 
 	uint64_t render_pass;
@@ -116,13 +118,78 @@ public:
 
 	struct Instance;
 
+	enum SpatialPartitioningType {
+		SPATIAL_PARTITIONING_OCTREE,
+		SPATIAL_PARTITIONING_BVH,
+	};
+
+	// Instances are stored in either an octree or a BVH, chosen per project when the scenario is created.
+	class SpatialPartitioning {
+
+		Octree<Instance, true> octree;
+		BVH<Instance> bvh;
+		bool use_bvh;
+
+	public:
+		typedef uint32_t ID; // same as OctreeElementID and BVHElementID
+
+		_FORCE_INLINE_ ID create(Instance *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+			return use_bvh ? bvh.create(p_userdata, p_aabb, p_subindex, p_pairable, p_pairable_type, p_pairable_mask) : octree.create(p_userdata, p_aabb, p_subindex, p_pairable, p_pairable_type, p_pairable_mask);
+		}
+		_FORCE_INLINE_ void move(ID p_id, const AABB &p_aabb) {
+			if (use_bvh)
+				bvh.move(p_id, p_aabb);
+			else
+				octree.move(p_id, p_aabb);
+		}
+		_FORCE_INLINE_ void set_pairable(ID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+			if (use_bvh)
+				bvh.set_pairable(p_id, p_pairable, p_pairable_type, p_pairable_mask);
+			else
+				octree.set_pairable(p_id, p_pairable, p_pairable_type, p_pairable_mask);
+		}
+		_FORCE_INLINE_ void erase(ID p_id) {
+			if (use_bvh)
+				bvh.erase(p_id);
+			else
+				octree.erase(p_id);
+		}
+
+		_FORCE_INLINE_ int cull_convex(const Vector<Plane> &p_convex, Instance **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) {
+			return use_bvh ? bvh.cull_convex(p_convex, p_result_array, p_result_max, p_mask) : octree.cull_convex(p_convex, p_result_array, p_result_max, p_mask);
+		}
+		_FORCE_INLINE_ int cull_aabb(const AABB &p_aabb, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) {
+			return use_bvh ? bvh.cull_aabb(p_aabb, p_result_array, p_result_max, p_subindex_array, p_mask) : octree.cull_aabb(p_aabb, p_result_array, p_result_max, p_subindex_array, p_mask);
+		}
+		_FORCE_INLINE_ int cull_segment(const Vector3 &p_from, const Vector3 &p_to, Instance **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) {
+			return use_bvh ? bvh.cull_segment(p_from, p_to, p_result_array, p_result_max, p_subindex_array, p_mask) : octree.cull_segment(p_from, p_to, p_result_array, p_result_max, p_subindex_array, p_mask);
+		}
+
+		_FORCE_INLINE_ int get_pair_count() const { return use_bvh ? bvh.get_pair_count() : octree.get_pair_count(); }
+
+		void init(SpatialPartitioningType p_type, void *p_userdata) {
+			use_bvh = p_type == SPATIAL_PARTITIONING_BVH;
+			octree.set_pair_callback(_instance_pair, p_userdata);
+			octree.set_unpair_callback(_instance_unpair, p_userdata);
+			bvh.set_pair_callback(_instance_pair, p_userdata);
+			bvh.set_unpair_callback(_instance_unpair, p_userdata);
+		}
+
+		SpatialPartitioning() { use_bvh = false; }
+	};
+
+	SpatialPartitioningType spatial_partitioning_type;
+
+	static void *_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int);
+	static void _instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *);
+
 	struct Scenario : RID_Data {
 
 		VS::ScenarioDebugMode debug;
 		RID self;
 		// well wtf, balloon allocator is slower?
 
-		Octree<Instance, true> octree;
+		SpatialPartitioning spatial_partitioning;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -137,9 +204,6 @@ public:
 
 	mutable RID_Owner<Scenario> scenario_owner;
 
-	static void *_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int);
-	static void _instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *);
-
 	virtual RID scenario_create();
 
 	virtual void scenario_set_debug(RID p_scenario, VS::ScenarioDebugMode p_debug_mode);
@@ -158,7 +222,7 @@ public:
 
 		RID self;
 		//scenario stuff
-		OctreeElementID octree_id;
+		SpatialPartitioning::ID spatial_partitioning_id;
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -201,7 +265,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 
-			octree_id = 0;
+			spatial_partitioning_id = 0;
 			scenario = NULL;
 
 			update_aabb = false;
@@ -446,6 +510,44 @@ public:
 	RID reflection_probe_instance_cull_result[MAX_REFLECTION_PROBES_CULLED];
 	int reflection_probe_cull_count;
 
+	// cull results are processed in chunks on the worker threads, each chunk
+	// compacts what it keeps to the front of its own range, then they are joined
+	struct CullChunk {
+
+		int from;
+		int to;
+		int count;
+		bool redraw;
+		bool animated;
+		float range_max;
+		Vector<Instance *> deferred; // must be processed on the calling thread
+	};
+
+	struct PostCullData {
+
+		CullChunk *chunks;
+		uint32_t layer_mask;
+		Plane near_plane;
+		float z_far;
+	};
+
+	struct ShadowCullData {
+
+		CullChunk *chunks;
+		Instance **instances;
+		Plane near_plane;
+		bool use_range;
+		Plane range_plane;
+	};
+
+	Vector<CullChunk> cull_chunks;
+
+	int _setup_cull_chunks(int p_count);
+	int _join_cull_chunks(Instance **p_instances, int p_chunk_count);
+	void _post_cull_chunk(uint32_t p_chunk, PostCullData *p_data);
+	void _shadow_cull_chunk(uint32_t p_chunk, ShadowCullData *p_data);
+	int _cull_shadow_casters(Instance **p_instances, int p_count, const Plane &p_near_plane, bool &r_animated, const Plane *p_range_plane = NULL, float *r_range_max = NULL);
+
 	RID_Owner<Instance> instance_owner;
 
 	// from can be mesh, light,  area and portal so far.
@@ -484,6 +586,7 @@ public:
 	_FORCE_INLINE_ void _update_instance_aabb(Instance *p_instance);
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
+	_FORCE_INLINE_ void _update_instance_render_data(Instance *p_instance, const Plane &p_near_plane, float p_z_far);
 
 	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
 
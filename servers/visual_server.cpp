@@ -2406,6 +2406,9 @@ VisualServer::VisualServer() {
 	GLOBAL_DEF("rendering/quality/depth_prepass/disable_for_vendors", "PowerVR,Mali,Adreno");
 
 	GLOBAL_DEF("rendering/quality/filters/use_nearest_mipmap_filter", false);
+
+	GLOBAL_DEF("rendering/quality/spatial_partitioning/scene_index", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/spatial_partitioning/scene_index", PropertyInfo(Variant::INT, "rendering/quality/spatial_partitioning/scene_index", PROPERTY_HINT_ENUM, "Octree,BVH"));
 }
 
 VisualServer::~VisualServer() {